@@ -461,6 +461,13 @@ def envoy_select_perf_annotation(xs):
         "//conditions:default": [],
     })
 
+# Selects the given values if the fast HTTP/1 request parser is enabled in the current build.
+def envoy_select_fast_http1_parser(xs):
+    return select({
+        "@envoy//bazel:enable_fast_http1_parser": xs,
+        "//conditions:default": [],
+    })
+
 # Selects the given values if Google gRPC is enabled in the current build.
 def envoy_select_google_grpc(xs, repository = ""):
     return select({
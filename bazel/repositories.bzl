@@ -455,6 +455,10 @@ def _com_google_absl():
         name = "abseil_strings",
         actual = "@com_google_absl//absl/strings:strings",
     )
+    native.bind(
+        name = "abseil_inlined_vector",
+        actual = "@com_google_absl//absl/container:inlined_vector",
+    )
     native.bind(
         name = "abseil_int128",
         actual = "@com_google_absl//absl/numeric:int128",
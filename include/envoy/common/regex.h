@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * A regular expression compiled by one of the regex engines.
+ */
+class CompiledMatcher {
+public:
+  virtual ~CompiledMatcher() {}
+
+  /**
+   * @param value supplies the value to match.
+   * @return bool whether the whole of value matches the expression.
+   */
+  virtual bool match(absl::string_view value) const PURE;
+};
+
+typedef std::unique_ptr<const CompiledMatcher> CompiledMatcherPtr;
+
+} // namespace Regex
+} // namespace Envoy
@@ -105,7 +105,11 @@ enum class StreamResetReason {
   // If the stream was locally reset due to connection termination.
   ConnectionTermination,
   // The stream was reset because of a resource overflow.
-  Overflow
+  Overflow,
+  // If the stream was locally reset due to connection termination before its response began, while
+  // it was pipelined behind another request. Only idempotent requests are pipelined, so it is safe
+  // to retry.
+  PipelinedRequestUnanswered
 };
 
 /**
@@ -198,6 +202,9 @@ struct Http1Settings {
   bool accept_http_10_{false};
   // Set a default host if no Host: header is present for HTTP/1.0 requests.`
   std::string default_host_for_http_10_;
+  // The maximum number of requests in flight on an upstream connection, above 1 to pipeline
+  // idempotent requests.
+  uint32_t max_pipeline_depth_{1};
 };
 
 /**
@@ -210,6 +217,8 @@ struct Http2Settings {
   uint32_t initial_stream_window_size_{DEFAULT_INITIAL_STREAM_WINDOW_SIZE};
   uint32_t initial_connection_window_size_{DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE};
   bool allow_connect_{DEFAULT_ALLOW_CONNECT};
+  // The maximum number of connections an upstream connection pool opens to a host.
+  uint32_t max_connections_per_host_{1};
 
   // disable HPACK compression
   static const uint32_t MIN_HPACK_TABLE_SIZE = 0;
@@ -346,6 +355,13 @@ public:
    * @return StreamEncoder& supplies the encoder to write the request into.
    */
   virtual StreamEncoder& newStream(StreamDecoder& response_decoder) PURE;
+
+  /**
+   * @return uint32_t the maximum number of concurrent streams the peer allows on the connection.
+   *         For HTTP/2 this is the peer's SETTINGS_MAX_CONCURRENT_STREAMS, which is unlimited
+   *         until its SETTINGS frame is received.
+   */
+  virtual uint32_t remoteMaxConcurrentStreams() PURE;
 };
 
 typedef std::unique_ptr<ClientConnection> ClientConnectionPtr;
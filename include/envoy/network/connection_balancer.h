@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/listen_socket.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A connection handler, one per worker for a listener, between which accepted sockets are balanced.
+ */
+class BalancedConnectionHandler {
+public:
+  virtual ~BalancedConnectionHandler() {}
+
+  /**
+   * @return uint64_t the number of active connections of the handler, including the sockets which
+   *         were posted to it but that it didn't get yet.
+   */
+  virtual uint64_t numConnections() const PURE;
+
+  /**
+   * Increment the number of connections of the handler, for a socket about to be posted to it.
+   * This may be called from any thread.
+   */
+  virtual void incNumConnections() PURE;
+
+  /**
+   * Post an accepted socket to the handler's thread, for it to take over.
+   * @param socket supplies the socket that is moved into the callee.
+   */
+  virtual void post(ConnectionSocketPtr&& socket) PURE;
+};
+
+/**
+ * Balances the sockets accepted by a listener across the handlers of all the workers. This is
+ * shared by the workers, so it must be thread safe.
+ */
+class ConnectionBalancer {
+public:
+  virtual ~ConnectionBalancer() {}
+
+  /**
+   * Register a handler, from its worker's thread, when the listener is added to the worker.
+   * @param handler supplies the handler, which must be unregistered before it is destroyed.
+   */
+  virtual void registerHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Unregister a handler, from its worker's thread, when the listener is removed from the worker.
+   * Once this returns, no socket is being handed to the handler.
+   * @param handler supplies the handler.
+   */
+  virtual void unregisterHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Pick the handler which takes over a socket which was just accepted. If it isn't the current
+   * handler, its number of connections is incremented, so that concurrent picks account for it,
+   * and the socket is posted to it, before the handler may be unregistered by its worker.
+   * @param current_handler supplies the handler which accepted the socket.
+   * @param socket supplies the socket, which is moved from if it is posted to another handler.
+   * @return bool whether the socket was posted to another handler. If not, the current handler
+   *         keeps it.
+   */
+  virtual bool balanceSocket(BalancedConnectionHandler& current_handler,
+                             ConnectionSocketPtr& socket) PURE;
+};
+
+typedef std::unique_ptr<ConnectionBalancer> ConnectionBalancerPtr;
+
+} // namespace Network
+} // namespace Envoy
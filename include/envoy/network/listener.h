@@ -6,6 +6,7 @@
 
 #include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/ssl/context.h"
@@ -39,6 +40,14 @@ public:
    */
   virtual Socket& socket() PURE;
 
+  /**
+   * @param worker_index supplies the index of the worker, lower than the number of workers.
+   * @return Socket& the listen socket of a worker. Listeners which reuse their port have a socket
+   *         per worker, bound to the address of socket() with SO_REUSEPORT, so that the kernel
+   *         balances new connections across workers. Otherwise this is socket().
+   */
+  virtual Socket& workerSocket(uint32_t worker_index) PURE;
+
   /**
    * @return bool specifies whether the listener should actually listen on the port.
    *         A listener that doesn't listen on a port can only receive connections
@@ -74,6 +83,12 @@ public:
    * @return const std::string& the listener's name.
    */
   virtual const std::string& name() const PURE;
+
+  /**
+   * @return ConnectionBalancer& the balancer of the sockets accepted by the listener across
+   *         workers.
+   */
+  virtual ConnectionBalancer& connectionBalancer() PURE;
 };
 
 /**
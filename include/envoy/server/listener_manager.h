@@ -52,6 +52,20 @@ public:
   createListenSocket(Network::Address::InstanceConstSharedPtr address,
                      const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) PURE;
 
+  /**
+   * Creates the listen socket of a worker for a listener which reuses its port. The first worker
+   * uses the socket from createListenSocket(), and the other workers each get their own.
+   * @param address supplies the address the listener's socket is bound to.
+   * @param options to be set on the created socket just before calling 'bind()', including
+   *        SO_REUSEPORT.
+   * @param worker_index supplies the index of the worker, at least 1.
+   * @return Network::SocketSharedPtr an initialized and bound socket.
+   */
+  virtual Network::SocketSharedPtr
+  createWorkerListenSocket(Network::Address::InstanceConstSharedPtr address,
+                           const Network::Socket::OptionsSharedPtr& options,
+                           uint32_t worker_index) PURE;
+
   /**
    * Creates a list of filter factories.
    * @param filters supplies the proto configuration.
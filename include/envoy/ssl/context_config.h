@@ -109,6 +109,12 @@ public:
    * are candidates for decrypting received tickets.
    */
   virtual const std::vector<SessionTicketKey>& sessionTicketKeys() const PURE;
+
+  /**
+   * @return uint32_t the number of threads to offload the private key operations of the handshakes
+   *         to, or 0 to run them inline on the thread of the connection.
+   */
+  virtual uint32_t privateKeyOffloadThreads() const PURE;
 };
 
 typedef std::unique_ptr<ServerContextConfig> ServerContextConfigPtr;
@@ -23,6 +23,14 @@ public:
    */
   virtual void flush(Source& source) PURE;
 
+  /**
+   * @return bool whether flush() only reads the stats which changed since the previous flush,
+   *         through Source::changedCounters() and Source::changedGauges(). The store then keeps
+   *         the snapshots of its stats across flushes, rather than rebuilding them for each one.
+   *         Sinks that read every stat on each flush need not override this.
+   */
+  virtual bool flushesChangedStatsOnly() const { return false; }
+
   /**
    * Flush a single histogram sample. Note: this call is called synchronously as a part of recording
    * the metric, so implementations must be thread-safe.
@@ -45,6 +45,23 @@ public:
    */
   virtual const std::vector<ParentHistogramSharedPtr>& cachedHistograms() PURE;
 
+  /**
+   * Returns the counters that were incremented since they were last returned by this method, which
+   * is usually the previous flush. The set is computed once per cache lifetime, so every sink of a
+   * flush sees the same counters.
+   * @return std::vector<CounterSharedPtr>& the changed counters. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<CounterSharedPtr>& changedCounters() PURE;
+
+  /**
+   * Returns the gauges that were updated since they were last returned by this method. See
+   * changedCounters().
+   * @return std::vector<GaugeSharedPtr>& the changed gauges. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<GaugeSharedPtr>& changedGauges() PURE;
+
   /**
    * Resets the cache so that any future calls to get cached metrics will refresh the set.
    */
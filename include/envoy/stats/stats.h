@@ -6,14 +6,13 @@
 #include <vector>
 
 #include "envoy/common/pure.h"
+#include "envoy/stats/tag.h"
 
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
 namespace Stats {
 
-struct Tag;
-
 /**
  * General interface for all stats objects.
  */
@@ -54,6 +53,12 @@ public:
   virtual uint64_t latch() PURE;
   virtual void reset() PURE;
   virtual uint64_t value() const PURE;
+
+  /**
+   * Clears the mark set whenever the counter is incremented.
+   * @return bool whether the counter was incremented since the previous call.
+   */
+  virtual bool latchChanged() PURE;
 };
 
 typedef std::shared_ptr<Counter> CounterSharedPtr;
@@ -71,6 +76,12 @@ public:
   virtual void set(uint64_t value) PURE;
   virtual void sub(uint64_t amount) PURE;
   virtual uint64_t value() const PURE;
+
+  /**
+   * Clears the mark set whenever the gauge is updated.
+   * @return bool whether the gauge was updated since the previous call.
+   */
+  virtual bool latchChanged() PURE;
 };
 
 typedef std::shared_ptr<Gauge> GaugeSharedPtr;
@@ -44,6 +44,12 @@ public:
    * The max allowed length of a stat suffix.
    */
   virtual size_t maxStatSuffixLength() const PURE;
+
+  /**
+   * Whether histograms record their values in fixed log-linear buckets, which are cheaper to
+   * record into and merge, rather than with libcircllhist, which gives more precise quantiles.
+   */
+  virtual bool logLinearHistograms() const PURE;
 };
 
 } // namespace Stats
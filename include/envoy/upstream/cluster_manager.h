@@ -262,11 +262,13 @@ public:
 
   /**
    * Allocate an HTTP connection pool for the host. Pools are separated by 'priority',
-   * 'protocol', and 'options->hashKey()', if any.
+   * 'protocol', 'pipelined', and 'options->hashKey()', if any. A 'pipelined' HTTP/1.1 pool
+   * pipelines requests up to the cluster's maximum pipeline depth, and is only given idempotent
+   * requests.
    */
   virtual Http::ConnectionPool::InstancePtr
   allocateConnPool(Event::Dispatcher& dispatcher, HostConstSharedPtr host,
-                   ResourcePriority priority, Http::Protocol protocol,
+                   ResourcePriority priority, Http::Protocol protocol, bool pipelined,
                    const Network::ConnectionSocket::OptionsSharedPtr& options) PURE;
 
   /**
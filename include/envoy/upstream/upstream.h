@@ -243,6 +243,16 @@ public:
    */
   virtual const HostsPerLocality& healthyHostsPerLocality() const PURE;
 
+  /**
+   * The following return the immutable snapshots behind hosts(), healthyHosts(),
+   * hostsPerLocality() and healthyHostsPerLocality(), which updates replace rather than modify.
+   * They can be handed to other threads, e.g. to update their own host sets, without copies.
+   */
+  virtual HostVectorConstSharedPtr hostsPtr() const PURE;
+  virtual HostVectorConstSharedPtr healthyHostsPtr() const PURE;
+  virtual HostsPerLocalityConstSharedPtr hostsPerLocalityPtr() const PURE;
+  virtual HostsPerLocalityConstSharedPtr healthyHostsPerLocalityPtr() const PURE;
+
   /**
    * @return weights for each locality in the host set.
    */
@@ -373,6 +383,11 @@ public:
   COUNTER  (upstream_rq_pending_failure_eject)                                                     \
   GAUGE    (upstream_rq_pending_active)                                                            \
   COUNTER  (upstream_rq_cancelled)                                                                 \
+  COUNTER  (upstream_rq_pipelined)                                                                 \
+  COUNTER  (upstream_rq_pipeline_reset)                                                            \
+  HISTOGRAM(upstream_rq_pipeline_depth)                                                            \
+  COUNTER  (upstream_rq_http2_stream_limited)                                                      \
+  HISTOGRAM(upstream_rq_http2_connection_streams)                                                  \
   COUNTER  (upstream_rq_maintenance_mode)                                                          \
   COUNTER  (upstream_rq_timeout)                                                                   \
   COUNTER  (upstream_rq_per_try_timeout)                                                           \
@@ -477,6 +492,12 @@ public:
    */
   virtual uint64_t features() const PURE;
 
+  /**
+   * @return const Http::Http1Settings& for HTTP/1.1 connections created on behalf of this cluster.
+   *         @see Http::Http1Settings.
+   */
+  virtual const Http::Http1Settings& http1Settings() const PURE;
+
   /**
    * @return const Http::Http2Settings& for HTTP/2 connections created on behalf of this cluster.
    *         @see Http::Http2Settings.
@@ -517,6 +538,13 @@ public:
   virtual const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>&
   lbRingHashConfig() const PURE;
 
+  /**
+   * @return const absl::optional<envoy::api::v2::Cluster::MaglevLbConfig>& the configuration for
+   *         Maglev load balancing, only used if type is set to MAGLEV.
+   */
+  virtual const absl::optional<envoy::api::v2::Cluster::MaglevLbConfig>&
+  lbMaglevConfig() const PURE;
+
   /**
    * @return const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& the configuration
    *         for the Original Destination load balancing policy, only used if type is set to
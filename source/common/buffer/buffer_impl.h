@@ -1,10 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/buffer/slice_pool.h"
+#include "common/common/assert.h"
 #include "common/common/non_copyable.h"
 #include "common/event/libevent.h"
 
@@ -46,6 +52,330 @@ private:
   const std::function<void(const void*, size_t, const BufferFragmentImpl*)> releasor_;
 };
 
+/**
+ * A Slice manages a contiguous block of bytes.
+ * The block is arranged like this:
+ *                   |<- dataSize() ->|<- reservableSize() ->|
+ * +-----------------+----------------+----------------------+
+ * | Drained         | Data           | Reservable           |
+ * | Unused space    | Usable content | New content can be   |
+ * | that formerly   |                | added here with      |
+ * | was in the Data |                | reserve()/commit()   |
+ * | section         |                |                      |
+ * +-----------------+----------------+----------------------+
+ *                   ^                ^                      ^
+ *                   |                |                      |
+ *                   base_ + data_    base_ + reservable_    base_ + capacity_
+ */
+class Slice {
+public:
+  virtual ~Slice() {}
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  const uint8_t* data() const { return base_ + data_; }
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  uint8_t* data() { return base_ + data_; }
+
+  /**
+   * @return the size in bytes of the usable content.
+   */
+  uint64_t dataSize() const { return reservable_ - data_; }
+
+  /**
+   * Remove the first `size` bytes of usable content. Runs in O(1) time.
+   * @param size number of bytes to remove. If greater than data_size(), the result is undefined.
+   */
+  void drain(uint64_t size) {
+    ASSERT(data_ + size <= reservable_);
+    data_ += size;
+    if (data_ == reservable_) {
+      // All the data in the slice has been drained. Reset the offsets so all
+      // the data can be reused.
+      data_ = 0;
+      reservable_ = 0;
+    }
+  }
+
+  /**
+   * @return the number of bytes available to be reserved.
+   * @note Read-only implementations of Slice should return zero from this method.
+   */
+  uint64_t reservableSize() const { return capacity_ - reservable_; }
+
+  /**
+   * Reserve `size` bytes that the caller can populate with content. The caller SHOULD then
+   * call commit() to add the newly populated content from the Reserved section to the Data
+   * section.
+   * @note If there is already an outstanding reservation (i.e., a reservation obtained
+   *       from reserve() that has not been released by calling commit()), this method will
+   *       return the same space again.
+   * @param size the number of bytes to reserve. The Slice implementation MAY reserve
+   *        fewer bytes than requested (for example, if it doesn't have enough room in the
+   *        Reservable section to fulfill the whole request).
+   * @return a RawSlice that describes the reserved space. The len_ field will be zero
+   *         if the Slice is unable to reserve any space.
+   */
+  RawSlice reserve(uint64_t size) {
+    if (size == 0) {
+      return {nullptr, 0};
+    }
+    // Verify the semantics that drain() enforces: if the slice is empty, either because
+    // no data has been added or because all the added data has been drained, the data
+    // section is at the very start of the slice.
+    ASSERT(!(dataSize() == 0 && data_ > 0));
+    const uint64_t available_size = capacity_ - reservable_;
+    if (available_size == 0) {
+      return {nullptr, 0};
+    }
+    const uint64_t reservation_size = std::min(size, available_size);
+    return {base_ + reservable_, static_cast<size_t>(reservation_size)};
+  }
+
+  /**
+   * Commit a Reservation that was previously obtained from a call to reserve().
+   * The Reservation's size is added to the Data section.
+   * @param reservation a reservation obtained from a previous call to reserve().
+   *        If the reservation is not from this Slice, commit() will return false.
+   *        If the caller is committing fewer bytes than provided by reserve(), it
+   *        should change the len_ field of the reservation before calling commit().
+   *        For example, if a caller reserve()s 4KB to do a nonblocking socket read,
+   *        and the read only returns two bytes, the caller should set
+   *        reservation.len_ = 2 and then call `commit(reservation)`.
+   * @return whether the Reservation was successfully committed to the Slice.
+   */
+  bool commit(const RawSlice& reservation) {
+    if (static_cast<const uint8_t*>(reservation.mem_) != base_ + reservable_ ||
+        reservable_ + reservation.len_ > capacity_ || reservable_ >= capacity_) {
+      // The reservation is not from this Slice.
+      return false;
+    }
+    reservable_ += reservation.len_;
+    return true;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the end of the slice.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero).
+   */
+  uint64_t append(const void* data, uint64_t size) {
+    const uint64_t copy_size = std::min(size, reservableSize());
+    memcpy(base_ + reservable_, data, copy_size);
+    reservable_ += copy_size;
+    return copy_size;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the front of the slice.
+   * If only part of the data will fit in the slice, the bytes from the _end_ are
+   * copied.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero).
+   */
+  uint64_t prepend(const void* data, uint64_t size);
+
+protected:
+  Slice(uint64_t data, uint64_t reservable, uint64_t capacity)
+      : data_(data), reservable_(reservable), capacity_(capacity) {}
+
+  /** Start of the slice - subclasses must set this */
+  uint8_t* base_{nullptr};
+
+  /** Offset in bytes from the start of the slice to the start of the Data section */
+  uint64_t data_;
+
+  /** Offset in bytes from the start of the slice to the start of the Reservable section */
+  uint64_t reservable_;
+
+  /** Total number of bytes in the slice */
+  uint64_t capacity_;
+};
+
+typedef std::unique_ptr<Slice> SlicePtr;
+
+/**
+ * A Slice that owns its storage. The object header and the storage are a single heap
+ * allocation, so creating a slice costs exactly one malloc.
+ */
+class OwnedSlice : public Slice {
+public:
+  /**
+   * Create an empty OwnedSlice.
+   * @param capacity number of bytes of space the slice should have. The slice may be given
+   *        slightly more space, since the allocation is rounded up to a whole number of pages.
+   * @return an OwnedSlice with at least the specified capacity.
+   */
+  static SlicePtr create(uint64_t capacity) {
+    const uint64_t slice_capacity = sliceSize(capacity);
+    return SlicePtr(new (slice_capacity) OwnedSlice(slice_capacity));
+  }
+
+  /**
+   * Create an OwnedSlice and initialize it with a copy of the supplied data.
+   * @param data the content to copy into the slice.
+   * @param size length of the content.
+   * @return an OwnedSlice containing a copy of the content, which may (dependent on
+   *         the internal implementation) have a nonzero amount of reservable space at the end.
+   */
+  static SlicePtr create(const void* data, uint64_t size) {
+    SlicePtr slice = create(size);
+    slice->append(data, size);
+    return slice;
+  }
+
+  // Storage is allocated inline with the object, so the matching deallocation must go through
+  // the class-specific operator delete. The block comes from the calling thread's SlicePool and
+  // starts with a header recording its size, which operator delete needs to return it.
+  static void* operator new(size_t object_size, size_t data_size) {
+    const uint64_t block_size = HeaderSize + object_size + data_size;
+    uint8_t* block = static_cast<uint8_t*>(SlicePool::allocate(block_size));
+    *reinterpret_cast<uint64_t*>(block) = block_size;
+    return block + HeaderSize;
+  }
+  static void operator delete(void* p) {
+    uint8_t* block = static_cast<uint8_t*>(p) - HeaderSize;
+    SlicePool::release(block, *reinterpret_cast<const uint64_t*>(block));
+  }
+
+private:
+  // Size of the block header; keeps the slice itself suitably aligned.
+  static constexpr uint64_t HeaderSize = alignof(std::max_align_t);
+
+  OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
+
+  /**
+   * Compute a slice size big enough to hold a specified amount of data.
+   * @param data_size the minimum amount of data the slice must be able to store, in bytes.
+   * @return a recommended slice size, in bytes, such that the whole block is a multiple of the
+   *         page size and so can be recycled through the SlicePool.
+   */
+  static uint64_t sliceSize(uint64_t data_size) {
+    constexpr uint64_t PageSize = SlicePool::PageSize;
+    constexpr uint64_t Overhead = HeaderSize + sizeof(OwnedSlice);
+    const uint64_t num_pages = (Overhead + data_size + PageSize - 1) / PageSize;
+    return num_pages * PageSize - Overhead;
+  }
+
+  uint8_t storage_[];
+};
+
+/**
+ * A Slice that refers to externally owned data supplied through a BufferFragment. No copying is
+ * done; the fragment's done() is called once the slice is destroyed.
+ */
+class UnownedSlice : public Slice {
+public:
+  UnownedSlice(BufferFragment& fragment)
+      : Slice(0, fragment.size(), fragment.size()), fragment_(fragment) {
+    base_ = static_cast<uint8_t*>(const_cast<void*>(fragment.data()));
+  }
+
+  ~UnownedSlice() override { fragment_.done(); }
+
+private:
+  BufferFragment& fragment_;
+};
+
+/**
+ * Queue of SlicePtr that supports efficient read and write access to both
+ * the front and the back of the queue.
+ * @note This class has similar properties to std::deque<T>. The reason for using
+ *       a custom deque implementation is that benchmark testing during development
+ *       revealed that std::deque was too slow to reach performance parity with the
+ *       prior evbuffer-based buffer implementation. The ring starts out in storage
+ *       that is part of the object itself, so buffers that never hold more than a
+ *       handful of slices never allocate for the ring.
+ */
+class SliceDeque : NonCopyable {
+public:
+  SliceDeque() : ring_(inline_ring_), capacity_(InlineRingCapacity) {}
+
+  void emplace_back(SlicePtr&& slice) {
+    growRing();
+    ring_[internalIndex(size_)] = std::move(slice);
+    size_++;
+  }
+
+  void emplace_front(SlicePtr&& slice) {
+    growRing();
+    start_ = (start_ == 0) ? capacity_ - 1 : start_ - 1;
+    ring_[start_] = std::move(slice);
+    size_++;
+  }
+
+  bool empty() const { return size() == 0; }
+  size_t size() const { return size_; }
+
+  SlicePtr& front() { return ring_[start_]; }
+  const SlicePtr& front() const { return ring_[start_]; }
+  SlicePtr& back() { return ring_[internalIndex(size_ - 1)]; }
+  const SlicePtr& back() const { return ring_[internalIndex(size_ - 1)]; }
+
+  SlicePtr& operator[](size_t i) { return ring_[internalIndex(i)]; }
+  const SlicePtr& operator[](size_t i) const { return ring_[internalIndex(i)]; }
+
+  void pop_front() {
+    if (size() == 0) {
+      return;
+    }
+    front().reset();
+    size_--;
+    start_++;
+    if (start_ == capacity_) {
+      start_ = 0;
+    }
+  }
+
+  void pop_back() {
+    if (size() == 0) {
+      return;
+    }
+    back().reset();
+    size_--;
+  }
+
+private:
+  static constexpr size_t InlineRingCapacity = 8;
+
+  size_t internalIndex(size_t index) const {
+    size_t internal_index = start_ + index;
+    if (internal_index >= capacity_) {
+      internal_index -= capacity_;
+      ASSERT(internal_index < capacity_);
+    }
+    return internal_index;
+  }
+
+  void growRing() {
+    if (size_ < capacity_) {
+      return;
+    }
+    const size_t new_capacity = capacity_ * 2;
+    auto new_ring = std::make_unique<SlicePtr[]>(new_capacity);
+    for (size_t i = 0; i < size_; i++) {
+      new_ring[i] = std::move(ring_[internalIndex(i)]);
+    }
+    external_ring_.swap(new_ring);
+    ring_ = external_ring_.get();
+    start_ = 0;
+    capacity_ = new_capacity;
+  }
+
+  SlicePtr inline_ring_[InlineRingCapacity];
+  std::unique_ptr<SlicePtr[]> external_ring_;
+  SlicePtr* ring_; // points to start of either inline or external ring.
+  size_t start_{0};
+  size_t size_{0};
+  size_t capacity_;
+};
+
 class LibEventInstance : public Instance {
 public:
   // Allows access into the underlying buffer for move() optimizations.
@@ -55,10 +385,14 @@ public:
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
+ * An owned buffer. There are two implementations behind this class, selected when the buffer is
+ * constructed (see useOldImpl()):
+ *   - The native implementation, which stores content in a SliceDeque of Slices. move() of whole
+ *     slices between buffers is O(1) and never copies.
+ *   - The legacy implementation, which wraps an allocated and owned libevent evbuffer.
  *
- * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
- * compatible with non-LibEventInstance buffers.
+ * Note that due to the internals of move() accessing the other buffer's storage directly,
+ * OwnedImpl is not compatible with non-LibEventInstance buffers.
  */
 class OwnedImpl : public LibEventInstance {
 public:
@@ -91,7 +425,60 @@ public:
 
   Event::Libevent::BufferPtr& buffer() override { return buffer_; }
 
+  /**
+   * Create a new slice at the end of the buffer, and copy the supplied content into it.
+   * @param data start of the content to copy.
+   * @param size length of the content.
+   */
+  void appendSliceForTest(const void* data, uint64_t size);
+
+  /**
+   * Create a new slice at the end of the buffer, and copy the supplied string into it.
+   * @param data the string to append to the buffer.
+   */
+  void appendSliceForTest(absl::string_view data);
+
+  /**
+   * Select the implementation used by buffers constructed after this call. Buffers that already
+   * exist keep the implementation they were created with.
+   * @param use_old_impl if true, new buffers wrap a libevent evbuffer; if false, new buffers use
+   *        the native slice-based implementation.
+   */
+  static void useOldImpl(bool use_old_impl);
+
+  /**
+   * @return whether newly constructed buffers will use the libevent evbuffer implementation.
+   */
+  static bool newBuffersUseOldImpl();
+
+  /**
+   * @return whether this buffer uses the libevent evbuffer implementation.
+   */
+  bool usesOldImpl() const { return old_impl_; }
+
 private:
+  /**
+   * @param rhs another buffer.
+   * @return whether the rhs buffer is also an instance of OwnedImpl (or a subclass) that uses
+   *         the same internal implementation as this buffer.
+   */
+  bool isSameBufferImpl(const Instance& rhs) const;
+
+  void addImpl(const void* data, uint64_t size);
+
+  /** Whether to use the old evbuffer implementation when constructing new OwnedImpl objects. */
+  static bool use_old_impl_;
+
+  /** Whether this buffer uses the old evbuffer implementation. */
+  const bool old_impl_;
+
+  /** Ring buffer of slices, used only by the native implementation. */
+  SliceDeque slices_;
+
+  /** Sum of the dataSize of all slices, used only by the native implementation. */
+  uint64_t length_{0};
+
+  /** Used only by the old evbuffer implementation. */
   Event::Libevent::BufferPtr buffer_;
 };
 
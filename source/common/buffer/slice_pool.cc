@@ -0,0 +1,199 @@
+#include "common/buffer/slice_pool.h"
+
+#include <atomic>
+#include <new>
+#include <unordered_set>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Buffer {
+
+namespace {
+
+std::atomic<uint64_t> pool_low_watermark{SlicePool::DefaultLowWatermark};
+std::atomic<uint64_t> pool_high_watermark{SlicePool::DefaultHighWatermark};
+
+// Counters are only ever written by the thread that owns them, so a relaxed load and store is
+// enough and avoids a locked read-modify-write on the allocation path.
+void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+  counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+class ThreadCache;
+
+/**
+ * Tracks the live thread caches so that stats() can aggregate them, and accumulates the
+ * counters of caches whose threads have exited.
+ */
+class Registry {
+public:
+  void add(const ThreadCache& cache) {
+    Thread::LockGuard lock(lock_);
+    caches_.insert(&cache);
+  }
+  void remove(const ThreadCache& cache);
+  SlicePool::Stats stats();
+
+private:
+  Thread::MutexBasicLockable lock_;
+  std::unordered_set<const ThreadCache*> caches_ GUARDED_BY(lock_);
+  SlicePool::Stats retired_ GUARDED_BY(lock_);
+};
+
+// Deliberately leaked: threads may still release blocks while static destructors are running.
+Registry& registry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+/**
+ * Free lists for one thread, indexed by the number of pages in a block. Free blocks are linked
+ * through their first word so the cache itself never allocates.
+ */
+class ThreadCache {
+public:
+  ThreadCache() { registry().add(*this); }
+
+  ~ThreadCache();
+
+  void* allocate(uint64_t size) {
+    FreeBlock*& head = free_lists_[size / SlicePool::PageSize - 1];
+    if (head == nullptr) {
+      bump(misses_, 1);
+      return ::operator new(size);
+    }
+    FreeBlock* block = head;
+    head = block->next_;
+    bump(hits_, 1);
+    resident_bytes_.store(resident_bytes_.load(std::memory_order_relaxed) - size,
+                          std::memory_order_relaxed);
+    return block;
+  }
+
+  void release(void* block, uint64_t size) {
+    const uint64_t high = pool_high_watermark.load(std::memory_order_relaxed);
+    if (size > high) {
+      ::operator delete(block);
+      return;
+    }
+    FreeBlock*& head = free_lists_[size / SlicePool::PageSize - 1];
+    head = new (block) FreeBlock{head};
+    bump(resident_bytes_, size);
+    if (resident_bytes_.load(std::memory_order_relaxed) > high) {
+      bump(trimmed_, trim(pool_low_watermark.load(std::memory_order_relaxed)));
+    }
+  }
+
+  /**
+   * Free cached blocks, largest first, until no more than target bytes remain cached.
+   * @return uint64_t the number of blocks freed.
+   */
+  uint64_t trim(uint64_t target) {
+    uint64_t freed = 0;
+    uint64_t resident = resident_bytes_.load(std::memory_order_relaxed);
+    for (uint64_t pages = SlicePool::MaxPooledPages; pages > 0 && resident > target; pages--) {
+      FreeBlock*& head = free_lists_[pages - 1];
+      while (head != nullptr && resident > target) {
+        FreeBlock* block = head;
+        head = block->next_;
+        ::operator delete(block);
+        resident -= pages * SlicePool::PageSize;
+        freed++;
+      }
+    }
+    resident_bytes_.store(resident, std::memory_order_relaxed);
+    return freed;
+  }
+
+  void addTo(SlicePool::Stats& stats) const {
+    stats.hits_ += hits_.load(std::memory_order_relaxed);
+    stats.misses_ += misses_.load(std::memory_order_relaxed);
+    stats.trimmed_ += trimmed_.load(std::memory_order_relaxed);
+    stats.resident_bytes_ += resident_bytes_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct FreeBlock {
+    FreeBlock* next_;
+  };
+
+  FreeBlock* free_lists_[SlicePool::MaxPooledPages]{};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> trimmed_{0};
+  std::atomic<uint64_t> resident_bytes_{0};
+};
+
+// Set once the calling thread's cache has been destroyed during thread exit. Buffers owned by
+// other thread_local objects may still be freed after that point; those blocks go straight to
+// the heap.
+thread_local bool thread_cache_destroyed = false;
+
+ThreadCache::~ThreadCache() {
+  thread_cache_destroyed = true;
+  trim(0);
+  registry().remove(*this);
+}
+
+void Registry::remove(const ThreadCache& cache) {
+  Thread::LockGuard lock(lock_);
+  caches_.erase(&cache);
+  cache.addTo(retired_);
+}
+
+SlicePool::Stats Registry::stats() {
+  Thread::LockGuard lock(lock_);
+  SlicePool::Stats stats = retired_;
+  for (const ThreadCache* cache : caches_) {
+    cache->addTo(stats);
+  }
+  return stats;
+}
+
+ThreadCache* threadCache() {
+  if (thread_cache_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+} // namespace
+
+void* SlicePool::allocate(uint64_t size) {
+  ThreadCache* cache;
+  if (!poolable(size) || (cache = threadCache()) == nullptr) {
+    return ::operator new(size);
+  }
+  return cache->allocate(size);
+}
+
+void SlicePool::release(void* block, uint64_t size) {
+  ThreadCache* cache;
+  if (!poolable(size) || (cache = threadCache()) == nullptr) {
+    ::operator delete(block);
+    return;
+  }
+  cache->release(block, size);
+}
+
+void SlicePool::setWatermarks(uint64_t low_watermark, uint64_t high_watermark) {
+  ASSERT(low_watermark <= high_watermark);
+  pool_low_watermark.store(low_watermark);
+  pool_high_watermark.store(high_watermark);
+}
+
+void SlicePool::drainThreadCache() {
+  ThreadCache* cache = threadCache();
+  if (cache != nullptr) {
+    cache->trim(0);
+  }
+}
+
+SlicePool::Stats SlicePool::stats() { return registry().stats(); }
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * Per-thread cache of the page-granular blocks that back buffer slices. Blocks of up to
+ * MaxPooledPages pages are recycled through free lists owned by the thread that releases them.
+ * Every worker runs its dispatcher on a dedicated thread, so each worker effectively owns a
+ * private slab and the hot allocate/release path never takes a lock or touches shared state.
+ *
+ * Idle memory held by each thread is bounded by a pair of watermarks. When the bytes cached by a
+ * thread rise above the high watermark, its cache is trimmed back down to the low watermark. The
+ * gap between the two keeps steady-state churn from thrashing between the cache and the heap,
+ * while a burst of traffic can't pin memory on a worker indefinitely.
+ */
+class SlicePool {
+public:
+  static constexpr uint64_t PageSize = 4096;
+  // Enough pages for a 16 KiB socket read reservation plus the slice bookkeeping.
+  static constexpr uint64_t MaxPooledPages = 5;
+  static constexpr uint64_t DefaultLowWatermark = 512 * 1024;
+  static constexpr uint64_t DefaultHighWatermark = 1024 * 1024;
+
+  /**
+   * Totals aggregated over every thread that has used the pool, including threads that have
+   * since exited.
+   */
+  struct Stats {
+    // Allocations served from a thread's cache.
+    uint64_t hits_{0};
+    // Allocations of a poolable size that had to go to the heap.
+    uint64_t misses_{0};
+    // Blocks handed back to the heap because a cache crossed its high watermark.
+    uint64_t trimmed_{0};
+    // Bytes currently idle in thread caches.
+    uint64_t resident_bytes_{0};
+  };
+
+  /**
+   * Allocate a block of memory.
+   * @param size supplies the block size in bytes. Sizes that aren't poolable() are always served
+   *        from the heap.
+   * @return void* the block, which must be freed with release() using the same size.
+   */
+  static void* allocate(uint64_t size);
+
+  /**
+   * Return a block to the calling thread's cache, or to the heap if it isn't poolable or the
+   * cache is full. The block may be released on a different thread than the one that allocated
+   * it.
+   * @param block supplies a block obtained from allocate().
+   * @param size supplies the size that was passed to allocate().
+   */
+  static void release(void* block, uint64_t size);
+
+  /**
+   * @return whether blocks of the given size are recycled through the per-thread caches.
+   */
+  static bool poolable(uint64_t size) {
+    return size != 0 && size % PageSize == 0 && size <= MaxPooledPages * PageSize;
+  }
+
+  /**
+   * Set the watermarks that bound the idle memory of each thread's cache. Takes effect on each
+   * thread the next time it releases a block. A high watermark of 0 disables caching. The server
+   * sets them from runtime on each stats flush.
+   * @param low_watermark supplies the number of bytes a cache is trimmed down to.
+   * @param high_watermark supplies the number of bytes above which a cache is trimmed.
+   */
+  static void setWatermarks(uint64_t low_watermark, uint64_t high_watermark);
+
+  /**
+   * Return every block cached by the calling thread to the heap.
+   */
+  static void drainThreadCache();
+
+  /**
+   * @return Stats a snapshot of the pool statistics. Safe to call from any thread; counters of
+   *         other threads are read without synchronizing with them, so the result may be a few
+   *         operations stale.
+   */
+  static Stats stats();
+};
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,762 @@
+#include "common/common/linear_regex.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Regex {
+
+namespace {
+
+// Bounds the size of a program, as bounded repetitions are compiled by repeating their operand.
+constexpr uint32_t MaxInstructions = 16384;
+constexpr uint32_t MaxRepeat = 1000;
+constexpr uint32_t Unbounded = std::numeric_limits<uint32_t>::max();
+
+struct Node;
+typedef std::unique_ptr<Node> NodePtr;
+
+// The syntax tree of a regular expression.
+struct Node {
+  enum class Type { Class, Concat, Alternate, Repeat, Begin, End };
+
+  explicit Node(Type type) : type_(type) {}
+
+  Type type_;
+  // For Class.
+  std::bitset<256> class_;
+  // For Concat and Alternate, and the operand of Repeat.
+  std::vector<NodePtr> children_;
+  // For Repeat.
+  uint32_t min_{};
+  uint32_t max_{};
+};
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool isAlnum(char c) { return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+void addRange(std::bitset<256>& bits, uint8_t lo, uint8_t hi) {
+  for (uint32_t c = lo; c <= hi; c++) {
+    bits.set(c);
+  }
+}
+
+/**
+ * Recursive descent parser for the supported subset of the ECMAScript grammar. Any construct
+ * outside of it, or whose meaning in libstdc++ is in doubt, fails the parse so that the pattern is
+ * left to std::regex.
+ */
+class Parser {
+public:
+  explicit Parser(absl::string_view pattern) : pattern_(pattern) {}
+
+  NodePtr parse() {
+    NodePtr node = parseDisjunction();
+    if (node == nullptr || position_ != pattern_.size()) {
+      return nullptr;
+    }
+    return node;
+  }
+
+private:
+  bool done() const { return position_ == pattern_.size(); }
+  char peek() const { return pattern_[position_]; }
+
+  NodePtr parseDisjunction() {
+    NodePtr alternative = parseAlternative();
+    if (alternative == nullptr || done() || peek() != '|') {
+      return alternative;
+    }
+    NodePtr node(new Node(Node::Type::Alternate));
+    node->children_.push_back(std::move(alternative));
+    while (!done() && peek() == '|') {
+      position_++;
+      alternative = parseAlternative();
+      if (alternative == nullptr) {
+        return nullptr;
+      }
+      node->children_.push_back(std::move(alternative));
+    }
+    return node;
+  }
+
+  NodePtr parseAlternative() {
+    NodePtr node(new Node(Node::Type::Concat));
+    while (!done() && peek() != '|' && peek() != ')') {
+      NodePtr term = parseTerm();
+      if (term == nullptr) {
+        return nullptr;
+      }
+      node->children_.push_back(std::move(term));
+    }
+    return node;
+  }
+
+  NodePtr parseTerm() {
+    const char c = peek();
+    if (c == '^' || c == '$') {
+      position_++;
+      return NodePtr(new Node(c == '^' ? Node::Type::Begin : Node::Type::End));
+    }
+
+    NodePtr atom = parseAtom();
+    if (atom == nullptr || done()) {
+      return atom;
+    }
+
+    uint32_t min;
+    uint32_t max;
+    switch (peek()) {
+    case '*':
+      min = 0;
+      max = Unbounded;
+      position_++;
+      break;
+    case '+':
+      min = 1;
+      max = Unbounded;
+      position_++;
+      break;
+    case '?':
+      min = 0;
+      max = 1;
+      position_++;
+      break;
+    case '{':
+      position_++;
+      if (!parseBounds(min, max)) {
+        return nullptr;
+      }
+      break;
+    default:
+      return atom;
+    }
+    // Whether a quantifier is lazy doesn't change whether the whole input matches.
+    if (!done() && peek() == '?') {
+      position_++;
+    }
+
+    NodePtr node(new Node(Node::Type::Repeat));
+    node->min_ = min;
+    node->max_ = max;
+    node->children_.push_back(std::move(atom));
+    return node;
+  }
+
+  // Parses the rest of {n}, {n,} or {n,m}.
+  bool parseBounds(uint32_t& min, uint32_t& max) {
+    if (!parseNumber(min)) {
+      return false;
+    }
+    max = min;
+    if (!done() && peek() == ',') {
+      position_++;
+      max = Unbounded;
+      if (!done() && isDigit(peek()) && !parseNumber(max)) {
+        return false;
+      }
+    }
+    if (done() || peek() != '}' || min > max) {
+      return false;
+    }
+    position_++;
+    return true;
+  }
+
+  bool parseNumber(uint32_t& value) {
+    value = 0;
+    const size_t start = position_;
+    while (!done() && isDigit(peek())) {
+      value = value * 10 + (peek() - '0');
+      position_++;
+      if (value > MaxRepeat) {
+        return false;
+      }
+    }
+    return position_ > start;
+  }
+
+  NodePtr parseAtom() {
+    const char c = peek();
+    position_++;
+    switch (c) {
+    case '(': {
+      if (!done() && peek() == '?') {
+        if (pattern_.substr(position_, 2) != "?:") {
+          return nullptr;
+        }
+        position_ += 2;
+      }
+      NodePtr node = parseDisjunction();
+      if (node == nullptr || done() || peek() != ')') {
+        return nullptr;
+      }
+      position_++;
+      return node;
+    }
+    case '.': {
+      NodePtr node(new Node(Node::Type::Class));
+      node->class_.set();
+      node->class_.reset('\n');
+      node->class_.reset('\r');
+      return node;
+    }
+    case '[':
+      return parseBracket();
+    case '\\': {
+      NodePtr node(new Node(Node::Type::Class));
+      bool single;
+      uint8_t character;
+      if (!parseEscape(node->class_, single, character)) {
+        return nullptr;
+      }
+      return node;
+    }
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+    case '}':
+    case ']':
+    case ')':
+    case '|':
+      return nullptr;
+    default: {
+      NodePtr node(new Node(Node::Type::Class));
+      node->class_.set(static_cast<uint8_t>(c));
+      return node;
+    }
+    }
+  }
+
+  // Parses an escape after its backslash into bits. If it stands for a single character rather
+  // than a class, single is set and character is the character.
+  bool parseEscape(std::bitset<256>& bits, bool& single, uint8_t& character) {
+    if (done()) {
+      return false;
+    }
+    const char c = peek();
+    position_++;
+    single = true;
+    switch (c) {
+    case 'f':
+      character = '\f';
+      break;
+    case 'n':
+      character = '\n';
+      break;
+    case 'r':
+      character = '\r';
+      break;
+    case 't':
+      character = '\t';
+      break;
+    case 'v':
+      character = '\v';
+      break;
+    default:
+      // Other letters and digits are classes, backreferences, assertions and code points.
+      if (isAlnum(c)) {
+        single = false;
+        return parseClassEscape(c, bits);
+      }
+      character = static_cast<uint8_t>(c);
+      break;
+    }
+    bits.set(character);
+    return true;
+  }
+
+  bool parseClassEscape(char c, std::bitset<256>& bits) {
+    switch (c) {
+    case 'd':
+    case 'D':
+      addRange(bits, '0', '9');
+      break;
+    case 'w':
+    case 'W':
+      addRange(bits, '0', '9');
+      addRange(bits, 'a', 'z');
+      addRange(bits, 'A', 'Z');
+      bits.set('_');
+      break;
+    case 's':
+    case 'S':
+      for (char space : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+        bits.set(static_cast<uint8_t>(space));
+      }
+      break;
+    default:
+      return false;
+    }
+    if (c == 'D' || c == 'W' || c == 'S') {
+      bits.flip();
+    }
+    return true;
+  }
+
+  // Parses a bracket expression after its '['.
+  NodePtr parseBracket() {
+    NodePtr node(new Node(Node::Type::Class));
+    bool negate = false;
+    if (!done() && peek() == '^') {
+      negate = true;
+      position_++;
+    }
+    // Empty brackets, and a ']' at the start, are not portable.
+    if (done() || peek() == ']') {
+      return nullptr;
+    }
+
+    while (!done() && peek() != ']') {
+      std::bitset<256> bits;
+      bool single;
+      uint8_t lo;
+      if (!parseBracketAtom(bits, single, lo)) {
+        return nullptr;
+      }
+      // A '-' before the closing ']' is a literal.
+      if (position_ + 1 < pattern_.size() && peek() == '-' && pattern_[position_ + 1] != ']') {
+        position_++;
+        uint8_t hi;
+        // Ranges bounded by a class are not portable.
+        if (!single || !parseBracketAtom(bits, single, hi) || !single || lo > hi) {
+          return nullptr;
+        }
+        addRange(bits, lo, hi);
+      }
+      node->class_ |= bits;
+    }
+    if (done()) {
+      return nullptr;
+    }
+    position_++;
+
+    if (negate) {
+      node->class_.flip();
+    }
+    return node;
+  }
+
+  // Parses a character or an escape in a bracket expression into bits. If it stands for a single
+  // character rather than a class, single is set and character is the character.
+  bool parseBracketAtom(std::bitset<256>& bits, bool& single, uint8_t& character) {
+    const char c = peek();
+    position_++;
+    if (c == '\\') {
+      // In brackets, \b is a backspace rather than an assertion, which isn't handled.
+      return !done() && peek() != 'b' && parseEscape(bits, single, character);
+    }
+    // POSIX classes, collating symbols and equivalence classes.
+    if (c == '[' && !done() && (peek() == ':' || peek() == '.' || peek() == '=')) {
+      return false;
+    }
+    single = true;
+    character = static_cast<uint8_t>(c);
+    bits.set(character);
+    return true;
+  }
+
+  const absl::string_view pattern_;
+  size_t position_{};
+};
+
+} // namespace
+
+/**
+ * Compiles syntax trees into the instructions of a program.
+ */
+class LinearProgram::Compiler {
+public:
+  explicit Compiler(LinearProgram& program) : program_(program) {}
+
+  bool compile(const Node& node) {
+    switch (node.type_) {
+    case Node::Type::Class:
+      return emit(Op::Class, internClass(node.class_)) != Overflow;
+    case Node::Type::Begin:
+      return emit(Op::AssertBegin) != Overflow;
+    case Node::Type::End:
+      return emit(Op::AssertEnd) != Overflow;
+    case Node::Type::Concat:
+      for (const NodePtr& child : node.children_) {
+        if (!compile(*child)) {
+          return false;
+        }
+      }
+      return true;
+    case Node::Type::Alternate: {
+      // Split to each alternative but the last, which the last split falls through to.
+      std::vector<uint32_t> jumps;
+      for (size_t i = 0; i < node.children_.size(); i++) {
+        uint32_t split = Overflow;
+        if (i + 1 < node.children_.size()) {
+          split = emit(Op::Split, next() + 1);
+          if (split == Overflow) {
+            return false;
+          }
+        }
+        if (!compile(*node.children_[i])) {
+          return false;
+        }
+        if (i + 1 < node.children_.size()) {
+          const uint32_t jump = emit(Op::Jump);
+          if (jump == Overflow) {
+            return false;
+          }
+          jumps.push_back(jump);
+          program_.instructions_[split].y_ = next();
+        }
+      }
+      for (uint32_t jump : jumps) {
+        program_.instructions_[jump].x_ = next();
+      }
+      return true;
+    }
+    case Node::Type::Repeat: {
+      const Node& operand = *node.children_[0];
+      for (uint32_t i = 0; i < node.min_; i++) {
+        if (!compile(operand)) {
+          return false;
+        }
+      }
+      if (node.max_ == Unbounded) {
+        const uint32_t split = emit(Op::Split, next() + 1);
+        if (split == Overflow || !compile(operand) || emit(Op::Jump, split) == Overflow) {
+          return false;
+        }
+        program_.instructions_[split].y_ = next();
+        return true;
+      }
+      // Each optional repetition may skip to the end.
+      std::vector<uint32_t> splits;
+      for (uint32_t i = node.min_; i < node.max_; i++) {
+        const uint32_t split = emit(Op::Split, next() + 1);
+        if (split == Overflow || !compile(operand)) {
+          return false;
+        }
+        splits.push_back(split);
+      }
+      for (uint32_t split : splits) {
+        program_.instructions_[split].y_ = next();
+      }
+      return true;
+    }
+    }
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+
+  bool finish(uint32_t pattern) { return emit(Op::Match, pattern) != Overflow; }
+
+  uint32_t next() const { return program_.instructions_.size(); }
+
+private:
+  static constexpr uint32_t Overflow = std::numeric_limits<uint32_t>::max();
+
+  uint32_t emit(Op op, uint32_t x = 0) {
+    if (program_.instructions_.size() >= MaxInstructions) {
+      return Overflow;
+    }
+    program_.instructions_.push_back({op, x, 0});
+    return program_.instructions_.size() - 1;
+  }
+
+  uint32_t internClass(const std::bitset<256>& bits) {
+    auto it = class_indices_.find(bits);
+    if (it != class_indices_.end()) {
+      return it->second;
+    }
+    program_.classes_.push_back(bits);
+    class_indices_.emplace(bits, program_.classes_.size() - 1);
+    return program_.classes_.size() - 1;
+  }
+
+  LinearProgram& program_;
+  std::unordered_map<std::bitset<256>, uint32_t> class_indices_;
+};
+
+/**
+ * The set of instructions reached at one position of the input. Inserting and testing for an
+ * instruction are constant time, and clearing doesn't depend on the size of the program.
+ */
+class LinearProgram::ThreadList {
+public:
+  explicit ThreadList(size_t size) : dense_(size), sparse_(size) {}
+
+  bool contains(uint32_t pc) const { return sparse_[pc] < size_ && dense_[sparse_[pc]] == pc; }
+
+  void insert(uint32_t pc) {
+    sparse_[pc] = size_;
+    dense_[size_++] = pc;
+  }
+
+  void clear() { size_ = 0; }
+  bool empty() const { return size_ == 0; }
+  const uint32_t* begin() const { return dense_.data(); }
+  const uint32_t* end() const { return dense_.data() + size_; }
+
+private:
+  std::vector<uint32_t> dense_;
+  std::vector<uint32_t> sparse_;
+  uint32_t size_{};
+};
+
+/**
+ * Converts the NFA of a program into a DFA by the subset construction. Each DFA state is the set
+ * of NFA instructions which consume a character, match, or assert the end of the input, reached at
+ * some position.
+ */
+class LinearProgram::DfaBuilder {
+public:
+  DfaBuilder(LinearProgram& program, uint32_t max_states)
+      : program_(program), max_states_(max_states), threads_(program.instructions_.size()) {}
+
+  bool build() {
+    computeCharacterClasses();
+
+    // The dead state is the empty set.
+    if (stateId({}) == Overflow) {
+      return false;
+    }
+    for (uint32_t pc : program_.starts_) {
+      program_.addThread(threads_, pc, true, false, stack_);
+    }
+    if (stateId(closure()) == Overflow) {
+      return false;
+    }
+    program_.empty_accepts_ = accepts(program_.starts_, true);
+
+    std::vector<uint32_t> next;
+    for (uint32_t state = 0; state < states_.size(); state++) {
+      for (uint32_t c = 0; c < program_.num_character_classes_; c++) {
+        const uint8_t character = representatives_[c];
+        threads_.clear();
+        for (uint32_t pc : *states_[state]) {
+          const Instruction& instruction = program_.instructions_[pc];
+          if (instruction.op_ == Op::Class && program_.classes_[instruction.x_][character]) {
+            program_.addThread(threads_, pc + 1, false, false, stack_);
+          }
+        }
+        const uint32_t id = stateId(closure());
+        if (id == Overflow) {
+          return false;
+        }
+        transitions_.push_back(id);
+      }
+      program_.accepts_.push_back(accepts(*states_[state], false));
+    }
+
+    program_.transitions_ = std::move(transitions_);
+    return true;
+  }
+
+private:
+  static constexpr uint32_t Overflow = std::numeric_limits<uint32_t>::max();
+
+  // Maps the characters to classes of characters which are in the same instruction classes.
+  void computeCharacterClasses() {
+    std::map<std::vector<bool>, uint8_t> ids;
+    for (uint32_t character = 0; character < 256; character++) {
+      std::vector<bool> membership;
+      membership.reserve(program_.classes_.size());
+      for (const std::bitset<256>& bits : program_.classes_) {
+        membership.push_back(bits[character]);
+      }
+      auto it = ids.emplace(std::move(membership), ids.size()).first;
+      if (it->second == representatives_.size()) {
+        representatives_.push_back(character);
+      }
+      program_.character_classes_[character] = it->second;
+    }
+    program_.num_character_classes_ = ids.size();
+  }
+
+  // Returns the instructions in threads_ which make up a DFA state, in ascending order.
+  std::vector<uint32_t> closure() {
+    std::vector<uint32_t> pcs;
+    for (uint32_t pc : threads_) {
+      const Op op = program_.instructions_[pc].op_;
+      if (op == Op::Class || op == Op::Match || op == Op::AssertEnd) {
+        pcs.push_back(pc);
+      }
+    }
+    std::sort(pcs.begin(), pcs.end());
+    threads_.clear();
+    return pcs;
+  }
+
+  uint32_t stateId(std::vector<uint32_t>&& pcs) {
+    auto it = ids_.find(pcs);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    if (states_.size() == max_states_) {
+      return Overflow;
+    }
+    it = ids_.emplace(std::move(pcs), states_.size()).first;
+    states_.push_back(&it->first);
+    return it->second;
+  }
+
+  // Returns the patterns matching if the input ends after reaching pcs.
+  std::vector<uint32_t> accepts(const std::vector<uint32_t>& pcs, bool at_begin) {
+    threads_.clear();
+    for (uint32_t pc : pcs) {
+      program_.addThread(threads_, pc, at_begin, true, stack_);
+    }
+    std::vector<uint32_t> patterns;
+    for (uint32_t pc : threads_) {
+      if (program_.instructions_[pc].op_ == Op::Match) {
+        patterns.push_back(program_.instructions_[pc].x_);
+      }
+    }
+    std::sort(patterns.begin(), patterns.end());
+    threads_.clear();
+    return patterns;
+  }
+
+  LinearProgram& program_;
+  const uint32_t max_states_;
+  ThreadList threads_;
+  std::vector<uint32_t> stack_;
+  std::vector<uint8_t> representatives_;
+  std::map<std::vector<uint32_t>, uint32_t> ids_;
+  std::vector<const std::vector<uint32_t>*> states_;
+  std::vector<uint32_t> transitions_;
+};
+
+LinearProgramPtr LinearProgram::compile(const std::vector<std::string>& patterns,
+                                        uint32_t max_dfa_states) {
+  std::unique_ptr<LinearProgram> program(new LinearProgram());
+  Compiler compiler(*program);
+  for (uint32_t i = 0; i < patterns.size(); i++) {
+    NodePtr node = Parser(patterns[i]).parse();
+    program->starts_.push_back(compiler.next());
+    if (node == nullptr || !compiler.compile(*node) || !compiler.finish(i)) {
+      return nullptr;
+    }
+  }
+
+  if (!DfaBuilder(*program, max_dfa_states).build()) {
+    // The NFA is simulated instead.
+    program->accepts_.clear();
+    program->empty_accepts_.clear();
+  }
+  return LinearProgramPtr(std::move(program));
+}
+
+void LinearProgram::addThread(ThreadList& threads, uint32_t pc, bool at_begin, bool at_end,
+                              std::vector<uint32_t>& stack) const {
+  stack.push_back(pc);
+  while (!stack.empty()) {
+    pc = stack.back();
+    stack.pop_back();
+    if (threads.contains(pc)) {
+      continue;
+    }
+    threads.insert(pc);
+    const Instruction& instruction = instructions_[pc];
+    switch (instruction.op_) {
+    case Op::Split:
+      stack.push_back(instruction.y_);
+      stack.push_back(instruction.x_);
+      break;
+    case Op::Jump:
+      stack.push_back(instruction.x_);
+      break;
+    case Op::AssertBegin:
+      if (at_begin) {
+        stack.push_back(pc + 1);
+      }
+      break;
+    case Op::AssertEnd:
+      if (at_end) {
+        stack.push_back(pc + 1);
+      }
+      break;
+    case Op::Class:
+    case Op::Match:
+      break;
+    }
+  }
+}
+
+const std::vector<uint32_t>* LinearProgram::dfaMatches(absl::string_view value) const {
+  if (value.empty()) {
+    return empty_accepts_.empty() ? nullptr : &empty_accepts_;
+  }
+  uint32_t state = 1;
+  for (const char c : value) {
+    state = transitions_[state * num_character_classes_ +
+                         character_classes_[static_cast<uint8_t>(c)]];
+    if (state == 0) {
+      return nullptr;
+    }
+  }
+  return accepts_[state].empty() ? nullptr : &accepts_[state];
+}
+
+template <class Fn> void LinearProgram::nfaMatches(absl::string_view value, Fn on_match) const {
+  ThreadList current(instructions_.size());
+  ThreadList next(instructions_.size());
+  std::vector<uint32_t> stack;
+  for (uint32_t start : starts_) {
+    addThread(current, start, true, value.empty(), stack);
+  }
+
+  for (size_t position = 0; position < value.size() && !current.empty(); position++) {
+    const uint8_t c = static_cast<uint8_t>(value[position]);
+    for (uint32_t pc : current) {
+      const Instruction& instruction = instructions_[pc];
+      if (instruction.op_ == Op::Class && classes_[instruction.x_][c]) {
+        addThread(next, pc + 1, false, position + 1 == value.size(), stack);
+      }
+    }
+    std::swap(current, next);
+    next.clear();
+  }
+
+  for (uint32_t pc : current) {
+    if (instructions_[pc].op_ == Op::Match && !on_match(instructions_[pc].x_)) {
+      return;
+    }
+  }
+}
+
+void LinearProgram::match(absl::string_view value, std::vector<uint32_t>& matches) const {
+  if (usesDfa()) {
+    const std::vector<uint32_t>* patterns = dfaMatches(value);
+    if (patterns != nullptr) {
+      matches.insert(matches.end(), patterns->begin(), patterns->end());
+    }
+    return;
+  }
+
+  const size_t first = matches.size();
+  nfaMatches(value, [&matches](uint32_t pattern) {
+    matches.push_back(pattern);
+    return true;
+  });
+  std::sort(matches.begin() + first, matches.end());
+}
+
+bool LinearProgram::matchAny(absl::string_view value) const {
+  if (usesDfa()) {
+    return dfaMatches(value) != nullptr;
+  }
+
+  bool matched = false;
+  nfaMatches(value, [&matched](uint32_t) {
+    matched = true;
+    return false;
+  });
+  return matched;
+}
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/regex.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Regex {
+
+class LinearProgram;
+typedef std::unique_ptr<const LinearProgram> LinearProgramPtr;
+
+/**
+ * One or more regular expressions compiled so that matching takes time linear in the input and
+ * never backtracks, unlike std::regex. Compiling several expressions into one program finds which
+ * of them match in a single pass over the input.
+ *
+ * The expressions are compiled into a Thompson NFA, which is then converted into a DFA so that
+ * matching is one table lookup per input character. When the DFA would be too large, the NFA is
+ * simulated instead, with all its threads advanced in lock step.
+ *
+ * Only a subset of the ECMAScript grammar of std::regex is supported: literals, '.', bracket
+ * expressions, the \d \w \s classes and their negations, groups, alternation, the greedy and lazy
+ * quantifiers, and the ^ and $ assertions. Backreferences, lookaheads, word boundaries and the
+ * escapes for code points are not supported.
+ */
+class LinearProgram {
+public:
+  // Bounds the size of the DFA, which can be exponential in the size of the NFA.
+  static const uint32_t DefaultMaxDfaStates = 4096;
+
+  /**
+   * Compiles regular expressions, which must already be known to be valid ECMAScript.
+   * @param patterns supplies the regular expressions.
+   * @param max_dfa_states supplies the largest number of states of the DFA. Should the DFA need
+   *        more, or should this be 0, the NFA is simulated instead.
+   * @return LinearProgramPtr the program, or nullptr if any pattern uses an unsupported construct
+   *         or the NFA would be too large.
+   */
+  static LinearProgramPtr compile(const std::vector<std::string>& patterns,
+                                  uint32_t max_dfa_states = DefaultMaxDfaStates);
+
+  /**
+   * Finds the patterns matching the whole of a value.
+   * @param value supplies the value to match.
+   * @param matches receives the indices of the matching patterns, in ascending order.
+   */
+  void match(absl::string_view value, std::vector<uint32_t>& matches) const;
+
+  /**
+   * @param value supplies the value to match.
+   * @return bool whether any pattern matches the whole of value.
+   */
+  bool matchAny(absl::string_view value) const;
+
+  /**
+   * @return bool whether the program was converted into a DFA.
+   */
+  bool usesDfa() const { return !transitions_.empty(); }
+
+private:
+  enum class Op : uint8_t {
+    // Consumes a character in the class x_.
+    Class,
+    // Continues at both x_ and y_.
+    Split,
+    // Continues at x_.
+    Jump,
+    // Continues at the next instruction at the start of the input.
+    AssertBegin,
+    // Continues at the next instruction at the end of the input.
+    AssertEnd,
+    // Pattern x_ matches if the input is consumed.
+    Match,
+  };
+
+  struct Instruction {
+    Op op_;
+    uint32_t x_;
+    uint32_t y_;
+  };
+
+  class Compiler;
+  class DfaBuilder;
+  class ThreadList;
+
+  LinearProgram() {}
+
+  // Adds pc and the instructions reachable from it without consuming a character to threads.
+  void addThread(ThreadList& threads, uint32_t pc, bool at_begin, bool at_end,
+                 std::vector<uint32_t>& stack) const;
+  // Returns the patterns matching value, or nullptr if there are none.
+  const std::vector<uint32_t>* dfaMatches(absl::string_view value) const;
+  // Calls on_match with each pattern matching value, until it returns false.
+  template <class Fn> void nfaMatches(absl::string_view value, Fn on_match) const;
+
+  // The NFA.
+  std::vector<Instruction> instructions_;
+  std::vector<std::bitset<256>> classes_;
+  // The first instruction of each pattern.
+  std::vector<uint32_t> starts_;
+
+  // The DFA, if it was small enough to build. State 0 is the dead state, from which no pattern can
+  // match, and state 1 the start state. The characters are mapped to the equivalence classes of
+  // characters which no pattern tells apart, by which the transitions are indexed.
+  std::vector<uint32_t> transitions_;
+  uint8_t character_classes_[256];
+  uint32_t num_character_classes_{};
+  // The patterns matching if the input ends in each state.
+  std::vector<std::vector<uint32_t>> accepts_;
+  // The patterns matching an empty input.
+  std::vector<uint32_t> empty_accepts_;
+};
+
+/**
+ * CompiledMatcher implemented with a LinearProgram.
+ */
+class LinearMatcher : public CompiledMatcher {
+public:
+  explicit LinearMatcher(LinearProgramPtr&& program) : program_(std::move(program)) {}
+
+  // Regex::CompiledMatcher
+  bool match(absl::string_view value) const override { return program_->matchAny(value); }
+
+private:
+  const LinearProgramPtr program_;
+};
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,21 @@
+#include "common/common/regex.h"
+
+#include "common/common/linear_regex.h"
+#include "common/common/utility.h"
+
+namespace Envoy {
+namespace Regex {
+
+CompiledMatcherPtr Utility::parseRegex(const std::string& regex, Engine engine) {
+  std::regex std_regex = RegexUtil::parseRegex(regex);
+  if (engine == Engine::Linear) {
+    LinearProgramPtr program = LinearProgram::compile({regex});
+    if (program != nullptr) {
+      return std::make_unique<LinearMatcher>(std::move(program));
+    }
+  }
+  return std::make_unique<StdRegexMatcher>(std::move(std_regex));
+}
+
+} // namespace Regex
+} // namespace Envoy
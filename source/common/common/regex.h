@@ -0,0 +1,52 @@
+#pragma once
+
+#include <regex>
+#include <string>
+
+#include "envoy/common/regex.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * The engines regular expressions can be compiled with.
+ */
+enum class Engine {
+  // libstdc++'s backtracking std::regex, which supports the whole ECMAScript grammar.
+  StdRegex,
+  // LinearProgram, which matches in time linear in the input. Patterns using constructs it doesn't
+  // support are compiled with std::regex instead.
+  Linear,
+};
+
+/**
+ * CompiledMatcher implemented with std::regex.
+ */
+class StdRegexMatcher : public CompiledMatcher {
+public:
+  explicit StdRegexMatcher(std::regex&& regex) : regex_(std::move(regex)) {}
+
+  // Regex::CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return std::regex_match(value.begin(), value.end(), regex_);
+  }
+
+private:
+  const std::regex regex_;
+};
+
+class Utility {
+public:
+  /**
+   * Compiles a regular expression in the ECMAScript grammar of std::regex. Whatever the engine,
+   * the pattern is validated by std::regex, so the same patterns are accepted by every engine.
+   * @param regex supplies the regular expression.
+   * @param engine supplies the engine to compile it with.
+   * @return CompiledMatcherPtr the compiled expression.
+   * @throw EnvoyException if the regular expression is invalid.
+   */
+  static CompiledMatcherPtr parseRegex(const std::string& regex, Engine engine = Engine::Linear);
+};
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,104 @@
+#include "common/common/suffix_trie.h"
+
+#include <algorithm>
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+
+struct SuffixTrie::Node {
+  // The part of the suffix between the parent and this node. Labels are not reversed, so that they
+  // can be compared with the key at once, but nodes are keyed on the last character of their label.
+  std::string label_;
+  absl::optional<uint32_t> index_;
+  // Sorted by the last character of their label, which is unique among siblings.
+  std::vector<NodePtr> children_;
+
+  static bool labelLess(const NodePtr& child, char c) { return child->label_.back() < c; }
+
+  std::vector<NodePtr>::iterator lowerBound(char c) {
+    return std::lower_bound(children_.begin(), children_.end(), c, labelLess);
+  }
+
+  const Node* findChild(char c) const {
+    auto it = std::lower_bound(children_.begin(), children_.end(), c, labelLess);
+    return it != children_.end() && (*it)->label_.back() == c ? it->get() : nullptr;
+  }
+};
+
+SuffixTrie::SuffixTrie() : root_(new Node()) {}
+
+SuffixTrie::SuffixTrie(SuffixTrie&& other) = default;
+
+SuffixTrie& SuffixTrie::operator=(SuffixTrie&& other) = default;
+
+SuffixTrie::~SuffixTrie() {}
+
+bool SuffixTrie::add(absl::string_view suffix, uint32_t index) {
+  Node* node = root_.get();
+  while (!suffix.empty()) {
+    auto it = node->lowerBound(suffix.back());
+    if (it == node->children_.end() || (*it)->label_.back() != suffix.back()) {
+      it = node->children_.insert(it, NodePtr(new Node()));
+      (*it)->label_ = std::string(suffix);
+      node = it->get();
+      break;
+    }
+
+    const std::string& label = (*it)->label_;
+    const size_t common =
+        std::mismatch(label.rbegin(), label.rend(), suffix.rbegin(), suffix.rend()).first -
+        label.rbegin();
+    if (common < label.size()) {
+      // The suffix diverges from the label, so the edge is split where they differ.
+      NodePtr split(new Node());
+      split->label_ = label.substr(label.size() - common);
+      (*it)->label_.erase(label.size() - common);
+      split->children_.push_back(std::move(*it));
+      *it = std::move(split);
+    }
+    node = it->get();
+    suffix.remove_suffix(common);
+  }
+
+  empty_ = false;
+  if (node->index_) {
+    return false;
+  }
+  node->index_ = index;
+  return true;
+}
+
+absl::optional<uint32_t> SuffixTrie::findLongest(absl::string_view key) const {
+  absl::optional<uint32_t> longest;
+  const Node* node = root_.get();
+  while (true) {
+    // The key left to match is the part before the suffix matched so far.
+    if (node->index_ && !key.empty()) {
+      longest = node->index_;
+    }
+    if (key.empty()) {
+      return longest;
+    }
+
+    node = node->findChild(key.back());
+    if (node == nullptr || !absl::EndsWith(key, node->label_)) {
+      return longest;
+    }
+    key.remove_suffix(node->label_.size());
+  }
+}
+
+absl::optional<uint32_t> SuffixTrie::find(absl::string_view key) const {
+  const Node* node = root_.get();
+  while (!key.empty()) {
+    node = node->findChild(key.back());
+    if (node == nullptr || !absl::EndsWith(key, node->label_)) {
+      return absl::nullopt;
+    }
+    key.remove_suffix(node->label_.size());
+  }
+  return node->index_;
+}
+
+} // namespace Envoy
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+
+/**
+ * Radix trie over suffixes, walked from the end of the key, used to find the longest wildcard
+ * domain suffix matching a host in a single pass over the host, whatever the number and lengths of
+ * the suffixes. Each suffix is associated with an index chosen by the caller. It can also look up
+ * whole keys, as a hash map keyed on strings would, without allocating for the lookup.
+ */
+class SuffixTrie {
+public:
+  SuffixTrie();
+  SuffixTrie(SuffixTrie&& other);
+  SuffixTrie& operator=(SuffixTrie&& other);
+  ~SuffixTrie();
+
+  /**
+   * Adds a suffix. A suffix which was already added keeps its first index.
+   * @param suffix supplies the suffix to match.
+   * @param index supplies the index associated with the suffix.
+   * @return bool whether the suffix was added, false if it was already present.
+   */
+  bool add(absl::string_view suffix, uint32_t index);
+
+  /**
+   * Finds the longest suffix of a key which is shorter than the key, so that "*.foo.com" doesn't
+   * match ".foo.com". Doesn't allocate.
+   * @param key supplies the key to match.
+   * @return absl::optional<uint32_t> the index of the longest matching suffix, if any.
+   */
+  absl::optional<uint32_t> findLongest(absl::string_view key) const;
+
+  /**
+   * Finds a suffix equal to a key. Doesn't allocate.
+   * @param key supplies the key to match.
+   * @return absl::optional<uint32_t> the index of the suffix, if any.
+   */
+  absl::optional<uint32_t> find(absl::string_view key) const;
+
+  /**
+   * @return bool whether no suffix was added.
+   */
+  bool empty() const { return empty_; }
+
+private:
+  struct Node;
+  typedef std::unique_ptr<Node> NodePtr;
+
+  NodePtr root_;
+  bool empty_{true};
+};
+
+} // namespace Envoy
@@ -1,7 +1,7 @@
 #include "common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <list>
 #include <string>
 
 #include "common/common/assert.h"
@@ -243,6 +243,219 @@ template <> bool HeaderMapImpl::HeaderList::isPseudoHeader(const LowerCaseString
   return key.get().c_str()[0] == ':';
 }
 
+HeaderMapImpl::EntryArena::~EntryArena() {
+  while (chunks_ != nullptr) {
+    Chunk* chunk = chunks_;
+    chunks_ = chunk->next_;
+    ::operator delete(chunk);
+  }
+}
+
+void* HeaderMapImpl::EntryArena::allocate() {
+  if (free_slots_ != nullptr) {
+    Slot* slot = free_slots_;
+    free_slots_ = slot->next_free_;
+    return slot;
+  }
+  if (chunks_ == nullptr || chunks_->used_ == chunks_->capacity_) {
+    uint32_t capacity = FirstChunkEntries;
+    if (chunks_ != nullptr) {
+      capacity = chunks_->capacity_ < MaxChunkEntries ? chunks_->capacity_ * 2 : MaxChunkEntries;
+    }
+    Chunk* chunk = static_cast<Chunk*>(::operator new(SlotOffset + capacity * sizeof(Slot)));
+    chunk->next_ = chunks_;
+    chunk->capacity_ = capacity;
+    chunk->used_ = 0;
+    chunks_ = chunk;
+  }
+  return &slots(chunks_)[chunks_->used_++];
+}
+
+void HeaderMapImpl::EntryArena::release(void* storage) {
+  Slot* slot = static_cast<Slot*>(storage);
+  slot->next_free_ = free_slots_;
+  free_slots_ = slot;
+}
+
+HeaderMapImpl::HeaderList::~HeaderList() {
+  for (HeaderEntryImpl* entry : entries_) {
+    if (entry != nullptr) {
+      entry->~HeaderEntryImpl();
+    }
+  }
+}
+
+void HeaderMapImpl::HeaderList::erase(HeaderEntryImpl& entry) {
+  ASSERT(entry.position_ < entries_.size() && entries_[entry.position_] == &entry);
+  entries_[entry.position_] = nullptr;
+  size_--;
+  if (!index_.empty()) {
+    index_.erase(entry);
+  }
+  destroy(entry);
+
+  // Slots at the end can be dropped right away, which keeps removing the last header cheap.
+  while (!entries_.empty() && entries_.back() == nullptr) {
+    entries_.pop_back();
+  }
+  pseudo_headers_end_ = std::min(pseudo_headers_end_, entries_.size());
+  if ((entries_.size() - size_) * 2 > entries_.size()) {
+    compact();
+  }
+}
+
+HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::HeaderList::find(absl::string_view key) const {
+  if (index_.empty()) {
+    return findLinear(key);
+  }
+  bool unique;
+  HeaderEntryImpl* entry = index_.find(key, EntryIndex::hash(key), unique);
+  if (entry == nullptr || unique) {
+    return entry;
+  }
+  // The index doesn't know the order of repeated keys.
+  return findLinear(key);
+}
+
+void HeaderMapImpl::HeaderList::remove(absl::string_view key) {
+  if (!index_.empty()) {
+    bool unique;
+    HeaderEntryImpl* entry = index_.find(key, EntryIndex::hash(key), unique);
+    if (entry == nullptr) {
+      return;
+    }
+    if (unique) {
+      erase(*entry);
+      return;
+    }
+  }
+  remove_if([key](const HeaderEntryImpl& entry) { return entry.key().getStringView() == key; });
+}
+
+void HeaderMapImpl::HeaderList::addToIndex(HeaderEntryImpl& entry) {
+  if (!index_.empty()) {
+    index_.insert(entry, EntryIndex::hash(entry.key().getStringView()));
+    return;
+  }
+  // The map just crossed the threshold; index everything, including the new entry.
+  for (HeaderEntryImpl* existing : *this) {
+    index_.insert(*existing, EntryIndex::hash(existing->key().getStringView()));
+  }
+}
+
+HeaderMapImpl::HeaderEntryImpl*
+HeaderMapImpl::HeaderList::findLinear(absl::string_view key) const {
+  for (HeaderEntryImpl* entry : *this) {
+    if (entry->key().getStringView() == key) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+void HeaderMapImpl::HeaderList::destroy(HeaderEntryImpl& entry) {
+  entry.~HeaderEntryImpl();
+  arena_.release(&entry);
+}
+
+void HeaderMapImpl::HeaderList::updatePositions(size_t from) {
+  for (size_t i = from; i < entries_.size(); i++) {
+    if (entries_[i] != nullptr) {
+      entries_[i]->position_ = i;
+    }
+  }
+}
+
+void HeaderMapImpl::HeaderList::compact() {
+  size_t kept = 0;
+  size_t kept_pseudo_headers = 0;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    HeaderEntryImpl* entry = entries_[i];
+    if (entry == nullptr) {
+      continue;
+    }
+    if (i < pseudo_headers_end_) {
+      kept_pseudo_headers++;
+    }
+    entry->position_ = kept;
+    entries_[kept++] = entry;
+  }
+  entries_.resize(kept);
+  pseudo_headers_end_ = kept_pseudo_headers;
+}
+
+void HeaderMapImpl::EntryIndex::insert(HeaderEntryImpl& entry, uint64_t hash) {
+  if ((size_ + 1) * 2 > slots_.size()) {
+    rehash(slots_.empty() ? MinCapacity : slots_.size() * 2);
+  }
+  size_t i = hash & mask();
+  while (slots_[i].entry_ != nullptr) {
+    i = (i + 1) & mask();
+  }
+  slots_[i] = {hash, &entry};
+  size_++;
+}
+
+void HeaderMapImpl::EntryIndex::erase(const HeaderEntryImpl& entry) {
+  size_t i = hash(entry.key().getStringView()) & mask();
+  while (slots_[i].entry_ != &entry) {
+    ASSERT(slots_[i].entry_ != nullptr);
+    i = (i + 1) & mask();
+  }
+  slots_[i].entry_ = nullptr;
+  if (--size_ == 0) {
+    clear();
+    return;
+  }
+
+  // Shift back any later slots in the probe run that would no longer be reachable from their
+  // home slot, so that lookups can stop at the first empty slot.
+  for (size_t j = (i + 1) & mask(); slots_[j].entry_ != nullptr; j = (j + 1) & mask()) {
+    const size_t home = slots_[j].hash_ & mask();
+    const bool reachable = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+    if (!reachable) {
+      slots_[i] = slots_[j];
+      slots_[j].entry_ = nullptr;
+      i = j;
+    }
+  }
+}
+
+void HeaderMapImpl::EntryIndex::clear() {
+  std::vector<Slot>().swap(slots_);
+  size_ = 0;
+}
+
+HeaderMapImpl::HeaderEntryImpl*
+HeaderMapImpl::EntryIndex::find(absl::string_view key, uint64_t hash, bool& unique) const {
+  HeaderEntryImpl* found = nullptr;
+  unique = true;
+  for (size_t i = hash & mask(); slots_[i].entry_ != nullptr; i = (i + 1) & mask()) {
+    if (slots_[i].hash_ == hash && slots_[i].entry_->key().getStringView() == key) {
+      if (found != nullptr) {
+        unique = false;
+        break;
+      }
+      found = slots_[i].entry_;
+    }
+  }
+  return found;
+}
+
+void HeaderMapImpl::EntryIndex::rehash(size_t capacity) {
+  std::vector<Slot> old_slots(capacity, Slot{0, nullptr});
+  old_slots.swap(slots_);
+  for (const Slot& slot : old_slots) {
+    if (slot.entry_ != nullptr) {
+      size_t i = slot.hash_ & mask();
+      while (slots_[i].entry_ != nullptr) {
+        i = (i + 1) & mask();
+      }
+      slots_[i] = slot;
+    }
+  }
+}
+
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key) : key_(key) {}
 
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value)
@@ -266,46 +479,35 @@ void HeaderMapImpl::HeaderEntryImpl::value(const HeaderEntry& header) {
 }
 
 #define INLINE_HEADER_STATIC_MAP_ENTRY(name)                                                       \
-  add(Headers::get().name.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {            \
-    return {&h.inline_headers_.name##_, &Headers::get().name};                                     \
-  });
+  {Headers::get().name.get(), [](HeaderMapImpl& h) -> StaticLookupResponse {                       \
+     return {&h.inline_headers_.name##_, &Headers::get().name};                                    \
+   }},
 
 HeaderMapImpl::StaticLookupTable::StaticLookupTable() {
-  ALL_INLINE_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
-
-  // Special case where we map a legacy host header to :authority.
-  add(Headers::get().HostLegacy.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {
-    return {&h.inline_headers_.Host_, &Headers::get().Host};
-  });
-}
-
-void HeaderMapImpl::StaticLookupTable::add(const char* key, StaticLookupEntry::EntryCb cb) {
-  StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    if (!current->entries_[c]) {
-      current->entries_[c].reset(new StaticLookupEntry());
-    }
-
-    current = current->entries_[c].get();
-    key++;
-  }
-
-  current->cb_ = cb;
-}
-
-HeaderMapImpl::StaticLookupEntry::EntryCb
-HeaderMapImpl::StaticLookupTable::find(const char* key) const {
-  const StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    current = current->entries_[c].get();
-    if (current) {
-      key++;
-    } else {
-      return nullptr;
+  entries_ = {
+      ALL_INLINE_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
+
+      // Special case where we map a legacy host header to :authority.
+      {Headers::get().HostLegacy.get(), [](HeaderMapImpl& h) -> StaticLookupResponse {
+         return {&h.inline_headers_.Host_, &Headers::get().Host};
+       }}};
+
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const StaticLookupEntry& lhs, const StaticLookupEntry& rhs) {
+                     return lhs.key_.size() < rhs.key_.size();
+                   });
+  for (StaticLookupEntry& entry : entries_) {
+    entry.signature_ = signature(entry.key_);
+  }
+  const size_t max_length = entries_.back().key_.size();
+  bucket_begin_.resize(max_length + 2);
+  uint32_t i = 0;
+  for (size_t length = 0; length <= max_length + 1; length++) {
+    while (i < entries_.size() && entries_[i].key_.size() < length) {
+      i++;
     }
+    bucket_begin_[length] = i;
   }
-
-  return current->cb_;
 }
 
 void HeaderMapImpl::appendToHeader(HeaderString& header, absl::string_view data) {
@@ -354,7 +556,7 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
   }
 
   for (auto i = headers_.begin(), j = rhs.headers_.begin(); i != headers_.end(); ++i, ++j) {
-    if (i->key() != j->key().c_str() || i->value() != j->value().c_str()) {
+    if ((*i)->key() != (*j)->key().c_str() || (*i)->value() != (*j)->value().c_str()) {
       return false;
     }
   }
@@ -363,7 +565,8 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
 }
 
 void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.c_str());
+  StaticLookupEntry::EntryCb cb =
+      ConstSingleton<StaticLookupTable>::get().find(key.getStringView());
   if (cb) {
     key.clear();
     StaticLookupResponse ref_lookup_response = cb(*this);
@@ -374,15 +577,14 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
       value.clear();
     }
   } else {
-    std::list<HeaderEntryImpl>::iterator i = headers_.insert(std::move(key), std::move(value));
-    i->entry_ = i;
+    headers_.insert(std::move(key), std::move(value));
   }
 }
 
 void HeaderMapImpl::addViaMove(HeaderString&& key, HeaderString&& value) {
   // If this is an inline header, we can't addViaMove, because we'll overwrite
   // the existing value.
-  auto* entry = getExistingInline(key.c_str());
+  auto* entry = getExistingInline(key.getStringView());
   if (entry != nullptr) {
     appendToHeader(entry->value(), value.c_str());
     key.clear();
@@ -415,7 +617,7 @@ void HeaderMapImpl::addReferenceKey(const LowerCaseString& key, const std::strin
 }
 
 void HeaderMapImpl::addCopy(const LowerCaseString& key, uint64_t value) {
-  auto* entry = getExistingInline(key.get().c_str());
+  auto* entry = getExistingInline(key.get());
   if (entry != nullptr) {
     char buf[32];
     StringUtil::itoa(buf, sizeof(buf), value);
@@ -432,7 +634,7 @@ void HeaderMapImpl::addCopy(const LowerCaseString& key, uint64_t value) {
 }
 
 void HeaderMapImpl::addCopy(const LowerCaseString& key, const std::string& value) {
-  auto* entry = getExistingInline(key.get().c_str());
+  auto* entry = getExistingInline(key.get());
   if (entry != nullptr) {
     appendToHeader(entry->value(), value);
     return;
@@ -464,45 +666,31 @@ void HeaderMapImpl::setReferenceKey(const LowerCaseString& key, const std::strin
 
 uint64_t HeaderMapImpl::byteSize() const {
   uint64_t byte_size = 0;
-  for (const HeaderEntryImpl& header : headers_) {
-    byte_size += header.key().size();
-    byte_size += header.value().size();
+  for (const HeaderEntryImpl* header : headers_) {
+    byte_size += header->key().size();
+    byte_size += header->value().size();
   }
 
   return byte_size;
 }
 
 const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
-    }
-  }
-
-  return nullptr;
+  return headers_.find(key.get());
 }
 
-HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
-  for (HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
-    }
-  }
-
-  return nullptr;
-}
+HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) { return headers_.find(key.get()); }
 
 void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (cb(header, context) == HeaderMap::Iterate::Break) {
+  for (const HeaderEntryImpl* header : headers_) {
+    if (cb(*header, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
 }
 
 void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
-  for (auto it = headers_.rbegin(); it != headers_.rend(); it++) {
-    if (cb(*it, context) == HeaderMap::Iterate::Break) {
+  for (auto it = headers_.rbegin(); it != headers_.rend(); ++it) {
+    if (cb(**it, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -510,7 +698,7 @@ void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
 
 HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
                                         const HeaderEntry** entry) const {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     // The accessor callbacks for predefined inline headers take a HeaderMapImpl& as an argument;
     // even though we don't make any modifications, we need to cast_cast in order to use the
@@ -532,18 +720,12 @@ HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
 }
 
 void HeaderMapImpl::remove(const LowerCaseString& key) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
-    for (auto i = headers_.begin(); i != headers_.end();) {
-      if (i->key() == key.get().c_str()) {
-        i = headers_.erase(i);
-      } else {
-        ++i;
-      }
-    }
+    headers_.remove(key.get());
   }
 }
 
@@ -554,7 +736,7 @@ void HeaderMapImpl::removePrefix(const LowerCaseString& prefix) {
       // If this header should be removed, make sure any references in the
       // static lookup table are cleared as well.
       StaticLookupEntry::EntryCb cb =
-          ConstSingleton<StaticLookupTable>::get().find(entry.key().c_str());
+          ConstSingleton<StaticLookupTable>::get().find(entry.key().getStringView());
       if (cb) {
         StaticLookupResponse ref_lookup_response = cb(*this);
         if (ref_lookup_response.entry_) {
@@ -572,9 +754,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key);
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key);
   return **entry;
 }
 
@@ -586,13 +766,11 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key, std::move(value));
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key, std::move(value));
   return **entry;
 }
 
-HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::getExistingInline(const char* key) {
+HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::getExistingInline(absl::string_view key) {
   StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key);
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
@@ -608,7 +786,7 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
-  headers_.erase(entry->entry_);
+  headers_.erase(*entry);
 }
 
 } // namespace Http
@@ -2,15 +2,20 @@
 
 #include <array>
 #include <cstdint>
-#include <list>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
+#include "common/common/hash.h"
 #include "common/common/non_copyable.h"
 #include "common/http/headers.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Http {
 
@@ -101,7 +106,93 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    // Index of the entry in its HeaderList, so that it can be erased without a search.
+    uint32_t position_{};
+  };
+
+  /**
+   * Storage for HeaderEntryImpl objects. Entries are carved out of chunks that double in size as
+   * the map grows, so a map with a typical number of headers makes a couple of allocations rather
+   * than one per header. Entries never move, so HeaderEntry pointers handed out by the map stay
+   * valid until the entry is removed, and slots freed by removals are reused by later insertions.
+   */
+  class EntryArena : NonCopyable {
+  public:
+    ~EntryArena();
+
+    /**
+     * @return void* uninitialized storage for one HeaderEntryImpl.
+     */
+    void* allocate();
+
+    /**
+     * Return storage obtained from allocate(). The entry must already have been destroyed.
+     */
+    void release(void* storage);
+
+  private:
+    union Slot {
+      Slot* next_free_;
+      std::aligned_storage<sizeof(HeaderEntryImpl), alignof(HeaderEntryImpl)>::type entry_;
+    };
+
+    // Header of a chunk; the chunk's slots follow it in the same allocation.
+    struct Chunk {
+      Chunk* next_;
+      uint32_t capacity_;
+      uint32_t used_;
+    };
+
+    static constexpr uint32_t FirstChunkEntries = 8;
+    static constexpr uint32_t MaxChunkEntries = 64;
+    static constexpr size_t SlotOffset =
+        (sizeof(Chunk) + alignof(Slot) - 1) & ~(alignof(Slot) - 1);
+
+    static Slot* slots(Chunk* chunk) {
+      return reinterpret_cast<Slot*>(reinterpret_cast<char*>(chunk) + SlotOffset);
+    }
+
+    Chunk* chunks_{};
+    Slot* free_slots_{};
+  };
+
+  /**
+   * Open addressing hash table from header key to entry, used by HeaderList to avoid linear
+   * scans once a map grows large. Keys may repeat, in which case each entry has its own slot.
+   */
+  class EntryIndex {
+  public:
+    bool empty() const { return size_ == 0; }
+    void insert(HeaderEntryImpl& entry, uint64_t hash);
+    void erase(const HeaderEntryImpl& entry);
+    void clear();
+
+    /**
+     * Find an entry by key.
+     * @param key supplies the key to look up.
+     * @param hash supplies the hash of the key.
+     * @param unique is set to whether the returned entry is the only one with this key.
+     * @return HeaderEntryImpl* an entry with the key, or nullptr if there is none.
+     */
+    HeaderEntryImpl* find(absl::string_view key, uint64_t hash, bool& unique) const;
+
+    static uint64_t hash(absl::string_view key) { return HashUtil::xxHash64(key); }
+
+  private:
+    struct Slot {
+      uint64_t hash_;
+      // nullptr for an empty slot.
+      HeaderEntryImpl* entry_;
+    };
+
+    static constexpr size_t MinCapacity = 64;
+
+    size_t mask() const { return slots_.size() - 1; }
+    void rehash(size_t capacity);
+
+    // Linear probing over a power of two sized table, kept at most half full.
+    std::vector<Slot> slots_;
+    size_t size_{};
   };
 
   struct StaticLookupResponse {
@@ -112,20 +203,45 @@ protected:
   struct StaticLookupEntry {
     typedef StaticLookupResponse (*EntryCb)(HeaderMapImpl&);
 
+    absl::string_view key_;
     EntryCb cb_{};
-    std::array<std::unique_ptr<StaticLookupEntry>, 256> entries_;
+    uint32_t signature_{};
   };
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
-   * headers. This uses a trie for lookup time at most equal to the size of the incoming string.
+   * headers. Entries are grouped by key length, so a lookup indexes straight to the handful of
+   * names with the incoming string's length. Within that group, a signature made of a few of the
+   * key's characters rules out almost every mismatch before a full comparison is needed.
    */
   struct StaticLookupTable {
     StaticLookupTable();
-    void add(const char* key, StaticLookupEntry::EntryCb cb);
-    StaticLookupEntry::EntryCb find(const char* key) const;
+    StaticLookupEntry::EntryCb find(absl::string_view key) const {
+      if (key.empty() || key.size() + 1 >= bucket_begin_.size()) {
+        return nullptr;
+      }
+      const uint32_t key_signature = signature(key);
+      for (uint32_t i = bucket_begin_[key.size()]; i < bucket_begin_[key.size() + 1]; i++) {
+        const StaticLookupEntry& entry = entries_[i];
+        if (entry.signature_ == key_signature &&
+            memcmp(entry.key_.data(), key.data(), key.size()) == 0) {
+          return entry.cb_;
+        }
+      }
+      return nullptr;
+    }
 
-    StaticLookupEntry root_;
+    // Many inline header names share a prefix (x-envoy-, content-, etc.), so sample the end and
+    // the middle of the key as well as its start. Requires a non-empty key.
+    static uint32_t signature(absl::string_view key) {
+      return static_cast<uint8_t>(key[0]) | static_cast<uint8_t>(key[key.size() / 2]) << 8 |
+             static_cast<uint32_t>(static_cast<uint8_t>(key[key.size() - 1])) << 16;
+    }
+
+    // All entries, sorted by key length.
+    std::vector<StaticLookupEntry> entries_;
+    // The entries with keys of length n are entries_[bucket_begin_[n]..bucket_begin_[n + 1]).
+    std::vector<uint32_t> bucket_begin_;
   };
 
   struct AllInlineHeaders {
@@ -136,68 +252,143 @@ protected:
    * List of HeaderEntryImpl that keeps the pseudo headers (key starting with ':') in the front
    * of the list (as required by nghttp2) and otherwise maintains insertion order.
    *
-   * Note: the internal iterators held in fields make this unsafe to copy and move, since the
-   * reference to end() is not preserved across a move (see Notes in
-   * https://en.cppreference.com/w/cpp/container/list/list). The NonCopyable will supress both copy
-   * and move constructors/assignment.
-   * TODO(htuch): Maybe we want this to movable one day; for now, our header map moves happen on
-   * HeaderMapPtr, so the performance impact should not be evident.
+   * The order is kept in a contiguous vector of entry pointers, which is cheap to scan and to
+   * shift, while the entries themselves live in an EntryArena and so never move. Each entry knows
+   * its position in the vector, so erasing it only clears its slot. Cleared slots are skipped by
+   * iteration and compacted away once they make up half the vector, so erasing is amortized O(1).
    */
   class HeaderList : NonCopyable {
   public:
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    /**
+     * Iterates over the entries of a HeaderList, skipping the slots of erased entries.
+     */
+    template <class BaseIterator> class Iterator {
+    public:
+      Iterator(BaseIterator it, BaseIterator end) : it_(it), end_(end) { skipErased(); }
+
+      HeaderEntryImpl* operator*() const { return *it_; }
+      Iterator& operator++() {
+        ++it_;
+        skipErased();
+        return *this;
+      }
+      bool operator==(const Iterator& rhs) const { return it_ == rhs.it_; }
+      bool operator!=(const Iterator& rhs) const { return it_ != rhs.it_; }
+
+    private:
+      void skipErased() {
+        while (it_ != end_ && *it_ == nullptr) {
+          ++it_;
+        }
+      }
+
+      BaseIterator it_;
+      BaseIterator end_;
+    };
+
+    typedef Iterator<std::vector<HeaderEntryImpl*>::const_iterator> ConstIterator;
+    typedef Iterator<std::vector<HeaderEntryImpl*>::const_reverse_iterator> ConstReverseIterator;
+
+    ~HeaderList();
 
     template <class Key> bool isPseudoHeader(const Key& key) { return key.c_str()[0] == ':'; }
 
-    template <class Key, class... Value>
-    std::list<HeaderEntryImpl>::iterator insert(Key&& key, Value&&... value) {
+    template <class Key, class... Value> HeaderEntryImpl& insert(Key&& key, Value&&... value) {
       const bool is_pseudo_header = isPseudoHeader(key);
-      std::list<HeaderEntryImpl>::iterator i =
-          headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
-                           std::forward<Key>(key), std::forward<Value>(value)...);
-      if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
-        pseudo_headers_end_ = i;
+      HeaderEntryImpl* entry = new (arena_.allocate())
+          HeaderEntryImpl(std::forward<Key>(key), std::forward<Value>(value)...);
+      if (entries_.capacity() == 0) {
+        // Skip the first few doublings; most maps hold at least this many headers.
+        entries_.reserve(InitialCapacity);
       }
-      return i;
-    }
-
-    std::list<HeaderEntryImpl>::iterator erase(std::list<HeaderEntryImpl>::iterator i) {
-      if (pseudo_headers_end_ == i) {
-        pseudo_headers_end_++;
+      if (!is_pseudo_header) {
+        entry->position_ = entries_.size();
+        entries_.push_back(entry);
+      } else if (pseudo_headers_end_ < entries_.size() &&
+                 entries_[pseudo_headers_end_] == nullptr) {
+        // The slot right after the pseudo headers was left by an erased entry, so take it over.
+        entry->position_ = pseudo_headers_end_;
+        entries_[pseudo_headers_end_++] = entry;
+      } else {
+        entries_.insert(entries_.begin() + pseudo_headers_end_, entry);
+        updatePositions(pseudo_headers_end_++);
       }
-      return headers_.erase(i);
+      size_++;
+      if (!index_.empty() || size_ > IndexThreshold) {
+        addToIndex(*entry);
+      }
+      return *entry;
     }
 
+    void erase(HeaderEntryImpl& entry);
+
+    /**
+     * @return HeaderEntryImpl* the first entry in iteration order with the given key, or nullptr.
+     */
+    HeaderEntryImpl* find(absl::string_view key) const;
+
+    /**
+     * Remove every entry with the given key.
+     */
+    void remove(absl::string_view key);
+
     template <class UnaryPredicate> void remove_if(UnaryPredicate p) {
-      headers_.remove_if([&](const HeaderEntryImpl& entry) {
-        const bool to_remove = p(entry);
-        if (to_remove) {
-          if (pseudo_headers_end_ == entry.entry_) {
-            pseudo_headers_end_++;
+      for (HeaderEntryImpl*& entry : entries_) {
+        if (entry != nullptr && p(static_cast<const HeaderEntryImpl&>(*entry))) {
+          if (!index_.empty()) {
+            index_.erase(*entry);
           }
+          destroy(*entry);
+          entry = nullptr;
+          size_--;
         }
-        return to_remove;
-      });
+      }
+      compact();
     }
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
-    size_t size() const { return headers_.size(); }
+    ConstIterator begin() const { return {entries_.begin(), entries_.end()}; }
+    ConstIterator end() const { return {entries_.end(), entries_.end()}; }
+    ConstReverseIterator rbegin() const { return {entries_.rbegin(), entries_.rend()}; }
+    ConstReverseIterator rend() const { return {entries_.rend(), entries_.rend()}; }
+    size_t size() const { return size_; }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
-    std::list<HeaderEntryImpl>::iterator pseudo_headers_end_;
+    static constexpr size_t InitialCapacity = 16;
+    // Below this many entries a linear scan of entries_ beats hashing the key.
+    static constexpr size_t IndexThreshold = 16;
+
+    void addToIndex(HeaderEntryImpl& entry);
+    HeaderEntryImpl* findLinear(absl::string_view key) const;
+    void destroy(HeaderEntryImpl& entry);
+
+    /**
+     * Set the position of the entries from the given index on, after they were shifted.
+     */
+    void updatePositions(size_t from);
+
+    /**
+     * Drop the slots of erased entries.
+     */
+    void compact();
+
+    // Holds nullptr in the slots of erased entries until the next compaction.
+    std::vector<HeaderEntryImpl*> entries_;
+    // The number of entries, not counting erased ones.
+    size_t size_{};
+    // The pseudo headers, and possibly slots of erased entries, are
+    // entries_[0..pseudo_headers_end_).
+    size_t pseudo_headers_end_{};
+    // Populated once the map has grown past IndexThreshold entries, and kept up to date from then
+    // on, even after the map shrinks back below the threshold, until every entry is erased.
+    EntryIndex index_;
+    EntryArena arena_;
   };
 
   void insertByKey(HeaderString&& key, HeaderString&& value);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key,
                                      HeaderString&& value);
-  HeaderEntryImpl* getExistingInline(const char* key);
+  HeaderEntryImpl* getExistingInline(absl::string_view key);
 
   void removeInline(HeaderEntryImpl** entry);
 
@@ -12,6 +12,8 @@
 #include "common/common/utility.h"
 #include "common/http/exception.h"
 #include "common/http/headers.h"
+#include "common/http/http1/fast_request_parser_impl.h"
+#include "common/http/http1/http_parser_impl.h"
 #include "common/http/utility.h"
 
 namespace Envoy {
@@ -21,18 +23,55 @@ namespace Http1 {
 const std::string StreamEncoderImpl::CRLF = "\r\n";
 const std::string StreamEncoderImpl::LAST_CHUNK = "0\r\n\r\n";
 
+/**
+ * Get the key a header is encoded with, so that sizing and encoding skip and translate the same
+ * headers.
+ * @param header supplies the header.
+ * @param key supplies the key to use, set on return.
+ * @param key_size supplies the byte size of the key to use, set on return.
+ * @return bool whether the header is encoded at all.
+ */
+static bool encodedHeaderKey(const HeaderEntry& header, const char*& key, uint32_t& key_size) {
+  key = header.key().c_str();
+  key_size = header.key().size();
+  // Translate :authority -> host so that upper layers do not need to deal with this.
+  if (key_size > 1 && key[0] == ':' && key[1] == 'a') {
+    key = Headers::get().HostLegacy.get().c_str();
+    key_size = Headers::get().HostLegacy.get().size();
+  }
+
+  // Skip all headers starting with ':' that make it here.
+  return key[0] != ':';
+}
+
+uint64_t StreamEncoderImpl::encodedHeadersSize(const HeaderMap& headers) {
+  uint64_t size = 0;
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        const char* key;
+        uint32_t key_size;
+        if (encodedHeaderKey(header, key, key_size)) {
+          // key: value CRLF
+          *static_cast<uint64_t*>(context) += key_size + 2 + header.value().size() + 2;
+        }
+        return HeaderMap::Iterate::Continue;
+      },
+      &size);
+
+  // The codec may add transfer-encoding: chunked, or the shorter content-length: 0, and the
+  // headers end with a CRLF.
+  return size + Headers::get().TransferEncoding.get().size() + 2 +
+         Headers::get().TransferEncodingValues.Chunked.size() + 2 + 2;
+}
+
 void StreamEncoderImpl::encodeHeader(const char* key, uint32_t key_size, const char* value,
                                      uint32_t value_size) {
-
-  connection_.reserveBuffer(key_size + value_size + 4);
   ASSERT(key_size > 0);
 
   connection_.copyToBuffer(key, key_size);
-  connection_.addCharToBuffer(':');
-  connection_.addCharToBuffer(' ');
+  connection_.copyToBuffer(": ", 2);
   connection_.copyToBuffer(value, value_size);
-  connection_.addCharToBuffer('\r');
-  connection_.addCharToBuffer('\n');
+  connection_.copyToBuffer("\r\n", 2);
 }
 
 void StreamEncoderImpl::encode100ContinueHeaders(const HeaderMap& headers) {
@@ -43,24 +82,17 @@ void StreamEncoderImpl::encode100ContinueHeaders(const HeaderMap& headers) {
 }
 
 void StreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
+  // The request and response encoders reserved encodedHeadersSize() bytes past their first line, so
+  // the headers are copied without any further reservation.
   bool saw_content_length = false;
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
-        const char* key_to_use = header.key().c_str();
-        uint32_t key_size_to_use = header.key().size();
-        // Translate :authority -> host so that upper layers do not need to deal with this.
-        if (key_size_to_use > 1 && key_to_use[0] == ':' && key_to_use[1] == 'a') {
-          key_to_use = Headers::get().HostLegacy.get().c_str();
-          key_size_to_use = Headers::get().HostLegacy.get().size();
-        }
-
-        // Skip all headers starting with ':' that make it here.
-        if (key_to_use[0] == ':') {
-          return HeaderMap::Iterate::Continue;
+        const char* key_to_use;
+        uint32_t key_size_to_use;
+        if (encodedHeaderKey(header, key_to_use, key_size_to_use)) {
+          static_cast<StreamEncoderImpl*>(context)->encodeHeader(
+              key_to_use, key_size_to_use, header.value().c_str(), header.value().size());
         }
-
-        static_cast<StreamEncoderImpl*>(context)->encodeHeader(
-            key_to_use, key_size_to_use, header.value().c_str(), header.value().size());
         return HeaderMap::Iterate::Continue;
       },
       this);
@@ -112,9 +144,7 @@ void StreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream)
     }
   }
 
-  connection_.reserveBuffer(2);
-  connection_.addCharToBuffer('\r');
-  connection_.addCharToBuffer('\n');
+  connection_.copyToBuffer("\r\n", 2);
 
   if (end_stream) {
     endEncode();
@@ -216,8 +246,12 @@ static const char HTTP_10_RESPONSE_PREFIX[] = "HTTP/1.0 ";
 void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
   started_response_ = true;
   uint64_t numeric_status = Utility::getResponseStatus(headers);
+  const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
+  uint32_t status_string_len = strlen(status_string);
 
-  connection_.reserveBuffer(4096);
+  // Reserve the whole header block at once: status line, then the headers.
+  connection_.reserveBuffer(sizeof(RESPONSE_PREFIX) - 1 + StringUtil::MIN_ITOA_OUT_LEN + 1 +
+                            status_string_len + 2 + encodedHeadersSize(headers));
   if (connection_.protocol() == Protocol::Http10 && connection_.supports_http_10()) {
     connection_.copyToBuffer(HTTP_10_RESPONSE_PREFIX, sizeof(HTTP_10_RESPONSE_PREFIX) - 1);
   } else {
@@ -225,13 +259,8 @@ void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end
   }
   connection_.addIntToBuffer(numeric_status);
   connection_.addCharToBuffer(' ');
-
-  const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
-  uint32_t status_string_len = strlen(status_string);
   connection_.copyToBuffer(status_string, status_string_len);
-
-  connection_.addCharToBuffer('\r');
-  connection_.addCharToBuffer('\n');
+  connection_.copyToBuffer("\r\n", 2);
 
   StreamEncoderImpl::encodeHeaders(headers, end_stream);
 }
@@ -248,7 +277,9 @@ void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_
     head_request_ = true;
   }
   connection_.onEncodeHeaders(headers);
-  connection_.reserveBuffer(std::max(4096U, path->value().size() + 4096));
+  // Reserve the whole header block at once: request line, then the headers.
+  connection_.reserveBuffer(method->value().size() + 1 + path->value().size() +
+                            sizeof(REQUEST_POSTFIX) - 1 + encodedHeadersSize(headers));
   connection_.copyToBuffer(method->value().c_str(), method->value().size());
   connection_.addCharToBuffer(' ');
   connection_.copyToBuffer(path->value().c_str(), path->value().size());
@@ -257,50 +288,52 @@ void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_
   StreamEncoderImpl::encodeHeaders(headers, end_stream);
 }
 
-http_parser_settings ConnectionImpl::settings_{
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageBeginBase();
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onUrl(at, length);
-      return 0;
-    },
-    nullptr, // on_status
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderField(at, length);
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderValue(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      return static_cast<ConnectionImpl*>(parser->data)->onHeadersCompleteBase();
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onBody(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageCompleteBase();
-      return 0;
-    },
-    nullptr, // on_chunk_header
-    nullptr  // on_chunk_complete
-};
+void RequestStreamEncoderImpl::resetStream(StreamResetReason reason) {
+  if (connection_.resetStreamCalled()) {
+    // Every stream awaiting a response is reset with the connection. A pipelined stream may be
+    // reset again from the reset callbacks of the streams ahead of it.
+    runResetCallbacks(reason);
+    return;
+  }
+  StreamEncoderImpl::resetStream(reason);
+}
+
+void RequestStreamEncoderImpl::readDisable(bool disable) {
+  if (disable) {
+    ++read_disable_calls_;
+  } else if (read_disable_calls_ > 0) {
+    --read_disable_calls_;
+  } else {
+    // The calls were already unwound when the response completed.
+    return;
+  }
+  StreamEncoderImpl::readDisable(disable);
+}
+
+void RequestStreamEncoderImpl::unwindReadDisable() {
+  for (; read_disable_calls_ > 0; --read_disable_calls_) {
+    StreamEncoderImpl::readDisable(false);
+  }
+}
 
 const ToLowerTable& ConnectionImpl::toLowerTable() {
   static ToLowerTable* table = new ToLowerTable();
   return *table;
 }
 
-ConnectionImpl::ConnectionImpl(Network::Connection& connection, http_parser_type type)
+ConnectionImpl::ConnectionImpl(Network::Connection& connection, http_parser_type type,
+                               RequestParserType request_parser)
     : connection_(connection), output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
                                               [&]() -> void { this->onAboveHighWatermark(); }) {
   output_buffer_.setWatermarks(connection.bufferLimit());
-  http_parser_init(&parser_, type);
-  parser_.data = this;
+  parser_ = createParser(type, request_parser);
+}
+
+ParserPtr ConnectionImpl::createParser(http_parser_type type, RequestParserType request_parser) {
+  if (type == HTTP_REQUEST && request_parser == RequestParserType::Fast) {
+    return std::make_unique<FastRequestParserImpl>(parser_callbacks_);
+  }
+  return std::make_unique<HttpParserImpl>(type, parser_callbacks_);
 }
 
 void ConnectionImpl::completeLastHeader() {
@@ -344,7 +377,7 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
   }
 
   // Always unpause before dispatch.
-  http_parser_pause(&parser_, 0);
+  parser_->pause(false);
 
   ssize_t total_parsed = 0;
   if (data.length() > 0) {
@@ -367,11 +400,10 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
 }
 
 size_t ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
-  ssize_t rc = http_parser_execute(&parser_, &settings_, slice, len);
-  if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED) {
+  size_t rc = parser_->execute(slice, len);
+  if (parser_->status() == ParserStatus::Error) {
     sendProtocolError();
-    throw CodecProtocolException("http/1.1 protocol error: " +
-                                 std::string(http_errno_name(HTTP_PARSER_ERRNO(&parser_))));
+    throw CodecProtocolException("http/1.1 protocol error: " + std::string(parser_->errorName()));
   }
 
   return rc;
@@ -400,10 +432,22 @@ void ConnectionImpl::onHeaderValue(const char* data, size_t length) {
   current_header_value_.append(data, length);
 }
 
+void ConnectionImpl::onHeader(const char* key, size_t key_length, const char* value,
+                              size_t value_length) {
+  ENVOY_CONN_LOG(trace, "completed header: key={} value={}", connection_,
+                 std::string(key, key_length), std::string(value, value_length));
+  HeaderString field;
+  field.setCopy(key, key_length);
+  toLowerTable().toLowerCase(field.buffer(), field.size());
+  HeaderString field_value;
+  field_value.setCopy(value, value_length);
+  current_header_map_->addViaMove(std::move(field), std::move(field_value));
+}
+
 int ConnectionImpl::onHeadersCompleteBase() {
   ENVOY_CONN_LOG(trace, "headers complete", connection_);
   completeLastHeader();
-  if (!(parser_.http_major == 1 && parser_.http_minor == 1)) {
+  if (!(parser_->httpMajor() == 1 && parser_->httpMinor() == 1)) {
     // This is not necessarily true, but it's good enough since higher layers only care if this is
     // HTTP/1.1 or not.
     protocol_ = Protocol::Http10;
@@ -428,7 +472,7 @@ void ConnectionImpl::onMessageCompleteBase() {
     // upgrade payload will be treated as stream body.
     ASSERT(!deferred_end_stream_headers_);
     ENVOY_CONN_LOG(trace, "Pausing parser due to upgrade.", connection_);
-    http_parser_pause(&parser_, 1);
+    parser_->pause(true);
     return;
   }
   onMessageComplete();
@@ -448,10 +492,23 @@ void ConnectionImpl::onResetStreamBase(StreamResetReason reason) {
   onResetStream(reason);
 }
 
+#ifdef ENVOY_FAST_HTTP1_PARSER
+static constexpr RequestParserType DEFAULT_REQUEST_PARSER = RequestParserType::Fast;
+#else
+static constexpr RequestParserType DEFAULT_REQUEST_PARSER = RequestParserType::HttpParser;
+#endif
+
 ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
                                            ServerConnectionCallbacks& callbacks,
                                            Http1Settings settings)
-    : ConnectionImpl(connection, HTTP_REQUEST), callbacks_(callbacks), codec_settings_(settings) {}
+    : ServerConnectionImpl(connection, callbacks, settings, DEFAULT_REQUEST_PARSER) {}
+
+ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
+                                           ServerConnectionCallbacks& callbacks,
+                                           Http1Settings settings,
+                                           RequestParserType request_parser)
+    : ConnectionImpl(connection, HTTP_REQUEST, request_parser), callbacks_(callbacks),
+      codec_settings_(settings) {}
 
 void ServerConnectionImpl::onEncodeComplete() {
   ASSERT(active_request_);
@@ -545,15 +602,15 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   // to disconnect the connection but we shouldn't fire any more events since it doesn't make
   // sense.
   if (active_request_) {
-    const char* method_string = http_method_str(static_cast<http_method>(parser_.method));
+    const char* method_string = http_method_str(static_cast<http_method>(parser_->method()));
 
     // Inform the response encoder about any HEAD method, so it can set content
     // length and transfer encoding headers correctly.
-    active_request_->response_encoder_.isResponseToHeadRequest(parser_.method == HTTP_HEAD);
+    active_request_->response_encoder_.isResponseToHeadRequest(parser_->method() == HTTP_HEAD);
 
     // Currently, CONNECT is not supported, however; http_parser_parse_url needs to know about
     // CONNECT
-    handlePath(*headers, parser_.method);
+    handlePath(*headers, parser_->method());
     ASSERT(active_request_->request_url_.empty());
 
     headers->insertMethod().value(method_string, strlen(method_string));
@@ -564,14 +621,15 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
     // with message complete. This allows upper layers to behave like HTTP/2 and prevents a proxy
     // scenario where the higher layers stream through and implicitly switch to chunked transfer
     // encoding because end stream with zero body length has not yet been indicated.
-    if (parser_.flags & F_CHUNKED ||
-        (parser_.content_length > 0 && parser_.content_length != ULLONG_MAX) || handling_upgrade_) {
+    if (parser_->isChunked() ||
+        (parser_->contentLength() > 0 && parser_->contentLength() != ULLONG_MAX) ||
+        handling_upgrade_) {
       active_request_->request_decoder_->decodeHeaders(std::move(headers), false);
 
       // If the connection has been closed (or is closing) after decoding headers, pause the parser
       // so we return control to the caller.
       if (connection_.state() != Network::Connection::State::Open) {
-        http_parser_pause(&parser_, 1);
+        parser_->pause(true);
       }
 
     } else {
@@ -622,7 +680,7 @@ void ServerConnectionImpl::onMessageComplete() {
   // Always pause the parser so that the calling code can process 1 request at a time and apply
   // back pressure. However this means that the calling code needs to detect if there is more data
   // in the buffer and dispatch it again.
-  http_parser_pause(&parser_, 1);
+  parser_->pause(true);
 }
 
 void ServerConnectionImpl::onResetStream(StreamResetReason reason) {
@@ -657,11 +715,11 @@ void ServerConnectionImpl::onBelowLowWatermark() {
 }
 
 ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks&)
-    : ConnectionImpl(connection, HTTP_RESPONSE) {}
+    : ConnectionImpl(connection, HTTP_RESPONSE, RequestParserType::HttpParser) {}
 
 bool ClientConnectionImpl::cannotHaveBody() {
   if ((!pending_responses_.empty() && pending_responses_.front().head_request_) ||
-      parser_.status_code == 204 || parser_.status_code == 304) {
+      parser_->statusCode() == 204 || parser_->statusCode() == 304) {
     return true;
   } else {
     return false;
@@ -672,16 +730,28 @@ StreamEncoder& ClientConnectionImpl::newStream(StreamDecoder& response_decoder)
   if (resetStreamCalled()) {
     throw CodecClientException("cannot create new streams after calling reset");
   }
-  // Streams are responsible for unwinding any outstanding readDisable(true)
-  // calls done on the underlying connection as they are destroyed. As this is
-  // the only place a HTTP/1 stream is destroyed where the Network::Connection is
-  // reused, unwind any outstanding readDisable() calls here.
-  while (!connection_.readEnabled()) {
-    connection_.readDisable(false);
+  if (pending_responses_.empty()) {
+    // Streams are responsible for unwinding any outstanding readDisable(true)
+    // calls done on the underlying connection as they are destroyed. As this is
+    // the only place a HTTP/1 stream is destroyed where the Network::Connection is
+    // reused, unwind any outstanding readDisable() calls here. A pipelined stream
+    // leaves them to the streams still awaiting a response, which unwind their own
+    // calls as they complete.
+    while (!connection_.readEnabled()) {
+      connection_.readDisable(false);
+    }
+    request_encoder_.reset();
+  }
+  const bool pipelined = !pending_responses_.empty();
+  pending_responses_.emplace_back(&response_decoder, *this);
+  pending_responses_.back().pipelined_ = pipelined;
+  RequestStreamEncoderImpl& encoder = *pending_responses_.back().encoder_;
+  // If the connection is currently above the high watermark, make sure to inform the new stream,
+  // as the low watermark is reported to the newest stream.
+  if (connection_.aboveHighWatermark()) {
+    encoder.runHighWatermarkCallbacks();
   }
-  request_encoder_.reset(new RequestStreamEncoderImpl(*this));
-  pending_responses_.emplace_back(&response_decoder);
-  return *request_encoder_;
+  return encoder;
 }
 
 void ClientConnectionImpl::onEncodeHeaders(const HeaderMap& headers) {
@@ -690,8 +760,14 @@ void ClientConnectionImpl::onEncodeHeaders(const HeaderMap& headers) {
   }
 }
 
+void ClientConnectionImpl::onMessageBegin() {
+  if (!pending_responses_.empty()) {
+    pending_responses_.front().response_started_ = true;
+  }
+}
+
 int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
-  headers->insertStatus().value(parser_.status_code);
+  headers->insertStatus().value(parser_->statusCode());
 
   // Handle the case where the client is closing a kept alive connection (by sending a 408
   // with a 'Connection: close' header). In this case we just let response flush out followed
@@ -699,7 +775,7 @@ int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   if (pending_responses_.empty() && !resetStreamCalled()) {
     throw PrematureResponseException(std::move(headers));
   } else if (!pending_responses_.empty()) {
-    if (parser_.status_code == 100) {
+    if (parser_->statusCode() == 100) {
       // http-parser treats 100 continue headers as their own complete response.
       // Swallow the spurious onMessageComplete and continue processing.
       ignore_message_complete_for_100_continue_ = true;
@@ -733,8 +809,11 @@ void ClientConnectionImpl::onMessageComplete() {
   }
   if (!pending_responses_.empty()) {
     // After calling decodeData() with end stream set to true, we should no longer be able to reset.
-    PendingResponse response = pending_responses_.front();
+    PendingResponse response = std::move(pending_responses_.front());
     pending_responses_.pop_front();
+    if (!pending_responses_.empty()) {
+      response.encoder_->unwindReadDisable();
+    }
 
     if (deferred_end_stream_headers_) {
       response.decoder_->decodeHeaders(std::move(deferred_end_stream_headers_), true);
@@ -743,21 +822,28 @@ void ClientConnectionImpl::onMessageComplete() {
       Buffer::OwnedImpl buffer;
       response.decoder_->decodeData(buffer, true);
     }
+    request_encoder_ = std::move(response.encoder_);
   }
 }
 
 void ClientConnectionImpl::onResetStream(StreamResetReason reason) {
-  // Only raise reset if we did not already dispatch a complete response.
-  if (!pending_responses_.empty()) {
-    pending_responses_.clear();
-    request_encoder_->runResetCallbacks(reason);
+  // Only raise reset if we did not already dispatch a complete response. Requests cannot be reset
+  // individually, so a reset takes every request awaiting a response with it.
+  reset_responses_ = std::move(pending_responses_);
+  pending_responses_.clear();
+  for (PendingResponse& response : reset_responses_) {
+    // Whatever reset the connection, the requests pipelined behind the one being answered were
+    // possibly never processed by the upstream, so they are told apart.
+    response.encoder_->runResetCallbacks(response.pipelined_ && !response.response_started_
+                                             ? StreamResetReason::PipelinedRequestUnanswered
+                                             : reason);
   }
 }
 
 void ClientConnectionImpl::onAboveHighWatermark() {
   // This should never happen without an active stream/request.
   ASSERT(!pending_responses_.empty());
-  request_encoder_->runHighWatermarkCallbacks();
+  pending_responses_.back().encoder_->runHighWatermarkCallbacks();
 }
 
 void ClientConnectionImpl::onBelowLowWatermark() {
@@ -765,7 +851,7 @@ void ClientConnectionImpl::onBelowLowWatermark() {
   // such as sending multiple responses to the same request, causing us to close the connection, but
   // in doing so go below low watermark.
   if (!pending_responses_.empty()) {
-    request_encoder_->runLowWatermarkCallbacks();
+    pending_responses_.back().encoder_->runLowWatermarkCallbacks();
   }
 }
 
@@ -17,6 +17,7 @@
 #include "common/http/codec_helper.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http1/parser.h"
 
 namespace Envoy {
 namespace Http {
@@ -51,6 +52,13 @@ public:
 protected:
   StreamEncoderImpl(ConnectionImpl& connection) : connection_(connection) {}
 
+  /**
+   * @return uint64_t the number of bytes encodeHeaders() writes for the headers past the first
+   *         line, so that the whole header block is reserved at once. It is exact but for the
+   *         header the codec may add, which is counted at its longest.
+   */
+  static uint64_t encodedHeadersSize(const HeaderMap& headers);
+
   static const std::string CRLF;
   static const std::string LAST_CHUNK;
 
@@ -103,10 +111,26 @@ public:
   // Http::StreamEncoder
   void encodeHeaders(const HeaderMap& headers, bool end_stream) override;
 
+  // Http::Stream
+  void resetStream(StreamResetReason reason) override;
+  void readDisable(bool disable) override;
+
+  /**
+   * Undo the readDisable(true) calls of the stream which were not matched by a readDisable(false),
+   * so that a complete response does not hold up the responses to the requests pipelined after it.
+   */
+  void unwindReadDisable();
+
 private:
   bool head_request_{};
+  uint32_t read_disable_calls_{};
 };
 
+/**
+ * Parsers of HTTP/1.1 requests. Responses are always parsed by http_parser.
+ */
+enum class RequestParserType { HttpParser, Fast };
+
 /**
  * Base class for HTTP/1.1 client and server connections.
  */
@@ -157,17 +181,17 @@ public:
 
   void readDisable(bool disable) { connection_.readDisable(disable); }
   uint32_t bufferLimit() { return connection_.bufferLimit(); }
+  bool resetStreamCalled() { return reset_stream_called_; }
   virtual bool supports_http_10() { return false; }
 
   bool maybeDirectDispatch(Buffer::Instance& data);
 
 protected:
-  ConnectionImpl(Network::Connection& connection, http_parser_type type);
-
-  bool resetStreamCalled() { return reset_stream_called_; }
+  ConnectionImpl(Network::Connection& connection, http_parser_type type,
+                 RequestParserType request_parser);
 
   Network::Connection& connection_;
-  http_parser parser_;
+  ParserPtr parser_;
   HeaderMapPtr deferred_end_stream_headers_;
   Http::Code error_code_{Http::Code::BadRequest};
   bool handling_upgrade_{};
@@ -175,6 +199,39 @@ protected:
 private:
   enum class HeaderParsingState { Field, Value, Done };
 
+  /**
+   * Forwards the callbacks of parser_ to the base routines of the connection.
+   */
+  struct ParserCallbacksImpl : public ParserCallbacks {
+    ParserCallbacksImpl(ConnectionImpl& parent) : parent_(parent) {}
+
+    // Http1::ParserCallbacks
+    void onMessageBegin() override { parent_.onMessageBeginBase(); }
+    void onUrl(const char* data, size_t length) override { parent_.onUrl(data, length); }
+    void onHeaderField(const char* data, size_t length) override {
+      parent_.onHeaderField(data, length);
+    }
+    void onHeaderValue(const char* data, size_t length) override {
+      parent_.onHeaderValue(data, length);
+    }
+    void onHeader(const char* key, size_t key_length, const char* value,
+                  size_t value_length) override {
+      parent_.onHeader(key, key_length, value, value_length);
+    }
+    int onHeadersComplete() override { return parent_.onHeadersCompleteBase(); }
+    void onBody(const char* data, size_t length) override { parent_.onBody(data, length); }
+    void onMessageComplete() override { parent_.onMessageCompleteBase(); }
+
+    ConnectionImpl& parent_;
+  };
+
+  /**
+   * Create the parser of the connection.
+   * @param type supplies whether requests or responses are parsed.
+   * @param request_parser supplies the parser of requests.
+   */
+  ParserPtr createParser(http_parser_type type, RequestParserType request_parser);
+
   /**
    * Called in order to complete an in progress header decode.
    */
@@ -215,6 +272,15 @@ private:
    */
   void onHeaderValue(const char* data, size_t length);
 
+  /**
+   * Called when a complete header is received.
+   * @param key supplies the start address of the field.
+   * @param key_length supplies the length of the field.
+   * @param value supplies the start address of the value.
+   * @param value_length supplies the length of the value.
+   */
+  void onHeader(const char* key, size_t key_length, const char* value, size_t value_length);
+
   /**
    * Called when headers are complete. A base routine happens first then a virtual disaptch is
    * invoked.
@@ -258,7 +324,6 @@ private:
    */
   virtual void onBelowLowWatermark() PURE;
 
-  static http_parser_settings settings_;
   static const ToLowerTable& toLowerTable();
 
   HeaderMapImplPtr current_header_map_;
@@ -270,6 +335,7 @@ private:
   Buffer::RawSlice reserved_iovec_;
   char* reserved_current_{};
   Protocol protocol_{Protocol::Http11};
+  ParserCallbacksImpl parser_callbacks_{*this};
 };
 
 /**
@@ -277,8 +343,15 @@ private:
  */
 class ServerConnectionImpl : public ServerConnection, public ConnectionImpl {
 public:
+  /**
+   * Requests are parsed by FastRequestParserImpl if the build defines ENVOY_FAST_HTTP1_PARSER, by
+   * http_parser otherwise.
+   */
   ServerConnectionImpl(Network::Connection& connection, ServerConnectionCallbacks& callbacks,
                        Http1Settings settings);
+  // For testing, so that both parsers are covered whatever the build.
+  ServerConnectionImpl(Network::Connection& connection, ServerConnectionCallbacks& callbacks,
+                       Http1Settings settings, RequestParserType request_parser);
 
   virtual bool supports_http_10() override { return codec_settings_.accept_http_10_; }
 
@@ -332,13 +405,19 @@ public:
 
   // Http::ClientConnection
   StreamEncoder& newStream(StreamDecoder& response_decoder) override;
+  uint32_t remoteMaxConcurrentStreams() override { return 1; }
 
 private:
   struct PendingResponse {
-    PendingResponse(StreamDecoder* decoder) : decoder_(decoder) {}
+    PendingResponse(StreamDecoder* decoder, ConnectionImpl& connection)
+        : decoder_(decoder), encoder_(new RequestStreamEncoderImpl(connection)) {}
 
     StreamDecoder* decoder_;
+    std::unique_ptr<RequestStreamEncoderImpl> encoder_;
     bool head_request_{};
+    // Whether the request was sent while another one awaited its response.
+    bool pipelined_{};
+    bool response_started_{};
   };
 
   bool cannotHaveBody();
@@ -346,7 +425,7 @@ private:
   // ConnectionImpl
   void onEncodeComplete() override {}
   void onEncodeHeaders(const HeaderMap& headers) override;
-  void onMessageBegin() override {}
+  void onMessageBegin() override;
   void onUrl(const char*, size_t) override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
   int onHeadersComplete(HeaderMapImplPtr&& headers) override;
   void onBody(const char* data, size_t length) override;
@@ -356,8 +435,13 @@ private:
   void onAboveHighWatermark() override;
   void onBelowLowWatermark() override;
 
+  // The encoder of the last complete response, which callers may still refer to. It lives until the
+  // next response completes or a stream is created on the idle connection.
   std::unique_ptr<RequestStreamEncoderImpl> request_encoder_;
+  // The streams awaiting a response, oldest first. There are several when requests are pipelined.
   std::list<PendingResponse> pending_responses_;
+  // The streams reset with the connection, whose encoders callers may still refer to.
+  std::list<PendingResponse> reset_responses_;
   // Set true between receiving 100-Continue headers and receiving the spurious onMessageComplete.
   bool ignore_message_complete_for_100_continue_{};
 };
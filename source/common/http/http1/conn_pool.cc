@@ -1,5 +1,6 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <list>
 
@@ -21,8 +22,10 @@ namespace Http1 {
 
 ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
                            Upstream::ResourcePriority priority,
-                           const Network::ConnectionSocket::OptionsSharedPtr& options)
+                           const Network::ConnectionSocket::OptionsSharedPtr& options,
+                           uint32_t max_pipeline_depth)
     : dispatcher_(dispatcher), host_(host), priority_(priority), socket_options_(options),
+      max_pipeline_depth_(max_pipeline_depth),
       upstream_ready_timer_(dispatcher_.createTimer([this]() { onUpstreamReady(); })) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
@@ -43,10 +46,11 @@ void ConnPoolImpl::drainConnections() {
     ready_clients_.front()->codec_client_->close();
   }
 
-  // We drain busy clients by manually setting remaining requests to 1. Thus, when the next
-  // response completes the client will be destroyed.
+  // We drain busy clients by manually setting remaining requests to the requests in flight, or 1
+  // for a client still connecting. Thus, when their responses complete the client will be
+  // destroyed.
   for (const auto& client : busy_clients_) {
-    client->remaining_requests_ = 1;
+    client->remaining_requests_ = std::max<uint64_t>(1, client->stream_wrappers_.size());
   }
 }
 
@@ -57,9 +61,41 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 
 void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) {
-  ASSERT(!client.stream_wrapper_);
-  client.stream_wrapper_.reset(new StreamWrapper(response_decoder, client));
-  callbacks.onPoolReady(*client.stream_wrapper_, client.real_host_description_);
+  ASSERT(client.stream_wrappers_.size() < max_pipeline_depth_);
+  if (max_pipeline_depth_ > 1) {
+    host_->cluster().stats().upstream_rq_pipeline_depth_.recordValue(
+        client.stream_wrappers_.size() + 1);
+  }
+  client.stream_wrappers_.emplace_back(new StreamWrapper(response_decoder, client));
+  callbacks.onPoolReady(*client.stream_wrappers_.back(), client.real_host_description_);
+}
+
+bool ConnPoolImpl::canPipeline(const ActiveClient& client) const {
+  // A request is pipelined once every request ahead of it has been fully sent, so that the codec
+  // only ever encodes one request at a time. It must also fit in the requests the connection has
+  // left, and the upstream must not have asked to close the connection.
+  if (client.stream_wrappers_.empty() || client.stream_wrappers_.size() >= max_pipeline_depth_ ||
+      !client.stream_wrappers_.back()->encode_complete_ ||
+      client.stream_wrappers_.front()->saw_close_header_ || client.codec_client_->remoteClosed()) {
+    return false;
+  }
+
+  return client.remaining_requests_ == 0 ||
+         client.stream_wrappers_.size() < client.remaining_requests_;
+}
+
+ConnPoolImpl::ActiveClient* ConnPoolImpl::chooseClientToPipeline() {
+  // Pick the client with the fewest requests in flight, as a request waits for the responses to
+  // all the requests ahead of it.
+  ActiveClient* chosen = nullptr;
+  for (const ActiveClientPtr& client : busy_clients_) {
+    if (canPipeline(*client) &&
+        (!chosen || client->stream_wrappers_.size() < chosen->stream_wrappers_.size())) {
+      chosen = client.get();
+    }
+  }
+
+  return chosen;
 }
 
 void ConnPoolImpl::checkForDrained() {
@@ -91,6 +127,15 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     return nullptr;
   }
 
+  if (max_pipeline_depth_ > 1) {
+    ActiveClient* client = chooseClientToPipeline();
+    if (client) {
+      ENVOY_CONN_LOG(debug, "pipelining on existing connection", *client->codec_client_);
+      attachRequestToClient(*client, response_decoder, callbacks);
+      return nullptr;
+    }
+  }
+
   if (host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
     bool can_create_connection =
         host_->cluster().resourceManager(priority_).connections().canCreate();
@@ -122,8 +167,10 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
     ENVOY_CONN_LOG(debug, "client disconnected", *client.codec_client_);
     ActiveClientPtr removed;
     bool check_for_drained = true;
-    if (client.stream_wrapper_) {
-      if (!client.stream_wrapper_->decode_complete_) {
+    if (!client.stream_wrappers_.empty()) {
+      // The response to the oldest request may be complete, if the connection was closed as it
+      // completed, but not those of the requests after it.
+      if (!client.stream_wrappers_.back()->decode_complete_) {
         if (event == Network::ConnectionEvent::LocalClose) {
           host_->cluster().stats().upstream_cx_destroy_local_with_active_rq_.inc();
         }
@@ -133,8 +180,16 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
         host_->cluster().stats().upstream_cx_destroy_with_active_rq_.inc();
       }
 
-      // There is an active request attached to this client. The underlying codec client will
-      // already have "reset" the stream to fire the reset callback. All we do here is just
+      // Pipelined requests whose response had not begun were possibly never processed by the
+      // upstream. They are safe to retry, as only idempotent requests are pipelined.
+      for (const StreamWrapperPtr& stream_wrapper : client.stream_wrappers_) {
+        if (stream_wrapper->pipelined_ && !stream_wrapper->decode_started_) {
+          host_->cluster().stats().upstream_rq_pipeline_reset_.inc();
+        }
+      }
+
+      // There are active requests attached to this client. The underlying codec client will
+      // already have "reset" the streams to fire the reset callbacks. All we do here is just
       // destroy the client.
       removed = client.removeFromList(busy_clients_);
     } else if (!client.connect_timer_) {
@@ -206,16 +261,22 @@ void ConnPoolImpl::onPendingRequestCancel(PendingRequest& request) {
 
 void ConnPoolImpl::onResponseComplete(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "response complete", *client.codec_client_);
-  if (!client.stream_wrapper_->encode_complete_) {
+  StreamWrapper& stream_wrapper = *client.stream_wrappers_.front();
+  if (!stream_wrapper.encode_complete_) {
     ENVOY_CONN_LOG(debug, "response before request complete", *client.codec_client_);
     onDownstreamReset(client);
-  } else if (client.stream_wrapper_->saw_close_header_ || client.codec_client_->remoteClosed()) {
+  } else if (stream_wrapper.saw_close_header_ || client.codec_client_->remoteClosed()) {
     ENVOY_CONN_LOG(debug, "saw upstream connection: close", *client.codec_client_);
     onDownstreamReset(client);
   } else if (client.remaining_requests_ > 0 && --client.remaining_requests_ == 0) {
     ENVOY_CONN_LOG(debug, "maximum requests per connection", *client.codec_client_);
     host_->cluster().stats().upstream_cx_max_requests_.inc();
     onDownstreamReset(client);
+  } else if (client.stream_wrappers_.size() > 1) {
+    // The connection stays busy with the requests pipelined after this one, but it has room for
+    // another.
+    client.stream_wrappers_.pop_front();
+    scheduleOnUpstreamReady();
   } else {
     // Upstream connection might be closed right after response is complete. Setting delay=true
     // here to attach pending requests in next dispatcher loop to handle that case.
@@ -236,10 +297,20 @@ void ConnPoolImpl::onUpstreamReady() {
     pending_requests_.pop_back();
     client.moveBetweenLists(ready_clients_, busy_clients_);
   }
+
+  if (max_pipeline_depth_ > 1) {
+    ActiveClient* client;
+    while (!pending_requests_.empty() && (client = chooseClientToPipeline()) != nullptr) {
+      ENVOY_CONN_LOG(debug, "pipelining next request", *client->codec_client_);
+      attachRequestToClient(*client, pending_requests_.back()->decoder_,
+                            pending_requests_.back()->callbacks_);
+      pending_requests_.pop_back();
+    }
+  }
 }
 
 void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
-  client.stream_wrapper_.reset();
+  client.stream_wrappers_.clear();
   if (pending_requests_.empty() || delay) {
     // There is nothing to service or delayed processing is requested, so just move the connection
     // into the ready list.
@@ -254,21 +325,31 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
     pending_requests_.pop_back();
   }
 
-  if (delay && !pending_requests_.empty() && !upstream_ready_enabled_) {
-    upstream_ready_enabled_ = true;
-    upstream_ready_timer_->enableTimer(std::chrono::milliseconds(0));
+  if (delay) {
+    scheduleOnUpstreamReady();
   }
 
   checkForDrained();
 }
 
+void ConnPoolImpl::scheduleOnUpstreamReady() {
+  if (!pending_requests_.empty() && !upstream_ready_enabled_) {
+    upstream_ready_enabled_ = true;
+    upstream_ready_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
 ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, ActiveClient& parent)
     : StreamEncoderWrapper(parent.codec_client_->newStream(*this)),
-      StreamDecoderWrapper(response_decoder), parent_(parent) {
+      StreamDecoderWrapper(response_decoder), parent_(parent),
+      pipelined_(!parent.stream_wrappers_.empty()) {
 
   StreamEncoderWrapper::inner_.getStream().addCallbacks(*this);
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.inc();
   parent_.parent_.host_->stats().rq_active_.inc();
+  if (pipelined_) {
+    parent_.parent_.host_->cluster().stats().upstream_rq_pipelined_.inc();
+  }
 }
 
 ConnPoolImpl::StreamWrapper::~StreamWrapper() {
@@ -276,7 +357,13 @@ ConnPoolImpl::StreamWrapper::~StreamWrapper() {
   parent_.parent_.host_->stats().rq_active_.dec();
 }
 
-void ConnPoolImpl::StreamWrapper::onEncodeComplete() { encode_complete_ = true; }
+void ConnPoolImpl::StreamWrapper::onEncodeComplete() {
+  encode_complete_ = true;
+  if (parent_.parent_.max_pipeline_depth_ > 1) {
+    // The connection may now take a pending request.
+    parent_.parent_.scheduleOnUpstreamReady();
+  }
+}
 
 void ConnPoolImpl::StreamWrapper::decodeHeaders(HeaderMapPtr&& headers, bool end_stream) {
   if (headers->Connection() &&
@@ -285,6 +372,7 @@ void ConnPoolImpl::StreamWrapper::decodeHeaders(HeaderMapPtr&& headers, bool end
     saw_close_header_ = true;
     parent_.parent_.host_->cluster().stats().upstream_cx_close_notify_.inc();
   }
+  decode_started_ = true;
 
   StreamDecoderWrapper::decodeHeaders(std::move(headers), end_stream);
 }
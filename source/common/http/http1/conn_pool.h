@@ -22,7 +22,9 @@ namespace Http {
 namespace Http1 {
 
 /**
- * A connection pool implementation for HTTP/1.1 connections.
+ * A connection pool implementation for HTTP/1.1 connections. With a maximum pipeline depth above 1,
+ * requests are also sent on busy connections once every request on them has been fully sent, up to
+ * that many requests per connection. Only idempotent requests should be given to such a pool.
  * NOTE: The connection pool does NOT do DNS resolution. It assumes it is being given a numeric IP
  *       address. Higher layer code should handle resolving DNS on error and creating a new pool
  *       bound to a different IP address.
@@ -31,7 +33,8 @@ class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::
 public:
   ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
                Upstream::ResourcePriority priority,
-               const Network::ConnectionSocket::OptionsSharedPtr& options);
+               const Network::ConnectionSocket::OptionsSharedPtr& options,
+               uint32_t max_pipeline_depth);
 
   ~ConnPoolImpl();
 
@@ -65,8 +68,11 @@ protected:
     void onBelowWriteBufferLowWatermark() override {}
 
     ActiveClient& parent_;
+    // Whether the request was sent with other requests in flight on the connection.
+    const bool pipelined_;
     bool encode_complete_{};
     bool saw_close_header_{};
+    bool decode_started_{};
     bool decode_complete_{};
   };
 
@@ -90,7 +96,8 @@ protected:
     ConnPoolImpl& parent_;
     CodecClientPtr codec_client_;
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
-    StreamWrapperPtr stream_wrapper_;
+    // The requests in flight, oldest first. Responses complete in this order.
+    std::list<StreamWrapperPtr> stream_wrappers_;
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
@@ -116,6 +123,8 @@ protected:
   void attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                              ConnectionPool::Callbacks& callbacks);
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
+  bool canPipeline(const ActiveClient& client) const;
+  ActiveClient* chooseClientToPipeline();
   void checkForDrained();
   void createNewConnection();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
@@ -124,6 +133,7 @@ protected:
   void onResponseComplete(ActiveClient& client);
   void onUpstreamReady();
   void processIdleClient(ActiveClient& client, bool delay);
+  void scheduleOnUpstreamReady();
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
@@ -134,6 +144,7 @@ protected:
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
+  const uint32_t max_pipeline_depth_;
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
 };
@@ -145,8 +156,9 @@ class ConnPoolImplProd : public ConnPoolImpl {
 public:
   ConnPoolImplProd(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
                    Upstream::ResourcePriority priority,
-                   const Network::ConnectionSocket::OptionsSharedPtr& options)
-      : ConnPoolImpl(dispatcher, host, priority, options) {}
+                   const Network::ConnectionSocket::OptionsSharedPtr& options,
+                   uint32_t max_pipeline_depth)
+      : ConnPoolImpl(dispatcher, host, priority, options, max_pipeline_depth) {}
 
   // ConnPoolImpl
   CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) override;
@@ -0,0 +1,541 @@
+#include "common/http/http1/fast_request_parser_impl.h"
+
+#include <http_parser.h>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include <array>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+/**
+ * The bytes allowed in the tokens of the request line and header fields, in URLs and in header
+ * values.
+ */
+struct CharTables {
+  CharTables() {
+    for (uint32_t c = 0; c < 256; c++) {
+      token_[c] = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c != 0 && strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+      url_[c] = c > ' ' && c != 0x7f;
+      value_[c] = c == '\t' || (c >= ' ' && c != 0x7f);
+    }
+  }
+
+  std::array<bool, 256> token_;
+  std::array<bool, 256> url_;
+  std::array<bool, 256> value_;
+};
+
+const CharTables& charTables() {
+  static CharTables* tables = new CharTables();
+  return *tables;
+}
+
+// The complements of the tables above as byte ranges, in the format of _mm_cmpestri(), which
+// takes at most 8 ranges. '|' and '~' are in the last range of non token bytes, so the bytes found
+// by the ranges are checked against the tables.
+alignas(16) const char NON_TOKEN_RANGES[16] = {'\x00', ' ', '"', '"', '(', ')', ',', ',',
+                                               '/',    '/', ':', '@', '[', ']', '{', '\xff'};
+const int NON_TOKEN_RANGES_SIZE = 16;
+alignas(16) const char NON_URL_RANGES[16] = {'\x00', ' ', '\x7f', '\x7f'};
+const int NON_URL_RANGES_SIZE = 4;
+alignas(16) const char NON_VALUE_RANGES[16] = {'\x00', '\x08', '\x0a', '\x1f', '\x7f', '\x7f'};
+const int NON_VALUE_RANGES_SIZE = 6;
+
+/**
+ * @return const char* the first byte of [begin, end) which isn't in the table, or end.
+ */
+const char* findNotIn(const char* begin, const char* end, const std::array<bool, 256>& table,
+                      const char* ranges, int ranges_size) {
+#ifdef __SSE4_2__
+  const __m128i ranges16 = _mm_load_si128(reinterpret_cast<const __m128i*>(ranges));
+  while (end - begin >= 16) {
+    const __m128i data16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const int index = _mm_cmpestri(ranges16, ranges_size, data16, 16,
+                                   _SIDD_LEAST_SIGNIFICANT | _SIDD_CMP_RANGES | _SIDD_UBYTE_OPS);
+    if (index == 16) {
+      begin += 16;
+      continue;
+    }
+    begin += index;
+    if (!table[static_cast<uint8_t>(*begin)]) {
+      return begin;
+    }
+    ++begin;
+  }
+#else
+  UNREFERENCED_PARAMETER(ranges);
+  UNREFERENCED_PARAMETER(ranges_size);
+#endif
+  while (begin < end && table[static_cast<uint8_t>(*begin)]) {
+    ++begin;
+  }
+  return begin;
+}
+
+/**
+ * @return const char* the position past the LF of the first empty line in [begin, end), or nullptr
+ *         if there is none. begin must be at the start of a line, or after it.
+ */
+const char* findHeadEnd(const char* begin, const char* end) {
+  while (begin < end) {
+    const char* lf = static_cast<const char*>(memchr(begin, '\n', end - begin));
+    if (lf == nullptr) {
+      return nullptr;
+    }
+    begin = lf + 1;
+    if (begin < end && *begin == '\n') {
+      return begin + 1;
+    }
+    if (end - begin >= 2 && begin[0] == '\r' && begin[1] == '\n') {
+      return begin + 2;
+    }
+  }
+  return nullptr;
+}
+
+struct MethodName {
+  absl::string_view name_;
+  http_method method_;
+};
+
+#define METHOD_NAME(num, name, string) {#string, HTTP_##name},
+const MethodName METHOD_NAMES[] = {HTTP_METHOD_MAP(METHOD_NAME)};
+#undef METHOD_NAME
+
+bool findMethod(absl::string_view name, unsigned int& method) {
+  for (const MethodName& method_name : METHOD_NAMES) {
+    if (method_name.name_ == name) {
+      method = method_name.method_;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @param head supplies the start of an incomplete request head.
+ * @return bool whether the head may still start with a known method. Like http_parser, this
+ *         rejects a bad method as soon as its bytes are received, rather than once the head is.
+ */
+bool isMethodPrefix(absl::string_view head) {
+  const size_t method_end = head.find(' ');
+  if (method_end != absl::string_view::npos) {
+    unsigned int method;
+    return findMethod(head.substr(0, method_end), method);
+  }
+  for (const MethodName& method_name : METHOD_NAMES) {
+    if (absl::StartsWith(method_name.name_, head)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int hexDigit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+} // namespace
+
+size_t FastRequestParserImpl::execute(const char* data, size_t length) {
+  if (status_ != ParserStatus::Ok) {
+    return 0;
+  }
+
+  const char* position = data;
+  const char* end = data + length;
+  while (status_ == ParserStatus::Ok) {
+    if (state_ == State::MessageComplete) {
+      completeMessage();
+      continue;
+    }
+    if (position == end) {
+      break;
+    }
+
+    switch (state_) {
+    case State::Head:
+      position = consumeHead(position, end);
+      break;
+    case State::Body:
+    case State::ChunkData:
+      position = consumeBody(position, end);
+      break;
+    case State::ChunkSize:
+      position = consumeChunkSize(position, end);
+      break;
+    case State::ChunkExtension:
+      position = consumeChunkExtension(position, end);
+      break;
+    case State::ChunkDataEnd:
+    case State::ChunkDataEndLf:
+      position = consumeChunkDataEnd(position);
+      break;
+    case State::Trailers:
+      position = consumeTrailers(position, end);
+      break;
+    case State::MessageComplete:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+  }
+
+  // The connection may only end in between requests.
+  if (length == 0 && status_ == ParserStatus::Ok && (message_begun_ || state_ != State::Head)) {
+    setError("HPE_INVALID_EOF_STATE");
+  }
+
+  return position - data;
+}
+
+void FastRequestParserImpl::pause(bool paused) {
+  if (status_ != ParserStatus::Error) {
+    status_ = paused ? ParserStatus::Paused : ParserStatus::Ok;
+  }
+}
+
+const char* FastRequestParserImpl::consumeHead(const char* data, const char* end) {
+  if (!message_begun_) {
+    // Like http_parser, tolerate empty lines in between requests.
+    while (data < end && (*data == '\r' || *data == '\n')) {
+      ++data;
+    }
+    if (data == end) {
+      return data;
+    }
+    // Like http_parser, a message only begins with a byte which may start a method.
+    if (!isMethodPrefix(absl::string_view(data, 1))) {
+      setError("HPE_INVALID_METHOD");
+      return data;
+    }
+    beginMessage();
+  }
+
+  if (head_buffer_.empty()) {
+    const char* head_end = findHeadEnd(data, end);
+    if (head_end == nullptr) {
+      if (static_cast<uint64_t>(end - data) > MAX_HEAD_SIZE) {
+        setError("HPE_HEADER_OVERFLOW");
+      } else if (!isMethodPrefix(absl::string_view(data, end - data))) {
+        setError("HPE_INVALID_METHOD");
+      } else {
+        head_buffer_.assign(data, end - data);
+      }
+      return end;
+    }
+    if (static_cast<uint64_t>(head_end - data) > MAX_HEAD_SIZE) {
+      setError("HPE_HEADER_OVERFLOW");
+    } else {
+      parseHead(data, head_end);
+    }
+    return head_end;
+  }
+
+  // The empty line may start in the bytes which were already buffered, with its LF or CRLF split.
+  const size_t buffered_size = head_buffer_.size();
+  head_buffer_.append(data, end - data);
+  const char* buffer_begin = head_buffer_.data();
+  const char* head_end = findHeadEnd(buffer_begin + (buffered_size >= 2 ? buffered_size - 2 : 0),
+                                     buffer_begin + head_buffer_.size());
+  if (head_end == nullptr) {
+    if (head_buffer_.size() > MAX_HEAD_SIZE) {
+      setError("HPE_HEADER_OVERFLOW");
+    } else if (!isMethodPrefix(head_buffer_)) {
+      setError("HPE_INVALID_METHOD");
+    }
+    return end;
+  }
+
+  const size_t head_size = head_end - buffer_begin;
+  if (head_size > MAX_HEAD_SIZE) {
+    setError("HPE_HEADER_OVERFLOW");
+  } else {
+    parseHead(buffer_begin, head_end);
+  }
+  head_buffer_.clear();
+  return data + (head_size - buffered_size);
+}
+
+const char* FastRequestParserImpl::parseRequestLine(const char* begin, const char* end) {
+  const char* line_end = static_cast<const char*>(memchr(begin, '\n', end - begin));
+  ASSERT(line_end != nullptr);
+
+  const CharTables& tables = charTables();
+  const char* method_end =
+      findNotIn(begin, line_end, tables.token_, NON_TOKEN_RANGES, NON_TOKEN_RANGES_SIZE);
+  if (*method_end != ' ' ||
+      !findMethod(absl::string_view(begin, method_end - begin), method_)) {
+    setError("HPE_INVALID_METHOD");
+    return nullptr;
+  }
+
+  const char* url = method_end + 1;
+  const char* url_end = findNotIn(url, line_end, tables.url_, NON_URL_RANGES, NON_URL_RANGES_SIZE);
+  if (url_end == url || *url_end != ' ') {
+    setError("HPE_INVALID_URL");
+    return nullptr;
+  }
+  callbacks_.onUrl(url, url_end - url);
+
+  const char* version = url_end + 1;
+  const char* version_end = line_end[-1] == '\r' ? line_end - 1 : line_end;
+  if (version_end - version != 8 || memcmp(version, "HTTP/", 5) != 0 || version[5] < '0' ||
+      version[5] > '9' || version[6] != '.' || version[7] < '0' || version[7] > '9') {
+    setError("HPE_INVALID_VERSION");
+    return nullptr;
+  }
+  http_major_ = version[5] - '0';
+  http_minor_ = version[7] - '0';
+
+  return line_end + 1;
+}
+
+void FastRequestParserImpl::parseHead(const char* begin, const char* end) {
+  const char* line = parseRequestLine(begin, end);
+  if (line == nullptr) {
+    return;
+  }
+
+  // The head ends with an empty line, which bounds the scans below. The bytes past a CR are only
+  // read when it isn't the last byte.
+  const CharTables& tables = charTables();
+  while (*line != '\n' && !(line[0] == '\r' && line[1] == '\n')) {
+    const char* key = line;
+    const char* key_end =
+        findNotIn(key, end, tables.token_, NON_TOKEN_RANGES, NON_TOKEN_RANGES_SIZE);
+    if (key_end == key || *key_end != ':') {
+      // This also rejects values folded over several lines.
+      setError("HPE_INVALID_HEADER_TOKEN");
+      return;
+    }
+
+    const char* value = key_end + 1;
+    while (*value == ' ' || *value == '\t') {
+      ++value;
+    }
+    const char* value_end =
+        findNotIn(value, end, tables.value_, NON_VALUE_RANGES, NON_VALUE_RANGES_SIZE);
+    if (value_end[0] == '\r' && value_end[1] == '\n') {
+      line = value_end + 2;
+    } else if (value_end[0] == '\n') {
+      line = value_end + 1;
+    } else {
+      setError("HPE_INVALID_HEADER_TOKEN");
+      return;
+    }
+    while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t')) {
+      --value_end;
+    }
+
+    if (!onSpecialHeader(key, key_end - key, value, value_end - value)) {
+      return;
+    }
+    callbacks_.onHeader(key, key_end - key, value, value_end - value);
+  }
+
+  if (chunked_ && content_length_ != ULLONG_MAX) {
+    setError("HPE_UNEXPECTED_CONTENT_LENGTH");
+    return;
+  }
+
+  const int rc = callbacks_.onHeadersComplete();
+  if (rc != 0 || method_ == HTTP_CONNECT) {
+    // Like http_parser, CONNECT requests don't have a body.
+    state_ = State::MessageComplete;
+  } else if (chunked_) {
+    state_ = State::ChunkSize;
+    remaining_ = 0;
+    chunk_size_has_digits_ = false;
+  } else if (content_length_ != ULLONG_MAX && content_length_ > 0) {
+    state_ = State::Body;
+    remaining_ = content_length_;
+  } else {
+    state_ = State::MessageComplete;
+  }
+}
+
+bool FastRequestParserImpl::onSpecialHeader(const char* key, size_t key_length, const char* value,
+                                            size_t value_length) {
+  const absl::string_view key_view(key, key_length);
+  const absl::string_view value_view(value, value_length);
+  if (absl::EqualsIgnoreCase(key_view, "content-length")) {
+    if (content_length_ != ULLONG_MAX) {
+      setError("HPE_UNEXPECTED_CONTENT_LENGTH");
+      return false;
+    }
+    if (value_view.empty()) {
+      setError("HPE_INVALID_CONTENT_LENGTH");
+      return false;
+    }
+    uint64_t content_length = 0;
+    for (const char c : value_view) {
+      if (c < '0' || c > '9' || content_length > (ULLONG_MAX - 1 - (c - '0')) / 10) {
+        setError("HPE_INVALID_CONTENT_LENGTH");
+        return false;
+      }
+      content_length = content_length * 10 + (c - '0');
+    }
+    content_length_ = content_length;
+  } else if (absl::EqualsIgnoreCase(key_view, "transfer-encoding")) {
+    // Chunked must be the last coding. The others are applied by upper layers, so a request whose
+    // body isn't chunked has no way to tell its length.
+    const size_t chunked_size = sizeof("chunked") - 1;
+    if (!absl::EndsWithIgnoreCase(value_view, "chunked") ||
+        (value_view.size() > chunked_size &&
+         value_view[value_view.size() - chunked_size - 1] != ',' &&
+         value_view[value_view.size() - chunked_size - 1] != ' ')) {
+      setError("HPE_INVALID_TRANSFER_ENCODING");
+      return false;
+    }
+    chunked_ = true;
+  }
+  return true;
+}
+
+const char* FastRequestParserImpl::consumeBody(const char* data, const char* end) {
+  const uint64_t length = std::min<uint64_t>(remaining_, end - data);
+  remaining_ -= length;
+  if (remaining_ == 0) {
+    state_ = state_ == State::Body ? State::MessageComplete : State::ChunkDataEnd;
+  }
+  callbacks_.onBody(data, length);
+  return data + length;
+}
+
+const char* FastRequestParserImpl::consumeChunkSize(const char* data, const char* end) {
+  for (; data < end; ++data) {
+    const int digit = hexDigit(*data);
+    if (digit < 0) {
+      break;
+    }
+    if (remaining_ > (ULLONG_MAX >> 4)) {
+      setError("HPE_INVALID_CHUNK_SIZE");
+      return data;
+    }
+    remaining_ = (remaining_ << 4) | digit;
+    chunk_size_has_digits_ = true;
+  }
+  if (data == end) {
+    return data;
+  }
+
+  // The size may be followed by whitespace and extensions, which are skipped up to the LF.
+  if (!chunk_size_has_digits_ || (*data != ';' && *data != ' ' && *data != '\t' &&
+                                  *data != '\r' && *data != '\n')) {
+    setError("HPE_INVALID_CHUNK_SIZE");
+    return data;
+  }
+  state_ = State::ChunkExtension;
+  skipped_size_ = 0;
+  return data;
+}
+
+const char* FastRequestParserImpl::consumeChunkExtension(const char* data, const char* end) {
+  const char* lf = static_cast<const char*>(memchr(data, '\n', end - data));
+  skipped_size_ += (lf != nullptr ? lf : end) - data;
+  if (skipped_size_ > MAX_HEAD_SIZE) {
+    setError("HPE_HEADER_OVERFLOW");
+    return end;
+  }
+  if (lf == nullptr) {
+    return end;
+  }
+
+  if (remaining_ > 0) {
+    state_ = State::ChunkData;
+  } else {
+    state_ = State::Trailers;
+    skipped_size_ = 0;
+    trailer_line_empty_ = true;
+  }
+  return lf + 1;
+}
+
+const char* FastRequestParserImpl::consumeChunkDataEnd(const char* data) {
+  if (*data == '\r' && state_ == State::ChunkDataEnd) {
+    state_ = State::ChunkDataEndLf;
+    return data + 1;
+  }
+  if (*data != '\n') {
+    setError("HPE_STRICT");
+    return data;
+  }
+  state_ = State::ChunkSize;
+  remaining_ = 0;
+  chunk_size_has_digits_ = false;
+  return data + 1;
+}
+
+const char* FastRequestParserImpl::consumeTrailers(const char* data, const char* end) {
+  // Trailers aren't reported, only skipped up to the empty line which ends them.
+  while (data < end) {
+    const char* lf = static_cast<const char*>(memchr(data, '\n', end - data));
+    const char* line_end = lf != nullptr ? lf : end;
+    for (const char* c = data; c < line_end && trailer_line_empty_; ++c) {
+      trailer_line_empty_ = *c == '\r';
+    }
+    skipped_size_ += line_end - data;
+    if (skipped_size_ > MAX_HEAD_SIZE) {
+      setError("HPE_HEADER_OVERFLOW");
+      return end;
+    }
+    if (lf == nullptr) {
+      return end;
+    }
+    if (trailer_line_empty_) {
+      state_ = State::MessageComplete;
+      return lf + 1;
+    }
+    trailer_line_empty_ = true;
+    data = lf + 1;
+  }
+  return data;
+}
+
+void FastRequestParserImpl::beginMessage() {
+  message_begun_ = true;
+  http_major_ = 0;
+  http_minor_ = 0;
+  method_ = 0;
+  chunked_ = false;
+  content_length_ = ULLONG_MAX;
+  callbacks_.onMessageBegin();
+}
+
+void FastRequestParserImpl::completeMessage() {
+  state_ = State::Head;
+  message_begun_ = false;
+  callbacks_.onMessageComplete();
+}
+
+void FastRequestParserImpl::setError(const char* name) {
+  status_ = ParserStatus::Error;
+  error_name_ = name;
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
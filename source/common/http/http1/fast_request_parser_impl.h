@@ -0,0 +1,107 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <string>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Request parser in the style of picohttpparser. Rather than stepping a state machine over every
+ * byte, the request head is parsed in one go once its empty line is found, scanning for the
+ * delimiters of each line 16 bytes at a time with SSE 4.2 when the build targets it. Headers are
+ * reported whole through ParserCallbacks::onHeader(), straight from the received bytes, which are
+ * only copied when the head spans several calls to execute(). Bodies are parsed incrementally.
+ *
+ * Errors are named after their http_parser equivalents. Unlike http_parser, header values folded
+ * over several lines and transfer-encodings other than chunked are rejected.
+ */
+class FastRequestParserImpl : public Parser {
+public:
+  FastRequestParserImpl(ParserCallbacks& callbacks) : callbacks_(callbacks) {}
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause(bool paused) override;
+  ParserStatus status() const override { return status_; }
+  const char* errorName() const override { return error_name_; }
+  uint16_t httpMajor() const override { return http_major_; }
+  uint16_t httpMinor() const override { return http_minor_; }
+  unsigned int method() const override { return method_; }
+  uint16_t statusCode() const override { return 0; }
+  bool isChunked() const override { return chunked_; }
+  uint64_t contentLength() const override { return content_length_; }
+
+  // The maximum size of a request head, or of the trailers of a chunked body. This is the same as
+  // http_parser's default HTTP_MAX_HEADER_SIZE.
+  static const uint64_t MAX_HEAD_SIZE = 80 * 1024;
+
+private:
+  enum class State {
+    Head,
+    Body,
+    ChunkSize,
+    ChunkExtension,
+    ChunkData,
+    ChunkDataEnd,
+    ChunkDataEndLf,
+    Trailers,
+    MessageComplete
+  };
+
+  /**
+   * Consume the bytes of the request head, which is parsed and reported once complete.
+   * @return const char* the position past the consumed bytes.
+   */
+  const char* consumeHead(const char* data, const char* end);
+
+  /**
+   * Parse a complete request head and report it.
+   * @param begin supplies the start of the request line.
+   * @param end supplies the position past the LF of the empty line ending the head.
+   */
+  void parseHead(const char* begin, const char* end);
+  const char* parseRequestLine(const char* begin, const char* end);
+  bool onSpecialHeader(const char* key, size_t key_length, const char* value,
+                       size_t value_length);
+
+  const char* consumeBody(const char* data, const char* end);
+  const char* consumeChunkSize(const char* data, const char* end);
+  const char* consumeChunkExtension(const char* data, const char* end);
+  const char* consumeChunkDataEnd(const char* data);
+  const char* consumeTrailers(const char* data, const char* end);
+
+  void beginMessage();
+  void completeMessage();
+  void setError(const char* name);
+
+  ParserCallbacks& callbacks_;
+  State state_{State::Head};
+  ParserStatus status_{ParserStatus::Ok};
+  const char* error_name_{"HPE_OK"};
+  // The start of a head which spans several calls to execute().
+  std::string head_buffer_;
+  bool message_begun_{};
+
+  uint16_t http_major_{};
+  uint16_t http_minor_{};
+  unsigned int method_{};
+  bool chunked_{};
+  uint64_t content_length_{ULLONG_MAX};
+
+  // The bytes left in the body or the current chunk.
+  uint64_t remaining_{};
+  bool chunk_size_has_digits_{};
+  // The bytes skipped in the extensions of a chunk or in the trailers, which are bounded by
+  // MAX_HEAD_SIZE.
+  uint64_t skipped_size_{};
+  bool trailer_line_empty_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#include "common/http/http1/http_parser_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+http_parser_settings HttpParserImpl::settings_{
+    [](http_parser* parser) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onMessageBegin();
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onUrl(at, length);
+      return 0;
+    },
+    nullptr, // on_status
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onHeaderField(at, length);
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onHeaderValue(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int {
+      return static_cast<ParserCallbacks*>(parser->data)->onHeadersComplete();
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onBody(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int {
+      static_cast<ParserCallbacks*>(parser->data)->onMessageComplete();
+      return 0;
+    },
+    nullptr, // on_chunk_header
+    nullptr  // on_chunk_complete
+};
+
+HttpParserImpl::HttpParserImpl(http_parser_type type, ParserCallbacks& callbacks) {
+  http_parser_init(&parser_, type);
+  parser_.data = &callbacks;
+}
+
+size_t HttpParserImpl::execute(const char* data, size_t length) {
+  return http_parser_execute(&parser_, &settings_, data, length);
+}
+
+void HttpParserImpl::pause(bool paused) { http_parser_pause(&parser_, paused ? 1 : 0); }
+
+ParserStatus HttpParserImpl::status() const {
+  switch (HTTP_PARSER_ERRNO(&parser_)) {
+  case HPE_OK:
+    return ParserStatus::Ok;
+  case HPE_PAUSED:
+    return ParserStatus::Paused;
+  default:
+    return ParserStatus::Error;
+  }
+}
+
+const char* HttpParserImpl::errorName() const {
+  return http_errno_name(HTTP_PARSER_ERRNO(&parser_));
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser backed by http_parser, for requests and responses. Headers are reported piecewise.
+ */
+class HttpParserImpl : public Parser {
+public:
+  HttpParserImpl(http_parser_type type, ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause(bool paused) override;
+  ParserStatus status() const override;
+  const char* errorName() const override;
+  uint16_t httpMajor() const override { return parser_.http_major; }
+  uint16_t httpMinor() const override { return parser_.http_minor; }
+  unsigned int method() const override { return parser_.method; }
+  uint16_t statusCode() const override { return parser_.status_code; }
+  bool isChunked() const override { return parser_.flags & F_CHUNKED; }
+  uint64_t contentLength() const override { return parser_.content_length; }
+
+private:
+  static http_parser_settings settings_;
+
+  http_parser parser_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
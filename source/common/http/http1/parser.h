@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Callbacks invoked by a Parser as it consumes a message. A parser either reports the headers
+ * piecewise through onHeaderField()/onHeaderValue(), which may be called several times for the
+ * same field or value as its bytes arrive, or whole through onHeader().
+ */
+class ParserCallbacks {
+public:
+  virtual ~ParserCallbacks() {}
+
+  /**
+   * Called when a message is beginning.
+   */
+  virtual void onMessageBegin() PURE;
+
+  /**
+   * Called when URL data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onUrl(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header field data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderField(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header value data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderValue(const char* data, size_t length) PURE;
+
+  /**
+   * Called when a complete header is received.
+   * @param key supplies the start address of the field.
+   * @param key_length supplies the length of the field.
+   * @param value supplies the start address of the value, trimmed of whitespace.
+   * @param value_length supplies the length of the value.
+   */
+  virtual void onHeader(const char* key, size_t key_length, const char* value,
+                        size_t value_length) PURE;
+
+  /**
+   * Called when headers are complete.
+   * @return 0 if no error, 1 if there should be no body, 2 if there should be no body nor further
+   *         data on the connection.
+   */
+  virtual int onHeadersComplete() PURE;
+
+  /**
+   * Called when body data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onBody(const char* data, size_t length) PURE;
+
+  /**
+   * Called when the message is complete.
+   */
+  virtual void onMessageComplete() PURE;
+};
+
+enum class ParserStatus { Ok, Paused, Error };
+
+/**
+ * An HTTP/1 message parser, which drives ParserCallbacks as it consumes the bytes of a connection.
+ */
+class Parser {
+public:
+  virtual ~Parser() {}
+
+  /**
+   * Parse a span of the connection's bytes. Parsing stops early if the parser is paused from a
+   * callback or on error. Nothing is consumed while the parser is paused or in error.
+   * @param data supplies the start address, which may be nullptr if length is 0.
+   * @param length supplies the length, 0 to signal the end of the connection.
+   * @return size_t the number of bytes consumed.
+   */
+  virtual size_t execute(const char* data, size_t length) PURE;
+
+  /**
+   * Pause or resume the parser. This has no effect on a parser in error.
+   * @param paused supplies whether the parser is paused.
+   */
+  virtual void pause(bool paused) PURE;
+
+  /**
+   * @return ParserStatus the status of the parser.
+   */
+  virtual ParserStatus status() const PURE;
+
+  /**
+   * @return const char* the name of the error, if status() is ParserStatus::Error.
+   */
+  virtual const char* errorName() const PURE;
+
+  /**
+   * The accessors below describe the message whose headers were last parsed.
+   * @return uint16_t the HTTP major version.
+   */
+  virtual uint16_t httpMajor() const PURE;
+
+  /**
+   * @return uint16_t the HTTP minor version.
+   */
+  virtual uint16_t httpMinor() const PURE;
+
+  /**
+   * @return unsigned int the http_method of a request.
+   */
+  virtual unsigned int method() const PURE;
+
+  /**
+   * @return uint16_t the status code of a response.
+   */
+  virtual uint16_t statusCode() const PURE;
+
+  /**
+   * @return bool whether the body uses chunked transfer-encoding.
+   */
+  virtual bool isChunked() const PURE;
+
+  /**
+   * @return uint64_t the content length, or ULLONG_MAX if there is none.
+   */
+  virtual uint64_t contentLength() const PURE;
+};
+
+typedef std::unique_ptr<Parser> ParserPtr;
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -218,9 +218,10 @@ int ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t
   // https://nghttp2.org/documentation/types.html#c.nghttp2_send_data_callback
   static const uint64_t FRAME_HEADER_SIZE = 9;
 
-  Buffer::OwnedImpl output(framehd, FRAME_HEADER_SIZE);
-  output.move(pending_send_data_, length);
-  parent_.connection_.write(output, false);
+  // Only the frame header is copied. The payload slices move from the stream's pending data, and
+  // on into the connection's write buffer once all pending frames are serialized.
+  parent_.pending_output_.add(framehd, FRAME_HEADER_SIZE);
+  parent_.pending_output_.move(pending_send_data_, length);
   return 0;
 }
 
@@ -501,8 +502,7 @@ int ConnectionImpl::onInvalidFrame(int32_t stream_id, int error_code) {
 
 ssize_t ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   ENVOY_CONN_LOG(trace, "send data: bytes={}", connection_, length);
-  Buffer::OwnedImpl buffer(data, length);
-  connection_.write(buffer, false);
+  pending_output_.add(data, length);
   return length;
 }
 
@@ -570,7 +570,13 @@ void ConnectionImpl::sendPendingFrames() {
     return;
   }
 
+  // Each frame is appended to pending_output_ as it is serialized, so that the connection's write
+  // filters and watermarks are run once for all of them, and its write buffer is not fragmented by
+  // frame headers moved in one by one.
   int rc = nghttp2_session_send(session_);
+  if (pending_output_.length() > 0) {
+    connection_.write(pending_output_, false);
+  }
   if (rc != 0) {
     ASSERT(rc == NGHTTP2_ERR_CALLBACK_FAILURE);
     throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
@@ -758,7 +764,9 @@ ConnectionImpl::ClientHttp2Options::ClientHttp2Options(const Http2Settings& http
   // Temporarily disable initial max streams limit/protection, since we might want to create
   // more than 100 streams before receiving the HTTP/2 SETTINGS frame from the server.
   //
-  // TODO(PiotrSikora): remove this once multiple upstream connections or queuing are implemented.
+  // The connection pool spreads streams over multiple upstream connections, but it picks one before
+  // the server's SETTINGS frame has been received on it, so this is still needed.
+  // TODO(PiotrSikora): remove this once the pool queues streams until a connection's SETTINGS.
   nghttp2_option_set_peer_max_concurrent_streams(options_,
                                                  Http2Settings::DEFAULT_MAX_CONCURRENT_STREAMS);
 }
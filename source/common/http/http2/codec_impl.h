@@ -281,6 +281,9 @@ protected:
   CodecStats stats_;
   Network::Connection& connection_;
   uint32_t per_stream_buffer_limit_;
+  // The frames serialized by nghttp2_session_send(), which sendPendingFrames() writes to the
+  // connection in one go.
+  Buffer::OwnedImpl pending_output_;
 
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
@@ -308,6 +311,9 @@ public:
 
   // Http::ClientConnection
   Http::StreamEncoder& newStream(StreamDecoder& response_decoder) override;
+  uint32_t remoteMaxConcurrentStreams() override {
+    return nghttp2_session_get_remote_settings(session_, NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
+  }
 
 private:
   // ConnectionImpl
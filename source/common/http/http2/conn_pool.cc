@@ -1,5 +1,6 @@
 #include "common/http/http2/conn_pool.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "envoy/event/dispatcher.h"
@@ -20,12 +21,12 @@ ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSha
     : dispatcher_(dispatcher), host_(host), priority_(priority), socket_options_(options) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  while (!active_clients_.empty()) {
+    active_clients_.front()->client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  while (!draining_clients_.empty()) {
+    draining_clients_.front()->client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -33,8 +34,8 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::ConnPoolImpl::drainConnections() {
-  if (primary_client_ != nullptr) {
-    movePrimaryClientToDraining();
+  while (!active_clients_.empty()) {
+    moveClientToDraining(*active_clients_.front());
   }
 }
 
@@ -48,22 +49,19 @@ void ConnPoolImpl::checkForDrained() {
     return;
   }
 
-  bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
-    } else {
-      drained = false;
+  // Closing a client removes it from the list, so advance past it first.
+  for (auto it = active_clients_.begin(); it != active_clients_.end();) {
+    ActiveClient& client = **it++;
+    if (client.client_->numActiveRequests() == 0) {
+      client.client_->close();
     }
   }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    drained = false;
-  }
-
-  if (drained) {
+  ASSERT(std::all_of(draining_clients_.begin(), draining_clients_.end(),
+                     [](const ActiveClientPtr& client) -> bool {
+                       return client->client_->numActiveRequests() > 0;
+                     }));
+  if (active_clients_.empty() && draining_clients_.empty()) {
     ENVOY_LOG(debug, "invoking drained callbacks");
     for (const DrainedCb& cb : drained_callbacks_) {
       cb();
@@ -81,12 +79,12 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     max_streams = maxTotalStreams();
   }
 
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
-  }
-
-  if (!primary_client_) {
-    primary_client_.reset(new ActiveClient(*this));
+  // Closing a client removes it from the list, so advance past it first.
+  for (auto it = active_clients_.begin(); it != active_clients_.end();) {
+    ActiveClient& client = **it++;
+    if (client.total_streams_ >= max_streams) {
+      moveClientToDraining(client);
+    }
   }
 
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
@@ -94,20 +92,68 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ActiveClient& client = chooseClient();
+    ENVOY_CONN_LOG(debug, "creating stream", *client.client_);
+    client.total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    if (host_->cluster().http2Settings().max_connections_per_host_ > 1) {
+      host_->cluster().stats().upstream_rq_http2_connection_streams_.recordValue(
+          client.client_->numActiveRequests() + 1);
+    }
+    callbacks.onPoolReady(client.client_->newStream(response_decoder),
+                          client.real_host_description_);
   }
 
   return nullptr;
 }
 
+ConnPoolImpl::ActiveClient& ConnPoolImpl::chooseClient() {
+  ActiveClient* least_loaded = nullptr;
+  ActiveClient* least_loaded_available = nullptr;
+  for (const ActiveClientPtr& client : active_clients_) {
+    const uint64_t active_streams = client->client_->numActiveRequests();
+    if (least_loaded == nullptr || active_streams < least_loaded->client_->numActiveRequests()) {
+      least_loaded = client.get();
+    }
+    if (active_streams < client->client_->remoteMaxConcurrentStreams() &&
+        (least_loaded_available == nullptr ||
+         active_streams < least_loaded_available->client_->numActiveRequests())) {
+      least_loaded_available = client.get();
+    }
+  }
+
+  // Spread streams over as many connections as allowed: a connection is only shared while all of
+  // them are carrying streams. Only the connections opened beyond the first one are charged to the
+  // connections circuit breaker, so a pool with a single connection per host behaves as it always
+  // has and doesn't take from the budget of HTTP/1.1 pools of the same cluster.
+  if (active_clients_.size() < host_->cluster().http2Settings().max_connections_per_host_ &&
+      (least_loaded_available == nullptr ||
+       least_loaded_available->client_->numActiveRequests() > 0)) {
+    const bool extra_connection = !active_clients_.empty();
+    if (!extra_connection ||
+        host_->cluster().resourceManager(priority_).connections().canCreate()) {
+      ActiveClientPtr client(new ActiveClient(*this, extra_connection));
+      client->moveIntoListBack(std::move(client), active_clients_);
+      return *active_clients_.back();
+    }
+    host_->cluster().stats().upstream_cx_overflow_.inc();
+  }
+
+  if (least_loaded_available == nullptr) {
+    // Every connection is at the host's limit. The codec holds the new stream back until one of
+    // the streams ahead of it completes.
+    ENVOY_CONN_LOG(debug, "max concurrent streams reached", *least_loaded->client_);
+    host_->cluster().stats().upstream_rq_http2_stream_limited_.inc();
+    return *least_loaded;
+  }
+
+  return *least_loaded_available;
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -121,12 +167,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       }
     }
 
-    if (&client == primary_client_.get()) {
-      ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
-    } else {
+    if (client.draining_) {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+      dispatcher_.deferredDelete(client.removeFromList(draining_clients_));
+    } else {
+      ENVOY_CONN_LOG(debug, "destroying active client", *client.client_);
+      dispatcher_.deferredDelete(client.removeFromList(active_clients_));
     }
 
     if (client.connect_timer_) {
@@ -149,25 +195,16 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
-  }
-
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
-    // If we are making a new connection and the primary does not have any active requests just
-    // close it now.
-    primary_client_->client_->close();
+void ConnPoolImpl::moveClientToDraining(ActiveClient& client) {
+  ENVOY_CONN_LOG(debug, "moving to draining", *client.client_);
+  ASSERT(!client.draining_);
+  if (client.client_->numActiveRequests() == 0) {
+    // If the client does not have any active requests just close it now.
+    client.client_->close();
   } else {
-    draining_client_ = std::move(primary_client_);
+    client.draining_ = true;
+    client.moveBetweenLists(active_clients_, draining_clients_);
   }
-
-  ASSERT(!primary_client_);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -179,8 +216,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    moveClientToDraining(client);
   }
 }
 
@@ -190,7 +227,7 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (client.draining_ && client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
   }
@@ -215,9 +252,10 @@ void ConnPoolImpl::onStreamReset(ActiveClient& client, Http::StreamResetReason r
   }
 }
 
-ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
+ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent, bool charge_connection)
     : parent_(parent),
-      connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })) {
+      connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })),
+      charge_connection_(charge_connection) {
 
   parent_.conn_connect_ms_.reset(new Stats::Timespan(
       parent_.host_->cluster().stats().upstream_cx_connect_ms_, parent_.dispatcher_.timeSystem()));
@@ -237,6 +275,9 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
   parent_.host_->cluster().stats().upstream_cx_http2_total_.inc();
   conn_length_.reset(new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_length_ms_,
                                          parent_.dispatcher_.timeSystem()));
+  if (charge_connection_) {
+    parent_.host_->cluster().resourceManager(parent_.priority_).connections().inc();
+  }
 
   client_->setConnectionStats({parent_.host_->cluster().stats().upstream_cx_rx_bytes_total_,
                                parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
@@ -249,6 +290,9 @@ ConnPoolImpl::ActiveClient::~ActiveClient() {
   parent_.host_->stats().cx_active_.dec();
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
   conn_length_->complete();
+  if (charge_connection_) {
+    parent_.host_->cluster().resourceManager(parent_.priority_).connections().dec();
+  }
 }
 
 CodecClientPtr ProdConnPoolImpl::createCodecClient(Upstream::Host::CreateConnectionData& data) {
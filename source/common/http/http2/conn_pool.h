@@ -10,6 +10,7 @@
 #include "envoy/stats/timespan.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/linked_object.h"
 #include "common/http/codec_client.h"
 
 namespace Envoy {
@@ -18,8 +19,9 @@ namespace Http2 {
 
 /**
  * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
- * shifting to a new connection if we reach max streams on the primary. This is a base class
- * used for both the prod implementation as well as the testing one.
+ * spreading streams over up to max_connections_per_host connections, and shifting to a new
+ * connection if one reaches max streams. This is a base class used for both the prod
+ * implementation as well as the testing one.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
@@ -36,11 +38,12 @@ public:
                                          ConnectionPool::Callbacks& callbacks) override;
 
 protected:
-  struct ActiveClient : public Network::ConnectionCallbacks,
+  struct ActiveClient : LinkedObject<ActiveClient>,
+                        public Network::ConnectionCallbacks,
                         public CodecClientCallbacks,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
-    ActiveClient(ConnPoolImpl& parent);
+    ActiveClient(ConnPoolImpl& parent, bool charge_connection);
     ~ActiveClient();
 
     void onConnectTimeout() { parent_.onConnectTimeout(*this); }
@@ -68,14 +71,22 @@ protected:
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     bool closed_with_active_rq_{};
+    bool draining_{};
+    // Whether the connection holds a slot of the cluster's connections resource.
+    const bool charge_connection_;
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
 
   void checkForDrained();
+  /**
+   * Choose the connection to create a new stream on, opening one if needed.
+   * @return ActiveClient& the least loaded connection which the host allows another stream on.
+   */
+  ActiveClient& chooseClient();
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+  void moveClientToDraining(ActiveClient& client);
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
@@ -85,8 +96,8 @@ protected:
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  std::list<ActiveClientPtr> active_clients_;
+  std::list<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
@@ -221,6 +221,16 @@ bool Utility::isWebSocketUpgradeRequest(const HeaderMap& headers) {
                                           Http::Headers::get().UpgradeValues.WebSocket.c_str())));
 }
 
+bool Utility::isPipelinable(const HeaderMap& headers) {
+  const HeaderEntry* method = headers.Method();
+  const HeaderEntry* content_length = headers.ContentLength();
+  return method &&
+         (method->value() == Headers::get().MethodValues.Get.c_str() ||
+          method->value() == Headers::get().MethodValues.Head.c_str()) &&
+         !isUpgrade(headers) && !headers.TransferEncoding() &&
+         (!content_length || content_length->value() == "0");
+}
+
 Http2Settings
 Utility::parseHttp2Settings(const envoy::api::v2::core::Http2ProtocolOptions& config) {
   Http2Settings ret;
@@ -234,6 +244,8 @@ Utility::parseHttp2Settings(const envoy::api::v2::core::Http2ProtocolOptions& co
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, initial_connection_window_size,
                                       Http::Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE);
   ret.allow_connect_ = config.allow_connect();
+  ret.max_connections_per_host_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connections_per_host, 1);
   return ret;
 }
 
@@ -243,6 +255,7 @@ Utility::parseHttp1Settings(const envoy::api::v2::core::Http1ProtocolOptions& co
   ret.allow_absolute_url_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, allow_absolute_url, false);
   ret.accept_http_10_ = config.accept_http_10();
   ret.default_host_for_http_10_ = config.default_host_for_http_10();
+  ret.max_pipeline_depth_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pipeline_depth, 1);
   return ret;
 }
 
@@ -114,6 +114,13 @@ bool isH2UpgradeRequest(const HeaderMap& headers);
  */
 bool isWebSocketUpgradeRequest(const HeaderMap& headers);
 
+/**
+ * @return true if this is a GET or HEAD request which is not an Upgrade request and doesn't declare
+ *         a body. These requests are idempotent, so may be pipelined and retried if reset before
+ *         their response began.
+ */
+bool isPipelinable(const HeaderMap& headers);
+
 /**
  * @return Http2Settings An Http2Settings populated from the
  * envoy::api::v2::core::Http2ProtocolOptions config.
@@ -0,0 +1,49 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+void ExactConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(&lock_);
+  handlers_.push_back(&handler);
+}
+
+void ExactConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  absl::MutexLock lock(&lock_);
+  auto it = std::find(handlers_.begin(), handlers_.end(), &handler);
+  ASSERT(it != handlers_.end());
+  handlers_.erase(it);
+}
+
+bool ExactConnectionBalancerImpl::balanceSocket(BalancedConnectionHandler& current_handler,
+                                                ConnectionSocketPtr& socket) {
+  absl::MutexLock lock(&lock_);
+  // The current handler wins ties, which saves a post.
+  BalancedConnectionHandler* min_handler = &current_handler;
+  uint64_t min_connections = current_handler.numConnections();
+  for (BalancedConnectionHandler* handler : handlers_) {
+    const uint64_t connections = handler->numConnections();
+    if (connections < min_connections) {
+      min_handler = handler;
+      min_connections = connections;
+    }
+  }
+
+  if (min_handler == &current_handler) {
+    return false;
+  }
+
+  // The count is incremented under the lock, so that concurrent picks don't all choose the same
+  // handler before it gets the socket. The socket is posted under the lock too, as the handler's
+  // worker may otherwise unregister and destroy it meanwhile.
+  min_handler->incNumConnections();
+  min_handler->post(std::move(socket));
+  return true;
+}
+
+} // namespace Network
+} // namespace Envoy
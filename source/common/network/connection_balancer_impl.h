@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "envoy/network/connection_balancer.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Balancer which keeps every socket on the handler which accepted it, leaving the balancing to the
+ * kernel.
+ */
+class NopConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler&) override {}
+  void unregisterHandler(BalancedConnectionHandler&) override {}
+  bool balanceSocket(BalancedConnectionHandler&, ConnectionSocketPtr&) override { return false; }
+};
+
+/**
+ * Balancer which hands every socket to the handler with the fewest connections, so that long lived
+ * connections end up evenly spread across workers, whichever workers accept them. Picks take a lock
+ * and scan all the handlers, and sockets handed to another handler pay for a cross thread post, so
+ * this is for listeners with few, long lived connections rather than many short ones.
+ */
+class ExactConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  bool balanceSocket(BalancedConnectionHandler& current_handler,
+                     ConnectionSocketPtr& socket) override;
+
+private:
+  absl::Mutex lock_;
+  std::vector<BalancedConnectionHandler*> handlers_ GUARDED_BY(lock_);
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -5,7 +5,6 @@
 #include <cstdint>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <vector>
 
@@ -20,6 +19,7 @@
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
 #include "common/common/logger.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -69,7 +69,7 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config)
     allow_origin_.push_back(origin);
   }
   for (const auto& regex : config.allow_origin_regex()) {
-    allow_origin_regex_.push_back(RegexUtil::parseRegex(regex));
+    allow_origin_regex_.push_back(Regex::Utility::parseRegex(regex));
   }
   allow_methods_ = config.allow_methods();
   allow_headers_ = config.allow_headers();
@@ -699,7 +699,7 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::route::Route& route,
                                          Server::Configuration::FactoryContext& factory_context)
     : RouteEntryImplBase(vhost, route, factory_context),
-      regex_(RegexUtil::parseRegex(route.match().regex().c_str())),
+      regex_(Regex::Utility::parseRegex(route.match().regex())),
       regex_str_(route.match().regex()) {}
 
 void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
@@ -708,7 +708,7 @@ void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
   // TODO(yuval-k): This ASSERT can happen if the path was changed by a filter without clearing the
   // route cache. We should consider if ASSERT-ing is the desired behavior in this case.
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str())));
   std::string matched_path(path.c_str(), query_string_start);
 
   finalizePathHeader(headers, matched_path, insert_envoy_original_path);
@@ -719,7 +719,7 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
   if (RouteEntryImplBase::matchRoute(headers, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str()))) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -730,8 +730,8 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
                                  const ConfigImpl& global_route_config,
                                  Server::Configuration::FactoryContext& factory_context,
                                  bool validate_clusters)
-    : name_(virtual_host.name()), rate_limit_policy_(virtual_host.rate_limits()),
-      global_route_config_(global_route_config),
+    : name_(virtual_host.name()), case_insensitive_path_trie_(true),
+      rate_limit_policy_(virtual_host.rate_limits()), global_route_config_(global_route_config),
       request_headers_parser_(HeaderParser::configure(virtual_host.request_headers_to_add(),
                                                       virtual_host.request_headers_to_remove())),
       response_headers_parser_(HeaderParser::configure(virtual_host.response_headers_to_add(),
@@ -778,6 +778,27 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
     }
   }
 
+  if (routes_.size() >= MIN_ROUTES_FOR_TRIE) {
+    for (int i = 0; i < virtual_host.routes_size(); i++) {
+      addToTrie(virtual_host.routes(i).match(), i);
+    }
+
+    if (!regex_routes_.empty()) {
+      std::vector<std::string> patterns;
+      for (uint32_t index : regex_routes_) {
+        patterns.push_back(virtual_host.routes(index).match().regex());
+      }
+      regex_routes_program_ = Regex::LinearProgram::compile(patterns);
+      if (regex_routes_program_ == nullptr) {
+        // Some regex isn't supported by the linear engine, so all of them are tried in turn.
+        unindexed_routes_.insert(unindexed_routes_.end(), regex_routes_.begin(),
+                                 regex_routes_.end());
+        std::sort(unindexed_routes_.begin(), unindexed_routes_.end());
+        regex_routes_.clear();
+      }
+    }
+  }
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(VirtualClusterEntry(virtual_cluster));
   }
@@ -794,10 +815,39 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   }
 
   const std::string pattern = virtual_cluster.pattern();
-  pattern_ = RegexUtil::parseRegex(pattern);
+  pattern_ = Regex::Utility::parseRegex(pattern);
   name_ = virtual_cluster.name();
 }
 
+void VirtualHostImpl::addToTrie(const envoy::api::v2::route::RouteMatch& match, uint32_t index) {
+  const bool case_sensitive = PROTOBUF_GET_WRAPPED_OR_DEFAULT(match, case_sensitive, true);
+  // The route entries compare with strncmp(), which stops at a NUL in the matcher. Such matchers
+  // are left to the route entries rather than reproducing that in the tries.
+  const auto indexable = [](const std::string& matcher) {
+    return matcher.find('\0') == std::string::npos;
+  };
+
+  if (match.path_specifier_case() == envoy::api::v2::route::RouteMatch::kPrefix &&
+      indexable(match.prefix())) {
+    if (case_sensitive) {
+      path_trie_.addPrefix(match.prefix(), index);
+    } else {
+      case_insensitive_path_trie_.addPrefix(match.prefix(), index);
+    }
+  } else if (match.path_specifier_case() == envoy::api::v2::route::RouteMatch::kPath &&
+             indexable(match.path())) {
+    if (case_sensitive) {
+      path_trie_.addPath(match.path(), index);
+    } else {
+      case_insensitive_path_trie_.addPath(match.path(), index);
+    }
+  } else if (match.path_specifier_case() == envoy::api::v2::route::RouteMatch::kRegex) {
+    regex_routes_.push_back(index);
+  } else {
+    unindexed_routes_.push_back(index);
+  }
+}
+
 const Config& VirtualHostImpl::routeConfig() const { return global_route_config_; }
 
 const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::string& name) const {
@@ -807,21 +857,8 @@ const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::str
 const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
   // We do a longest wildcard suffix match against the host that's passed in.
   // (e.g. foo-bar.baz.com should match *-bar.baz.com before matching *.baz.com)
-  // This is done by scanning the length => wildcards map looking for every
-  // wildcard whose size is < length.
-  for (const auto& iter : wildcard_virtual_host_suffixes_) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
-    }
-    const auto& match = wildcard_map.find(host.substr(host.size() - wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
-    }
-  }
-  return nullptr;
+  const absl::optional<uint32_t> index = wildcard_virtual_host_suffixes_.findLongest(host);
+  return index ? wildcard_virtual_hosts_[index.value()].get() : nullptr;
 }
 
 RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_config,
@@ -839,7 +876,11 @@ RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_confi
         }
         default_virtual_host_ = virtual_host;
       } else if (domain.size() > 0 && '*' == domain[0]) {
-        wildcard_virtual_host_suffixes_[domain.size() - 1].emplace(domain.substr(1), virtual_host);
+        // The first virtual host with a given wildcard wins.
+        if (wildcard_virtual_host_suffixes_.add(absl::string_view(domain).substr(1),
+                                                wildcard_virtual_hosts_.size())) {
+          wildcard_virtual_hosts_.push_back(virtual_host);
+        }
       } else {
         if (virtual_hosts_.find(domain) != virtual_hosts_.end()) {
           throw EnvoyException(fmt::format(
@@ -862,9 +903,53 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+  if (routes_.size() < MIN_ROUTES_FOR_TRIE || headers.Path() == nullptr) {
+    // Check for a route that matches the request.
+    for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+      RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+      if (nullptr != route_entry) {
+        return route_entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // Only the routes whose path matches, along with the routes that can't be looked up by path, are
+  // tried, in the order they were configured in so that the first matching route still wins.
+  const Http::HeaderString& path_header = headers.Path()->value();
+  const absl::string_view path(path_header.c_str(), path_header.size());
+  const char* query_string_start = Http::Utility::findQueryStringStart(path_header);
+  const size_t path_length =
+      query_string_start != nullptr ? query_string_start - path_header.c_str() : path.size();
+
+  // The candidates are gathered in a buffer reused across the requests of the thread, so that
+  // routing doesn't allocate once it has grown to the largest number of candidates seen.
+  static thread_local std::vector<uint32_t> candidates;
+  candidates.clear();
+  path_trie_.find(path, path_length, candidates);
+  if (!case_insensitive_path_trie_.empty()) {
+    case_insensitive_path_trie_.find(path, path_length, candidates);
+  }
+  if (regex_routes_program_ != nullptr) {
+    const size_t first = candidates.size();
+    regex_routes_program_->match(path.substr(0, path_length), candidates);
+    for (size_t i = first; i < candidates.size(); i++) {
+      candidates[i] = regex_routes_[candidates[i]];
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  auto candidate = candidates.begin();
+  auto unindexed = unindexed_routes_.begin();
+  while (candidate != candidates.end() || unindexed != unindexed_routes_.end()) {
+    uint32_t index;
+    if (unindexed == unindexed_routes_.end() ||
+        (candidate != candidates.end() && *candidate < *unindexed)) {
+      index = *candidate++;
+    } else {
+      index = *unindexed++;
+    }
+    RouteConstSharedPtr route_entry = routes_[index]->matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -916,7 +1001,8 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
     bool method_matches =
         !entry.method_ || headers.Method()->value().c_str() == entry.method_.value();
 
-    if (method_matches && std::regex_match(headers.Path()->value().c_str(), entry.pattern_)) {
+    const Http::HeaderString& path = headers.Path()->value();
+    if (method_matches && entry.pattern_->match(absl::string_view(path.c_str(), path.size()))) {
       return &entry;
     }
   }
@@ -5,7 +5,6 @@
 #include <list>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -17,11 +16,14 @@
 #include "envoy/server/filter_config.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/linear_regex.h"
+#include "common/common/suffix_trie.h"
 #include "common/http/header_utility.h"
 #include "common/router/config_utility.h"
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/path_trie.h"
 #include "common/router/router_ratelimit.h"
 #include "common/tcp_proxy/tcp_proxy.h"
 
@@ -98,7 +100,9 @@ public:
 
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; }
+  const std::list<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  }
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -108,7 +112,7 @@ public:
 
 private:
   std::list<std::string> allow_origin_;
-  std::list<std::regex> allow_origin_regex_;
+  std::list<Regex::CompiledMatcherPtr> allow_origin_regex_;
   std::string allow_methods_;
   std::string allow_headers_;
   std::string expose_headers_;
@@ -150,7 +154,7 @@ private:
     // Router::VirtualCluster
     const std::string& name() const override { return name_; }
 
-    std::regex pattern_;
+    Regex::CompiledMatcherPtr pattern_;
     absl::optional<std::string> method_;
     std::string name_;
   };
@@ -165,8 +169,24 @@ private:
   static const CatchAllVirtualCluster VIRTUAL_CLUSTER_CATCH_ALL;
   static const std::shared_ptr<const SslRedirectRoute> SSL_REDIRECT_ROUTE;
 
+  // Below this number of routes, trying each of them is cheaper than looking them up in the tries.
+  static const size_t MIN_ROUTES_FOR_TRIE = 8;
+
+  void addToTrie(const envoy::api::v2::route::RouteMatch& match, uint32_t index);
+
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // The prefix and path routes, by the index of the route in routes_. Case insensitive routes are
+  // keyed on their lower cased path.
+  PathTrie path_trie_;
+  PathTrie case_insensitive_path_trie_;
+  // The regex routes, compiled into one program matching all of them in a single pass. Pattern i
+  // of the program is the route regex_routes_[i].
+  Regex::LinearProgramPtr regex_routes_program_;
+  std::vector<uint32_t> regex_routes_;
+  // The indices of the routes which are neither in a trie nor in regex_routes_program_, in
+  // ascending order. These are tried for every request.
+  std::vector<uint32_t> unindexed_routes_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
@@ -626,7 +646,7 @@ public:
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
 
 private:
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
   const std::string regex_str_;
 };
 
@@ -647,17 +667,11 @@ private:
   const VirtualHostImpl* findWildcardVirtualHost(const std::string& host) const;
 
   std::unordered_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<int64_t>>
-      wildcard_virtual_host_suffixes_;
+  // The suffixes of the wildcard domains, mapped to the index of their virtual host in
+  // wildcard_virtual_hosts_. The longest matching suffix is found in one pass over the host,
+  // whatever the number of wildcard domains.
+  SuffixTrie wildcard_virtual_host_suffixes_;
+  std::vector<VirtualHostSharedPtr> wildcard_virtual_hosts_;
   VirtualHostSharedPtr default_virtual_host_;
 };
 
@@ -0,0 +1,105 @@
+#include "common/router/path_trie.h"
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Router {
+
+struct PathTrie::Node {
+  // The part of the key between the parent and this node.
+  std::string label_;
+  std::vector<uint32_t> prefix_routes_;
+  std::vector<uint32_t> path_routes_;
+  // Sorted by the first character of their label, which is unique among siblings.
+  std::vector<NodePtr> children_;
+
+  std::vector<NodePtr>::const_iterator findChild(char c) const {
+    auto it = std::lower_bound(children_.begin(), children_.end(), c,
+                               [](const NodePtr& child, char c) { return child->label_[0] < c; });
+    return it != children_.end() && (*it)->label_[0] == c ? it : children_.end();
+  }
+};
+
+PathTrie::PathTrie(bool ignore_case) : ignore_case_(ignore_case), root_(new Node()) {}
+
+PathTrie::~PathTrie() {}
+
+void PathTrie::addPrefix(absl::string_view prefix, uint32_t index) {
+  if (ignore_case_) {
+    insert(absl::AsciiStrToLower(prefix)).prefix_routes_.push_back(index);
+  } else {
+    insert(prefix).prefix_routes_.push_back(index);
+  }
+  empty_ = false;
+}
+
+void PathTrie::addPath(absl::string_view path, uint32_t index) {
+  if (ignore_case_) {
+    insert(absl::AsciiStrToLower(path)).path_routes_.push_back(index);
+  } else {
+    insert(path).path_routes_.push_back(index);
+  }
+  empty_ = false;
+}
+
+PathTrie::Node& PathTrie::insert(absl::string_view key) {
+  Node* node = root_.get();
+  while (!key.empty()) {
+    auto it = std::lower_bound(node->children_.begin(), node->children_.end(), key[0],
+                               [](const NodePtr& child, char c) { return child->label_[0] < c; });
+    if (it == node->children_.end() || (*it)->label_[0] != key[0]) {
+      NodePtr child(new Node());
+      child->label_ = std::string(key);
+      return **node->children_.insert(it, std::move(child));
+    }
+
+    const std::string& label = (*it)->label_;
+    const size_t common = std::mismatch(label.begin(), label.end(), key.begin(), key.end()).first -
+                          label.begin();
+    if (common < label.size()) {
+      // The key diverges from the label, so the edge is split where they differ.
+      NodePtr split(new Node());
+      split->label_ = label.substr(0, common);
+      (*it)->label_.erase(0, common);
+      split->children_.push_back(std::move(*it));
+      *it = std::move(split);
+    }
+    node = it->get();
+    key.remove_prefix(common);
+  }
+  return *node;
+}
+
+void PathTrie::find(absl::string_view path, size_t path_length,
+                    std::vector<uint32_t>& indices) const {
+  const Node* node = root_.get();
+  size_t depth = 0;
+  while (true) {
+    indices.insert(indices.end(), node->prefix_routes_.begin(), node->prefix_routes_.end());
+    if (depth == path_length) {
+      indices.insert(indices.end(), node->path_routes_.begin(), node->path_routes_.end());
+    }
+    if (depth == path.size()) {
+      return;
+    }
+
+    // The labels of a case insensitive trie are lower cased, so the path is folded to match them.
+    auto it = node->findChild(ignore_case_ ? absl::ascii_tolower(path[depth]) : path[depth]);
+    if (it == node->children_.end()) {
+      return;
+    }
+    const std::string& label = (*it)->label_;
+    const absl::string_view segment = path.substr(depth, label.size());
+    if (ignore_case_ ? !absl::EqualsIgnoreCase(segment, label) : segment != label) {
+      return;
+    }
+    depth += label.size();
+    node = it->get();
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
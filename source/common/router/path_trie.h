@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Radix trie over request paths, used to find the routes whose path or prefix matches a request
+ * without comparing the path against every route. Each key is associated with the indices of the
+ * routes which match on it. The trie only answers which keys match; the caller decides the order
+ * in which the routes are tried.
+ */
+class PathTrie {
+public:
+  /**
+   * @param ignore_case supplies whether keys match paths regardless of the case of their ASCII
+   *        letters. Paths are then folded as the trie is walked, so they need not be lower cased
+   *        beforehand.
+   */
+  explicit PathTrie(bool ignore_case = false);
+  ~PathTrie();
+
+  /**
+   * Adds a route which matches any path starting with prefix.
+   * @param prefix supplies the prefix to match.
+   * @param index supplies the index of the route.
+   */
+  void addPrefix(absl::string_view prefix, uint32_t index);
+
+  /**
+   * Adds a route which matches a path equal to path.
+   * @param path supplies the path to match.
+   * @param index supplies the index of the route.
+   */
+  void addPath(absl::string_view path, uint32_t index);
+
+  /**
+   * Finds the routes which match a path.
+   * @param path supplies the path, including its query string, which prefixes are matched on.
+   * @param path_length supplies the length of the path without its query string, which exact paths
+   *        are matched on.
+   * @param indices receives the indices of the matching routes, in no particular order.
+   */
+  void find(absl::string_view path, size_t path_length, std::vector<uint32_t>& indices) const;
+
+  /**
+   * @return bool whether no route was added.
+   */
+  bool empty() const { return empty_; }
+
+private:
+  struct Node;
+  typedef std::unique_ptr<Node> NodePtr;
+
+  Node& insert(absl::string_view key);
+
+  const bool ignore_case_;
+  NodePtr root_;
+  bool empty_{true};
+};
+
+} // namespace Router
+} // namespace Envoy
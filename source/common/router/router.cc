@@ -343,6 +343,9 @@ Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_strea
     buffering = false;
     do_shadowing_ = false;
   }
+  if (!buffering && data.length() > 0) {
+    request_body_unbuffered_ = true;
+  }
 
   // If we are going to buffer for retries or shadowing, we need to make a copy before encoding
   // since it's all moves from here on.
@@ -382,6 +385,11 @@ void Filter::setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callb
 void Filter::cleanup() {
   upstream_request_.reset();
   retry_state_.reset();
+  if (pipelined_retry_pending_) {
+    cluster_->resourceManager(route_entry_->priority()).retries().dec();
+    pipelined_retry_pending_ = false;
+  }
+  pipelined_retry_timer_.reset();
   if (response_timeout_) {
     response_timeout_->disableTimer();
     response_timeout_.reset();
@@ -460,13 +468,28 @@ void Filter::onUpstreamReset(UpstreamResetType type,
   Upstream::HostDescriptionConstSharedPtr upstream_host;
   if (upstream_request_) {
     upstream_host = upstream_request_->upstream_host_;
-    if (upstream_host) {
-      upstream_host->outlierDetector().putHttpResponseCode(
-          enumToInt(type == UpstreamResetType::Reset ? Http::Code::ServiceUnavailable
-                                                     : timeout_response_code_));
+  }
+
+  // The upstream closed the connection before answering the request, which was pipelined and is
+  // therefore idempotent, so it's retried once whatever the retry policy, within the retries
+  // circuit breaker. This isn't held against the host. A request with a body is only retried this
+  // way if the whole body is buffered, as it would otherwise be sent again without it.
+  if (type == UpstreamResetType::Reset && reset_reason &&
+      reset_reason.value() == Http::StreamResetReason::PipelinedRequestUnanswered &&
+      !retried_pipelined_request_ && !downstream_response_started_ && downstream_end_stream_ &&
+      !request_body_unbuffered_) {
+    retried_pipelined_request_ = true;
+    if (retryPipelinedRequest(upstream_host)) {
+      return;
     }
   }
 
+  if (upstream_host) {
+    upstream_host->outlierDetector().putHttpResponseCode(
+        enumToInt(type == UpstreamResetType::Reset ? Http::Code::ServiceUnavailable
+                                                   : timeout_response_code_));
+  }
+
   // We don't retry on a global timeout or if we already started the response.
   if (type != UpstreamResetType::GlobalTimeout && !downstream_response_started_ && retry_state_) {
     // Notify retry modifiers about the attempted host.
@@ -534,6 +557,7 @@ Filter::streamResetReasonToResponseFlag(Http::StreamResetReason reset_reason) {
   case Http::StreamResetReason::ConnectionFailure:
     return RequestInfo::ResponseFlag::UpstreamConnectionFailure;
   case Http::StreamResetReason::ConnectionTermination:
+  case Http::StreamResetReason::PipelinedRequestUnanswered:
     return RequestInfo::ResponseFlag::UpstreamConnectionTermination;
   case Http::StreamResetReason::LocalReset:
   case Http::StreamResetReason::LocalRefusedStreamReset:
@@ -751,6 +775,38 @@ bool Filter::setupRetry(bool end_stream) {
   return true;
 }
 
+bool Filter::retryPipelinedRequest(const Upstream::HostDescriptionConstSharedPtr& upstream_host) {
+  Upstream::ResourceManager& resource_manager = cluster_->resourceManager(route_entry_->priority());
+  if (!resource_manager.retries().canCreate()) {
+    cluster_->stats().upstream_rq_retry_overflow_.inc();
+    callbacks_->requestInfo().setResponseFlag(RequestInfo::ResponseFlag::UpstreamOverflow);
+    return false;
+  }
+
+  if (!setupRetry(true)) {
+    return false;
+  }
+
+  // Notify retry modifiers about the attempted host.
+  if (retry_state_) {
+    retry_state_->onHostAttempted(upstream_host);
+  }
+
+  // As for the retries of the retry policy, the retry is counted against the circuit breaker until
+  // the request is sent again. The reset is raised while the connection pool tears the connection
+  // down, so this is from the next dispatcher iteration.
+  resource_manager.retries().inc();
+  cluster_->stats().upstream_rq_retry_.inc();
+  pipelined_retry_pending_ = true;
+  pipelined_retry_timer_ = callbacks_->dispatcher().createTimer([this]() -> void {
+    cluster_->resourceManager(route_entry_->priority()).retries().dec();
+    pipelined_retry_pending_ = false;
+    doRetry();
+  });
+  pipelined_retry_timer_->enableTimer(std::chrono::milliseconds(0));
+  return true;
+}
+
 void Filter::doRetry() {
   is_retry_ = true;
   Http::ConnectionPool::Instance* conn_pool = getConnPool();
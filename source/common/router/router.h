@@ -366,6 +366,9 @@ private:
   void sendNoHealthyUpstreamResponse();
   bool setupRetry(bool end_stream);
   void doRetry();
+  // Retries an unanswered pipelined request, unless the retries circuit breaker overflows.
+  // @return bool whether the request is retried.
+  bool retryPipelinedRequest(const Upstream::HostDescriptionConstSharedPtr& upstream_host);
   // Called immediately after a non-5xx header is received from upstream, performs stats accounting
   // and handle difference between gRPC and non-gRPC requests.
   void handleNon5xxResponseHeaders(const Http::HeaderMap& headers, bool end_stream);
@@ -379,6 +382,7 @@ private:
   std::string alt_stat_prefix_;
   const VirtualCluster* request_vcluster_;
   Event::TimerPtr response_timeout_;
+  Event::TimerPtr pipelined_retry_timer_;
   FilterUtility::TimeoutData timeout_;
   Http::Code timeout_response_code_ = Http::Code::GatewayTimeout;
   UpstreamRequestPtr upstream_request_;
@@ -388,6 +392,11 @@ private:
   MonotonicTime downstream_request_complete_time_;
   uint32_t buffer_limit_{0};
   bool stream_destroyed_{};
+  bool retried_pipelined_request_{};
+  bool pipelined_retry_pending_{};
+  // Set once part of the request body was sent upstream without being kept in the decoding buffer,
+  // so the request can't be sent again as a whole.
+  bool request_body_unbuffered_{};
   MetadataMatchCriteriaConstPtr metadata_match_;
 
   // list of cookies to add to upstream headers
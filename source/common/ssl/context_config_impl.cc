@@ -191,7 +191,9 @@ ServerContextConfigImpl::ServerContextConfigImpl(
         }
 
         return ret;
-      }()) {
+      }()),
+      private_key_offload_threads_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, private_key_offload_threads, 0)) {
   // TODO(PiotrSikora): Support multiple TLS certificates.
   if ((config.common_tls_context().tls_certificates().size() +
        config.common_tls_context().tls_certificate_sds_secret_configs().size()) == 0) {
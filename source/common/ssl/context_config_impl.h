@@ -122,10 +122,12 @@ public:
   const std::vector<SessionTicketKey>& sessionTicketKeys() const override {
     return session_ticket_keys_;
   }
+  uint32_t privateKeyOffloadThreads() const override { return private_key_offload_threads_; }
 
 private:
   const bool require_client_certificate_;
   const std::vector<SessionTicketKey> session_ticket_keys_;
+  const uint32_t private_key_offload_threads_;
 
   static void validateAndAppendKey(std::vector<ServerContextConfig::SessionTicketKey>& keys,
                                    const std::string& key_data);
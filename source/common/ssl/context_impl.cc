@@ -503,7 +503,8 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
 
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
-                                     Runtime::Loader& runtime)
+                                     Runtime::Loader& runtime,
+                                     PrivateKeyOffloadPool* private_key_offload_pool)
     : ContextImpl(scope, config), runtime_(runtime),
       session_ticket_keys_(config.sessionTicketKeys()) {
   if (config.tlsCertificate() == nullptr) {
@@ -557,6 +558,16 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextCon
 
   parsed_alt_alpn_protocols_ = parseAlpnProtocols(config.altAlpnProtocols());
 
+  // The private key method is set on each SSL by SslSocket, which implements it.
+  if (config.privateKeyOffloadThreads() > 0) {
+    ASSERT(private_key_offload_pool != nullptr);
+    private_key_offload_pool_ = private_key_offload_pool;
+    const std::string prefix("ssl.private_key_offload.");
+    private_key_offload_stats_.reset(new PrivateKeyOffloadStats{ALL_PRIVATE_KEY_OFFLOAD_STATS(
+        POOL_COUNTER_PREFIX(scope, prefix), POOL_GAUGE_PREFIX(scope, prefix),
+        POOL_HISTOGRAM_PREFIX(scope, prefix))});
+  }
+
   if (!parsed_alpn_protocols_.empty()) {
     SSL_CTX_set_alpn_select_cb(ctx_.get(),
                                [](SSL*, const unsigned char** out, unsigned char* outlen,
@@ -11,6 +11,7 @@
 
 #include "common/ssl/context_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/ssl/private_key_offload_pool.h"
 
 #include "openssl/ssl.h"
 
@@ -40,6 +41,24 @@ struct SslStats {
   ALL_SSL_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
+// clang-format off
+#define ALL_PRIVATE_KEY_OFFLOAD_STATS(COUNTER, GAUGE, HISTOGRAM)                                   \
+  COUNTER(operations)                                                                              \
+  COUNTER(failed)                                                                                  \
+  GAUGE  (pending)                                                                                 \
+  HISTOGRAM(operation_time_ms)                                                                     \
+  HISTOGRAM(handshake_time_ms)
+// clang-format on
+
+/**
+ * Wrapper struct for the stats of the private key operations a context offloads. @see
+ * stats_macros.h
+ */
+struct PrivateKeyOffloadStats {
+  ALL_PRIVATE_KEY_OFFLOAD_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                                GENERATE_HISTOGRAM_STRUCT)
+};
+
 class ContextImpl : public virtual Context {
 public:
   virtual bssl::UniquePtr<SSL> newSsl() const;
@@ -69,6 +88,18 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return PrivateKeyOffloadPool* the pool to offload the private key operations to, or nullptr
+   *         if they run inline.
+   */
+  PrivateKeyOffloadPool* privateKeyOffloadPool() const { return private_key_offload_pool_; }
+
+  /**
+   * @return PrivateKeyOffloadStats& the stats of the offloaded private key operations. Only valid
+   *         if privateKeyOffloadPool() isn't nullptr.
+   */
+  PrivateKeyOffloadStats& privateKeyOffloadStats() const { return *private_key_offload_stats_; }
+
   // Ssl::Context
   size_t daysUntilFirstCertExpires() const override;
   std::string getCaCertInformation() const override;
@@ -134,6 +165,9 @@ protected:
   bssl::UniquePtr<X509> cert_chain_;
   std::string ca_file_path_;
   std::string cert_chain_file_path_;
+  // Owned by the context manager, which outlives the context.
+  PrivateKeyOffloadPool* private_key_offload_pool_{};
+  std::unique_ptr<PrivateKeyOffloadStats> private_key_offload_stats_;
 };
 
 typedef std::shared_ptr<ContextImpl> ContextImplSharedPtr;
@@ -151,8 +185,13 @@ private:
 
 class ServerContextImpl : public ContextImpl, public ServerContext {
 public:
+  /**
+   * @param private_key_offload_pool supplies the pool to offload the private key operations to,
+   *        or nullptr to run them inline. It must be set if config has private key offload threads.
+   */
   ServerContextImpl(Stats::Scope& scope, const ServerContextConfig& config,
-                    const std::vector<std::string>& server_names, Runtime::Loader& runtime);
+                    const std::vector<std::string>& server_names, Runtime::Loader& runtime,
+                    PrivateKeyOffloadPool* private_key_offload_pool);
 
 private:
   int alpnSelectCallback(const unsigned char** out, unsigned char* outlen, const unsigned char* in,
@@ -38,8 +38,18 @@ ContextManagerImpl::createSslServerContext(Stats::Scope& scope, const ServerCont
     return nullptr;
   }
 
-  ServerContextSharedPtr context =
-      std::make_shared<ServerContextImpl>(scope, config, server_names, runtime_);
+  const uint32_t private_key_offload_threads = config.privateKeyOffloadThreads();
+  if (private_key_offload_threads > 0) {
+    if (private_key_offload_pool_ == nullptr) {
+      private_key_offload_pool_ =
+          std::make_unique<PrivateKeyOffloadPool>(private_key_offload_threads);
+    } else {
+      private_key_offload_pool_->ensureThreads(private_key_offload_threads);
+    }
+  }
+
+  ServerContextSharedPtr context = std::make_shared<ServerContextImpl>(
+      scope, config, server_names, runtime_, private_key_offload_pool_.get());
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
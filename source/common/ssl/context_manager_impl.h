@@ -7,6 +7,8 @@
 #include "envoy/ssl/context_manager.h"
 #include "envoy/stats/scope.h"
 
+#include "common/ssl/private_key_offload_pool.h"
+
 namespace Envoy {
 namespace Ssl {
 
@@ -16,6 +18,10 @@ namespace Ssl {
  * thread). They can be released from any thread (and in practice are since cluster information can
  * be released from any thread). Context allocation/free is a very uncommon thing so we just do a
  * global lock to protect it all.
+ *
+ * The manager owns the pool which the server contexts offload their private key operations to.
+ * It is created for the first context which offloads them, grown to the largest number of threads
+ * any context asks for, and destroyed with the manager, on the main thread.
  */
 class ContextManagerImpl final : public ContextManager {
 public:
@@ -35,6 +41,7 @@ private:
   void removeEmptyContexts();
   Runtime::Loader& runtime_;
   std::list<std::weak_ptr<Context>> contexts_;
+  PrivateKeyOffloadPoolPtr private_key_offload_pool_;
 };
 
 } // namespace Ssl
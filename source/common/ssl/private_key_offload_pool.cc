@@ -0,0 +1,64 @@
+#include "common/ssl/private_key_offload_pool.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Ssl {
+
+PrivateKeyOffloadPool::PrivateKeyOffloadPool(uint32_t num_threads) {
+  ASSERT(num_threads > 0);
+  ensureThreads(num_threads);
+}
+
+PrivateKeyOffloadPool::~PrivateKeyOffloadPool() {
+  {
+    Thread::LockGuard guard(lock_);
+    shutdown_ = true;
+    queue_.clear();
+  }
+  queue_not_empty_.notifyAll();
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void PrivateKeyOffloadPool::ensureThreads(uint32_t num_threads) {
+  while (threads_.size() < num_threads) {
+    threads_.emplace_back(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+size_t PrivateKeyOffloadPool::queueSize() {
+  Thread::LockGuard guard(lock_);
+  return queue_.size();
+}
+
+void PrivateKeyOffloadPool::post(Operation operation) {
+  {
+    Thread::LockGuard guard(lock_);
+    queue_.push_back(std::move(operation));
+  }
+  queue_not_empty_.notifyOne();
+}
+
+void PrivateKeyOffloadPool::threadRoutine() {
+  while (true) {
+    Operation operation;
+    {
+      Thread::LockGuard guard(lock_);
+      while (queue_.empty() && !shutdown_) {
+        queue_not_empty_.wait(lock_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    operation();
+  }
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+#include "envoy/common/time.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+#include "common/common/utility.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Pool of threads which run the private key operations of handshakes, off the workers. A single
+ * pool is shared by all the server contexts which offload their private key operations, so that
+ * the number of threads doesn't grow with the number of filter chains, or with secret updates.
+ * Each operation carries the key it runs with. The operations are queued in order and picked by
+ * the first idle thread.
+ *
+ * The pool is owned by the context manager and destroyed with it, on the main thread, once every
+ * context is gone. Operations which are still queued then are dropped, which is fine since there
+ * are no more connections to resume.
+ */
+class PrivateKeyOffloadPool {
+public:
+  typedef std::function<void()> Operation;
+
+  /**
+   * @param num_threads supplies the number of threads, at least 1.
+   */
+  explicit PrivateKeyOffloadPool(uint32_t num_threads);
+  ~PrivateKeyOffloadPool();
+
+  /**
+   * Start more threads, so that the pool has at least num_threads. Only called on the main thread.
+   * @param num_threads supplies the number of threads the pool must have.
+   */
+  void ensureThreads(uint32_t num_threads);
+
+  /**
+   * @return uint32_t the number of threads of the pool.
+   */
+  uint32_t numThreads() const { return threads_.size(); }
+
+  /**
+   * @return size_t the number of operations waiting for a thread.
+   */
+  size_t queueSize();
+
+  /**
+   * Queue an operation, from any thread. The operation is run on a thread of the pool, so it must
+   * only touch thread safe state, and post back to the dispatcher of its connection to resume it.
+   * @param operation supplies the operation.
+   */
+  void post(Operation operation);
+
+  TimeSource& timeSource() { return time_source_; }
+
+private:
+  void threadRoutine();
+
+  RealTimeSource time_source_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar queue_not_empty_;
+  std::list<Operation> queue_ GUARDED_BY(lock_);
+  bool shutdown_ GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+typedef std::unique_ptr<PrivateKeyOffloadPool> PrivateKeyOffloadPoolPtr;
+
+} // namespace Ssl
+} // namespace Envoy
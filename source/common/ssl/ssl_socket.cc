@@ -1,15 +1,19 @@
 #include "common/ssl/ssl_socket.h"
 
+#include "envoy/event/dispatcher.h"
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/hex.h"
+#include "common/common/macros.h"
 #include "common/http/headers.h"
 #include "common/ssl/utility.h"
 
 #include "absl/strings/str_replace.h"
 #include "openssl/err.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
 #include "openssl/x509v3.h"
 
 using Envoy::Network::PostIoAction;
@@ -33,8 +37,91 @@ public:
   void onConnected() override {}
   const Ssl::Connection* ssl() const override { return nullptr; }
 };
+
+// Signs as BoringSSL does with a private key which it holds itself.
+bool signWithKey(EVP_PKEY* key, uint16_t signature_algorithm, const std::vector<uint8_t>& in,
+                 size_t max_out, std::vector<uint8_t>& output) {
+  bssl::ScopedEVP_MD_CTX md_ctx;
+  EVP_PKEY_CTX* pkey_ctx;
+  if (!EVP_DigestSignInit(md_ctx.get(), &pkey_ctx,
+                          SSL_get_signature_algorithm_digest(signature_algorithm), nullptr, key)) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1 /* salt length is digest length */))) {
+    return false;
+  }
+  size_t out_len = max_out;
+  output.resize(max_out);
+  if (!EVP_DigestSign(md_ctx.get(), output.data(), &out_len, in.data(), in.size())) {
+    return false;
+  }
+  output.resize(out_len);
+  return true;
+}
+
+// Decrypts the premaster secret of RSA key exchange, which BoringSSL unpads itself.
+bool decryptWithKey(EVP_PKEY* key, const std::vector<uint8_t>& in, size_t max_out,
+                    std::vector<uint8_t>& output) {
+  RSA* rsa = EVP_PKEY_get0_RSA(key);
+  if (rsa == nullptr) {
+    return false;
+  }
+  size_t out_len;
+  output.resize(max_out);
+  if (!RSA_decrypt(rsa, &out_len, output.data(), max_out, in.data(), in.size(), RSA_NO_PADDING)) {
+    return false;
+  }
+  output.resize(out_len);
+  return true;
+}
 } // namespace
 
+// A private key operation offloaded to the pool of the context, with the key it runs with. Its
+// output is written on the thread of the pool before its completion is posted to the dispatcher of
+// the connection, and is only read after, on the thread of the connection.
+struct SslSocket::PrivateKeyOperation {
+  PrivateKeyOperation(SslSocket& socket, Event::Dispatcher& dispatcher, EVP_PKEY* key,
+                      MonotonicTime queued_time)
+      : socket_(&socket), dispatcher_(dispatcher), key_(bssl::UpRef(key)),
+        queued_time_(queued_time) {}
+
+  void onComplete() {
+    SslSocket* socket;
+    {
+      absl::MutexLock lock(&lock_);
+      socket = socket_;
+    }
+    if (socket != nullptr) {
+      socket->onPrivateKeyOperationComplete();
+    }
+  }
+
+  // Guards socket_, which is reset when the socket is destroyed, so that the completion isn't
+  // posted to the dispatcher once the socket, and possibly the dispatcher, are gone.
+  absl::Mutex lock_;
+  SslSocket* socket_ GUARDED_BY(lock_);
+  Event::Dispatcher& dispatcher_;
+  const bssl::UniquePtr<EVP_PKEY> key_;
+  const MonotonicTime queued_time_;
+  std::vector<uint8_t> output_;
+  bool succeeded_{};
+  // Set on the thread of the connection once the completion is delivered.
+  bool done_{};
+};
+
+const SSL_PRIVATE_KEY_METHOD SslSocket::private_key_method_ = {
+    SslSocket::privateKeySign, SslSocket::privateKeyDecrypt, SslSocket::privateKeyComplete};
+
+int SslSocket::sslSocketIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int ssl_socket_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(ssl_socket_index >= 0, "");
+    return ssl_socket_index;
+  }());
+}
+
 SslSocket::SslSocket(ContextSharedPtr ctx, InitialState state)
     : ctx_(std::dynamic_pointer_cast<ContextImpl>(ctx)), ssl_(ctx_->newSsl()) {
   if (state == InitialState::Client) {
@@ -43,6 +130,22 @@ SslSocket::SslSocket(ContextSharedPtr ctx, InitialState state)
     ASSERT(state == InitialState::Server);
     SSL_set_accept_state(ssl_.get());
   }
+
+  if (ctx_->privateKeyOffloadPool() != nullptr) {
+    int rc = SSL_set_ex_data(ssl_.get(), sslSocketIndex(), this);
+    RELEASE_ASSERT(rc == 1, "");
+    SSL_set_private_key_method(ssl_.get(), &private_key_method_);
+  }
+}
+
+SslSocket::~SslSocket() {
+  if (private_key_operation_ != nullptr) {
+    if (!private_key_operation_->done_) {
+      ctx_->privateKeyOffloadStats().pending_.dec();
+    }
+    absl::MutexLock lock(&private_key_operation_->lock_);
+    private_key_operation_->socket_ = nullptr;
+  }
 }
 
 void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& callbacks) {
@@ -51,6 +154,10 @@ void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& c
 
   BIO* bio = BIO_new_socket(callbacks_->fd(), 0);
   SSL_set_bio(ssl_.get(), bio, bio);
+
+  if (ctx_->privateKeyOffloadPool() != nullptr) {
+    handshake_start_time_ = ctx_->privateKeyOffloadPool()->timeSource().monotonicTime();
+  }
 }
 
 Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
@@ -120,6 +227,13 @@ PostIoAction SslSocket::doHandshake() {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     handshake_complete_ = true;
     ctx_->logHandshake(ssl_.get());
+    PrivateKeyOffloadPool* pool = ctx_->privateKeyOffloadPool();
+    if (pool != nullptr) {
+      ctx_->privateKeyOffloadStats().handshake_time_ms_.recordValue(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              pool->timeSource().monotonicTime() - handshake_start_time_)
+              .count());
+    }
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -132,6 +246,8 @@ PostIoAction SslSocket::doHandshake() {
     switch (err) {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
+    // The handshake resumes once the offloaded private key operation completes.
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
       return PostIoAction::KeepOpen;
     default:
       drainErrorQueue();
@@ -140,6 +256,90 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+ssl_private_key_result_t SslSocket::privateKeySign(SSL* ssl, uint8_t*, size_t*, size_t max_out,
+                                                   uint16_t signature_algorithm,
+                                                   const uint8_t* in, size_t in_len) {
+  SslSocket* socket = static_cast<SslSocket*>(SSL_get_ex_data(ssl, sslSocketIndex()));
+  const std::vector<uint8_t> input(in, in + in_len);
+  return socket->startPrivateKeyOperation(
+      [signature_algorithm, input, max_out](EVP_PKEY* key, std::vector<uint8_t>& output) {
+        return signWithKey(key, signature_algorithm, input, max_out, output);
+      });
+}
+
+ssl_private_key_result_t SslSocket::privateKeyDecrypt(SSL* ssl, uint8_t*, size_t*, size_t max_out,
+                                                      const uint8_t* in, size_t in_len) {
+  SslSocket* socket = static_cast<SslSocket*>(SSL_get_ex_data(ssl, sslSocketIndex()));
+  const std::vector<uint8_t> input(in, in + in_len);
+  return socket->startPrivateKeyOperation(
+      [input, max_out](EVP_PKEY* key, std::vector<uint8_t>& output) {
+        return decryptWithKey(key, input, max_out, output);
+      });
+}
+
+ssl_private_key_result_t SslSocket::privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                       size_t max_out) {
+  SslSocket* socket = static_cast<SslSocket*>(SSL_get_ex_data(ssl, sslSocketIndex()));
+  return socket->completePrivateKeyOperation(out, out_len, max_out);
+}
+
+ssl_private_key_result_t SslSocket::startPrivateKeyOperation(PrivateKeyComputation computation) {
+  ASSERT(private_key_operation_ == nullptr);
+  PrivateKeyOffloadPool& pool = *ctx_->privateKeyOffloadPool();
+  auto operation = std::make_shared<PrivateKeyOperation>(
+      *this, callbacks_->connection().dispatcher(), SSL_get_privatekey(ssl_.get()),
+      pool.timeSource().monotonicTime());
+  ctx_->privateKeyOffloadStats().operations_.inc();
+  ctx_->privateKeyOffloadStats().pending_.inc();
+  pool.post([operation, computation]() -> void {
+    operation->succeeded_ = computation(operation->key_.get(), operation->output_);
+    if (!operation->succeeded_) {
+      // The error queue is per thread, the connection sees the failure in the completion.
+      ERR_clear_error();
+    }
+    absl::MutexLock lock(&operation->lock_);
+    if (operation->socket_ != nullptr) {
+      operation->dispatcher_.post([operation]() -> void { operation->onComplete(); });
+    }
+  });
+  private_key_operation_ = std::move(operation);
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t SslSocket::completePrivateKeyOperation(uint8_t* out, size_t* out_len,
+                                                                size_t max_out) {
+  if (private_key_operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  // The handshake may be driven by socket events before the operation completes.
+  if (!private_key_operation_->done_) {
+    return ssl_private_key_retry;
+  }
+
+  PrivateKeyOperationSharedPtr operation = std::move(private_key_operation_);
+  if (!operation->succeeded_ || operation->output_.size() > max_out) {
+    ctx_->privateKeyOffloadStats().failed_.inc();
+    return ssl_private_key_failure;
+  }
+  std::copy(operation->output_.begin(), operation->output_.end(), out);
+  *out_len = operation->output_.size();
+  return ssl_private_key_success;
+}
+
+void SslSocket::onPrivateKeyOperationComplete() {
+  ASSERT(private_key_operation_ != nullptr);
+  private_key_operation_->done_ = true;
+  PrivateKeyOffloadStats& stats = ctx_->privateKeyOffloadStats();
+  stats.pending_.dec();
+  stats.operation_time_ms_.recordValue(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          ctx_->privateKeyOffloadPool()->timeSource().monotonicTime() -
+          private_key_operation_->queued_time_)
+          .count());
+  // Resume the handshake, on the next read of the connection.
+  callbacks_->setReadBufferReady();
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/secret/secret_callbacks.h"
@@ -39,6 +43,7 @@ class SslSocket : public Network::TransportSocket,
                   protected Logger::Loggable<Logger::Id::connection> {
 public:
   SslSocket(ContextSharedPtr ctx, InitialState state);
+  ~SslSocket();
 
   // Ssl::Connection
   bool peerCertificatePresented() const override;
@@ -65,10 +70,32 @@ public:
   SSL* rawSslForTest() const { return ssl_.get(); }
 
 private:
+  struct PrivateKeyOperation;
+  typedef std::shared_ptr<PrivateKeyOperation> PrivateKeyOperationSharedPtr;
+  // Runs a private key operation with the key, writing its output, on a thread of the pool.
+  typedef std::function<bool(EVP_PKEY* key, std::vector<uint8_t>& output)> PrivateKeyComputation;
+
   Network::PostIoAction doHandshake();
   void drainErrorQueue();
   void shutdownSsl();
 
+  // The SSL_PRIVATE_KEY_METHOD of sockets whose context offloads the private key operations.
+  static int sslSocketIndex();
+  static ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                 size_t max_out, uint16_t signature_algorithm,
+                                                 const uint8_t* in, size_t in_len);
+  static ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                    size_t max_out, const uint8_t* in,
+                                                    size_t in_len);
+  static ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                     size_t max_out);
+  static const SSL_PRIVATE_KEY_METHOD private_key_method_;
+
+  ssl_private_key_result_t startPrivateKeyOperation(PrivateKeyComputation computation);
+  ssl_private_key_result_t completePrivateKeyOperation(uint8_t* out, size_t* out_len,
+                                                       size_t max_out);
+  void onPrivateKeyOperationComplete();
+
   // TODO: Move helper functions to the `Ssl::Utility` namespace.
   std::string getUriSanFromCertificate(X509* cert) const;
   std::string getSubjectFromCertificate(X509* cert) const;
@@ -80,6 +107,9 @@ private:
   bool handshake_complete_{};
   bool shutdown_sent_{};
   uint64_t bytes_to_retry_{};
+  // The pending private key operation, if any, when they are offloaded.
+  PrivateKeyOperationSharedPtr private_key_operation_;
+  MonotonicTime handshake_start_time_;
   mutable std::string cached_sha_256_peer_certificate_digest_;
   mutable std::string cached_url_encoded_pem_encoded_peer_certificate_;
 };
@@ -6,16 +6,18 @@
 namespace Envoy {
 namespace Stats {
 
-HeapStatData::HeapStatData(absl::string_view key) : name_(key.data(), key.size()) {}
+HeapStatData::HeapStatData(absl::string_view name, SymbolTableImpl& symbol_table)
+    : name_(name, symbol_table) {}
 
-HeapStatDataAllocator::HeapStatDataAllocator() {}
+HeapStatDataAllocator::HeapStatDataAllocator(SymbolTableImpl& symbol_table)
+    : symbol_table_(symbol_table) {}
 
 HeapStatDataAllocator::~HeapStatDataAllocator() { ASSERT(stats_.empty()); }
 
 HeapStatData* HeapStatDataAllocator::alloc(absl::string_view name) {
   // Any expected truncation of name is done at the callsite. No truncation is
   // required to use this allocator.
-  auto data = std::make_unique<HeapStatData>(name);
+  auto data = std::make_unique<HeapStatData>(name, symbol_table_);
   Thread::ReleasableLockGuard lock(mutex_);
   auto ret = stats_.insert(data.get());
   HeapStatData* existing_data = *ret.first;
@@ -8,32 +8,34 @@
 #include "common/common/thread.h"
 #include "common/common/thread_annotations.h"
 #include "common/stats/stat_data_allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
 namespace Stats {
 
 /**
  * This structure is an alternate backing store for both CounterImpl and GaugeImpl. It is designed
- * so that it can be allocated efficiently from the heap on demand.
+ * so that it can be allocated efficiently from the heap on demand. The name is symbolized against
+ * the allocator's symbol table, so the segments shared by many stats are only stored once.
  */
 struct HeapStatData {
-  explicit HeapStatData(absl::string_view key);
+  HeapStatData(absl::string_view name, SymbolTableImpl& symbol_table);
 
   /**
-   * @returns absl::string_view the name as a string_view.
+   * @returns const std::string& the encoded name, which identifies the stat within its allocator.
    */
-  absl::string_view key() const { return name_; }
+  const std::string& key() const { return name_.encoding(); }
 
   /**
    * @returns std::string the name as a std::string.
    */
-  std::string name() const { return name_; }
+  std::string name() const { return name_.toString(); }
 
   std::atomic<uint64_t> value_{0};
   std::atomic<uint64_t> pending_increment_{0};
   std::atomic<uint16_t> flags_{0};
   std::atomic<uint16_t> ref_count_{1};
-  std::string name_;
+  StatNameImpl name_;
 };
 
 /**
@@ -42,7 +44,12 @@ struct HeapStatData {
  */
 class HeapStatDataAllocator : public StatDataAllocatorImpl<HeapStatData> {
 public:
-  HeapStatDataAllocator();
+  /**
+   * @param symbol_table the table the names of the stats are symbolized against. It is shared with
+   *     the store the allocator serves, so that each name is only interned once, and must outlive
+   *     the allocator.
+   */
+  explicit HeapStatDataAllocator(SymbolTableImpl& symbol_table);
   ~HeapStatDataAllocator();
 
   // StatDataAllocatorImpl
@@ -62,9 +69,6 @@ private:
     }
   };
 
-  // TODO(jmarantz): See https://github.com/envoyproxy/envoy/pull/3927 and
-  //  https://github.com/envoyproxy/envoy/issues/3585, which can help reorganize
-  // the heap stats using a ref-counted symbol table to compress the stat strings.
   typedef std::unordered_set<HeapStatData*, HeapStatHash_, HeapStatCompare_> StatSet;
 
   // An unordered set of HeapStatData pointers which keys off the key()
@@ -74,6 +78,7 @@ private:
   // Although alloc() operations are called under existing locking, free() operations are made from
   // the destructors of the individual stat objects, which are not protected by locks.
   Thread::MutexBasicLockable mutex_;
+  SymbolTableImpl& symbol_table_;
 };
 
 } // namespace Stats
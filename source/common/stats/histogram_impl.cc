@@ -10,6 +10,52 @@
 namespace Envoy {
 namespace Stats {
 
+HistogramBuckets::HistogramBuckets(bool log_linear) {
+  if (log_linear) {
+    log_linear_ = std::make_unique<LogLinearHistogram>();
+  } else {
+    circllhist_ = hist_alloc();
+  }
+}
+
+HistogramBuckets::HistogramBuckets(HistogramBuckets&& other)
+    : circllhist_(other.circllhist_), log_linear_(std::move(other.log_linear_)) {
+  other.circllhist_ = nullptr;
+}
+
+HistogramBuckets::~HistogramBuckets() {
+  if (circllhist_ != nullptr) {
+    hist_free(circllhist_);
+  }
+}
+
+void HistogramBuckets::merge(const HistogramBuckets& other) {
+  ASSERT((log_linear_ != nullptr) == (other.log_linear_ != nullptr));
+  if (log_linear_ != nullptr) {
+    log_linear_->merge(*other.log_linear_);
+  } else {
+    hist_accumulate(circllhist_, &other.circllhist_, 1);
+  }
+}
+
+void HistogramBuckets::clear() {
+  if (log_linear_ != nullptr) {
+    log_linear_->clear();
+  } else {
+    hist_clear(circllhist_);
+  }
+}
+
+void HistogramBuckets::computeQuantiles(const std::vector<double>& quantiles,
+                                        std::vector<double>& computed) const {
+  if (log_linear_ != nullptr) {
+    log_linear_->computeQuantiles(quantiles, computed);
+  } else {
+    computed.assign(quantiles.size(), 0.0);
+    hist_approx_quantile(circllhist_, quantiles.data(), quantiles.size(), computed.data());
+  }
+}
+
 HistogramStatisticsImpl::HistogramStatisticsImpl(const histogram_t* histogram_ptr)
     : computed_quantiles_(supportedQuantiles().size(), 0.0) {
   hist_approx_quantile(histogram_ptr, supportedQuantiles().data(), supportedQuantiles().size(),
@@ -43,5 +89,9 @@ void HistogramStatisticsImpl::refresh(const histogram_t* new_histogram_ptr) {
                        computed_quantiles_.data());
 }
 
+void HistogramStatisticsImpl::refresh(const HistogramBuckets& buckets) {
+  buckets.computeQuantiles(supportedQuantiles(), computed_quantiles_);
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -1,20 +1,67 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/stats/histogram.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/store.h"
 
 #include "common/common/non_copyable.h"
+#include "common/stats/log_linear_histogram.h"
 #include "common/stats/metric_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "circllhist.h"
 
 namespace Envoy {
 namespace Stats {
 
+/**
+ * The values recorded into a histogram, held either by libcircllhist or in fixed log-linear
+ * buckets. The representation is chosen at construction, so recording a value only branches on a
+ * flag that never changes.
+ */
+class HistogramBuckets {
+public:
+  explicit HistogramBuckets(bool log_linear);
+  HistogramBuckets(HistogramBuckets&& other);
+  HistogramBuckets(const HistogramBuckets&) = delete;
+  HistogramBuckets& operator=(const HistogramBuckets&) = delete;
+  ~HistogramBuckets();
+
+  void recordValue(uint64_t value) {
+    if (log_linear_ != nullptr) {
+      log_linear_->recordValue(value);
+    } else {
+      hist_insert_intscale(circllhist_, value, 0, 1);
+    }
+  }
+
+  /**
+   * Adds the values of another instance, which must have the same representation.
+   */
+  void merge(const HistogramBuckets& other);
+
+  /**
+   * Forgets all recorded values.
+   */
+  void clear();
+
+  /**
+   * Computes quantiles of the recorded values.
+   * @param quantiles the quantiles to compute, in ascending order.
+   * @param computed receives the value of each quantile.
+   */
+  void computeQuantiles(const std::vector<double>& quantiles, std::vector<double>& computed) const;
+
+private:
+  histogram_t* circllhist_{};
+  std::unique_ptr<LogLinearHistogram> log_linear_;
+};
+
 /**
  * Implementation of HistogramStatistics for circllhist.
  */
@@ -30,6 +77,12 @@ public:
 
   void refresh(const histogram_t* new_histogram_ptr);
 
+  /**
+   * Clears the old computed values and refreshes them with values computed from the passed
+   * buckets, in whichever representation they are.
+   */
+  void refresh(const HistogramBuckets& buckets);
+
   // HistogramStatistics
   std::string summary() const override;
   const std::vector<double>& supportedQuantiles() const override;
@@ -44,12 +97,12 @@ private:
  */
 class HistogramImpl : public Histogram, public MetricImpl {
 public:
-  HistogramImpl(const std::string& name, Store& parent, std::string&& tag_extracted_name,
-                std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), parent_(parent), name_(name) {}
+  HistogramImpl(const std::string& name, Store& parent, const std::string& tag_extracted_name,
+                const std::vector<Tag>& tags, SymbolTableImpl& symbol_table)
+      : MetricImpl(tag_extracted_name, tags), parent_(parent), name_(name, symbol_table) {}
 
   // Stats:;Metric
-  const std::string name() const override { return name_; }
+  const std::string name() const override { return name_.toString(); }
 
   // Stats::Histogram
   void recordValue(uint64_t value) override { parent_.deliverHistogramToSinks(*this, value); }
@@ -60,7 +113,7 @@ private:
   // This is used for delivering the histogram data to sinks.
   Store& parent_;
 
-  const std::string name_;
+  const StatNameImpl name_;
 };
 
 } // namespace Stats
@@ -13,7 +13,7 @@ namespace Envoy {
 namespace Stats {
 
 IsolatedStoreImpl::IsolatedStoreImpl()
-    : counters_([this](const std::string& name) -> CounterSharedPtr {
+    : alloc_(symbol_table_), counters_([this](const std::string& name) -> CounterSharedPtr {
         std::string tag_extracted_name = name;
         std::vector<Tag> tags;
         return alloc_.makeCounter(name, std::move(tag_extracted_name), std::move(tags));
@@ -24,7 +24,8 @@ IsolatedStoreImpl::IsolatedStoreImpl()
         return alloc_.makeGauge(name, std::move(tag_extracted_name), std::move(tags));
       }),
       histograms_([this](const std::string& name) -> HistogramSharedPtr {
-        return std::make_shared<HistogramImpl>(name, *this, std::string(name), std::vector<Tag>());
+        return std::make_shared<HistogramImpl>(name, *this, name, std::vector<Tag>(),
+                                               symbol_table_);
       }) {}
 
 struct IsolatedScopeImpl : public Scope {
@@ -0,0 +1,78 @@
+#include "common/stats/log_linear_histogram.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Stats {
+
+void LogLinearHistogram::merge(const LogLinearHistogram& other) {
+  for (uint32_t group = 0; group < NumGroups; group++) {
+    const uint64_t* other_counts = other.groups_[group].get();
+    if (other_counts == nullptr) {
+      continue;
+    }
+    std::unique_ptr<uint64_t[]>& counts = groups_[group];
+    if (counts == nullptr) {
+      counts.reset(new uint64_t[SubBuckets]());
+    }
+    for (uint64_t bucket = 0; bucket < SubBuckets; bucket++) {
+      counts[bucket] += other_counts[bucket];
+    }
+  }
+  count_ += other.count_;
+}
+
+void LogLinearHistogram::clear() {
+  for (std::unique_ptr<uint64_t[]>& counts : groups_) {
+    if (counts != nullptr) {
+      std::fill(counts.get(), counts.get() + SubBuckets, 0);
+    }
+  }
+  count_ = 0;
+}
+
+void LogLinearHistogram::computeQuantiles(const std::vector<double>& quantiles,
+                                          std::vector<double>& computed) const {
+  computed.assign(quantiles.size(), std::numeric_limits<double>::quiet_NaN());
+  if (count_ == 0) {
+    return;
+  }
+
+  size_t next = 0;
+  uint64_t cumulative = 0;
+  double upper = 0;
+  for (uint32_t group = 0; group < NumGroups && next < quantiles.size(); group++) {
+    const uint64_t* counts = groups_[group].get();
+    if (counts == nullptr) {
+      continue;
+    }
+    const uint64_t width = group == 0 ? 1 : uint64_t(1) << (group - 1);
+    const uint64_t base = group == 0 ? 0 : SubBuckets << (group - 1);
+    for (uint64_t bucket = 0; bucket < SubBuckets && next < quantiles.size(); bucket++) {
+      if (counts[bucket] == 0) {
+        continue;
+      }
+      const double lower = static_cast<double>(base + bucket * width);
+      const uint64_t end = cumulative + counts[bucket];
+      while (next < quantiles.size() && quantiles[next] * count_ <= end) {
+        ASSERT(next == 0 || quantiles[next - 1] <= quantiles[next]);
+        const double fraction = std::max(0.0, quantiles[next] * count_ - cumulative) /
+                                static_cast<double>(counts[bucket]);
+        computed[next++] = lower + fraction * width;
+      }
+      cumulative = end;
+      upper = lower + width;
+    }
+  }
+
+  // Rounding can leave the largest quantiles just past the last value.
+  while (next < quantiles.size()) {
+    computed[next++] = upper;
+  }
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * A histogram of integer values with fixed log-linear buckets, as an alternative to libcircllhist
+ * where the cost of recording a value matters more than the precision of the quantiles.
+ *
+ * Each power of two is split into SubBuckets buckets of equal width, so recording a value is a
+ * couple of shifts and an increment, and the relative error of a bucket is at most 1/SubBuckets.
+ * Values below 2 * SubBuckets are recorded exactly. The buckets of a power of two are allocated
+ * the first time a value falls in it, so a histogram of values spanning a few orders of magnitude
+ * stays small.
+ *
+ * This class is not thread-safe.
+ */
+class LogLinearHistogram {
+public:
+  static constexpr uint32_t SubBucketBits = 4;
+  static constexpr uint64_t SubBuckets = 1 << SubBucketBits;
+  // Group 0 holds the values below SubBuckets. Group g > 0 holds the values in
+  // [SubBuckets << (g - 1), SubBuckets << g), in buckets of width 1 << (g - 1).
+  static constexpr uint32_t NumGroups = 64 - SubBucketBits + 1;
+
+  LogLinearHistogram() = default;
+  LogLinearHistogram(const LogLinearHistogram&) = delete;
+  LogLinearHistogram& operator=(const LogLinearHistogram&) = delete;
+
+  void recordValue(uint64_t value) {
+    uint32_t group = 0;
+    uint64_t bucket = value;
+    if (value >= SubBuckets) {
+      // The position of the most significant bit selects the group, and the SubBucketBits bits
+      // below it the bucket within the group.
+      const uint32_t shift = 63 - __builtin_clzll(value) - SubBucketBits;
+      group = shift + 1;
+      bucket = (value >> shift) - SubBuckets;
+    }
+    std::unique_ptr<uint64_t[]>& counts = groups_[group];
+    if (counts == nullptr) {
+      counts.reset(new uint64_t[SubBuckets]());
+    }
+    counts[bucket]++;
+    count_++;
+  }
+
+  /**
+   * Adds the values recorded by another histogram to this one.
+   */
+  void merge(const LogLinearHistogram& other);
+
+  /**
+   * Forgets all recorded values. The buckets stay allocated, as the same ranges of values are
+   * likely to be recorded again.
+   */
+  void clear();
+
+  /**
+   * @return uint64_t the number of recorded values.
+   */
+  uint64_t count() const { return count_; }
+
+  /**
+   * Computes quantiles by interpolating linearly within the bucket holding each of them. Like
+   * libcircllhist, every quantile of an empty histogram is NaN.
+   * @param quantiles the quantiles to compute, in ascending order and within [0, 1].
+   * @param computed receives the value of each quantile.
+   */
+  void computeQuantiles(const std::vector<double>& quantiles, std::vector<double>& computed) const;
+
+private:
+  std::array<std::unique_ptr<uint64_t[]>, NumGroups> groups_;
+  uint64_t count_{};
+};
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,107 @@
+#include "common/stats/metric_impl.h"
+
+#include <array>
+#include <unordered_map>
+
+#include "envoy/stats/tag.h"
+
+#include "common/common/hash.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Stats {
+
+namespace {
+
+/**
+ * A thread-safe table of immutable values, so that equal values are held once while in use. The
+ * table is split into shards by key, each with its own lock, so that stats created concurrently
+ * rarely contend, and a value already interned is found under a shared lock.
+ */
+template <class T> class InternTable {
+public:
+  /**
+   * @param key supplies the key identifying the value.
+   * @param make supplies the function creating the value if it is not interned yet.
+   * @return the interned value, which is removed from the table once no longer referenced.
+   */
+  template <class MakeFn> std::shared_ptr<const T> intern(const std::string& key, MakeFn make) {
+    Shard& shard = shards_[HashUtil::xxHash64(key) % NumShards];
+    {
+      absl::ReaderMutexLock lock(&shard.lock_);
+      auto it = shard.entries_.find(key);
+      if (it != shard.entries_.end()) {
+        std::shared_ptr<const T> value = it->second.lock();
+        if (value != nullptr) {
+          return value;
+        }
+      }
+    }
+
+    absl::MutexLock lock(&shard.lock_);
+    std::weak_ptr<const T>& entry = shard.entries_[key];
+    std::shared_ptr<const T> value = entry.lock();
+    if (value == nullptr) {
+      value.reset(new T(make()), [&shard, key](const T* expired) { shard.release(key, expired); });
+      entry = value;
+    }
+    return value;
+  }
+
+private:
+  struct Shard {
+    void release(const std::string& key, const T* expired) {
+      {
+        absl::MutexLock lock(&lock_);
+        auto it = entries_.find(key);
+        // The value may have been interned again between its last reference going away and here.
+        if (it != entries_.end() && it->second.expired()) {
+          entries_.erase(it);
+        }
+      }
+      delete expired;
+    }
+
+    absl::Mutex lock_;
+    std::unordered_map<std::string, std::weak_ptr<const T>> entries_ GUARDED_BY(lock_);
+  };
+
+  static constexpr size_t NumShards = 16;
+
+  std::array<Shard, NumShards> shards_;
+};
+
+// Values may be released when a stat is destroyed during static destruction, so the tables are
+// never destroyed.
+InternTable<std::string>& tagExtractedNames() {
+  static InternTable<std::string>* table = new InternTable<std::string>();
+  return *table;
+}
+
+InternTable<std::vector<Tag>>& tagSets() {
+  static InternTable<std::vector<Tag>>* table = new InternTable<std::vector<Tag>>();
+  return *table;
+}
+
+std::string tagSetKey(const std::vector<Tag>& tags) {
+  std::string key;
+  for (const Tag& tag : tags) {
+    key.append(tag.name_);
+    key.push_back('\0');
+    key.append(tag.value_);
+    key.push_back('\0');
+  }
+  return key;
+}
+
+} // namespace
+
+MetricImpl::MetricImpl(const std::string& tag_extracted_name, const std::vector<Tag>& tags)
+    : tag_extracted_name_(tagExtractedNames().intern(
+          tag_extracted_name, [&tag_extracted_name]() { return tag_extracted_name; })),
+      tags_(tagSets().intern(tagSetKey(tags), [&tags]() { return tags; })) {}
+
+} // namespace Stats
+} // namespace Envoy
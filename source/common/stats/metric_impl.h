@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -19,11 +21,10 @@ namespace Stats {
  */
 class MetricImpl : public virtual Metric {
 public:
-  MetricImpl(std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : tag_extracted_name_(std::move(tag_extracted_name)), tags_(std::move(tags)) {}
+  MetricImpl(const std::string& tag_extracted_name, const std::vector<Tag>& tags);
 
-  const std::string& tagExtractedName() const override { return tag_extracted_name_; }
-  const std::vector<Tag>& tags() const override { return tags_; }
+  const std::string& tagExtractedName() const override { return *tag_extracted_name_; }
+  const std::vector<Tag>& tags() const override { return *tags_; }
 
 protected:
   /**
@@ -31,11 +32,30 @@ protected:
    */
   struct Flags {
     static const uint8_t Used = 0x1;
+    // Set on every update and cleared by latchChanged(), so that a flush can skip idle stats.
+    static const uint8_t Changed = 0x2;
   };
 
+  /**
+   * Clears the Changed flag of a stat.
+   * @param flags the flags of the stat.
+   * @return bool whether the flag was set.
+   */
+  static bool clearChangedFlag(std::atomic<uint16_t>& flags) {
+    // Most stats are idle between flushes, so skip the read-modify-write when there's nothing to
+    // clear.
+    if ((flags & Flags::Changed) == 0) {
+      return false;
+    }
+    return (flags.fetch_and(static_cast<uint16_t>(~Flags::Changed)) & Flags::Changed) != 0;
+  }
+
 private:
-  const std::string tag_extracted_name_;
-  const std::vector<Tag> tags_;
+  // Interned across the process: a tag-extracted name is shared by the stats of every cluster or
+  // listener, and a set of tags by all the stats of one of them. Sinks read them on every flush,
+  // so they are kept decoded.
+  const std::shared_ptr<const std::string> tag_extracted_name_;
+  const std::shared_ptr<const std::vector<Tag>> tags_;
 };
 
 } // namespace Stats
@@ -5,29 +5,79 @@
 namespace Envoy {
 namespace Stats {
 
-std::vector<CounterSharedPtr>& SourceImpl::cachedCounters() {
+namespace {
+
+template <class StatType>
+std::vector<std::shared_ptr<StatType>>
+collectChanged(const std::vector<std::shared_ptr<StatType>>& stats) {
+  std::vector<std::shared_ptr<StatType>> changed;
+  for (const std::shared_ptr<StatType>& stat : stats) {
+    if (stat->latchChanged()) {
+      changed.push_back(stat);
+    }
+  }
+  return changed;
+}
+
+} // namespace
+
+const std::vector<CounterSharedPtr>& SourceImpl::cachedCounters() {
+  refreshIfStale();
   if (!counters_) {
     counters_ = store_.counters();
   }
   return *counters_;
 }
-std::vector<GaugeSharedPtr>& SourceImpl::cachedGauges() {
+const std::vector<GaugeSharedPtr>& SourceImpl::cachedGauges() {
+  refreshIfStale();
   if (!gauges_) {
     gauges_ = store_.gauges();
   }
   return *gauges_;
 }
-std::vector<ParentHistogramSharedPtr>& SourceImpl::cachedHistograms() {
+const std::vector<ParentHistogramSharedPtr>& SourceImpl::cachedHistograms() {
+  refreshIfStale();
   if (!histograms_) {
     histograms_ = store_.histograms();
   }
   return *histograms_;
 }
 
+const std::vector<CounterSharedPtr>& SourceImpl::changedCounters() {
+  if (!changed_counters_) {
+    changed_counters_ = collectChanged(cachedCounters());
+  }
+  return *changed_counters_;
+}
+
+const std::vector<GaugeSharedPtr>& SourceImpl::changedGauges() {
+  if (!changed_gauges_) {
+    changed_gauges_ = collectChanged(cachedGauges());
+  }
+  return *changed_gauges_;
+}
+
 void SourceImpl::clearCache() {
-  counters_.reset();
-  gauges_.reset();
-  histograms_.reset();
+  changed_counters_.reset();
+  changed_gauges_.reset();
+  if (!retain_snapshots_) {
+    counters_.reset();
+    gauges_.reset();
+    histograms_.reset();
+  }
+  snapshots_in_use_ = false;
+}
+
+void SourceImpl::refreshIfStale() {
+  // References to the snapshots handed out since the last clearCache() must stay valid, so a
+  // refresh only happens on the first access of a cache lifetime. The flag is cleared before the
+  // store is read again, so no change can be missed.
+  if (retain_snapshots_ && !snapshots_in_use_ && stale_.exchange(false)) {
+    counters_.reset();
+    gauges_.reset();
+    histograms_.reset();
+  }
+  snapshots_in_use_ = true;
 }
 
 } // namespace Stats
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "envoy/stats/source.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/store.h"
@@ -9,21 +11,55 @@
 namespace Envoy {
 namespace Stats {
 
+/**
+ * Source implementation that snapshots the stats of a store on demand.
+ *
+ * By default the snapshots are dropped by every clearCache(), so that they don't keep the stats of
+ * destroyed scopes alive. A store that reports changes to its set of stats through markStale() can
+ * instead have them retained across flushes, so that a flush of the changed stats of a large,
+ * mostly idle set of stats only walks the snapshots rather than rebuilding them.
+ */
 class SourceImpl : public Source {
 public:
-  SourceImpl(Store& store) : store_(store){};
+  /**
+   * @param store the store to snapshot.
+   * @param retain_snapshots whether the snapshots of all stats are kept until markStale() is
+   *     called, rather than until the next clearCache().
+   */
+  SourceImpl(Store& store, bool retain_snapshots = false)
+      : store_(store), retain_snapshots_(retain_snapshots){};
+
+  /**
+   * Keeps the snapshots of all stats until markStale() is called from now on.
+   */
+  void retainSnapshots() { retain_snapshots_ = true; }
 
   // Stats::Source
-  std::vector<CounterSharedPtr>& cachedCounters() override;
-  std::vector<GaugeSharedPtr>& cachedGauges() override;
-  std::vector<ParentHistogramSharedPtr>& cachedHistograms() override;
+  const std::vector<CounterSharedPtr>& cachedCounters() override;
+  const std::vector<GaugeSharedPtr>& cachedGauges() override;
+  const std::vector<ParentHistogramSharedPtr>& cachedHistograms() override;
+  const std::vector<CounterSharedPtr>& changedCounters() override;
+  const std::vector<GaugeSharedPtr>& changedGauges() override;
   void clearCache() override;
 
+  /**
+   * Records that stats were added to or removed from the store, so that retained snapshots are
+   * refreshed by the next flush. This may be called from any thread.
+   */
+  void markStale() { stale_ = true; }
+
 private:
+  void refreshIfStale();
+
   Store& store_;
+  bool retain_snapshots_;
+  std::atomic<bool> stale_{true};
+  bool snapshots_in_use_{false};
   absl::optional<std::vector<CounterSharedPtr>> counters_;
   absl::optional<std::vector<GaugeSharedPtr>> gauges_;
   absl::optional<std::vector<ParentHistogramSharedPtr>> histograms_;
+  absl::optional<std::vector<CounterSharedPtr>> changed_counters_;
+  absl::optional<std::vector<GaugeSharedPtr>> changed_gauges_;
 };
 
 } // namespace Stats
@@ -62,8 +62,8 @@ public:
 template <class StatData> class CounterImpl : public Counter, public MetricImpl {
 public:
   CounterImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
-              std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), data_(data), alloc_(alloc) {}
+              const std::string& tag_extracted_name, const std::vector<Tag>& tags)
+      : MetricImpl(tag_extracted_name, tags), data_(data), alloc_(alloc) {}
   ~CounterImpl() { alloc_.free(data_); }
 
   // Stats::Metric
@@ -73,7 +73,7 @@ public:
   void add(uint64_t amount) override {
     data_.value_ += amount;
     data_.pending_increment_ += amount;
-    data_.flags_ |= Flags::Used;
+    data_.flags_ |= Flags::Used | Flags::Changed;
   }
 
   void inc() override { add(1); }
@@ -81,6 +81,7 @@ public:
   void reset() override { data_.value_ = 0; }
   bool used() const override { return data_.flags_ & Flags::Used; }
   uint64_t value() const override { return data_.value_; }
+  bool latchChanged() override { return clearChangedFlag(data_.flags_); }
 
 private:
   StatData& data_;
@@ -93,8 +94,8 @@ private:
 template <class StatData> class GaugeImpl : public Gauge, public MetricImpl {
 public:
   GaugeImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
-            std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), data_(data), alloc_(alloc) {}
+            const std::string& tag_extracted_name, const std::vector<Tag>& tags)
+      : MetricImpl(tag_extracted_name, tags), data_(data), alloc_(alloc) {}
   ~GaugeImpl() { alloc_.free(data_); }
 
   // Stats::Metric
@@ -103,21 +104,23 @@ public:
   // Stats::Gauge
   virtual void add(uint64_t amount) override {
     data_.value_ += amount;
-    data_.flags_ |= Flags::Used;
+    data_.flags_ |= Flags::Used | Flags::Changed;
   }
   virtual void dec() override { sub(1); }
   virtual void inc() override { add(1); }
   virtual void set(uint64_t value) override {
     data_.value_ = value;
-    data_.flags_ |= Flags::Used;
+    data_.flags_ |= Flags::Used | Flags::Changed;
   }
   virtual void sub(uint64_t amount) override {
     ASSERT(data_.value_ >= amount);
     ASSERT(used());
     data_.value_ -= amount;
+    data_.flags_ |= Flags::Changed;
   }
   virtual uint64_t value() const override { return data_.value_; }
   bool used() const override { return data_.flags_ & Flags::Used; }
+  bool latchChanged() override { return clearChangedFlag(data_.flags_); }
 
 private:
   StatData& data_;
@@ -132,8 +135,7 @@ CounterSharedPtr StatDataAllocatorImpl<StatData>::makeCounter(absl::string_view
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<CounterImpl<StatData>>(*data, *this, std::move(tag_extracted_name),
-                                                 std::move(tags));
+  return std::make_shared<CounterImpl<StatData>>(*data, *this, tag_extracted_name, tags);
 }
 
 template <class StatData>
@@ -144,8 +146,7 @@ GaugeSharedPtr StatDataAllocatorImpl<StatData>::makeGauge(absl::string_view name
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<GaugeImpl<StatData>>(*data, *this, std::move(tag_extracted_name),
-                                               std::move(tags));
+  return std::make_shared<GaugeImpl<StatData>>(*data, *this, tag_extracted_name, tags);
 }
 
 } // namespace Stats
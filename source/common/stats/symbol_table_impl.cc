@@ -9,41 +9,96 @@
 namespace Envoy {
 namespace Stats {
 
+namespace {
+
+// Symbols are written as base-128 varints: 7 bits per byte, least significant group first, with
+// the high bit set on every byte but the last.
+void appendVarint(uint64_t value, std::string& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+uint64_t readVarint(absl::string_view& in) {
+  uint64_t value = 0;
+  for (uint32_t shift = 0;; shift += 7) {
+    RELEASE_ASSERT(!in.empty(), "truncated stat name encoding");
+    const uint8_t byte = static_cast<uint8_t>(in.front());
+    in.remove_prefix(1);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+}
+
+} // namespace
+
 // TODO(ambuc): There is a possible performance optimization here for avoiding the encoding of IPs,
 // if they appear in stat names. We don't want to waste time symbolizing an integer as an integer,
 // if we can help it.
 StatNamePtr SymbolTableImpl::encode(const absl::string_view name) {
-  SymbolVec symbol_vec;
-  std::vector<absl::string_view> name_vec = absl::StrSplit(name, '.');
-  symbol_vec.reserve(name_vec.size());
-  std::transform(name_vec.begin(), name_vec.end(), std::back_inserter(symbol_vec),
-                 [this](absl::string_view x) { return toSymbol(x); });
+  return std::make_unique<StatNameImpl>(name, *this);
+}
+
+void SymbolTableImpl::encodeInto(absl::string_view name, std::string& encoding) {
+  const std::vector<absl::string_view> name_vec = absl::StrSplit(name, '.');
+  absl::MutexLock lock(&lock_);
+  for (absl::string_view segment : name_vec) {
+    appendVarint(toSymbol(segment), encoding);
+  }
+}
+
+bool SymbolTableImpl::lookup(absl::string_view name, std::string& encoding) const {
+  const std::vector<absl::string_view> name_vec = absl::StrSplit(name, '.');
+  encoding.clear();
+  absl::ReaderMutexLock lock(&lock_);
+  for (absl::string_view segment : name_vec) {
+    auto encode_find = encode_map_.find(segment);
+    if (encode_find == encode_map_.end()) {
+      return false;
+    }
+    appendVarint(encode_find->second.symbol_, encoding);
+  }
+  return true;
+}
 
-  return std::make_unique<StatNameImpl>(symbol_vec, *this);
+std::string SymbolTableImpl::decode(absl::string_view encoding) const {
+  return decode(decodeSymbols(encoding));
 }
 
 std::string SymbolTableImpl::decode(const SymbolVec& symbol_vec) const {
   std::vector<absl::string_view> name;
   name.reserve(symbol_vec.size());
-  std::transform(symbol_vec.begin(), symbol_vec.end(), std::back_inserter(name),
-                 [this](Symbol x) { return fromSymbol(x); });
+  for (const Symbol symbol : symbol_vec) {
+    name.push_back(segments_.get(symbol));
+  }
   return absl::StrJoin(name, ".");
 }
 
-void SymbolTableImpl::free(const SymbolVec& symbol_vec) {
-  for (const Symbol symbol : symbol_vec) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
+SymbolVec SymbolTableImpl::decodeSymbols(absl::string_view encoding) {
+  SymbolVec symbol_vec;
+  while (!encoding.empty()) {
+    symbol_vec.push_back(static_cast<Symbol>(readVarint(encoding)));
+  }
+  return symbol_vec;
+}
 
-    auto encode_search = encode_map_.find(decode_search->second);
+void SymbolTableImpl::free(absl::string_view encoding) {
+  const SymbolVec symbol_vec = decodeSymbols(encoding);
+  absl::MutexLock lock(&lock_);
+  for (const Symbol symbol : symbol_vec) {
+    auto encode_search = encode_map_.find(segments_.get(symbol));
     ASSERT(encode_search != encode_map_.end());
 
     encode_search->second.ref_count_--;
     // If that was the last remaining client usage of the symbol, erase the the current
     // mappings and add the now-unused symbol to the reuse pool.
     if (encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
       encode_map_.erase(encode_search);
+      segments_.erase(symbol);
       pool_.push(symbol);
     }
   }
@@ -54,15 +109,12 @@ Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
   auto encode_find = encode_map_.find(sv);
   // If the string segment doesn't already exist,
   if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert a string_view
+    // We create the actual string, place it in the segments_, and then insert a string_view
     // pointing to it in the encode_map_. This allows us to only store the string once.
-    std::string str = std::string(sv);
+    const std::string& segment = segments_.set(next_symbol_, std::string(sv));
 
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
-
-    auto encode_insert = encode_map_.insert(
-        {decode_insert.first->second, {.symbol_ = next_symbol_, .ref_count_ = 1}});
+    auto encode_insert =
+        encode_map_.insert({segment, {.symbol_ = next_symbol_, .ref_count_ = 1}});
     ASSERT(encode_insert.second);
 
     result = next_symbol_;
@@ -76,10 +128,49 @@ Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
   return result;
 }
 
-absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const {
-  auto search = decode_map_.find(symbol);
-  ASSERT(search != decode_map_.end());
-  return search->second;
+SymbolTableImpl::SegmentTable::~SegmentTable() {
+  for (uint32_t block = 0; block < NumBlocks; block++) {
+    Slot* slots = blocks_[block].load(std::memory_order_relaxed);
+    if (slots == nullptr) {
+      continue;
+    }
+    for (uint64_t i = 0; i < (FirstBlockSize << block); i++) {
+      delete slots[i].load(std::memory_order_relaxed);
+    }
+    delete[] slots;
+  }
+}
+
+absl::string_view SymbolTableImpl::SegmentTable::get(const Symbol symbol) const {
+  uint32_t block;
+  const uint64_t index = locate(symbol, block);
+  const Slot* slots = blocks_[block].load(std::memory_order_acquire);
+  RELEASE_ASSERT(slots != nullptr, "decoding an unknown stat name symbol");
+  const std::string* segment = slots[index].load(std::memory_order_acquire);
+  RELEASE_ASSERT(segment != nullptr, "decoding an unknown stat name symbol");
+  return *segment;
+}
+
+const std::string& SymbolTableImpl::SegmentTable::set(const Symbol symbol,
+                                                      std::string&& segment) {
+  uint32_t block;
+  const uint64_t index = locate(symbol, block);
+  Slot* slots = blocks_[block].load(std::memory_order_relaxed);
+  if (slots == nullptr) {
+    slots = new Slot[FirstBlockSize << block]();
+    blocks_[block].store(slots, std::memory_order_release);
+  }
+  ASSERT(slots[index].load(std::memory_order_relaxed) == nullptr);
+  const std::string* stored = new std::string(std::move(segment));
+  slots[index].store(stored, std::memory_order_release);
+  return *stored;
+}
+
+void SymbolTableImpl::SegmentTable::erase(const Symbol symbol) {
+  uint32_t block;
+  const uint64_t index = locate(symbol, block);
+  delete blocks_[block].load(std::memory_order_relaxed)[index].exchange(
+      nullptr, std::memory_order_relaxed);
 }
 
 } // namespace Stats
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
-#include <stack>
+#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -11,10 +14,12 @@
 #include "envoy/stats/symbol_table.h"
 
 #include "common/common/assert.h"
+#include "common/common/thread_annotations.h"
 #include "common/common/utility.h"
 
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -29,17 +34,65 @@ using SymbolVec = std::vector<Symbol>;
  * effect of the non-monotonically-increasing symbol counter is that if a string is encoded, the
  * resulting stat is destroyed, and then that same string is re-encoded, it may or may not encode to
  * the same underlying symbol.
+ *
+ * An encoded name is a byte string holding each of its symbols as a base-128 varint, so a name
+ * made of commonly used segments costs one or two bytes per segment. Since symbols are recycled
+ * from the smallest freed ones, encodings stay short in steady state and usually fit within the
+ * small-string buffer of a std::string. Two encodings from the same table are equal iff they
+ * encode the same name, so they can be hashed and compared as plain strings.
+ *
+ * The table is thread-safe. Encoding a name takes the table's lock exclusively, as it updates the
+ * symbol reference counts, and lookup() takes it shared. Decoding doesn't take it at all, so that
+ * sinks and the admin handlers reading the names of many stats on every flush neither contend
+ * with each other nor with stat creation.
  */
 class SymbolTableImpl : public SymbolTable {
 public:
+  // Stats::SymbolTable
   StatNamePtr encode(absl::string_view name) override;
 
   // For testing purposes only.
   size_t size() const override {
-    ASSERT(encode_map_.size() == decode_map_.size());
+    absl::ReaderMutexLock lock(&lock_);
     return encode_map_.size();
   }
 
+  /**
+   * Appends the encoding of a name to a string, taking a reference on each of its symbols. The
+   * references must be released by passing the appended bytes to free().
+   *
+   * @param name the stat name to encode.
+   * @param encoding the string to append the encoding to.
+   */
+  void encodeInto(absl::string_view name, std::string& encoding);
+
+  /**
+   * Computes the encoding of a name without taking references on its symbols, so that it can be
+   * used as a key to find an encoding held elsewhere.
+   *
+   * @param name the stat name to look up.
+   * @param encoding receives the encoding.
+   * @return bool false if some segment of the name has no symbol, in which case nothing can
+   *         currently be holding an encoding of the name.
+   */
+  bool lookup(absl::string_view name, std::string& encoding) const;
+
+  /**
+   * Decodes an encoded name back into its period-delimited stat name.
+   * @param encoding an encoding obtained from encodeInto() whose references are still held.
+   * @return std::string the retrieved stat name.
+   */
+  std::string decode(absl::string_view encoding) const;
+
+  /**
+   * Since SymbolTableImpl does manual reference counting, a client of SymbolTable (such as
+   * StatName) must manually call free() when it is freeing the stat it represents. This
+   * way, the symbol table will grow and shrink dynamically, instead of being write-only.
+   *
+   * @param encoding an encoding obtained from encodeInto().
+   */
+  void free(absl::string_view encoding);
+
 private:
   friend class StatNameImpl;
   friend class StatNameTest;
@@ -49,6 +102,62 @@ private:
     uint32_t ref_count_;
   };
 
+  /**
+   * The segments of the table indexed by symbol, readable without a lock. Block k holds the
+   * FirstBlockSize << k symbols following those of the blocks before it, so the table grows
+   * without ever moving a slot. Slots are only written under the table's lock, and a slot isn't
+   * cleared while any encoding holds a reference to its symbol, so a reader decoding an encoding
+   * it holds always finds its segments.
+   */
+  class SegmentTable {
+  public:
+    SegmentTable() = default;
+    SegmentTable(const SegmentTable&) = delete;
+    SegmentTable& operator=(const SegmentTable&) = delete;
+    ~SegmentTable();
+
+    /**
+     * @param symbol a symbol referenced by the caller.
+     * @return absl::string_view the segment of the symbol.
+     */
+    absl::string_view get(Symbol symbol) const;
+
+    /**
+     * Stores the segment of a new symbol. Must be called under the table's lock.
+     * @param symbol the new symbol.
+     * @param segment the segment, owned by the table until the symbol is erased.
+     * @return const std::string& the stored segment.
+     */
+    const std::string& set(Symbol symbol, std::string&& segment);
+
+    /**
+     * Erases the segment of a symbol no longer referenced. Must be called under the table's lock.
+     * @param symbol the symbol to erase.
+     */
+    void erase(Symbol symbol);
+
+  private:
+    static const uint32_t FirstBlockBits = 6;
+    static const uint64_t FirstBlockSize = 1 << FirstBlockBits;
+    // Enough blocks to hold every Symbol.
+    static const uint32_t NumBlocks = 32;
+
+    typedef std::atomic<const std::string*> Slot;
+
+    /**
+     * @param symbol a symbol.
+     * @param block receives the index of the block of the symbol.
+     * @return uint64_t the index of the symbol within its block.
+     */
+    static uint64_t locate(Symbol symbol, uint32_t& block) {
+      const uint64_t index = static_cast<uint64_t>(symbol) + FirstBlockSize;
+      block = 63 - __builtin_clzll(index) - FirstBlockBits;
+      return index - (FirstBlockSize << block);
+    }
+
+    std::array<std::atomic<Slot*>, NumBlocks> blocks_{};
+  };
+
   /**
    * Decodes a vector of symbols back into its period-delimited stat name.
    * If decoding fails on any part of the symbol_vec, we release_assert and crash hard, since this
@@ -60,13 +169,10 @@ private:
   std::string decode(const SymbolVec& symbol_vec) const;
 
   /**
-   * Since SymbolTableImpl does manual reference counting, a client of SymbolTable (such as
-   * StatName) must manually call free(symbol_vec) when it is freeing the stat it represents. This
-   * way, the symbol table will grow and shrink dynamically, instead of being write-only.
-   *
-   * @param symbol_vec the vector of symbols to be freed.
+   * @param encoding an encoded name.
+   * @return SymbolVec the symbols making up the encoding.
    */
-  void free(const SymbolVec& symbol_vec);
+  static SymbolVec decodeSymbols(absl::string_view encoding);
 
   /**
    * Convenience function for encode(), symbolizing one string segment at a time.
@@ -74,18 +180,10 @@ private:
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv);
-
-  /**
-   * Convenience function for decode(), decoding one symbol at a time.
-   *
-   * @param symbol the individual symbol to be decoded.
-   * @return absl::string_view the decoded string.
-   */
-  absl::string_view fromSymbol(Symbol symbol) const;
+  Symbol toSymbol(absl::string_view sv) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Stages a new symbol for use. To be called after a successful insertion.
-  void newSymbol() {
+  void newSymbol() EXCLUSIVE_LOCKS_REQUIRED(lock_) {
     if (pool_.empty()) {
       next_symbol_ = ++monotonic_counter_;
     } else {
@@ -96,25 +194,32 @@ private:
     ASSERT(monotonic_counter_ != 0);
   }
 
-  Symbol monotonicCounter() { return monotonic_counter_; }
+  Symbol monotonicCounter() {
+    absl::ReaderMutexLock lock(&lock_);
+    return monotonic_counter_;
+  }
+
+  mutable absl::Mutex lock_;
 
   // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
   // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ = 0;
+  Symbol next_symbol_ GUARDED_BY(lock_) = 0;
 
   // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_ = 0;
+  Symbol monotonic_counter_ GUARDED_BY(lock_) = 0;
 
   // Bimap implementation.
   // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  std::unordered_map<absl::string_view, SharedSymbol, StringViewHash> encode_map_;
-  std::unordered_map<Symbol, std::string> decode_map_;
+  // Using absl::string_view lets us only store the complete string once, in the segment table.
+  std::unordered_map<absl::string_view, SharedSymbol, StringViewHash>
+      encode_map_ GUARDED_BY(lock_);
+  SegmentTable segments_;
 
-  // Free pool of symbols for re-use.
+  // Free pool of symbols for re-use. Smallest symbols are reused first as they have the shortest
+  // encodings.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_;
+  std::priority_queue<Symbol, std::vector<Symbol>, std::greater<Symbol>> pool_ GUARDED_BY(lock_);
 };
 
 /**
@@ -123,16 +228,37 @@ private:
  */
 class StatNameImpl : public StatName {
 public:
-  StatNameImpl(SymbolVec symbol_vec, SymbolTableImpl& symbol_table)
-      : symbol_vec_(symbol_vec), symbol_table_(symbol_table) {}
-  ~StatNameImpl() override { symbol_table_.free(symbol_vec_); }
-  std::string toString() const override { return symbol_table_.decode(symbol_vec_); }
+  StatNameImpl(absl::string_view name, SymbolTableImpl& symbol_table)
+      : symbol_table_(&symbol_table) {
+    symbol_table.encodeInto(name, encoding_);
+  }
+  StatNameImpl(StatNameImpl&& src) noexcept
+      : encoding_(std::move(src.encoding_)), symbol_table_(src.symbol_table_) {
+    src.symbol_table_ = nullptr;
+  }
+  StatNameImpl(const StatNameImpl&) = delete;
+  StatNameImpl& operator=(const StatNameImpl&) = delete;
+  ~StatNameImpl() override {
+    if (symbol_table_ != nullptr) {
+      symbol_table_->free(encoding_);
+    }
+  }
+
+  // Stats::StatName
+  std::string toString() const override { return symbol_table_->decode(encoding_); }
+
+  /**
+   * @return const std::string& the encoded name, suitable for use as a map key among names
+   *         encoded by the same table.
+   */
+  const std::string& encoding() const { return encoding_; }
 
 private:
   friend class StatNameTest;
-  SymbolVec symbolVec() { return symbol_vec_; }
-  SymbolVec symbol_vec_;
-  SymbolTableImpl& symbol_table_;
+  SymbolVec symbolVec() const { return SymbolTableImpl::decodeSymbols(encoding_); }
+
+  std::string encoding_;
+  SymbolTableImpl* symbol_table_;
 };
 
 } // namespace Stats
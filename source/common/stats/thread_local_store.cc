@@ -22,10 +22,12 @@ namespace Envoy {
 namespace Stats {
 
 ThreadLocalStoreImpl::ThreadLocalStoreImpl(const StatsOptions& stats_options,
-                                           StatDataAllocator& alloc)
-    : stats_options_(stats_options), alloc_(alloc), default_scope_(createScope("")),
-      tag_producer_(std::make_unique<TagProducerImpl>()),
-      num_last_resort_stats_(default_scope_->counter("stats.overflow")), source_(*this) {}
+                                           StatDataAllocator& alloc,
+                                           SymbolTableImpl& symbol_table)
+    : stats_options_(stats_options), alloc_(alloc), symbol_table_(symbol_table),
+      heap_allocator_(symbol_table), source_(*this),
+      default_scope_(createScope("")), tag_producer_(std::make_unique<TagProducerImpl>()),
+      num_last_resort_stats_(default_scope_->counter("stats.overflow")) {}
 
 ThreadLocalStoreImpl::~ThreadLocalStoreImpl() {
   ASSERT(shutting_down_);
@@ -39,9 +41,12 @@ std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
   std::unordered_set<std::string> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
-    for (auto& counter : scope->central_cache_.counters_) {
-      if (names.insert(counter.first).second) {
-        ret.push_back(counter.second);
+    for (const CentralCacheShard& shard : scope->central_cache_.shards_) {
+      absl::ReaderMutexLock shard_lock(&shard.mutex_);
+      for (auto& counter : shard.counters_) {
+        if (names.insert(counter.first).second) {
+          ret.push_back(counter.second);
+        }
       }
     }
   }
@@ -62,9 +67,12 @@ std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
   std::unordered_set<std::string> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
-    for (auto& gauge : scope->central_cache_.gauges_) {
-      if (names.insert(gauge.first).second) {
-        ret.push_back(gauge.second);
+    for (const CentralCacheShard& shard : scope->central_cache_.shards_) {
+      absl::ReaderMutexLock shard_lock(&shard.mutex_);
+      for (auto& gauge : shard.gauges_) {
+        if (names.insert(gauge.first).second) {
+          ret.push_back(gauge.second);
+        }
       }
     }
   }
@@ -81,9 +89,12 @@ std::vector<ParentHistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
   // in histograms with duplicate names, but until shared storage is implemented it's ultimately
   // less confusing for users who have such configs.
   for (ScopeImpl* scope : scopes_) {
-    for (const auto& name_histogram_pair : scope->central_cache_.histograms_) {
-      const ParentHistogramSharedPtr& parent_hist = name_histogram_pair.second;
-      ret.push_back(parent_hist);
+    for (const CentralCacheShard& shard : scope->central_cache_.shards_) {
+      absl::ReaderMutexLock shard_lock(&shard.mutex_);
+      for (const auto& name_histogram_pair : shard.histograms_) {
+        const ParentHistogramSharedPtr& parent_hist = name_histogram_pair.second;
+        ret.push_back(parent_hist);
+      }
     }
   }
 
@@ -139,6 +150,7 @@ void ThreadLocalStoreImpl::releaseScopeCrossThread(ScopeImpl* scope) {
   Thread::LockGuard lock(lock_);
   ASSERT(scopes_.count(scope) == 1);
   scopes_.erase(scope);
+  source_.markStale();
 
   // This can happen from any thread. We post() back to the main thread which will initiate the
   // cache flush operation.
@@ -185,26 +197,56 @@ absl::string_view ThreadLocalStoreImpl::truncateStatNameIfNeeded(absl::string_vi
 
 std::atomic<uint64_t> ThreadLocalStoreImpl::ScopeImpl::next_scope_id_;
 
-ThreadLocalStoreImpl::ScopeImpl::~ScopeImpl() { parent_.releaseScopeCrossThread(this); }
+ThreadLocalStoreImpl::ScopeImpl::~ScopeImpl() {
+  parent_.releaseScopeCrossThread(this);
+  for (CentralCacheShard& shard : central_cache_.shards_) {
+    shard.freeNames(parent_.symbolTable());
+  }
+}
+
+void ThreadLocalStoreImpl::CentralCacheShard::freeNames(SymbolTableImpl& symbol_table) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& counter : counters_) {
+    symbol_table.free(counter.first);
+  }
+  for (const auto& gauge : gauges_) {
+    symbol_table.free(gauge.first);
+  }
+  for (const auto& histogram : histograms_) {
+    symbol_table.free(histogram.first);
+  }
+}
 
 template <class StatType>
 StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
-    const std::string& name,
-    std::unordered_map<std::string, std::shared_ptr<StatType>>& central_cache_map,
-    MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref) {
-
-  // If we have a valid cache entry, return it.
-  if (tls_ref && *tls_ref) {
-    return **tls_ref;
+    const std::string& name, StatMap<StatType> CentralCacheShard::*central_cache_map,
+    MakeStatFn<StatType> make_stat, TlsStatMap<StatType>* tls_cache) {
+
+  // If we have a valid cache entry, return it. The TLS cache is keyed by the plain name, so a hit
+  // never touches the symbol table.
+  if (tls_cache) {
+    auto it = tls_cache->find(name);
+    if (it != tls_cache->end()) {
+      return *it->second;
+    }
   }
 
-  // We must now look in the central store so we must be locked. We grab a reference to the
-  // central store location. It might contain nothing. In this case, we allocate a new stat.
-  Thread::LockGuard lock(parent_.lock_);
-  std::shared_ptr<StatType>& central_ref = central_cache_map[name];
+  // Look in the central store. Only the shard holding the name is locked, and only for reading,
+  // so threads resolving stats that already exist never wait on each other. If some segment of
+  // the name has never been symbolized, the stat can't exist yet.
+  SymbolTableImpl& symbol_table = parent_.symbolTable();
+  std::string encoding;
+  std::shared_ptr<StatType> central_ref;
+  if (symbol_table.lookup(name, encoding)) {
+    central_ref = central_cache_.shard(encoding).find(central_cache_map, encoding);
+  }
   if (!central_ref) {
     std::vector<Tag> tags;
 
+    // Tag extraction and allocation are the expensive part of making a stat, so they run without
+    // holding the shard lock. If two threads race to make the same stat, both allocations resolve
+    // to the same backing data, and the loser's copy is dropped by insert().
+    //
     // Tag extraction occurs on the original, untruncated name so the extraction
     // can complete properly, even if the tag values are partially truncated.
     std::string tag_extracted_name = parent_.getTagsForName(name, tags);
@@ -217,15 +259,21 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
                        std::move(tags));
       ASSERT(stat != nullptr);
     }
-    central_ref = stat;
+    encoding.clear();
+    symbol_table.encodeInto(name, encoding);
+    CentralCacheShard& shard = central_cache_.shard(encoding);
+    central_ref =
+        shard.insert(central_cache_map, std::move(encoding), std::move(stat), symbol_table);
+    parent_.source_.markStale();
   }
 
-  // If we have a TLS location to store or allocation into, do it.
-  if (tls_ref) {
-    *tls_ref = central_ref;
+  // If we have a TLS cache to store the allocation into, do it.
+  if (tls_cache) {
+    tls_cache->emplace(name, central_ref);
   }
 
-  // Finally we return the reference.
+  // Finally we return the reference. The central cache keeps the stat alive for the lifetime of
+  // the scope.
   return *central_ref;
 }
 
@@ -233,22 +281,20 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
   // Determine the final name based on the prefix and the passed name.
   std::string final_name = prefix_ + name;
 
-  // We now try to acquire a *reference* to the TLS cache shared pointer. This might remain null
-  // if we don't have TLS initialized currently. The de-referenced pointer might be null if there
-  // is no cache entry.
-  CounterSharedPtr* tls_ref = nullptr;
+  // We now try to acquire a pointer to the TLS cache of the scope. This might remain null if we
+  // don't have TLS initialized currently.
+  TlsStatMap<Counter>* tls_cache = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref =
-        &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].counters_[final_name];
+    tls_cache = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].counters_;
   }
 
   return safeMakeStat<Counter>(
-      final_name, central_cache_.counters_,
+      final_name, &CentralCacheShard::counters_,
       [](StatDataAllocator& allocator, absl::string_view name, std::string&& tag_extracted_name,
          std::vector<Tag>&& tags) -> CounterSharedPtr {
         return allocator.makeCounter(name, std::move(tag_extracted_name), std::move(tags));
       },
-      tls_ref);
+      tls_cache);
 }
 
 void ThreadLocalStoreImpl::ScopeImpl::deliverHistogramToSinks(const Histogram& histogram,
@@ -271,70 +317,85 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
   std::string final_name = prefix_ + name;
-  GaugeSharedPtr* tls_ref = nullptr;
+  TlsStatMap<Gauge>* tls_cache = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].gauges_[final_name];
+    tls_cache = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].gauges_;
   }
 
   return safeMakeStat<Gauge>(
-      final_name, central_cache_.gauges_,
+      final_name, &CentralCacheShard::gauges_,
       [](StatDataAllocator& allocator, absl::string_view name, std::string&& tag_extracted_name,
          std::vector<Tag>&& tags) -> GaugeSharedPtr {
         return allocator.makeGauge(name, std::move(tag_extracted_name), std::move(tags));
       },
-      tls_ref);
+      tls_cache);
 }
 
 Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
   std::string final_name = prefix_ + name;
-  ParentHistogramSharedPtr* tls_ref = nullptr;
+  TlsStatMap<ParentHistogramImpl>* tls_cache = nullptr;
 
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>()
-                   .scope_cache_[this->scope_id_]
-                   .parent_histograms_[final_name];
+    tls_cache =
+        &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].parent_histograms_;
   }
 
-  if (tls_ref && *tls_ref) {
-    return **tls_ref;
+  if (tls_cache) {
+    auto it = tls_cache->find(final_name);
+    if (it != tls_cache->end()) {
+      return *it->second;
+    }
   }
 
-  Thread::LockGuard lock(parent_.lock_);
-  ParentHistogramImplSharedPtr& central_ref = central_cache_.histograms_[final_name];
+  SymbolTableImpl& symbol_table = parent_.symbolTable();
+  std::string encoding;
+  ParentHistogramImplSharedPtr central_ref;
+  if (symbol_table.lookup(final_name, encoding)) {
+    central_ref = central_cache_.shard(encoding).find(&CentralCacheShard::histograms_, encoding);
+  }
   if (!central_ref) {
     std::vector<Tag> tags;
     std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
-    central_ref.reset(new ParentHistogramImpl(final_name, parent_, *this,
-                                              std::move(tag_extracted_name), std::move(tags)));
+    auto histogram = std::make_shared<ParentHistogramImpl>(
+        final_name, parent_, *this, tag_extracted_name, tags, symbol_table,
+        parent_.stats_options_.logLinearHistograms());
+    encoding.clear();
+    symbol_table.encodeInto(final_name, encoding);
+    CentralCacheShard& shard = central_cache_.shard(encoding);
+    central_ref = shard.insert(&CentralCacheShard::histograms_, std::move(encoding),
+                               std::move(histogram), symbol_table);
+    parent_.source_.markStale();
   }
 
-  if (tls_ref) {
-    *tls_ref = central_ref;
+  if (tls_cache) {
+    tls_cache->emplace(std::move(final_name), central_ref);
   }
   return *central_ref;
 }
 
-Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name,
-                                                         ParentHistogramImpl& parent) {
+Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(ParentHistogramImpl& parent) {
   // See comments in counter() which explains the logic here.
 
   // Here prefix will not be considered because, by the time ParentHistogram calls this method
-  // during recordValue, the prefix is already attached to the name.
+  // during recordValue, the prefix is already attached to its name.
   TlsHistogramSharedPtr* tls_ref = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].histograms_[name];
+    tls_ref = &parent_.tls_->getTyped<TlsCache>()
+                   .scope_cache_[this->scope_id_]
+                   .histograms_[parent.encodedName()];
   }
 
   if (tls_ref && *tls_ref) {
     return **tls_ref;
   }
 
-  std::vector<Tag> tags;
-  std::string tag_extracted_name = parent_.getTagsForName(name, tags);
+  // The tags were already extracted for the parent, so they are shared rather than extracted
+  // again on every thread.
   TlsHistogramSharedPtr hist_tls_ptr = std::make_shared<ThreadLocalHistogramImpl>(
-      name, std::move(tag_extracted_name), std::move(tags));
+      parent.name(), parent.tagExtractedName(), parent.tags(), parent_.symbolTable(),
+      parent.logLinear());
 
   parent.addTlsHistogram(hist_tls_ptr);
 
@@ -345,46 +406,51 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name
 }
 
 ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(const std::string& name,
-                                                   std::string&& tag_extracted_name,
-                                                   std::vector<Tag>&& tags)
-    : MetricImpl(std::move(tag_extracted_name), std::move(tags)), current_active_(0), flags_(0),
-      created_thread_id_(std::this_thread::get_id()), name_(name) {
-  histograms_[0] = hist_alloc();
-  histograms_[1] = hist_alloc();
-}
-
-ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
-  hist_free(histograms_[0]);
-  hist_free(histograms_[1]);
-}
+                                                   const std::string& tag_extracted_name,
+                                                   const std::vector<Tag>& tags,
+                                                   SymbolTableImpl& symbol_table, bool log_linear)
+    : MetricImpl(tag_extracted_name, tags), current_active_(0),
+      histograms_{HistogramBuckets(log_linear), HistogramBuckets(log_linear)}, flags_(0),
+      created_thread_id_(std::this_thread::get_id()), name_(name, symbol_table) {}
 
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
-  hist_insert_intscale(histograms_[current_active_], value, 0, 1);
-  flags_ |= Flags::Used;
+  histograms_[current_active_.load(std::memory_order_relaxed)].recordValue(value);
+  // Avoid a locked read-modify-write on every value once the flag is set.
+  if (!(flags_.load(std::memory_order_relaxed) & Flags::Used)) {
+    flags_ |= Flags::Used;
+  }
 }
 
-void ThreadLocalHistogramImpl::merge(histogram_t* target) {
-  histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
-  hist_accumulate(target, other_histogram, 1);
-  hist_clear(*other_histogram);
+void ThreadLocalHistogramImpl::merge(HistogramBuckets& target) {
+  HistogramBuckets& other_histogram = histograms_[otherHistogramIndex()];
+  target.merge(other_histogram);
+  other_histogram.clear();
 }
 
 ParentHistogramImpl::ParentHistogramImpl(const std::string& name, Store& parent,
-                                         TlsScope& tls_scope, std::string&& tag_extracted_name,
-                                         std::vector<Tag>&& tags)
-    : MetricImpl(std::move(tag_extracted_name), std::move(tags)), parent_(parent),
-      tls_scope_(tls_scope), interval_histogram_(hist_alloc()), cumulative_histogram_(hist_alloc()),
-      interval_statistics_(interval_histogram_), cumulative_statistics_(cumulative_histogram_),
-      merged_(false), name_(name) {}
+                                         TlsScope& tls_scope,
+                                         const std::string& tag_extracted_name,
+                                         const std::vector<Tag>& tags,
+                                         SymbolTableImpl& symbol_table, bool log_linear)
+    : MetricImpl(tag_extracted_name, tags), parent_(parent), tls_scope_(tls_scope),
+      log_linear_(log_linear), interval_histogram_(log_linear), cumulative_histogram_(log_linear),
+      merged_(false), name_(name, symbol_table) {
+  interval_statistics_.refresh(interval_histogram_);
+  cumulative_statistics_.refresh(cumulative_histogram_);
+}
 
 ParentHistogramImpl::~ParentHistogramImpl() {
-  hist_free(interval_histogram_);
-  hist_free(cumulative_histogram_);
+  TlsHistogramNode* node = tls_histograms_.load(std::memory_order_acquire);
+  while (node != nullptr) {
+    TlsHistogramNode* next = node->next_;
+    delete node;
+    node = next;
+  }
 }
 
 void ParentHistogramImpl::recordValue(uint64_t value) {
-  Histogram& tls_histogram = tls_scope_.tlsHistogram(name(), *this);
+  Histogram& tls_histogram = tls_scope_.tlsHistogram(*this);
   tls_histogram.recordValue(value);
   parent_.deliverHistogramToSinks(*this, value);
 }
@@ -395,19 +461,15 @@ bool ParentHistogramImpl::used() const {
 }
 
 void ParentHistogramImpl::merge() {
-  Thread::ReleasableLockGuard lock(merge_lock_);
-  if (merged_ || usedLockHeld()) {
-    hist_clear(interval_histogram_);
-    // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
-    // then release the lock before we do the actual merge. However it is not a big deal
-    // because the tls_histogram merge is not that expensive as it is a single histogram
-    // merge and adding TLS histograms is rare.
-    for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
+  if (merged_ || usedByThreads()) {
+    interval_histogram_.clear();
+    // Thread local histograms added while this runs are missed, but they can only hold values
+    // recorded after the swap that started this merge, which the next merge picks up.
+    for (TlsHistogramNode* node = tls_histograms_.load(std::memory_order_acquire); node != nullptr;
+         node = node->next_) {
+      node->histogram_->merge(interval_histogram_);
     }
-    // Since TLS merge is done, we can release the lock here.
-    lock.release();
-    hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
+    cumulative_histogram_.merge(interval_histogram_);
     cumulative_statistics_.refresh(cumulative_histogram_);
     interval_statistics_.refresh(interval_histogram_);
     merged_ = true;
@@ -431,13 +493,15 @@ const std::string ParentHistogramImpl::summary() const {
 }
 
 void ParentHistogramImpl::addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr) {
-  Thread::LockGuard lock(merge_lock_);
-  tls_histograms_.emplace_back(hist_ptr);
+  TlsHistogramNode* node = new TlsHistogramNode{hist_ptr, tls_histograms_.load()};
+  while (!tls_histograms_.compare_exchange_weak(node->next_, node, std::memory_order_release)) {
+  }
 }
 
-bool ParentHistogramImpl::usedLockHeld() const {
-  for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-    if (tls_histogram->used()) {
+bool ParentHistogramImpl::usedByThreads() const {
+  for (TlsHistogramNode* node = tls_histograms_.load(std::memory_order_acquire); node != nullptr;
+       node = node->next_) {
+    if (node->histogram_->used()) {
       return true;
     }
   }
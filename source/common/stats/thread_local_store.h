@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -10,11 +11,13 @@
 
 #include "envoy/thread_local/thread_local.h"
 
+#include "common/common/hash.h"
 #include "common/stats/heap_stat_data.h"
 #include "common/stats/histogram_impl.h"
 #include "common/stats/source_impl.h"
 #include "common/stats/utility.h"
 
+#include "absl/synchronization/mutex.h"
 #include "circllhist.h"
 
 namespace Envoy {
@@ -23,15 +26,19 @@ namespace Stats {
 /**
  * A histogram that is stored in TLS and used to record values per thread. This holds two
  * histograms, one to collect the values and other as backup that is used for merge process. The
- * swap happens during the merge process.
+ * swap happens during the merge process, on the owning thread, so the main thread reads the
+ * backup histogram while the worker records into the other one without either taking a lock.
  */
 class ThreadLocalHistogramImpl : public Histogram, public MetricImpl {
 public:
-  ThreadLocalHistogramImpl(const std::string& name, std::string&& tag_extracted_name,
-                           std::vector<Tag>&& tags);
-  ~ThreadLocalHistogramImpl();
+  ThreadLocalHistogramImpl(const std::string& name, const std::string& tag_extracted_name,
+                           const std::vector<Tag>& tags, SymbolTableImpl& symbol_table,
+                           bool log_linear);
 
-  void merge(histogram_t* target);
+  /**
+   * Adds the values collected before the last beginMerge() to target, and clears them.
+   */
+  void merge(HistogramBuckets& target);
 
   /**
    * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
@@ -40,7 +47,8 @@ public:
   void beginMerge() {
     // This switches the current_active_ between 1 and 0.
     ASSERT(std::this_thread::get_id() == created_thread_id_);
-    current_active_ = otherHistogramIndex();
+    current_active_.store(1 - current_active_.load(std::memory_order_relaxed),
+                          std::memory_order_release);
   }
 
   // Stats::Histogram
@@ -48,15 +56,18 @@ public:
   bool used() const override { return flags_ & Flags::Used; }
 
   // Stats::Metric
-  const std::string name() const override { return name_; }
+  const std::string name() const override { return name_.toString(); }
 
 private:
-  uint64_t otherHistogramIndex() const { return 1 - current_active_; }
-  uint64_t current_active_;
-  histogram_t* histograms_[2];
+  uint64_t otherHistogramIndex() const {
+    return 1 - current_active_.load(std::memory_order_acquire);
+  }
+  // Only written by the owning thread, but read by the main thread when merging.
+  std::atomic<uint64_t> current_active_;
+  HistogramBuckets histograms_[2];
   std::atomic<uint16_t> flags_;
   std::thread::id created_thread_id_;
-  const std::string name_;
+  const StatNameImpl name_;
 };
 
 typedef std::shared_ptr<ThreadLocalHistogramImpl> TlsHistogramSharedPtr;
@@ -64,12 +75,14 @@ typedef std::shared_ptr<ThreadLocalHistogramImpl> TlsHistogramSharedPtr;
 class TlsScope;
 
 /**
- * Log Linear Histogram implementation that is stored in the main thread.
+ * Log Linear Histogram implementation that is stored in the main thread. The values are recorded
+ * either by libcircllhist, or in fixed log-linear buckets which are cheaper to record into.
  */
 class ParentHistogramImpl : public ParentHistogram, public MetricImpl {
 public:
   ParentHistogramImpl(const std::string& name, Store& parent, TlsScope& tlsScope,
-                      std::string&& tag_extracted_name, std::vector<Tag>&& tags);
+                      const std::string& tag_extracted_name, const std::vector<Tag>& tags,
+                      SymbolTableImpl& symbol_table, bool log_linear);
   ~ParentHistogramImpl();
 
   void addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr);
@@ -90,22 +103,41 @@ public:
   }
   const std::string summary() const override;
 
+  /**
+   * @return const std::string& the symbolized name of the histogram, which identifies it among
+   *         the histograms of the store without having to be decoded.
+   */
+  const std::string& encodedName() const { return name_.encoding(); }
+
+  /**
+   * @return bool whether values are recorded in fixed log-linear buckets rather than by
+   *         libcircllhist.
+   */
+  bool logLinear() const { return log_linear_; }
+
   // Stats::Metric
-  const std::string name() const override { return name_; }
+  const std::string name() const override { return name_.toString(); }
 
 private:
-  bool usedLockHeld() const EXCLUSIVE_LOCKS_REQUIRED(merge_lock_);
+  // The thread local histograms are kept in a list which is only ever prepended to, so that
+  // neither workers adding their histogram nor the main thread merging them take a lock.
+  struct TlsHistogramNode {
+    TlsHistogramSharedPtr histogram_;
+    TlsHistogramNode* next_;
+  };
+
+  bool usedByThreads() const;
 
   Store& parent_;
   TlsScope& tls_scope_;
-  histogram_t* interval_histogram_;
-  histogram_t* cumulative_histogram_;
+  const bool log_linear_;
+  HistogramBuckets interval_histogram_;
+  HistogramBuckets cumulative_histogram_;
   HistogramStatisticsImpl interval_statistics_;
   HistogramStatisticsImpl cumulative_statistics_;
-  mutable Thread::MutexBasicLockable merge_lock_;
-  std::list<TlsHistogramSharedPtr> tls_histograms_ GUARDED_BY(merge_lock_);
+  std::atomic<TlsHistogramNode*> tls_histograms_{nullptr};
   bool merged_;
-  const std::string name_;
+  const StatNameImpl name_;
 };
 
 typedef std::shared_ptr<ParentHistogramImpl> ParentHistogramImplSharedPtr;
@@ -120,9 +152,9 @@ public:
   // TODO(ramaraochavali): Allow direct TLS access for the advanced consumers.
   /**
    * @return a ThreadLocalHistogram within the scope's namespace.
-   * @param name name of the histogram with scope prefix attached.
+   * @param parent the parent histogram, whose name already has the scope prefix attached.
    */
-  virtual Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) PURE;
+  virtual Histogram& tlsHistogram(ParentHistogramImpl& parent) PURE;
 };
 
 /**
@@ -141,6 +173,17 @@ public:
  * - Scopes can be deleted from any thread, and they are in practice as scopes are likely to be
  *   shared across all worker threads.
  * - Per thread caches are checked, and if empty, they are populated from the central cache.
+ * - Stat names are symbolized: the central caches are keyed by the encoding of each name in the
+ *   store's symbol table, and the stats themselves hold their names and tags in encoded form, so
+ *   the segments shared by the names of many stats are only stored once. The symbol table is
+ *   owned by the caller and shared with the allocators, so a stat made by a heap allocator doesn't
+ *   intern its name a second time. The per thread caches are keyed by the plain name, so a cache
+ *   hit neither encodes the name nor takes the lock of the symbol table, and names are only
+ *   encoded on a miss.
+ * - The central cache of each scope is split into shards by stat name, each with its own
+ *   reader/writer lock. Tag extraction and allocation of a new stat happen outside of any lock,
+ *   so threads filling their caches only ever block each other briefly, and only when they
+ *   insert into the same shard. The store-wide lock only guards the set of scopes.
  * - Scopes are entirely owned by the caller. The store only keeps weak pointers.
  * - When a scope is destroyed, a cache flush operation is run on all threads to flush any cached
  *   data owned by the destroyed scope.
@@ -149,6 +192,9 @@ public:
  *   reference the old scope which may be about to be cache flushed.
  * - Since it's possible to have overlapping scopes, we de-dup stats when counters() or gauges() is
  *   called since these are very uncommon operations.
+ * - The stats source keeps its snapshots of all stats across flushes, and only takes new ones after
+ *   stats were created or scopes destroyed. Together with the changed flag of counters and gauges,
+ *   this lets a flush skip the stats that are idle.
  * - Though this implementation is designed to work with a fixed shared memory space, it will fall
  *   back to heap allocated stats if needed. NOTE: In this case, overlapping scopes will not share
  *   the same backing store. This is to keep things simple, it could be done in the future if
@@ -176,7 +222,15 @@ public:
  */
 class ThreadLocalStoreImpl : Logger::Loggable<Logger::Id::stats>, public StoreRoot {
 public:
-  ThreadLocalStoreImpl(const Stats::StatsOptions& stats_options, StatDataAllocator& alloc);
+  /**
+   * @param stats_options the options of the store.
+   * @param alloc the allocator of counters and gauges. A HeapStatDataAllocator should share
+   *     symbol_table.
+   * @param symbol_table the table the names of the stats of the store are symbolized against,
+   *     which must outlive the store.
+   */
+  ThreadLocalStoreImpl(const Stats::StatsOptions& stats_options, StatDataAllocator& alloc,
+                       SymbolTableImpl& symbol_table);
   ~ThreadLocalStoreImpl();
 
   // Stats::Scope
@@ -196,7 +250,12 @@ public:
   std::vector<ParentHistogramSharedPtr> histograms() const override;
 
   // Stats::StoreRoot
-  void addSink(Sink& sink) override { timer_sinks_.push_back(sink); }
+  void addSink(Sink& sink) override {
+    timer_sinks_.push_back(sink);
+    if (sink.flushesChangedStatsOnly()) {
+      source_.retainSnapshots();
+    }
+  }
   void setTagProducer(TagProducerPtr&& tag_producer) override {
     tag_producer_ = std::move(tag_producer);
   }
@@ -211,17 +270,81 @@ public:
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
 
 private:
+  // Maps the name of a stat to the stat in a per thread cache. The keys are at hand without the
+  // symbol table, so that a cache hit never touches it.
+  template <class StatType>
+  using TlsStatMap = std::unordered_map<std::string, std::shared_ptr<StatType>>;
+
   struct TlsCacheEntry {
-    std::unordered_map<std::string, CounterSharedPtr> counters_;
-    std::unordered_map<std::string, GaugeSharedPtr> gauges_;
-    std::unordered_map<std::string, TlsHistogramSharedPtr> histograms_;
-    std::unordered_map<std::string, ParentHistogramSharedPtr> parent_histograms_;
+    TlsStatMap<Counter> counters_;
+    TlsStatMap<Gauge> gauges_;
+    // Keyed by the encoded name of the parent histogram, as that is all recordValue() has at hand.
+    // The parent already holds it, so it doesn't have to be looked up in the symbol table.
+    TlsStatMap<ThreadLocalHistogramImpl> histograms_;
+    TlsStatMap<ParentHistogramImpl> parent_histograms_;
+  };
+
+  // Maps the encoded name of a stat to the stat. Each key holds a reference on the symbols of
+  // its encoding, which is released when the owning scope is destroyed.
+  template <class StatType>
+  using StatMap = std::unordered_map<std::string, std::shared_ptr<StatType>>;
+
+  struct CentralCacheShard {
+    /**
+     * @return the stat with the given encoded name in one of the shard's maps, or nullptr if
+     *         there is none yet.
+     */
+    template <class StatType>
+    std::shared_ptr<StatType> find(StatMap<StatType> CentralCacheShard::*map,
+                                   const std::string& encoding) const {
+      absl::ReaderMutexLock lock(&mutex_);
+      auto it = (this->*map).find(encoding);
+      return it == (this->*map).end() ? nullptr : it->second;
+    }
+
+    /**
+     * Inserts a stat into one of the shard's maps unless another thread got there first.
+     * @param encoding the encoded name of the stat, holding references on its symbols. They are
+     *     either transferred to the map or released.
+     * @return the stat that is in the map once the insertion completes.
+     */
+    template <class StatType>
+    std::shared_ptr<StatType> insert(StatMap<StatType> CentralCacheShard::*map,
+                                     std::string&& encoding, std::shared_ptr<StatType> stat,
+                                     SymbolTableImpl& symbol_table) {
+      std::shared_ptr<StatType> central_ref;
+      {
+        absl::WriterMutexLock lock(&mutex_);
+        auto result = (this->*map).emplace(encoding, std::move(stat));
+        if (result.second) {
+          return result.first->second;
+        }
+        central_ref = result.first->second;
+      }
+      symbol_table.free(encoding);
+      return central_ref;
+    }
+
+    /**
+     * Releases the symbols held by the keys of the shard's maps.
+     */
+    void freeNames(SymbolTableImpl& symbol_table);
+
+    mutable absl::Mutex mutex_;
+    StatMap<Counter> counters_ GUARDED_BY(mutex_);
+    StatMap<Gauge> gauges_ GUARDED_BY(mutex_);
+    StatMap<ParentHistogramImpl> histograms_ GUARDED_BY(mutex_);
   };
 
   struct CentralCacheEntry {
-    std::unordered_map<std::string, CounterSharedPtr> counters_;
-    std::unordered_map<std::string, GaugeSharedPtr> gauges_;
-    std::unordered_map<std::string, ParentHistogramImplSharedPtr> histograms_;
+    // Enough to spread the workers of a large machine without bloating every scope.
+    static constexpr size_t NumShards = 8;
+
+    CentralCacheShard& shard(const std::string& encoding) {
+      return shards_[HashUtil::xxHash64(encoding) % NumShards];
+    }
+
+    std::array<CentralCacheShard, NumShards> shards_;
   };
 
   struct ScopeImpl : public TlsScope {
@@ -238,7 +361,7 @@ private:
     void deliverHistogramToSinks(const Histogram& histogram, uint64_t value) override;
     Gauge& gauge(const std::string& name) override;
     Histogram& histogram(const std::string& name) override;
-    Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) override;
+    Histogram& tlsHistogram(ParentHistogramImpl& parent) override;
     const Stats::StatsOptions& statsOptions() const override { return parent_.statsOptions(); }
 
     template <class StatType>
@@ -253,16 +376,16 @@ private:
      * result, creating it with the heap allocator.
      *
      * @param name the full name of the stat (not tag extracted).
-     * @param central_cache_map a map from name to the desired object in the central cache.
+     * @param central_cache_map the map in each central cache shard from name to the desired
+     *     object.
      * @param make_stat a function to generate the stat object, called if it's not in cache.
-     * @param tls_ref possibly null reference to a cache entry for this stat, which will be
-     *     used if non-empty, or filled in if empty (and non-null).
+     * @param tls_cache possibly null per thread cache of the scope, which will be used if it
+     *     holds the stat, or filled in if it doesn't (and is non-null).
      */
     template <class StatType>
-    StatType&
-    safeMakeStat(const std::string& name,
-                 std::unordered_map<std::string, std::shared_ptr<StatType>>& central_cache_map,
-                 MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref);
+    StatType& safeMakeStat(const std::string& name,
+                           StatMap<StatType> CentralCacheShard::*central_cache_map,
+                           MakeStatFn<StatType> make_stat, TlsStatMap<StatType>* tls_cache);
 
     static std::atomic<uint64_t> next_scope_id_;
 
@@ -284,6 +407,7 @@ private:
   };
 
   std::string getTagsForName(const std::string& name, std::vector<Tag>& tags) const;
+  SymbolTableImpl& symbolTable() { return symbol_table_; }
   void clearScopeFromCaches(uint64_t scope_id);
   void releaseScopeCrossThread(ScopeImpl* scope);
   void mergeInternal(PostMergeCb mergeCb);
@@ -291,6 +415,11 @@ private:
 
   const Stats::StatsOptions& stats_options_;
   StatDataAllocator& alloc_;
+  SymbolTableImpl& symbol_table_;
+  HeapStatDataAllocator heap_allocator_;
+  // Keeps its snapshots across flushes, and is marked stale whenever a stat is created or a scope
+  // is destroyed. It is constructed before any stat is created.
+  SourceImpl source_;
   Event::Dispatcher* main_thread_dispatcher_{};
   ThreadLocal::SlotPtr tls_;
   mutable Thread::MutexBasicLockable lock_;
@@ -301,8 +430,6 @@ private:
   std::atomic<bool> shutting_down_{};
   std::atomic<bool> merge_in_progress_{};
   Counter& num_last_resort_stats_;
-  HeapStatDataAllocator heap_allocator_;
-  SourceImpl source_;
 };
 
 } // namespace Stats
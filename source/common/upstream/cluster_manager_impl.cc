@@ -23,6 +23,7 @@
 #include "common/http/async_client_impl.h"
 #include "common/http/http1/conn_pool.h"
 #include "common/http/http2/conn_pool.h"
+#include "common/http/utility.h"
 #include "common/json/config_schemas.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/utility.h"
@@ -522,7 +523,8 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::api::v2::Cluster& clust
 
 void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster) {
   tls_->runOnAllThreads([this, new_cluster = cluster.cluster_->info(),
-                         thread_aware_lb_factory = cluster.loadBalancerFactory()]() -> void {
+                         thread_aware_lb_factory = cluster.loadBalancerFactory(),
+                         schedule_cache = cluster.schedule_cache_]() -> void {
     ThreadLocalClusterManagerImpl& cluster_manager =
         tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
@@ -533,7 +535,7 @@ void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster)
     }
 
     auto thread_local_cluster = new ThreadLocalClusterManagerImpl::ClusterEntry(
-        cluster_manager, new_cluster, thread_aware_lb_factory);
+        cluster_manager, new_cluster, thread_aware_lb_factory, schedule_cache);
     cluster_manager.thread_local_clusters_[new_cluster->name()].reset(thread_local_cluster);
     for (auto& cb : cluster_manager.update_callbacks_) {
       cb->onClusterAddOrUpdate(*thread_local_cluster);
@@ -627,7 +629,14 @@ void ClusterManagerImpl::loadCluster(const envoy::api::v2::Cluster& cluster,
   } else if (cluster_reference.info()->lbType() == LoadBalancerType::Maglev) {
     cluster_entry_it->second->thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(
         cluster_reference.prioritySet(), cluster_reference.info()->stats(), runtime_, random_,
-        cluster_reference.info()->lbConfig());
+        cluster_reference.info()->lbConfig(),
+        MaglevLoadBalancer::tableSize(cluster_reference.info()->lbMaglevConfig()));
+  } else if (cluster_reference.info()->lbType() == LoadBalancerType::RoundRobin &&
+             !cluster_reference.info()->lbSubsetInfo().isEnabled() &&
+             cluster_reference.info()->lbConfig().weighted_scheduler() ==
+                 envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED) {
+    // Interleaved schedules only depend on the hosts, so the workers share them.
+    cluster_entry_it->second->schedule_cache_ = std::make_shared<InterleavedScheduleCache>();
   }
 
   updateGauges();
@@ -682,20 +691,19 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, ui
                                                       const HostVector& hosts_removed) {
   const auto& host_set = cluster.prioritySet().hostSetsPerPriority()[priority];
 
-  // TODO(htuch): Can we skip these copies by exporting out const shared_ptr from HostSet?
-  HostVectorConstSharedPtr hosts_copy(new HostVector(host_set->hosts()));
-  HostVectorConstSharedPtr healthy_hosts_copy(new HostVector(host_set->healthyHosts()));
-  HostsPerLocalityConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocality().clone();
-  HostsPerLocalityConstSharedPtr healthy_hosts_per_locality_copy =
-      host_set->healthyHostsPerLocality().clone();
-
+  // The snapshots of the host set are immutable, so all the workers share them rather than copies.
+  // The added and removed hosts are shared as well, as the callback is copied for each worker.
   tls_->runOnAllThreads(
-      [this, name = cluster.info()->name(), priority, hosts_copy, healthy_hosts_copy,
-       hosts_per_locality_copy, healthy_hosts_per_locality_copy,
-       locality_weights = host_set->localityWeights(), hosts_added, hosts_removed]() {
+      [this, name = cluster.info()->name(), priority, hosts = host_set->hostsPtr(),
+       healthy_hosts = host_set->healthyHostsPtr(),
+       hosts_per_locality = host_set->hostsPerLocalityPtr(),
+       healthy_hosts_per_locality = host_set->healthyHostsPerLocalityPtr(),
+       locality_weights = host_set->localityWeights(),
+       hosts_added = std::make_shared<const HostVector>(hosts_added),
+       hosts_removed = std::make_shared<const HostVector>(hosts_removed)]() {
         ThreadLocalClusterManagerImpl::updateClusterMembership(
-            name, priority, hosts_copy, healthy_hosts_copy, hosts_per_locality_copy,
-            healthy_hosts_per_locality_copy, locality_weights, hosts_added, hosts_removed, *tls_);
+            name, priority, hosts, healthy_hosts, hosts_per_locality, healthy_hosts_per_locality,
+            locality_weights, *hosts_added, *hosts_removed, *tls_);
       });
 }
 
@@ -798,8 +806,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
   if (local_cluster_name) {
     ENVOY_LOG(debug, "adding TLS local cluster {}", local_cluster_name.value());
     auto& local_cluster = parent.active_clusters_.at(local_cluster_name.value());
-    thread_local_clusters_[local_cluster_name.value()].reset(new ClusterEntry(
-        *this, local_cluster->cluster_->info(), local_cluster->loadBalancerFactory()));
+    thread_local_clusters_[local_cluster_name.value()].reset(
+        new ClusterEntry(*this, local_cluster->cluster_->info(),
+                         local_cluster->loadBalancerFactory(), local_cluster->schedule_cache_));
   }
 
   local_priority_set_ = local_cluster_name
@@ -814,8 +823,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
 
     ENVOY_LOG(debug, "adding TLS initial cluster {}", cluster.first);
     ASSERT(thread_local_clusters_.count(cluster.first) == 0);
-    thread_local_clusters_[cluster.first].reset(new ClusterEntry(
-        *this, cluster.second->cluster_->info(), cluster.second->loadBalancerFactory()));
+    thread_local_clusters_[cluster.first].reset(
+        new ClusterEntry(*this, cluster.second->cluster_->info(),
+                         cluster.second->loadBalancerFactory(), cluster.second->schedule_cache_));
   }
 }
 
@@ -1015,7 +1025,8 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
 
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     ThreadLocalClusterManagerImpl& parent, ClusterInfoConstSharedPtr cluster,
-    const LoadBalancerFactorySharedPtr& lb_factory)
+    const LoadBalancerFactorySharedPtr& lb_factory,
+    const InterleavedScheduleCacheSharedPtr& schedule_cache)
     : parent_(parent), lb_factory_(lb_factory), cluster_info_(cluster),
       http_async_client_(*cluster, parent.parent_.stats_, parent.thread_local_dispatcher_,
                          parent.parent_.local_info_, parent.parent_, parent.parent_.runtime_,
@@ -1029,7 +1040,8 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     lb_.reset(new SubsetLoadBalancer(cluster->lbType(), priority_set_, parent_.local_priority_set_,
                                      cluster->stats(), parent.parent_.runtime_,
                                      parent.parent_.random_, cluster->lbSubsetInfo(),
-                                     cluster->lbRingHashConfig(), cluster->lbConfig()));
+                                     cluster->lbRingHashConfig(), cluster->lbMaglevConfig(),
+                                     cluster->lbConfig()));
   } else {
     switch (cluster->lbType()) {
     case LoadBalancerType::LeastRequest: {
@@ -1048,9 +1060,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     }
     case LoadBalancerType::RoundRobin: {
       ASSERT(lb_factory_ == nullptr);
-      lb_.reset(new RoundRobinLoadBalancer(priority_set_, parent_.local_priority_set_,
-                                           cluster->stats(), parent.parent_.runtime_,
-                                           parent.parent_.random_, cluster->lbConfig()));
+      lb_.reset(new RoundRobinLoadBalancer(
+          priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
+          parent.parent_.random_, cluster->lbConfig(), schedule_cache));
       break;
     }
     case LoadBalancerType::RingHash:
@@ -1100,8 +1112,15 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     return nullptr;
   }
 
+  // Idempotent requests to a cluster which pipelines HTTP/1.1 requests get pools of their own, so
+  // that requests which cannot be safely retried are never pipelined.
+  const bool pipelined = protocol == Http::Protocol::Http11 &&
+                         cluster_info_->http1Settings().max_pipeline_depth_ > 1 && context &&
+                         context->downstreamHeaders() &&
+                         Http::Utility::isPipelinable(*context->downstreamHeaders());
+
   // Inherit socket options from downstream connection, if set.
-  std::vector<uint8_t> hash_key = {uint8_t(protocol), uint8_t(priority)};
+  std::vector<uint8_t> hash_key = {uint8_t(protocol), uint8_t(priority), uint8_t(pipelined)};
 
   // Use downstream connection socket options for computing connection pool hash key, if any.
   // This allows socket options to control connection pooling so that connections with
@@ -1121,7 +1140,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
   ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[host];
   if (!container.pools_[hash_key]) {
     container.pools_[hash_key] = parent_.parent_.factory_.allocateConnPool(
-        parent_.thread_local_dispatcher_, host, priority, protocol,
+        parent_.thread_local_dispatcher_, host, priority, protocol, pipelined,
         have_options ? context->downstreamConnection()->socketOptions() : nullptr);
   }
 
@@ -1178,14 +1197,17 @@ ClusterManagerPtr ProdClusterManagerFactory::clusterManagerFromProto(
 
 Http::ConnectionPool::InstancePtr ProdClusterManagerFactory::allocateConnPool(
     Event::Dispatcher& dispatcher, HostConstSharedPtr host, ResourcePriority priority,
-    Http::Protocol protocol, const Network::ConnectionSocket::OptionsSharedPtr& options) {
+    Http::Protocol protocol, bool pipelined,
+    const Network::ConnectionSocket::OptionsSharedPtr& options) {
   if (protocol == Http::Protocol::Http2 &&
       runtime_.snapshot().featureEnabled("upstream.use_http2", 100)) {
     return Http::ConnectionPool::InstancePtr{
         new Http::Http2::ProdConnPoolImpl(dispatcher, host, priority, options)};
   } else {
-    return Http::ConnectionPool::InstancePtr{
-        new Http::Http1::ConnPoolImplProd(dispatcher, host, priority, options)};
+    const uint32_t max_pipeline_depth =
+        pipelined ? host->cluster().http1Settings().max_pipeline_depth_ : 1;
+    return Http::ConnectionPool::InstancePtr{new Http::Http1::ConnPoolImplProd(
+        dispatcher, host, priority, options, max_pipeline_depth)};
   }
 }
 
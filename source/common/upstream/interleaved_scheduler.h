@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+// Interleaved weighted round robin scheduler
+// (https://en.wikipedia.org/wiki/Interleaved_weighted_round_robin) over a schedule computed once
+// from a fixed set of entries with integer weights. A cycle is made of max weight rounds, and round
+// r visits the entries whose weight is at least r, so each entry is picked exactly weight times per
+// cycle, spread across the cycle. The entries are kept in a flat array sorted by descending weight,
+// then insertion order, so that the entries of a round are a prefix of it. Picks are O(1), against
+// O(log n) for EdfScheduler, but weights can't change without rebuilding the scheduler. The built
+// schedule is immutable, so schedulers over the same entries can share it and only keep their own
+// position in it.
+template <class C> class InterleavedScheduler {
+public:
+  struct Schedule;
+  typedef std::shared_ptr<const Schedule> ScheduleConstSharedPtr;
+
+  InterleavedScheduler() {}
+
+  /**
+   * Start from the beginning of a schedule built by another scheduler. The schedule is immutable,
+   * so it is shared rather than copied, and only the position in it is per scheduler.
+   * @param schedule supplies the schedule, as returned by schedule().
+   */
+  explicit InterleavedScheduler(ScheduleConstSharedPtr schedule) : schedule_(std::move(schedule)) {}
+
+  /**
+   * Pick the next entry of the schedule.
+   * @return const std::shared_ptr<C>& the entry, or nullptr if there are no entries. The entry
+   *         stays in the schedule.
+   */
+  const std::shared_ptr<C>& pick() {
+    if (empty()) {
+      return null_entry_;
+    }
+    build();
+    const std::shared_ptr<C>& entry = schedule_->entries_[position_].entry_;
+    if (++position_ == schedule_->levels_[level_].size_) {
+      nextRound();
+    }
+    return entry;
+  }
+
+  /**
+   * Insert entry into the schedule. Entries must all be added before the first pick.
+   * @param weight integer weight, at least 1.
+   * @param entry shared pointer to entry, which is retained until the schedule is destroyed.
+   */
+  void add(uint32_t weight, std::shared_ptr<C> entry) {
+    ASSERT(weight > 0);
+    ASSERT(schedule_ == nullptr);
+    pending_.push_back({weight, std::move(entry)});
+  }
+
+  /**
+   * Skip a number of picks, e.g. to desynchronize schedulers built from the same entries.
+   * @param picks the number of picks to skip.
+   */
+  void skip(uint64_t picks) {
+    if (empty()) {
+      return;
+    }
+    build();
+    picks %= schedule_->cycle_length_;
+    // Whole rounds are skipped at once, and the rounds of a level all have the same size.
+    while (picks > 0) {
+      const Level& level = schedule_->levels_[level_];
+      const uint64_t left_in_round = level.size_ - position_;
+      if (picks < left_in_round) {
+        position_ += picks;
+        return;
+      }
+      picks -= left_in_round;
+      const uint64_t rounds = std::min<uint64_t>(picks / level.size_, level.last_round_ - round_);
+      round_ += rounds;
+      picks -= rounds * level.size_;
+      nextRound();
+    }
+  }
+
+  /**
+   * Build the schedule if it isn't yet, after which no entries can be added.
+   * @return const ScheduleConstSharedPtr& the schedule, to start other schedulers from.
+   */
+  const ScheduleConstSharedPtr& schedule() {
+    build();
+    return schedule_;
+  }
+
+  /**
+   * @return bool whether there are no entries.
+   */
+  bool empty() const { return schedule_ == nullptr ? pending_.empty() : schedule_->empty(); }
+
+private:
+  struct Entry {
+    uint32_t weight_;
+    std::shared_ptr<C> entry_;
+  };
+
+  // Consecutive rounds which visit the same entries.
+  struct Level {
+    // The last round of the level, i.e. the weight of its lightest entries.
+    uint32_t last_round_;
+    // The number of entries visited by each round of the level.
+    uint32_t size_;
+  };
+
+  void build() {
+    if (schedule_ != nullptr) {
+      return;
+    }
+    auto schedule = std::make_shared<Schedule>();
+    schedule->entries_ = std::move(pending_);
+    pending_.clear();
+    std::vector<Entry>& entries = schedule->entries_;
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.weight_ > b.weight_; });
+    for (size_t i = entries.size(); i > 0; i--) {
+      const uint32_t weight = entries[i - 1].weight_;
+      schedule->cycle_length_ += weight;
+      if (schedule->levels_.empty() || schedule->levels_.back().last_round_ != weight) {
+        schedule->levels_.push_back({weight, static_cast<uint32_t>(i)});
+      }
+    }
+    schedule_ = std::move(schedule);
+  }
+
+  void nextRound() {
+    position_ = 0;
+    if (round_++ == schedule_->levels_[level_].last_round_ &&
+        ++level_ == schedule_->levels_.size()) {
+      level_ = 0;
+      round_ = 1;
+    }
+  }
+
+  // Entries added while the schedule isn't built, in insertion order.
+  std::vector<Entry> pending_;
+  ScheduleConstSharedPtr schedule_;
+  // The current round, starting from 1, its level, and the position in it.
+  uint32_t round_{1};
+  size_t level_{};
+  size_t position_{};
+  std::shared_ptr<C> null_entry_;
+};
+
+template <class C> struct InterleavedScheduler<C>::Schedule {
+  bool empty() const { return entries_.empty(); }
+
+  // Sorted by descending weight, then insertion order.
+  std::vector<Entry> entries_;
+  // Sorted by ascending last round.
+  std::vector<Level> levels_;
+  uint64_t cycle_length_{};
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/upstream/load_balancer_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -433,6 +434,44 @@ const HostVector& ZoneAwareLoadBalancerBase::hostSourceToHosts(HostsSource hosts
   }
 }
 
+InterleavedScheduleCache::ScheduleConstSharedPtr
+InterleavedScheduleCache::get(std::shared_ptr<const void> snapshot, const HostVector& hosts) {
+  absl::MutexLock lock(&mutex_);
+  // Once the cache holds the last reference to a snapshot, no host set uses it anymore.
+  for (auto it = snapshots_.begin(); it != snapshots_.end();) {
+    if (it->second.snapshot_.use_count() == 1) {
+      it = snapshots_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  CachedSnapshot& cached_snapshot = snapshots_[snapshot.get()];
+  if (cached_snapshot.snapshot_ == nullptr) {
+    cached_snapshot.snapshot_ = std::move(snapshot);
+  }
+  CachedSchedule& cached = cached_snapshot.schedules_[&hosts];
+  if (cached.schedule_ != nullptr && cached.weights_.size() == hosts.size() &&
+      std::equal(hosts.begin(), hosts.end(), cached.weights_.begin(),
+                 [](const HostSharedPtr& host, uint32_t weight) {
+                   return host->weight() == weight;
+                 })) {
+    return cached.schedule_;
+  }
+
+  // The schedule is built under the lock, so that the workers refreshing concurrently wait for it
+  // rather than all building it.
+  InterleavedScheduler<const Host> scheduler;
+  cached.weights_.clear();
+  for (const auto& host : hosts) {
+    const uint32_t weight = host->weight();
+    scheduler.add(weight, host);
+    cached.weights_.push_back(weight);
+  }
+  cached.schedule_ = scheduler.schedule();
+  return cached.schedule_;
+}
+
 EdfLoadBalancerBase::EdfLoadBalancerBase(
     const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
     Runtime::Loader& runtime, Runtime::RandomGenerator& random,
@@ -456,11 +495,27 @@ void EdfLoadBalancerBase::initialize() {
 }
 
 void EdfLoadBalancerBase::refresh(uint32_t priority) {
-  const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
+  const auto add_hosts_source = [this](HostsSource source, std::shared_ptr<const void> snapshot,
+                                       const HostVector& hosts) {
     // Nuke existing scheduler if it exists.
     auto& scheduler = scheduler_[source] = Scheduler{};
     refreshHostSource(source);
 
+    if (interleavedSchedule()) {
+      // The whole schedule is computed from the current weights, and offset by the seed.
+      InterleavedScheduleCache* schedule_cache = interleavedScheduleCache();
+      if (schedule_cache != nullptr) {
+        scheduler.interleaved_ =
+            InterleavedScheduler<const Host>(schedule_cache->get(std::move(snapshot), hosts));
+      } else {
+        for (const auto& host : hosts) {
+          scheduler.interleaved_.add(host->weight(), host);
+        }
+      }
+      scheduler.interleaved_.skip(seed_);
+      return;
+    }
+
     // Populate scheduler with host list.
     // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
     // weighted 1. This is because currently we don't refresh host sets if only weights change.
@@ -487,14 +542,17 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
 
   // Populate EdfSchedulers for each valid HostsSource value for the host set at this priority.
   const auto& host_set = priority_set_.hostSetsPerPriority()[priority];
-  add_hosts_source(HostsSource(priority, HostsSource::SourceType::AllHosts), host_set->hosts());
+  add_hosts_source(HostsSource(priority, HostsSource::SourceType::AllHosts), host_set->hostsPtr(),
+                   host_set->hosts());
   add_hosts_source(HostsSource(priority, HostsSource::SourceType::HealthyHosts),
-                   host_set->healthyHosts());
+                   host_set->healthyHostsPtr(), host_set->healthyHosts());
+  const HostsPerLocalityConstSharedPtr healthy_hosts_per_locality =
+      host_set->healthyHostsPerLocalityPtr();
   for (uint32_t locality_index = 0;
        locality_index < host_set->healthyHostsPerLocality().get().size(); ++locality_index) {
     add_hosts_source(
         HostsSource(priority, HostsSource::SourceType::LocalityHealthyHosts, locality_index),
-        host_set->healthyHostsPerLocality().get()[locality_index]);
+        healthy_hosts_per_locality, host_set->healthyHostsPerLocality().get()[locality_index]);
   }
 }
 
@@ -514,6 +572,9 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   // the same but not 1 (like 42), we will use the EDF schedule not the unweighted pick. This is
   // not optimal. If this is fixed, remove the note in the arch overview docs for the LR LB.
   if (stats_.max_host_weight_.value() != 1) {
+    if (interleavedSchedule()) {
+      return scheduler.interleaved_.pick();
+    }
     auto host = scheduler.edf_.pick();
     if (host != nullptr) {
       scheduler.edf_.add(hostWeight(*host), host);
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <queue>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/api/v2/cds.pb.h"
@@ -11,6 +12,9 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/upstream/edf_scheduler.h"
+#include "common/upstream/interleaved_scheduler.h"
+
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -238,6 +242,42 @@ private:
   Common::CallbackHandle* local_priority_set_member_update_cb_handle_{};
 };
 
+/**
+ * Interleaved schedules shared by the round robin load balancers of a cluster on all the workers.
+ * After a membership update the host sets of the workers hold the same immutable host snapshots, so
+ * the schedule of some hosts is built by the first worker to refresh, and the other workers only
+ * keep their own position in it.
+ */
+class InterleavedScheduleCache {
+public:
+  typedef InterleavedScheduler<const Host>::ScheduleConstSharedPtr ScheduleConstSharedPtr;
+
+  /**
+   * @param snapshot supplies the immutable snapshot holding the hosts, e.g. HostSet::hostsPtr(). It
+   *        is retained while its schedules are cached, so that its address isn't reused.
+   * @param hosts supplies the hosts to schedule, within the snapshot.
+   * @return ScheduleConstSharedPtr the schedule of the hosts with their current weights.
+   */
+  ScheduleConstSharedPtr get(std::shared_ptr<const void> snapshot, const HostVector& hosts);
+
+private:
+  struct CachedSchedule {
+    // The weights of the hosts when the schedule was built, as weights are updated in place.
+    std::vector<uint32_t> weights_;
+    ScheduleConstSharedPtr schedule_;
+  };
+
+  struct CachedSnapshot {
+    std::shared_ptr<const void> snapshot_;
+    std::unordered_map<const HostVector*, CachedSchedule> schedules_;
+  };
+
+  absl::Mutex mutex_;
+  std::unordered_map<const void*, CachedSnapshot> snapshots_ GUARDED_BY(mutex_);
+};
+
+typedef std::shared_ptr<InterleavedScheduleCache> InterleavedScheduleCacheSharedPtr;
+
 /**
  * Base implementation of LoadBalancer that performs weighted RR selection across the hosts in the
  * cluster. This scheduler respects host weighting and utilizes an EdfScheduler to achieve O(log
@@ -250,7 +290,8 @@ private:
  * support large ranges of weights or arbitrary precision floating weights, we could construct an
  * explicit schedule, since m will be a small constant factor in O(m * n). This
  * could also be done on a thread aware LB, avoiding creating multiple EDF
- * instances.
+ * instances. RoundRobinLoadBalancer can already be configured to use such a schedule, computed by
+ * an InterleavedScheduler.
  *
  * This base class also supports unweighted selection which derived classes can use to customize
  * behavior. Derived classes can also override how host weight is determined when in weighted mode.
@@ -269,6 +310,8 @@ protected:
   struct Scheduler {
     // EdfScheduler for weighted LB.
     EdfScheduler<const Host> edf_;
+    // InterleavedScheduler for weighted LB, used instead of edf_ when interleavedSchedule().
+    InterleavedScheduler<const Host> interleaved_;
   };
 
   void initialize();
@@ -286,23 +329,32 @@ private:
   virtual double hostWeight(const Host& host) PURE;
   virtual HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                                 const HostsSource& source) PURE;
+  // Whether to schedule weighted hosts with an InterleavedScheduler. This is only possible when
+  // the weight of a host is its configured weight, which doesn't change between refreshes.
+  virtual bool interleavedSchedule() const { return false; }
+  // Optional interleaved schedules shared with the load balancers of the other workers.
+  virtual InterleavedScheduleCache* interleavedScheduleCache() const { return nullptr; }
 
   // Scheduler for each valid HostsSource.
   std::unordered_map<HostsSource, Scheduler, HostsSourceHash> scheduler_;
 };
 
 /**
- * A round roubin load balancer. When in weighted mode, EDF scheduling is used. When in not
- * weighted mode, simple RR index selection is used.
+ * A round roubin load balancer. When in weighted mode, EDF scheduling is used, or interleaved
+ * weighted round robin if configured. When in not weighted mode, simple RR index selection is used.
  */
 class RoundRobinLoadBalancer : public EdfLoadBalancerBase {
 public:
   RoundRobinLoadBalancer(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
                          ClusterStats& stats, Runtime::Loader& runtime,
                          Runtime::RandomGenerator& random,
-                         const envoy::api::v2::Cluster::CommonLbConfig& common_config)
+                         const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                         InterleavedScheduleCacheSharedPtr schedule_cache = nullptr)
       : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
-                            common_config) {
+                            common_config),
+        interleaved_(common_config.weighted_scheduler() ==
+                     envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED),
+        schedule_cache_(std::move(schedule_cache)) {
     initialize();
   }
 
@@ -322,7 +374,13 @@ private:
     ASSERT(rr_indexes_.find(source) != rr_indexes_.end());
     return hosts_to_use[rr_indexes_[source]++ % hosts_to_use.size()];
   }
+  bool interleavedSchedule() const override { return interleaved_; }
+  InterleavedScheduleCache* interleavedScheduleCache() const override {
+    return schedule_cache_.get();
+  }
 
+  const bool interleaved_;
+  const InterleavedScheduleCacheSharedPtr schedule_cache_;
   std::unordered_map<HostsSource, uint64_t, HostsSourceHash> rr_indexes_;
 };
 
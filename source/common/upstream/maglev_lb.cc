@@ -1,17 +1,23 @@
 #include "common/upstream/maglev_lb.h"
 
+#include <limits>
+
 namespace Envoy {
 namespace Upstream {
 
+namespace {
+// Marks the entries of the table which are not populated yet.
+constexpr uint32_t EmptyEntry = std::numeric_limits<uint32_t>::max();
+} // namespace
+
 MaglevTable::MaglevTable(const HostsPerLocality& hosts_per_locality,
                          const LocalityWeightsConstSharedPtr& locality_weights, uint64_t table_size)
     : table_size_(table_size) {
-  // TODO(mattklein123): The Maglev table must have a size that is a prime number for the algorithm
-  // to work. Currently, the table size is not user configurable. In the future, if the table size
-  // is made user configurable, we will need proper error checking that the user cannot configure a
-  // size that is not prime (the result is going to be an infinite loop with some inputs which is
-  // not good!).
-  ASSERT(Primes::isPrime(table_size));
+  // The Maglev table must have a size that is a prime number for the algorithm to work, otherwise
+  // some permutations would loop over part of the table, forever with some inputs. This is checked
+  // when the table size is configured, see ClusterInfoImpl.
+  ASSERT(table_size >= 2 && table_size <= std::numeric_limits<uint32_t>::max() &&
+         Primes::isPrime(table_size));
 
   // Compute host weight combined with locality weight where applicable.
   const auto effective_weight = [&locality_weights](uint32_t host_weight,
@@ -41,17 +47,19 @@ MaglevTable::MaglevTable(const HostsPerLocality& hosts_per_locality,
   // Implementation of pseudocode listing 1 in the paper (see header file for more info).
   std::vector<TableBuildEntry> table_build_entries;
   table_build_entries.reserve(total_hosts);
+  hosts_.reserve(total_hosts);
   for (uint32_t i = 0; i < hosts_per_locality.get().size(); ++i) {
     for (const auto& host : hosts_per_locality.get()[i]) {
       const std::string& address = host->address()->asString();
-      table_build_entries.emplace_back(host, HashUtil::xxHash64(address) % table_size_,
+      table_build_entries.emplace_back(HashUtil::xxHash64(address) % table_size_,
                                        (HashUtil::xxHash64(address, 1) % (table_size_ - 1)) + 1,
                                        max_host_weight > 0 ? effective_weight(host->weight(), i)
                                                            : 0);
+      hosts_.push_back(host);
     }
   }
 
-  table_.resize(table_size_);
+  table_.assign(table_size_, EmptyEntry);
   uint64_t table_index = 0;
   uint32_t iteration = 1;
   while (true) {
@@ -69,19 +77,17 @@ MaglevTable::MaglevTable(const HostsPerLocality& hosts_per_locality,
         }
         entry.counts_ += max_host_weight;
       }
-      uint64_t c = permutation(entry);
-      while (table_[c] != nullptr) {
-        entry.next_++;
-        c = permutation(entry);
+      while (table_[entry.next_] != EmptyEntry) {
+        advance(entry);
       }
 
-      table_[c] = entry.host_;
-      entry.next_++;
+      table_[entry.next_] = static_cast<uint32_t>(i);
+      advance(entry);
       table_index++;
       if (table_index == table_size_) {
         if (ENVOY_LOG_CHECK_LEVEL(trace)) {
           for (uint64_t i = 0; i < table_.size(); i++) {
-            ENVOY_LOG(trace, "maglev: i={} host={}", i, table_[i]->address()->asString());
+            ENVOY_LOG(trace, "maglev: i={} host={}", i, hosts_[table_[i]]->address()->asString());
           }
         }
         return;
@@ -91,16 +97,20 @@ MaglevTable::MaglevTable(const HostsPerLocality& hosts_per_locality,
   }
 }
 
-HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash) const {
-  if (table_.empty()) {
+HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash, uint32_t attempt) const {
+  if (table_.empty() || attempt >= table_size_) {
     return nullptr;
   }
 
-  return table_[hash % table_size_];
+  return hosts_[table_[(hash % table_size_ + attempt) % table_size_]];
 }
 
-uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
-  return (entry.offset_ + (entry.skip_ * entry.next_)) % table_size_;
+void MaglevTable::advance(TableBuildEntry& entry) const {
+  // skip_ < table_size_, so this is (next_ + skip_) % table_size_ without a division.
+  entry.next_ += entry.skip_;
+  if (entry.next_ >= table_size_) {
+    entry.next_ -= table_size_;
+  }
 }
 
 } // namespace Upstream
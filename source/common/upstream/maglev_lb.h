@@ -9,8 +9,9 @@ namespace Upstream {
 /**
  * This is an implementation of Maglev consistent hashing as described in:
  * https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/44824.pdf
- * section 3.4. Specifically, the algorithm shown in pseudocode listening 1 is implemented
- * with a fixed table size of 65537. This is the recommended table size in section 5.3.
+ * section 3.4. Specifically, the algorithm shown in pseudocode listening 1 is implemented, by
+ * default with a table size of 65537. This is the recommended table size in section 5.3, for up to
+ * a few hundred hosts; the table should be about 100 times larger than the number of hosts.
  */
 class MaglevTable : public ThreadAwareLoadBalancerBase::HashingLoadBalancer,
                     Logger::Loggable<Logger::Id::upstream> {
@@ -20,28 +21,31 @@ public:
               uint64_t table_size = DefaultTableSize);
 
   // ThreadAwareLoadBalancerBase::HashingLoadBalancer
-  HostConstSharedPtr chooseHost(uint64_t hash) const override;
+  HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
 
   // Recommended table size in section 5.3 of the paper.
   static const uint64_t DefaultTableSize = 65537;
 
 private:
   struct TableBuildEntry {
-    TableBuildEntry(const HostSharedPtr& host, uint64_t offset, uint64_t skip, uint64_t weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+    TableBuildEntry(uint64_t offset, uint64_t skip, uint64_t weight)
+        : skip_(skip), weight_(weight), next_(offset) {}
 
-    HostSharedPtr host_;
-    const uint64_t offset_;
     const uint64_t skip_;
     const uint64_t weight_;
     uint64_t counts_{};
-    uint64_t next_{};
+    // The next entry of the permutation of the host, i.e. (offset + skip * i) % table_size_ for
+    // the i-th entry, computed incrementally.
+    uint64_t next_;
   };
 
-  uint64_t permutation(const TableBuildEntry& entry);
+  void advance(TableBuildEntry& entry) const;
 
   const uint64_t table_size_;
-  HostVector table_;
+  // The table holds indices into hosts_ rather than hosts, which makes it 4 times smaller and
+  // saves touching the reference count of a host for each of its entries.
+  HostVector hosts_;
+  std::vector<uint32_t> table_;
 };
 
 /**
@@ -56,6 +60,16 @@ public:
       : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
         table_size_(table_size) {}
 
+  /**
+   * @return uint64_t the table size set by config, or the default table size.
+   */
+  static uint64_t
+  tableSize(const absl::optional<envoy::api::v2::Cluster::MaglevLbConfig>& config) {
+    return config ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value(), table_size,
+                                                    MaglevTable::DefaultTableSize)
+                  : MaglevTable::DefaultTableSize;
+  }
+
 private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) override {
@@ -83,6 +97,8 @@ private:
     }
   }
 
+  bool hashesByWeight() const override { return true; }
+
   const uint64_t table_size_;
 };
 
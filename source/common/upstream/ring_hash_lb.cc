@@ -21,8 +21,8 @@ RingHashLoadBalancer::RingHashLoadBalancer(
     : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
       config_(config) {}
 
-HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
-  if (ring_.empty()) {
+HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_t attempt) const {
+  if (attempt >= ring_.size()) {
     return nullptr;
   }
 
@@ -36,14 +36,14 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
     int64_t midp = (lowp + highp) / 2;
 
     if (midp == static_cast<int64_t>(ring_.size())) {
-      return ring_[0].host_;
+      return ring_[attempt].host_;
     }
 
     uint64_t midval = ring_[midp].hash_;
     uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
 
     if (h <= midval && h > midval1) {
-      return ring_[midp].host_;
+      return ring_[(midp + attempt) % ring_.size()].host_;
     }
 
     if (midval < h) {
@@ -53,7 +53,7 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
     }
 
     if (lowp > highp) {
-      return ring_[0].host_;
+      return ring_[attempt].host_;
     }
   }
 }
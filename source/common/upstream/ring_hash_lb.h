@@ -17,7 +17,8 @@ namespace Upstream {
  * In the future it would be nice to support:
  * 1) Weighting.
  * 2) Per-zone rings and optional zone aware routing (not all applications will want this).
- * 3) Max request fallback to support hot shards (not all applications will want this).
+ * 3) Max request fallback to support hot shards (not all applications will want this). This is
+ *    now available as bounded loads, see CommonLbConfig.hash_balance_factor.
  */
 class RingHashLoadBalancer : public ThreadAwareLoadBalancerBase,
                              Logger::Loggable<Logger::Id::upstream> {
@@ -38,7 +39,7 @@ private:
          const HostVector& hosts);
 
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
-    HostConstSharedPtr chooseHost(uint64_t hash) const override;
+    HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
 
     std::vector<RingEntry> ring_;
   };
@@ -56,6 +57,9 @@ private:
     }
   }
 
+  // The ring doesn't support weighting yet.
+  bool hashesByWeight() const override { return false; }
+
   const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& config_;
 };
 
@@ -21,8 +21,11 @@ SubsetLoadBalancer::SubsetLoadBalancer(
     ClusterStats& stats, Runtime::Loader& runtime, Runtime::RandomGenerator& random,
     const LoadBalancerSubsetInfo& subsets,
     const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
+    const absl::optional<envoy::api::v2::Cluster::MaglevLbConfig>& lb_maglev_config,
     const envoy::api::v2::Cluster::CommonLbConfig& common_config)
-    : lb_type_(lb_type), lb_ring_hash_config_(lb_ring_hash_config), common_config_(common_config),
+    : lb_type_(lb_type), lb_ring_hash_config_(lb_ring_hash_config),
+      maglev_table_size_(MaglevLoadBalancer::tableSize(lb_maglev_config)),
+      common_config_(common_config),
       stats_(stats), runtime_(runtime), random_(random), fallback_policy_(subsets.fallbackPolicy()),
       default_subset_metadata_(subsets.defaultSubset().fields().begin(),
                                subsets.defaultSubset().fields().end()),
@@ -463,7 +466,8 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
     // We should make the subset LB thread aware since the calculations are costly, and then we
     // can also use a thread aware sub-LB properly. The following works fine but is not optimal.
     thread_aware_lb_.reset(new MaglevLoadBalancer(*this, subset_lb.stats_, subset_lb.runtime_,
-                                                  subset_lb.random_, subset_lb.common_config_));
+                                                  subset_lb.random_, subset_lb.common_config_,
+                                                  subset_lb.maglev_table_size_));
     thread_aware_lb_->initialize();
     lb_ = thread_aware_lb_->factory()->create();
     break;
@@ -26,6 +26,7 @@ public:
       ClusterStats& stats, Runtime::Loader& runtime, Runtime::RandomGenerator& random,
       const LoadBalancerSubsetInfo& subsets,
       const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
+      const absl::optional<envoy::api::v2::Cluster::MaglevLbConfig>& lb_maglev_config,
       const envoy::api::v2::Cluster::CommonLbConfig& common_config);
   ~SubsetLoadBalancer();
 
@@ -143,6 +144,7 @@ private:
 
   const LoadBalancerType lb_type_;
   const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
+  const uint64_t maglev_table_size_;
   const envoy::api::v2::Cluster::CommonLbConfig common_config_;
   ClusterStats& stats_;
   Runtime::Loader& runtime_;
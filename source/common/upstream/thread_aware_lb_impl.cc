@@ -1,5 +1,9 @@
 #include "common/upstream/thread_aware_lb_impl.h"
 
+#include <cmath>
+
+#include "absl/container/inlined_vector.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -11,21 +15,43 @@ void ThreadAwareLoadBalancerBase::initialize() {
   // complicated initialization as the load balancer would need its own initialized callback. I
   // think the synchronous/asynchronous split is probably the best option.
   priority_set_.addMemberUpdateCb(
-      [this](uint32_t, const HostVector&, const HostVector&) -> void { refresh(); });
+      [this](uint32_t priority, const HostVector&, const HostVector&) -> void {
+        refresh(priority);
+      });
 
-  refresh();
+  refresh(absl::nullopt);
 }
 
-void ThreadAwareLoadBalancerBase::refresh() {
+void ThreadAwareLoadBalancerBase::refresh(absl::optional<uint32_t> updated_priority) {
+  // The load balancer of a priority only depends on its own hosts, so that when one priority is
+  // updated, e.g. by a health check, the tables of the other priorities needn't be rebuilt. Only
+  // this thread writes the state, but the workers read it concurrently.
+  std::shared_ptr<std::vector<PerPriorityStatePtr>> previous_state;
+  if (updated_priority.has_value()) {
+    absl::ReaderMutexLock lock(&factory_->mutex_);
+    previous_state = factory_->per_priority_state_;
+  }
+
   auto per_priority_state_vector = std::make_shared<std::vector<PerPriorityStatePtr>>(
       priority_set_.hostSetsPerPriority().size());
   auto per_priority_load = std::make_shared<std::vector<uint32_t>>(per_priority_load_);
 
   for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
     const uint32_t priority = host_set->priority();
-    (*per_priority_state_vector)[priority].reset(new PerPriorityState);
-    const auto& per_priority_state = (*per_priority_state_vector)[priority];
+    if (previous_state != nullptr && priority != updated_priority.value() &&
+        priority < previous_state->size()) {
+      (*per_priority_state_vector)[priority] = (*previous_state)[priority];
+      continue;
+    }
+
+    auto per_priority_state = std::make_shared<PerPriorityState>();
+    (*per_priority_state_vector)[priority] = per_priority_state;
     per_priority_state->current_lb_ = createLoadBalancer(*host_set);
+    if (hash_balance_factor_ > 0) {
+      per_priority_state->current_lb_ = std::make_shared<BoundedLoadHashingLoadBalancer>(
+          per_priority_state->current_lb_, hostShares(*host_set), hash_balance_factor_,
+          stats_.upstream_rq_active_);
+    }
     per_priority_state->global_panic_ = isGlobalPanic(*host_set);
   }
 
@@ -36,6 +62,86 @@ void ThreadAwareLoadBalancerBase::refresh() {
   }
 }
 
+ThreadAwareLoadBalancerBase::HostShares
+ThreadAwareLoadBalancerBase::hostShares(const HostSet& host_set) {
+  // This mirrors the choice of hosts of createLoadBalancer(), locality weights only mattering to
+  // the load balancers which hash by weight.
+  const bool global_panic = isGlobalPanic(host_set);
+  const LocalityWeightsConstSharedPtr& locality_weights = host_set.localityWeights();
+  const bool has_locality =
+      hashesByWeight() && locality_weights != nullptr && !locality_weights->empty();
+  const HostsPerLocality& hosts_per_locality =
+      global_panic ? host_set.hostsPerLocality() : host_set.healthyHostsPerLocality();
+  const HostVector& hosts = global_panic ? host_set.hosts() : host_set.healthyHosts();
+
+  HostShares shares;
+  double total_weight = 0;
+  const auto add_host = [&](const HostSharedPtr& host, uint32_t locality_weight) {
+    const double weight = hashesByWeight() ? host->weight() * locality_weight : 1;
+    auto share = shares.emplace(host.get(), HostShare{0, static_cast<uint32_t>(shares.size())});
+    share.first->second.share_ += weight;
+    total_weight += weight;
+  };
+  if (has_locality) {
+    for (uint32_t i = 0; i < hosts_per_locality.get().size(); ++i) {
+      for (const HostSharedPtr& host : hosts_per_locality.get()[i]) {
+        add_host(host, (*locality_weights)[i]);
+      }
+    }
+  } else {
+    for (const HostSharedPtr& host : hosts) {
+      add_host(host, 1);
+    }
+  }
+
+  for (auto& share : shares) {
+    share.second.share_ /= total_weight;
+  }
+  return shares;
+}
+
+HostConstSharedPtr
+ThreadAwareLoadBalancerBase::BoundedLoadHashingLoadBalancer::chooseHost(uint64_t hash,
+                                                                        uint32_t attempt) const {
+  // The active requests of the cluster, counting this one, which the hosts may carry together.
+  const double capacity = (active_requests_.value() + 1) * balance_factor_ / 100.0;
+
+  // Should every host be at its bound, e.g. as other workers route requests concurrently, the
+  // least loaded host relative to its bound is chosen. The walk then stops once every host has been
+  // seen, or after a few probes per host, as a host with a small share may otherwise take most of
+  // the ring or table to be reached.
+  // The hosts seen are tracked in a bitmap indexed by host position, which stays inline for
+  // clusters of up to a few hundred hosts.
+  const uint64_t max_attempt = attempt + MaxProbesPerHost * shares_.size();
+  absl::InlinedVector<uint64_t, 8> hosts_at_bound((shares_.size() + 63) / 64);
+  size_t num_hosts_at_bound = 0;
+  HostConstSharedPtr least_loaded;
+  double least_load = 0;
+  for (HostConstSharedPtr host;
+       attempt < max_attempt && (host = lb_->chooseHost(hash, attempt)) != nullptr; ++attempt) {
+    const auto share = shares_.find(host.get());
+    ASSERT(share != shares_.end());
+    const double slots = std::ceil(capacity * share->second.share_);
+    const double load = host->stats().rq_active_.value() / slots;
+    if (load < 1) {
+      return host;
+    }
+    if (least_loaded == nullptr || load < least_load) {
+      least_loaded = host;
+      least_load = load;
+    }
+    uint64_t& word = hosts_at_bound[share->second.index_ / 64];
+    const uint64_t bit = uint64_t(1) << (share->second.index_ % 64);
+    if ((word & bit) == 0) {
+      word |= bit;
+      if (++num_hosts_at_bound == shares_.size()) {
+        break;
+      }
+    }
+  }
+  return least_loaded;
+}
+
 HostConstSharedPtr
 ThreadAwareLoadBalancerBase::LoadBalancerImpl::chooseHost(LoadBalancerContext* context) {
   // Make sure we correctly return nullptr for any early chooseHost() calls.
@@ -56,7 +162,7 @@ ThreadAwareLoadBalancerBase::LoadBalancerImpl::chooseHost(LoadBalancerContext* c
   if (per_priority_state->global_panic_) {
     stats_.lb_healthy_panic_.inc();
   }
-  return per_priority_state->current_lb_->chooseHost(h);
+  return per_priority_state->current_lb_->chooseHost(h, 0);
 }
 
 LoadBalancerPtr ThreadAwareLoadBalancerBase::LoadBalancerFactoryImpl::create() {
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <unordered_map>
+
+#include "common/protobuf/utility.h"
 #include "common/upstream/load_balancer_impl.h"
 
 #include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -20,7 +24,14 @@ public:
   class HashingLoadBalancer {
   public:
     virtual ~HashingLoadBalancer() {}
-    virtual HostConstSharedPtr chooseHost(uint64_t hash) const PURE;
+
+    /**
+     * @param hash supplies the hash of the request.
+     * @param attempt supplies the number of ring or table entries to walk past the entry owning the
+     *        hash, so that bounded loads can fall back to the following hosts.
+     * @return HostConstSharedPtr the host, or nullptr once attempt has walked past every entry.
+     */
+    virtual HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const PURE;
   };
   typedef std::shared_ptr<HashingLoadBalancer> HashingLoadBalancerSharedPtr;
 
@@ -38,14 +49,52 @@ protected:
                               Runtime::Loader& runtime, Runtime::RandomGenerator& random,
                               const envoy::api::v2::Cluster::CommonLbConfig& common_config)
       : LoadBalancerBase(priority_set, stats, runtime, random, common_config),
+        hash_balance_factor_(
+            PROTOBUF_GET_WRAPPED_OR_DEFAULT(common_config, hash_balance_factor, 0)),
         factory_(new LoadBalancerFactoryImpl(stats, random)) {}
 
 private:
+  struct HostShare {
+    // Share of the hash space of the host. The shares of all the hosts sum to 1.
+    double share_;
+    // Position of the host among the hosts sharing the hash space, from 0.
+    uint32_t index_;
+  };
+  typedef std::unordered_map<const Host*, HostShare> HostShares;
+
+  /**
+   * Bounds the load of the hosts of another hashing load balancer, as in "Consistent Hashing with
+   * Bounded Loads" (https://arxiv.org/abs/1608.01350). A host may carry up to balance_factor
+   * percent of its share of the active requests of the cluster, counting the request being routed,
+   * after which the request goes to the first following host of the ring or table below its bound.
+   * Should no host within a bounded walk be below its bound, the least loaded one is chosen.
+   */
+  class BoundedLoadHashingLoadBalancer : public HashingLoadBalancer {
+  public:
+    BoundedLoadHashingLoadBalancer(HashingLoadBalancerSharedPtr lb, HostShares&& shares,
+                                   uint32_t balance_factor, Stats::Gauge& active_requests)
+        : lb_(std::move(lb)), shares_(std::move(shares)), balance_factor_(balance_factor),
+          active_requests_(active_requests) {}
+
+    // ThreadAwareLoadBalancerBase::HashingLoadBalancer
+    HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
+
+  private:
+    // The number of probes per host after which a request goes to the least loaded host seen.
+    static const uint32_t MaxProbesPerHost = 8;
+
+    const HashingLoadBalancerSharedPtr lb_;
+    const HostShares shares_;
+    const uint32_t balance_factor_;
+    Stats::Gauge& active_requests_;
+  };
+
   struct PerPriorityState {
     std::shared_ptr<HashingLoadBalancer> current_lb_;
     bool global_panic_{};
   };
-  typedef std::unique_ptr<PerPriorityState> PerPriorityStatePtr;
+  // Shared by the successive states of the priorities which didn't change.
+  typedef std::shared_ptr<const PerPriorityState> PerPriorityStatePtr;
 
   struct LoadBalancerImpl : public LoadBalancer {
     LoadBalancerImpl(ClusterStats& stats, Runtime::RandomGenerator& random)
@@ -76,8 +125,28 @@ private:
   };
 
   virtual HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) PURE;
-  void refresh();
 
+  /**
+   * @return whether createLoadBalancer() spreads keys by host and locality weight. Otherwise, all
+   *         the hosts it is given own an equal share of the keys.
+   */
+  virtual bool hashesByWeight() const PURE;
+
+  /**
+   * @return HostShares the share of the keys of each host of the load balancer which
+   *         createLoadBalancer() returns for host_set.
+   */
+  HostShares hostShares(const HostSet& host_set);
+
+  /**
+   * Rebuilds the load balancers of the priorities and publishes them to the workers.
+   * @param updated_priority supplies the only priority whose hosts changed, if known. The load
+   *        balancers of the other priorities are kept.
+   */
+  void refresh(absl::optional<uint32_t> updated_priority);
+
+  // Zero unless loads are bounded.
+  const uint32_t hash_balance_factor_;
   std::shared_ptr<LoadBalancerFactoryImpl> factory_;
 };
 
@@ -322,12 +322,14 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
       stats_(generateStats(*stats_scope_)),
       load_report_stats_(generateLoadReportStats(load_report_stats_store_)),
       features_(parseFeatures(config)),
+      http1_settings_(Http::Utility::parseHttp1Settings(config.http_protocol_options())),
       http2_settings_(Http::Utility::parseHttp2Settings(config.http2_protocol_options())),
       extension_protocol_options_(parseExtensionProtocolOptions(config)),
       resource_managers_(config, runtime, name_),
       maintenance_mode_runtime_key_(fmt::format("upstream.maintenance_mode.{}", name_)),
       source_address_(getSourceAddress(config, bind_config)),
       lb_ring_hash_config_(config.ring_hash_lb_config()),
+      lb_maglev_config_(config.maglev_lb_config()),
       lb_original_dst_config_(config.original_dst_lb_config()), added_via_api_(added_via_api),
       lb_subset_(LoadBalancerSubsetInfoImpl(config.lb_subset_config())),
       metadata_(config.metadata()), common_lb_config_(config.common_lb_config()),
@@ -356,6 +358,11 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
     break;
   case envoy::api::v2::Cluster::MAGLEV:
     lb_type_ = LoadBalancerType::Maglev;
+    if (config.has_maglev_lb_config() && config.maglev_lb_config().has_table_size() &&
+        !Primes::isPrime(config.maglev_lb_config().table_size().value())) {
+      throw EnvoyException(fmt::format("cluster: maglev table size {} is not a prime number",
+                                       config.maglev_lb_config().table_size().value()));
+    }
     break;
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
@@ -652,11 +659,9 @@ void ClusterImplBase::reloadHealthyHosts() {
   }
 
   for (auto& host_set : prioritySet().hostSetsPerPriority()) {
-    // TODO(htuch): Can we skip these copies by exporting out const shared_ptr from HostSet?
-    HostVectorConstSharedPtr hosts_copy(new HostVector(host_set->hosts()));
-    HostsPerLocalityConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocality().clone();
-    host_set->updateHosts(hosts_copy, createHealthyHostList(host_set->hosts()),
-                          hosts_per_locality_copy,
+    // Only health changed, so the host snapshots are kept.
+    host_set->updateHosts(host_set->hostsPtr(), createHealthyHostList(host_set->hosts()),
+                          host_set->hostsPerLocalityPtr(),
                           createHealthyHostLists(host_set->hostsPerLocality()),
                           host_set->localityWeights(), {}, {}, absl::nullopt);
   }
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <memory>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/compiler_requirements.h"
 #include "common/common/perf_annotation.h"
 #include "common/event/libevent.h"
@@ -41,6 +42,9 @@ Runtime::LoaderPtr ProdComponentFactory::createRuntime(Server::Instance& server,
 MainCommonBase::MainCommonBase(OptionsImpl& options) : options_(options) {
   ares_library_init(ARES_LIB_INIT_ALL);
   Event::Libevent::Global::initialize();
+  // This must happen before any buffers are created, since each buffer latches its implementation
+  // at construction time.
+  Buffer::OwnedImpl::useOldImpl(options_.libeventBuffersEnabled());
   RELEASE_ASSERT(Envoy::Server::validateProtoDescriptors(), "");
 
   switch (options_.mode()) {
@@ -52,7 +56,7 @@ MainCommonBase::MainCommonBase(OptionsImpl& options) : options_(options) {
     }
 #endif
     if (restarter_.get() == nullptr) {
-      restarter_.reset(new Server::HotRestartNopImpl());
+      restarter_.reset(new Server::HotRestartNopImpl(symbol_table_));
     }
 
     tls_.reset(new ThreadLocal::InstanceImpl);
@@ -62,8 +66,8 @@ MainCommonBase::MainCommonBase(OptionsImpl& options) : options_(options) {
     logging_context_ =
         std::make_unique<Logger::Context>(options_.logLevel(), options_.logFormat(), log_lock);
 
-    stats_store_ = std::make_unique<Stats::ThreadLocalStoreImpl>(options_.statsOptions(),
-                                                                 restarter_->statsAllocator());
+    stats_store_ = std::make_unique<Stats::ThreadLocalStoreImpl>(
+        options_.statsOptions(), restarter_->statsAllocator(), symbol_table_);
 
     server_ = std::make_unique<Server::InstanceImpl>(
         options_, time_system_, local_address, default_test_hooks_, *restarter_, *stats_store_,
@@ -72,7 +76,7 @@ MainCommonBase::MainCommonBase(OptionsImpl& options) : options_(options) {
     break;
   }
   case Server::Mode::Validate:
-    restarter_.reset(new Server::HotRestartNopImpl());
+    restarter_.reset(new Server::HotRestartNopImpl(symbol_table_));
     logging_context_ = std::make_unique<Logger::Context>(options_.logLevel(), options_.logFormat(),
                                                          restarter_->logLock());
     break;
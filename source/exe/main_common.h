@@ -53,6 +53,8 @@ protected:
   Event::RealTimeSystem time_system_;
   DefaultTestHooks default_test_hooks_;
   std::unique_ptr<ThreadLocal::InstanceImpl> tls_;
+  // Shared by the stats store and the stats allocator of the restarter.
+  Stats::SymbolTableImpl symbol_table_;
   std::unique_ptr<Server::HotRestart> restarter_;
   std::unique_ptr<Stats::ThreadLocalStoreImpl> stats_store_;
   std::unique_ptr<Logger::Context> logging_context_;
@@ -40,9 +40,10 @@ void Writer::write(const std::string& message) {
 
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
                              Network::Address::InstanceConstSharedPtr address, const bool use_tag,
-                             const std::string& prefix)
+                             const std::string& prefix, const bool changed_stats_only)
     : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
-      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix) {
+      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
+      changed_stats_only_(changed_stats_only) {
   tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<Writer>(this->server_address_);
   });
@@ -50,22 +51,42 @@ UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
 
 void UdpStatsdSink::flush(Stats::Source& source) {
   Writer& writer = tls_->getTyped<Writer>();
+  if (changed_stats_only_) {
+    // Statsd servers keep the last value of a gauge and treat a missing counter as zero, so the
+    // stats that didn't change since the previous flush can be skipped.
+    for (const Stats::CounterSharedPtr& counter : source.changedCounters()) {
+      flushCounter(writer, *counter);
+    }
+    for (const Stats::GaugeSharedPtr& gauge : source.changedGauges()) {
+      flushGauge(writer, *gauge);
+    }
+    return;
+  }
+
   for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
     if (counter->used()) {
-      uint64_t delta = counter->latch();
-      writer.write(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
-                               buildTagStr(counter->tags())));
+      flushCounter(writer, *counter);
     }
   }
 
   for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
     if (gauge->used()) {
-      writer.write(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
-                               buildTagStr(gauge->tags())));
+      flushGauge(writer, *gauge);
     }
   }
 }
 
+void UdpStatsdSink::flushCounter(Writer& writer, Stats::Counter& counter) {
+  uint64_t delta = counter.latch();
+  writer.write(fmt::format("{}.{}:{}|c{}", prefix_, getName(counter), delta,
+                           buildTagStr(counter.tags())));
+}
+
+void UdpStatsdSink::flushGauge(Writer& writer, const Stats::Gauge& gauge) {
+  writer.write(fmt::format("{}.{}:{}|g{}", prefix_, getName(gauge), gauge.value(),
+                           buildTagStr(gauge.tags())));
+}
+
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
   // For statsd histograms are all timers.
   const std::string message(fmt::format("{}.{}:{}|ms{}", prefix_, getName(histogram),
@@ -98,8 +119,9 @@ const std::string UdpStatsdSink::buildTagStr(const std::vector<Stats::Tag>& tags
 TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
                              const std::string& cluster_name, ThreadLocal::SlotAllocator& tls,
                              Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
-                             const std::string& prefix)
-    : prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix), tls_(tls.allocateSlot()),
+                             const std::string& prefix, const bool changed_stats_only)
+    : prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
+      changed_stats_only_(changed_stats_only), tls_(tls.allocateSlot()),
       cluster_manager_(cluster_manager), cx_overflow_stat_(scope.counter("statsd.cx_overflow")) {
 
   Config::Utility::checkClusterAndLocalInfo("tcp statsd", cluster_name, cluster_manager,
@@ -113,16 +135,26 @@ TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
 void TcpStatsdSink::flush(Stats::Source& source) {
   TlsSink& tls_sink = tls_->getTyped<TlsSink>();
   tls_sink.beginFlush(true);
-  for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
-    if (counter->used()) {
+  if (changed_stats_only_) {
+    // See UdpStatsdSink::flush() for why the stats that didn't change can be skipped.
+    for (const Stats::CounterSharedPtr& counter : source.changedCounters()) {
       tls_sink.flushCounter(counter->name(), counter->latch());
     }
-  }
-
-  for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
-    if (gauge->used()) {
+    for (const Stats::GaugeSharedPtr& gauge : source.changedGauges()) {
       tls_sink.flushGauge(gauge->name(), gauge->value());
     }
+  } else {
+    for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
+      if (counter->used()) {
+        tls_sink.flushCounter(counter->name(), counter->latch());
+      }
+    }
+
+    for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
+      if (gauge->used()) {
+        tls_sink.flushGauge(gauge->name(), gauge->value());
+      }
+    }
   }
   tls_sink.endFlush(true);
 }
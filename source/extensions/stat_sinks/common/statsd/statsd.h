@@ -46,18 +46,22 @@ private:
 class UdpStatsdSink : public Stats::Sink {
 public:
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix());
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                const bool changed_stats_only = false);
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix())
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                const bool changed_stats_only = false)
       : tls_(tls.allocateSlot()), use_tag_(use_tag),
-        prefix_(prefix.empty() ? getDefaultPrefix() : prefix) {
+        prefix_(prefix.empty() ? getDefaultPrefix() : prefix),
+        changed_stats_only_(changed_stats_only) {
     tls_->set(
         [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
   }
 
   // Stats::Sink
   void flush(Stats::Source& source) override;
+  bool flushesChangedStatsOnly() const override { return changed_stats_only_; }
   void onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) override;
 
   // Called in unit test to validate writer construction and address.
@@ -66,6 +70,8 @@ public:
   const std::string& getPrefix() { return prefix_; }
 
 private:
+  void flushCounter(Writer& writer, Stats::Counter& counter);
+  void flushGauge(Writer& writer, const Stats::Gauge& gauge);
   const std::string getName(const Stats::Metric& metric);
   const std::string buildTagStr(const std::vector<Stats::Tag>& tags);
 
@@ -74,6 +80,8 @@ private:
   const bool use_tag_;
   // Prefix for all flushed stats.
   const std::string prefix_;
+  // Whether a flush skips the stats that didn't change since the previous one.
+  const bool changed_stats_only_;
 };
 
 /**
@@ -83,10 +91,12 @@ class TcpStatsdSink : public Stats::Sink {
 public:
   TcpStatsdSink(const LocalInfo::LocalInfo& local_info, const std::string& cluster_name,
                 ThreadLocal::SlotAllocator& tls, Upstream::ClusterManager& cluster_manager,
-                Stats::Scope& scope, const std::string& prefix = getDefaultPrefix());
+                Stats::Scope& scope, const std::string& prefix = getDefaultPrefix(),
+                const bool changed_stats_only = false);
 
   // Stats::Sink
   void flush(Stats::Source& source) override;
+  bool flushesChangedStatsOnly() const override { return changed_stats_only_; }
   void onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) override {
     // For statsd histograms are all timers.
     tls_->getTyped<TlsSink>().onTimespanComplete(histogram.name(),
@@ -131,6 +141,8 @@ private:
 
   // Prefix for all flushed stats.
   const std::string prefix_;
+  // Whether a flush skips the stats that didn't change since the previous one.
+  const bool changed_stats_only_;
 
   Upstream::ClusterInfoConstSharedPtr cluster_info_;
   ThreadLocal::SlotPtr tls_;
@@ -329,13 +329,13 @@ void HystrixSink::flush(Stats::Source& source) {
   for (const Stats::ParentHistogramSharedPtr& histogram : source.cachedHistograms()) {
     if (histogram->tagExtractedName() == "cluster.upstream_rq_time") {
       // TODO(mrice32): add an Envoy utility function to look up and return a tag for a metric.
-      auto it = std::find_if(histogram->tags().begin(), histogram->tags().end(),
-                             [](const Stats::Tag& tag) {
-                               return (tag.name_ == Config::TagNames::get().CLUSTER_NAME);
-                             });
+      const std::vector<Stats::Tag>& tags = histogram->tags();
+      auto it = std::find_if(tags.begin(), tags.end(), [](const Stats::Tag& tag) {
+        return (tag.name_ == Config::TagNames::get().CLUSTER_NAME);
+      });
 
       // Make sure we found the cluster name tag
-      ASSERT(it != histogram->tags().end());
+      ASSERT(it != tags.end());
       auto it_bool_pair = time_histograms.emplace(std::make_pair(it->value_, QuantileLatencyMap()));
       // Make sure histogram with this name was not already added
       ASSERT(it_bool_pair.second);
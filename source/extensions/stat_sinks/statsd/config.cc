@@ -24,14 +24,16 @@ Stats::SinkPtr StatsdSinkFactory::createStatsSink(const Protobuf::Message& confi
     Network::Address::InstanceConstSharedPtr address =
         Network::Address::resolveProtoAddress(statsd_sink.address());
     ENVOY_LOG(debug, "statsd UDP ip address: {}", address->asString());
-    return std::make_unique<Common::Statsd::UdpStatsdSink>(server.threadLocal(), std::move(address),
-                                                           false, statsd_sink.prefix());
+    return std::make_unique<Common::Statsd::UdpStatsdSink>(
+        server.threadLocal(), std::move(address), false, statsd_sink.prefix(),
+        statsd_sink.flush_changed_stats_only());
   }
   case envoy::config::metrics::v2::StatsdSink::kTcpClusterName:
     ENVOY_LOG(debug, "statsd TCP cluster: {}", statsd_sink.tcp_cluster_name());
     return std::make_unique<Common::Statsd::TcpStatsdSink>(
         server.localInfo(), statsd_sink.tcp_cluster_name(), server.threadLocal(),
-        server.clusterManager(), server.stats(), statsd_sink.prefix());
+        server.clusterManager(), server.stats(), statsd_sink.prefix(),
+        statsd_sink.flush_changed_stats_only());
   default:
     // Verified by schema.
     NOT_REACHED_GCOVR_EXCL_LINE;
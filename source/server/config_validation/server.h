@@ -122,6 +122,11 @@ public:
     // validation mock.
     return nullptr;
   }
+  Network::SocketSharedPtr createWorkerListenSocket(Network::Address::InstanceConstSharedPtr,
+                                                    const Network::Socket::OptionsSharedPtr&,
+                                                    uint32_t) override {
+    return nullptr;
+  }
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType) override {
     return nullptr;
   }
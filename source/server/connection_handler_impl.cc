@@ -14,8 +14,9 @@
 namespace Envoy {
 namespace Server {
 
-ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
-    : logger_(logger), dispatcher_(dispatcher) {}
+ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                                             absl::optional<uint32_t> worker_index)
+    : logger_(logger), dispatcher_(dispatcher), worker_index_(worker_index) {}
 
 void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
   ActiveListenerPtr l(new ActiveListener(*this, config));
@@ -35,14 +36,14 @@ void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
 void ConnectionHandlerImpl::stopListeners(uint64_t listener_tag) {
   for (auto& listener : listeners_) {
     if (listener.second->listener_tag_ == listener_tag) {
-      listener.second->listener_.reset();
+      listener.second->stop();
     }
   }
 }
 
 void ConnectionHandlerImpl::stopListeners() {
   for (auto& listener : listeners_) {
-    listener.second->listener_.reset();
+    listener.second->stop();
   }
 }
 
@@ -55,12 +56,21 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
   parent_.num_connections_--;
 }
 
+void ConnectionHandlerImpl::ActiveListener::stop() {
+  if (listener_ != nullptr) {
+    config_.connectionBalancer().unregisterHandler(*this);
+    listener_.reset();
+  }
+}
+
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
                                                       Network::ListenerConfig& config)
     : ActiveListener(
           parent,
-          parent.dispatcher_.createListener(config.socket(), *this, config.bindToPort(),
-                                            config.handOffRestoredDestinationConnections()),
+          parent.dispatcher_.createListener(
+              parent.worker_index_ ? config.workerSocket(parent.worker_index_.value())
+                                   : config.socket(),
+              *this, config.bindToPort(), config.handOffRestoredDestinationConnections()),
           config) {}
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
@@ -68,9 +78,20 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& par
                                                       Network::ListenerConfig& config)
     : parent_(parent), listener_(std::move(listener)),
       stats_(generateStats(config.listenerScope())), listener_tag_(config.listenerTag()),
-      config_(config) {}
+      config_(config) {
+  if (parent_.worker_index_) {
+    per_worker_stats_ = std::make_unique<PerWorkerListenerStats>(
+        generatePerWorkerStats(config.listenerScope(), parent_.worker_index_.value()));
+  }
+  // Only listening handlers are balanced to, and stop() unregisters them.
+  if (listener_ != nullptr) {
+    config_.connectionBalancer().registerHandler(*this);
+  }
+}
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
+  stop();
+
   // Purge sockets that have not progressed to connections. This should only happen when
   // a listener filter stops iteration and never resumes.
   while (!sockets_.empty()) {
@@ -120,6 +141,18 @@ ConnectionHandlerImpl::findActiveListenerByAddress(const Network::Address::Insta
   return (listener_it != listeners_.end()) ? listener_it->second.get() : nullptr;
 }
 
+ConnectionHandlerImpl::ActiveListener*
+ConnectionHandlerImpl::findActiveListenerByTag(uint64_t listener_tag) {
+  // Like the search by address, this is linear in the number of listeners, which is small. We do
+  // not return stopped listeners.
+  for (const auto& listener : listeners_) {
+    if (listener.second->listener_tag_ == listener_tag && listener.second->listener_ != nullptr) {
+      return listener.second.get();
+    }
+  }
+  return nullptr;
+}
+
 void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
   if (success) {
     if (iter_ == accept_filters_.end()) {
@@ -149,7 +182,7 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
       // Hands off connections redirected by iptables to the listener associated with the
       // original destination address. Pass 'hand_off_restored_destionations' as false to
       // prevent further redirection.
-      new_listener->onAccept(std::move(socket_), false);
+      new_listener->onAcceptWorker(std::move(socket_), false, true);
     } else {
       // Set default transport protocol if none of the listener filters did it.
       if (socket_->detectedTransportProtocol().empty()) {
@@ -170,7 +203,16 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
 
 void ConnectionHandlerImpl::ActiveListener::onAccept(
     Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
-  Network::Address::InstanceConstSharedPtr local_address = socket->localAddress();
+  onAcceptWorker(std::move(socket), hand_off_restored_destination_connections, false);
+}
+
+void ConnectionHandlerImpl::ActiveListener::onAcceptWorker(
+    Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections,
+    bool rebalanced) {
+  if (!rebalanced && config_.connectionBalancer().balanceSocket(*this, socket)) {
+    return;
+  }
+
   auto active_socket = std::make_unique<ActiveSocket>(*this, std::move(socket),
                                                       hand_off_restored_destination_connections);
 
@@ -226,6 +268,28 @@ void ConnectionHandlerImpl::ActiveListener::onNewConnection(
   }
 }
 
+void ConnectionHandlerImpl::ActiveListener::post(Network::ConnectionSocketPtr&& socket) {
+  // The posted callback must be copyable, so it can't own the socket directly. The callback looks
+  // up the listener again, as it may have been stopped or removed from this worker by then, in
+  // which case the socket is closed.
+  std::shared_ptr<Network::ConnectionSocketPtr> posted_socket =
+      std::make_shared<Network::ConnectionSocketPtr>(std::move(socket));
+  ConnectionHandlerImpl& parent = parent_;
+  const uint64_t listener_tag = listener_tag_;
+  const bool hand_off_restored_destination_connections =
+      config_.handOffRestoredDestinationConnections();
+  parent_.dispatcher_.post(
+      [posted_socket, &parent, listener_tag, hand_off_restored_destination_connections]() {
+        ActiveListener* listener = parent.findActiveListenerByTag(listener_tag);
+        if (listener != nullptr) {
+          // The socket becomes a connection, if at all, which counts itself.
+          listener->num_listener_connections_--;
+          listener->onAcceptWorker(std::move(*posted_socket),
+                                   hand_off_restored_destination_connections, true);
+        }
+      });
+}
+
 ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listener,
                                                           Network::ConnectionPtr&& new_connection,
                                                           Event::TimeSystem& time_system)
@@ -237,11 +301,20 @@ ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listen
   connection_->addConnectionCallbacks(*this);
   listener_.stats_.downstream_cx_total_.inc();
   listener_.stats_.downstream_cx_active_.inc();
+  listener_.num_listener_connections_++;
+  if (listener_.per_worker_stats_) {
+    listener_.per_worker_stats_->downstream_cx_total_.inc();
+    listener_.per_worker_stats_->downstream_cx_active_.inc();
+  }
 }
 
 ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
   listener_.stats_.downstream_cx_active_.dec();
   listener_.stats_.downstream_cx_destroy_.inc();
+  listener_.num_listener_connections_--;
+  if (listener_.per_worker_stats_) {
+    listener_.per_worker_stats_->downstream_cx_active_.dec();
+  }
   conn_length_->complete();
 }
 
@@ -249,5 +322,12 @@ ListenerStats ConnectionHandlerImpl::generateStats(Stats::Scope& scope) {
   return {ALL_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
+PerWorkerListenerStats ConnectionHandlerImpl::generatePerWorkerStats(Stats::Scope& scope,
+                                                                     uint32_t worker_index) {
+  const std::string prefix = fmt::format("worker_{}.", worker_index);
+  return {ALL_PER_WORKER_LISTENER_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                        POOL_GAUGE_PREFIX(scope, prefix))};
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -8,6 +8,7 @@
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -19,6 +20,7 @@
 #include "common/common/linked_object.h"
 #include "common/common/non_copyable.h"
 
+#include "absl/types/optional.h"
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -40,13 +42,33 @@ struct ListenerStats {
   ALL_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
+// clang-format off
+#define ALL_PER_WORKER_LISTENER_STATS(COUNTER, GAUGE)                                              \
+  COUNTER(downstream_cx_total)                                                                     \
+  GAUGE  (downstream_cx_active)
+// clang-format on
+
+/**
+ * Wrapper struct for per worker listener stats. @see stats_macros.h
+ */
+struct PerWorkerListenerStats {
+  ALL_PER_WORKER_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * Server side connection handler. This is used both by workers as well as the
  * main thread for non-threaded listeners.
  */
 class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
 public:
-  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  /**
+   * @param logger supplies the logger to log to.
+   * @param dispatcher supplies the dispatcher the listeners run on.
+   * @param worker_index supplies the index of the worker the handler runs on, if any. Listeners
+   *        then accept on the socket of that worker, and have per worker connection stats.
+   */
+  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                        absl::optional<uint32_t> worker_index = absl::nullopt);
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
@@ -60,6 +82,7 @@ public:
 private:
   struct ActiveListener;
   ActiveListener* findActiveListenerByAddress(const Network::Address::Instance& address);
+  ActiveListener* findActiveListenerByTag(uint64_t listener_tag);
 
   struct ActiveConnection;
   typedef std::unique_ptr<ActiveConnection> ActiveConnectionPtr;
@@ -69,7 +92,8 @@ private:
   /**
    * Wrapper for an active listener owned by this handler.
    */
-  struct ActiveListener : public Network::ListenerCallbacks {
+  struct ActiveListener : public Network::ListenerCallbacks,
+                          public Network::BalancedConnectionHandler {
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
 
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerPtr&& listener,
@@ -82,6 +106,28 @@ private:
                   bool hand_off_restored_destination_connections) override;
     void onNewConnection(Network::ConnectionPtr&& new_connection) override;
 
+    // Network::BalancedConnectionHandler
+    uint64_t numConnections() const override { return num_listener_connections_; }
+    void incNumConnections() override { num_listener_connections_++; }
+    void post(Network::ConnectionSocketPtr&& socket) override;
+
+    /**
+     * Take over an accepted socket, after handing it to the handler of another worker picked by the
+     * listener's connection balancer, unless it was already rebalanced.
+     * @param socket supplies the socket that is moved into the callee.
+     * @param hand_off_restored_destination_connections supplies whether the socket may be handed
+     *        off to the listener of its original destination address.
+     * @param rebalanced supplies whether the socket was already handed to this listener by another
+     *        one, in which case it isn't handed to another handler again.
+     */
+    void onAcceptWorker(Network::ConnectionSocketPtr&& socket,
+                        bool hand_off_restored_destination_connections, bool rebalanced);
+
+    /**
+     * Stop accepting connections, including the sockets balanced from other workers.
+     */
+    void stop();
+
     /**
      * Remove and destroy an active connection.
      * @param connection supplies the connection to remove.
@@ -96,10 +142,15 @@ private:
     ConnectionHandlerImpl& parent_;
     Network::ListenerPtr listener_;
     ListenerStats stats_;
+    // Only set on workers.
+    std::unique_ptr<PerWorkerListenerStats> per_worker_stats_;
     std::list<ActiveSocketPtr> sockets_;
     std::list<ActiveConnectionPtr> connections_;
     const uint64_t listener_tag_;
     Network::ListenerConfig& config_;
+    // The active connections, plus the sockets the balancer picked this listener for, which are
+    // still being posted to it. Read by the balancer from other workers.
+    std::atomic<uint64_t> num_listener_connections_{};
   };
 
   typedef std::unique_ptr<ActiveListener> ActiveListenerPtr;
@@ -162,9 +213,11 @@ private:
   };
 
   static ListenerStats generateStats(Stats::Scope& scope);
+  static PerWorkerListenerStats generatePerWorkerStats(Stats::Scope& scope, uint32_t worker_index);
 
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
+  const absl::optional<uint32_t> worker_index_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
   std::atomic<uint64_t> num_connections_{};
 };
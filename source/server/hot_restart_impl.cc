@@ -28,7 +28,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 10;
+const uint64_t SharedMemory::VERSION = 11;
 
 static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
   BlockMemoryHashSetOptions hash_set_options;
@@ -228,7 +228,8 @@ void HotRestartImpl::drainParentListeners() {
   shmem_.flags_ &= ~SharedMemory::Flags::INITIALIZING;
 }
 
-int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
+int HotRestartImpl::duplicateParentListenSocket(const std::string& address,
+                                                uint32_t worker_index) {
   if (options_.restartEpoch() == 0 || parent_terminated_) {
     return -1;
   }
@@ -236,6 +237,7 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   RpcGetListenSocketRequest rpc;
   ASSERT(address.length() < sizeof(rpc.address_));
   StringUtil::strlcpy(rpc.address_, address.c_str(), sizeof(rpc.address_));
+  rpc.worker_index_ = worker_index;
   sendMessage(parent_address_, rpc);
   RpcGetListenSocketReply* reply =
       receiveTypedRpc<RpcGetListenSocketReply, RpcMessageType::GetListenSocketReply>();
@@ -366,7 +368,14 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
       Network::Utility::resolveUrl(std::string(rpc.address_));
   for (const auto& listener : server_->listenerManager().listeners()) {
     if (*listener.get().socket().localAddress() == *addr) {
-      reply.fd_ = listener.get().socket().fd();
+      // Worker sockets are only handed over if the listener has its own socket per worker, and
+      // there is none for the workers the child has beyond ours.
+      if (rpc.worker_index_ == 0) {
+        reply.fd_ = listener.get().socket().fd();
+      } else if (rpc.worker_index_ < options_.concurrency() &&
+                 &listener.get().workerSocket(rpc.worker_index_) != &listener.get().socket()) {
+        reply.fd_ = listener.get().workerSocket(rpc.worker_index_).fd();
+      }
       break;
     }
   }
@@ -5,6 +5,8 @@
 #include "envoy/server/hot_restart.h"
 
 #include "common/common/thread.h"
+#include "common/stats/heap_stat_data.h"
+#include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
 namespace Server {
@@ -14,11 +16,15 @@ namespace Server {
  */
 class HotRestartNopImpl : public Server::HotRestart {
 public:
-  HotRestartNopImpl() {}
+  /**
+   * @param symbol_table the symbol table of the stats store the allocator serves.
+   */
+  explicit HotRestartNopImpl(Stats::SymbolTableImpl& symbol_table)
+      : stats_allocator_(symbol_table) {}
 
   // Server::HotRestart
   void drainParentListeners() override {}
-  int duplicateParentListenSocket(const std::string&) override { return -1; }
+  int duplicateParentListenSocket(const std::string&, uint32_t) override { return -1; }
   void getParentStats(GetParentStatsInfo& info) override { memset(&info, 0, sizeof(info)); }
   void initialize(Event::Dispatcher&, Server::Instance&) override {}
   void shutdownParentAdmin(ShutdownParentAdminInfo&) override {}
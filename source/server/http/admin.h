@@ -26,6 +26,7 @@
 #include "common/http/date_provider_impl.h"
 #include "common/http/default_server_string.h"
 #include "common/http/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/stats/isolated_store_impl.h"
 
@@ -241,17 +242,20 @@ private:
     Network::FilterChainManager& filterChainManager() override { return parent_; }
     Network::FilterChainFactory& filterChainFactory() override { return parent_; }
     Network::Socket& socket() override { return parent_.mutable_socket(); }
+    Network::Socket& workerSocket(uint32_t) override { return socket(); }
     bool bindToPort() override { return true; }
     bool handOffRestoredDestinationConnections() const override { return false; }
     uint32_t perConnectionBufferLimitBytes() override { return 0; }
     Stats::Scope& listenerScope() override { return *scope_; }
     uint64_t listenerTag() const override { return 0; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
 
     AdminImpl& parent_;
     const std::string name_;
     Stats::ScopePtr scope_;
     Http::ConnectionManagerListenerStats stats_;
+    Network::NopConnectionBalancerImpl connection_balancer_;
   };
 
   class AdminFilterChain : public Network::FilterChain {
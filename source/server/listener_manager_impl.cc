@@ -10,9 +10,11 @@
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/config/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/socket_option_factory.h"
+#include "common/network/socket_option_impl.h"
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
 
@@ -94,7 +96,7 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   // First we try to get the socket from our parent if applicable.
   if (address->type() == Network::Address::Type::Pipe) {
     const std::string addr = fmt::format("unix://{}", address->asString());
-    const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+    const int fd = server_.hotRestart().duplicateParentListenSocket(addr, 0);
     if (fd != -1) {
       ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
       return std::make_shared<Network::UdsListenSocket>(fd, address);
@@ -103,7 +105,7 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   }
 
   const std::string addr = fmt::format("tcp://{}", address->asString());
-  const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, 0);
   if (fd != -1) {
     ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
     return std::make_shared<Network::TcpListenSocket>(fd, address, options);
@@ -111,6 +113,22 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   return std::make_shared<Network::TcpListenSocket>(address, options, bind_to_port);
 }
 
+Network::SocketSharedPtr ProdListenerComponentFactory::createWorkerListenSocket(
+    Network::Address::InstanceConstSharedPtr address,
+    const Network::Socket::OptionsSharedPtr& options, uint32_t worker_index) {
+  ASSERT(address->type() == Network::Address::Type::Ip);
+  ASSERT(worker_index > 0);
+
+  // The parent's worker with the same index hands over its socket, if it has one.
+  const std::string addr = fmt::format("tcp://{}", address->asString());
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
+  if (fd != -1) {
+    ENVOY_LOG(debug, "obtained socket of worker {} for address {} from parent", worker_index, addr);
+    return std::make_shared<Network::TcpListenSocket>(fd, address, options);
+  }
+  return std::make_shared<Network::TcpListenSocket>(address, options, true);
+}
+
 DrainManagerPtr
 ProdListenerComponentFactory::createDrainManager(envoy::api::v2::Listener::DrainType drain_type) {
   return DrainManagerPtr{new DrainManagerImpl(server_, drain_type)};
@@ -124,6 +142,7 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
       listener_scope_(
           parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      reuse_port_(bind_to_port_ && PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, reuse_port, false)),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
@@ -132,6 +151,20 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
       workers_started_(workers_started), hash_(hash),
       local_drain_manager_(parent.factory_.createDrainManager(config.drain_type())),
       config_(config), version_info_(version_info) {
+  if (config.has_connection_balance_config()) {
+    // Exact balance is the only balance type for now.
+    ASSERT(config.connection_balance_config().has_exact_balance());
+    connection_balancer_ = std::make_unique<Network::ExactConnectionBalancerImpl>();
+  } else {
+    connection_balancer_ = std::make_unique<Network::NopConnectionBalancerImpl>();
+  }
+  if (reuse_port_) {
+    if (address_->type() != Network::Address::Type::Ip) {
+      throw EnvoyException(
+          fmt::format("error adding listener '{}': reuse_port requires an IP address", name_));
+    }
+    addListenSocketOptions(Network::SocketOptionFactory::buildReusePortOptions());
+  }
   if (config.has_transparent()) {
     addListenSocketOptions(Network::SocketOptionFactory::buildIpTransparentOptions());
   }
@@ -173,6 +206,7 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
   }
 
   bool need_tls_inspector = false;
+  DestinationPortsMap destination_ports_map;
   std::unordered_set<envoy::api::v2::listener::FilterChainMatch, MessageUtil, MessageUtil>
       filter_chains;
 
@@ -233,6 +267,7 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
         parent_.server_.stats());
     factory_context.setInitManager(initManager());
     addFilterChain(
+        destination_ports_map,
         PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0), destination_ips,
         server_names, filter_chain_match.transport_protocol(), application_protocols,
         config_factory.createTransportSocketFactory(*message, factory_context, server_names),
@@ -243,8 +278,8 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
                            (!server_names.empty() || !application_protocols.empty()));
   }
 
-  // Convert DestinationIPsMap to DestinationIPsTrie for faster lookups.
-  convertDestinationIPsMapToTrie();
+  // Compile the maps of filter chains into matchers which don't allocate per connection.
+  compileFilterChainMatchers(destination_ports_map);
 
   // Automatically inject TLS Inspector if it wasn't configured explicitly and it's needed.
   if (need_tls_inspector) {
@@ -278,14 +313,16 @@ ListenerImpl::~ListenerImpl() {
   // active. This is done here explicitly by setting a boolean and then clearing the factory
   // vector for clarity.
   initialize_canceled_ = true;
-  destination_ports_map_.clear();
+  destination_ports_matchers_.clear();
+  filter_chains_.clear();
 }
 
 bool ListenerImpl::isWildcardServerName(const std::string& name) {
   return absl::StartsWith(name, "*.");
 }
 
-void ListenerImpl::addFilterChain(uint16_t destination_port,
+void ListenerImpl::addFilterChain(DestinationPortsMap& destination_ports_map,
+                                  uint16_t destination_port,
                                   const std::vector<std::string>& destination_ips,
                                   const std::vector<std::string>& server_names,
                                   const std::string& transport_protocol,
@@ -294,7 +331,8 @@ void ListenerImpl::addFilterChain(uint16_t destination_port,
                                   std::vector<Network::FilterFactoryCb> filters_factory) {
   const auto filter_chain = std::make_shared<FilterChainImpl>(std::move(transport_socket_factory),
                                                               std::move(filters_factory));
-  addFilterChainForDestinationPorts(destination_ports_map_, destination_port, destination_ips,
+  filter_chains_.push_back(filter_chain);
+  addFilterChainForDestinationPorts(destination_ports_map, destination_port, destination_ips,
                                     server_names, transport_protocol, application_protocols,
                                     filter_chain);
 }
@@ -304,11 +342,7 @@ void ListenerImpl::addFilterChainForDestinationPorts(
     const std::vector<std::string>& destination_ips, const std::vector<std::string>& server_names,
     const std::string& transport_protocol, const std::vector<std::string>& application_protocols,
     const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ports_map.find(destination_port) == destination_ports_map.end()) {
-    destination_ports_map[destination_port] =
-        std::make_pair<DestinationIPsMap, DestinationIPsTriePtr>(DestinationIPsMap{}, nullptr);
-  }
-  addFilterChainForDestinationIPs(destination_ports_map[destination_port].first, destination_ips,
+  addFilterChainForDestinationIPs(destination_ports_map[destination_port], destination_ips,
                                   server_names, transport_protocol, application_protocols,
                                   filter_chain);
 }
@@ -364,30 +398,102 @@ void ListenerImpl::addFilterChainForApplicationProtocols(
   }
 }
 
-void ListenerImpl::convertDestinationIPsMapToTrie() {
-  for (auto& port : destination_ports_map_) {
-    auto& destination_ips_pair = port.second;
-    auto& destination_ips_map = destination_ips_pair.first;
-    std::vector<std::pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>> list;
-    for (const auto& entry : destination_ips_map) {
-      std::vector<Network::Address::CidrRange> subnets;
-      if (entry.first == EMPTY_STRING) {
-        if (Network::Address::ipFamilySupported(AF_INET)) {
-          subnets.push_back(Network::Address::CidrRange::create("0.0.0.0/0"));
-        }
-        if (Network::Address::ipFamilySupported(AF_INET6)) {
-          subnets.push_back(Network::Address::CidrRange::create("::/0"));
-        }
-      } else {
-        subnets.push_back(Network::Address::CidrRange::create(entry.first));
+void ListenerImpl::compileFilterChainMatchers(const DestinationPortsMap& destination_ports_map) {
+  for (const auto& port : destination_ports_map) {
+    destination_ports_matchers_.emplace(port.first, compileDestinationIPsMatcher(port.second));
+  }
+}
+
+ListenerImpl::DestinationIPsMatcher
+ListenerImpl::compileDestinationIPsMatcher(const DestinationIPsMap& destination_ips_map) {
+  DestinationIPsMatcher matcher;
+  std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>> list;
+  for (const auto& entry : destination_ips_map) {
+    std::vector<Network::Address::CidrRange> subnets;
+    if (entry.first == EMPTY_STRING) {
+      if (Network::Address::ipFamilySupported(AF_INET)) {
+        subnets.push_back(Network::Address::CidrRange::create("0.0.0.0/0"));
       }
-      list.push_back(
-          std::make_pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>(
-              std::make_shared<ServerNamesMap>(entry.second),
-              std::vector<Network::Address::CidrRange>(subnets)));
+      if (Network::Address::ipFamilySupported(AF_INET6)) {
+        subnets.push_back(Network::Address::CidrRange::create("::/0"));
+      }
+    } else {
+      subnets.push_back(Network::Address::CidrRange::create(entry.first));
+    }
+    list.emplace_back(matcher.server_names_.size(), std::move(subnets));
+    matcher.server_names_.push_back(compileServerNamesMatcher(entry.second));
+  }
+
+  // Any destination IP, including the fake one used for UDS, matches the only entry without IP
+  // requirements, if there is one.
+  if (destination_ips_map.size() != 1 || destination_ips_map.count(EMPTY_STRING) == 0) {
+    matcher.trie_ = std::make_unique<Network::LcTrie::LcTrie<uint32_t>>(list, true);
+  }
+  return matcher;
+}
+
+ListenerImpl::ServerNamesMatcher
+ListenerImpl::compileServerNamesMatcher(const ServerNamesMap& server_names_map) {
+  ServerNamesMatcher matcher;
+  for (const auto& entry : server_names_map) {
+    const uint32_t index = matcher.transport_protocols_.size();
+    matcher.transport_protocols_.push_back(compileTransportProtocolsMatcher(entry.second));
+    if (entry.first == EMPTY_STRING) {
+      matcher.any_ = index;
+    } else if (entry.first[0] == '.') {
+      matcher.wildcards_.add(entry.first, index);
+    } else {
+      matcher.exact_.add(entry.first, index);
     }
-    destination_ips_pair.second = std::make_unique<DestinationIPsTrie>(list, true);
   }
+  return matcher;
+}
+
+ListenerImpl::TransportProtocolsMatcher ListenerImpl::compileTransportProtocolsMatcher(
+    const TransportProtocolsMap& transport_protocols_map) {
+  TransportProtocolsMatcher matcher;
+  for (const auto& entry : transport_protocols_map) {
+    if (entry.first == EMPTY_STRING) {
+      matcher.any_ = compileApplicationProtocolsMatcher(entry.second);
+    } else {
+      matcher.protocols_.emplace_back(internProtocol(entry.first),
+                                      compileApplicationProtocolsMatcher(entry.second));
+    }
+  }
+  return matcher;
+}
+
+ListenerImpl::ApplicationProtocolsMatcher ListenerImpl::compileApplicationProtocolsMatcher(
+    const ApplicationProtocolsMap& application_protocols_map) {
+  ApplicationProtocolsMatcher matcher;
+  for (const auto& entry : application_protocols_map) {
+    if (entry.first == EMPTY_STRING) {
+      matcher.any_ = entry.second.get();
+    } else {
+      matcher.protocols_.emplace_back(internProtocol(entry.first), entry.second.get());
+    }
+  }
+  return matcher;
+}
+
+ListenerImpl::ProtocolId ListenerImpl::internProtocol(const std::string& protocol) {
+  const auto id = findProtocol(protocol);
+  if (id) {
+    return id.value();
+  }
+  protocols_.push_back(protocol);
+  return protocols_.size() - 1;
+}
+
+absl::optional<ListenerImpl::ProtocolId>
+ListenerImpl::findProtocol(absl::string_view protocol) const {
+  // There are only a few distinct protocols in a listener.
+  for (size_t i = 0; i < protocols_.size(); i++) {
+    if (protocols_[i] == protocol) {
+      return i;
+    }
+  }
+  return absl::nullopt;
 }
 
 const Network::FilterChain*
@@ -396,111 +502,110 @@ ListenerImpl::findFilterChain(const Network::ConnectionSocket& socket) const {
 
   // Match on destination port (only for IP addresses).
   if (address->type() == Network::Address::Type::Ip) {
-    const auto port_match = destination_ports_map_.find(address->ip()->port());
-    if (port_match != destination_ports_map_.end()) {
-      return findFilterChainForDestinationIP(*port_match->second.second, socket);
+    const auto port_match = destination_ports_matchers_.find(address->ip()->port());
+    if (port_match != destination_ports_matchers_.end()) {
+      return findFilterChainForDestinationIP(port_match->second, address, socket);
     }
   }
 
   // Match on catch-all port 0.
-  const auto port_match = destination_ports_map_.find(0);
-  if (port_match != destination_ports_map_.end()) {
-    return findFilterChainForDestinationIP(*port_match->second.second, socket);
+  const auto port_match = destination_ports_matchers_.find(0);
+  if (port_match != destination_ports_matchers_.end()) {
+    return findFilterChainForDestinationIP(port_match->second, address, socket);
   }
 
   return nullptr;
 }
 
-const Network::FilterChain*
-ListenerImpl::findFilterChainForDestinationIP(const DestinationIPsTrie& destination_ips_trie,
-                                              const Network::ConnectionSocket& socket) const {
+const Network::FilterChain* ListenerImpl::findFilterChainForDestinationIP(
+    const DestinationIPsMatcher& destination_ips_matcher,
+    const Network::Address::InstanceConstSharedPtr& address,
+    const Network::ConnectionSocket& socket) const {
+  if (destination_ips_matcher.trie_ == nullptr) {
+    ASSERT(destination_ips_matcher.server_names_.size() == 1);
+    return findFilterChainForServerName(destination_ips_matcher.server_names_[0], socket);
+  }
+
   // Use invalid IP address (matching only filter chains without IP requirements) for UDS.
   static const auto& fake_address = Network::Utility::parseInternetAddress("255.255.255.255");
 
-  auto address = socket.localAddress();
-  if (address->type() != Network::Address::Type::Ip) {
-    address = fake_address;
-  }
-
   // Match on both: exact IP and wider CIDR ranges using LcTrie.
-  const auto& data = destination_ips_trie.getData(address);
+  const auto& data = destination_ips_matcher.trie_->getData(
+      address->type() == Network::Address::Type::Ip ? address : fake_address);
   if (!data.empty()) {
     ASSERT(data.size() == 1);
-    return findFilterChainForServerName(*data.back(), socket);
+    return findFilterChainForServerName(destination_ips_matcher.server_names_[data.back()], socket);
   }
 
   return nullptr;
 }
 
 const Network::FilterChain*
-ListenerImpl::findFilterChainForServerName(const ServerNamesMap& server_names_map,
+ListenerImpl::findFilterChainForServerName(const ServerNamesMatcher& server_names_matcher,
                                            const Network::ConnectionSocket& socket) const {
-  const std::string server_name(socket.requestedServerName());
+  const absl::string_view server_name = socket.requestedServerName();
 
   // Match on exact server name, i.e. "www.example.com" for "www.example.com".
-  const auto server_name_exact_match = server_names_map.find(server_name);
-  if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
-  }
-
-  // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
-  size_t pos = server_name.find('.', 1);
-  while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
-    const auto server_name_wildcard_match = server_names_map.find(wildcard);
-    if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
-    }
-    pos = server_name.find('.', pos + 1);
+  absl::optional<uint32_t> match = server_names_matcher.exact_.find(server_name);
+
+  // Match on the longest wildcard domain, i.e. ".example.com" before ".com" for
+  // "www.example.com".
+  if (!match) {
+    match = server_names_matcher.wildcards_.findLongest(server_name);
   }
 
   // Match on a filter chain without server name requirements.
-  const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
-  if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
+  if (!match) {
+    match = server_names_matcher.any_;
+  }
+
+  if (match) {
+    return findFilterChainForTransportProtocol(
+        server_names_matcher.transport_protocols_[match.value()], socket);
   }
 
   return nullptr;
 }
 
 const Network::FilterChain* ListenerImpl::findFilterChainForTransportProtocol(
-    const TransportProtocolsMap& transport_protocols_map,
+    const TransportProtocolsMatcher& transport_protocols_matcher,
     const Network::ConnectionSocket& socket) const {
-  const std::string transport_protocol(socket.detectedTransportProtocol());
-
   // Match on exact transport protocol, e.g. "tls".
-  const auto transport_protocol_match = transport_protocols_map.find(transport_protocol);
-  if (transport_protocol_match != transport_protocols_map.end()) {
-    return findFilterChainForApplicationProtocols(transport_protocol_match->second, socket);
+  const auto id = findProtocol(socket.detectedTransportProtocol());
+  if (id) {
+    for (const auto& transport_protocol : transport_protocols_matcher.protocols_) {
+      if (transport_protocol.first == id.value()) {
+        return findFilterChainForApplicationProtocols(transport_protocol.second, socket);
+      }
+    }
   }
 
   // Match on a filter chain without transport protocol requirements.
-  const auto any_protocol_match = transport_protocols_map.find(EMPTY_STRING);
-  if (any_protocol_match != transport_protocols_map.end()) {
-    return findFilterChainForApplicationProtocols(any_protocol_match->second, socket);
+  if (transport_protocols_matcher.any_) {
+    return findFilterChainForApplicationProtocols(transport_protocols_matcher.any_.value(), socket);
   }
 
   return nullptr;
 }
 
 const Network::FilterChain* ListenerImpl::findFilterChainForApplicationProtocols(
-    const ApplicationProtocolsMap& application_protocols_map,
+    const ApplicationProtocolsMatcher& application_protocols_matcher,
     const Network::ConnectionSocket& socket) const {
   // Match on exact application protocol, e.g. "h2" or "http/1.1".
-  for (const auto& application_protocol : socket.requestedApplicationProtocols()) {
-    const auto application_protocol_match = application_protocols_map.find(application_protocol);
-    if (application_protocol_match != application_protocols_map.end()) {
-      return application_protocol_match->second.get();
+  for (const auto& requested_protocol : socket.requestedApplicationProtocols()) {
+    const auto id = findProtocol(requested_protocol);
+    if (!id) {
+      continue;
+    }
+    for (const auto& application_protocol : application_protocols_matcher.protocols_) {
+      if (application_protocol.first == id.value()) {
+        return application_protocol.second;
+      }
     }
   }
 
   // Match on a filter chain without application protocol requirements.
-  const auto any_protocol_match = application_protocols_map.find(EMPTY_STRING);
-  if (any_protocol_match != application_protocols_map.end()) {
-    return any_protocol_match->second.get();
-  }
-
-  return nullptr;
+  return application_protocols_matcher.any_;
 }
 
 bool ListenerImpl::createNetworkFilterChain(
@@ -552,25 +657,42 @@ void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
   ASSERT(!socket_);
   socket_ = socket;
   // Server config validation sets nullptr sockets.
-  if (socket_ && listen_socket_options_) {
-    // 'pre_bind = false' as bind() is never done after this.
-    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket_,
-                                            envoy::api::v2::core::SocketOption::STATE_BOUND);
-    const std::string message =
-        fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
-    if (!ok) {
-      ENVOY_LOG(warn, "{}", message);
-      throw EnvoyException(message);
-    } else {
-      ENVOY_LOG(debug, "{}", message);
-    }
+  if (socket_) {
+    applySocketOptions(*socket_);
+  }
+}
 
-    // Add the options to the socket_ so that STATE_LISTENING options can be
-    // set in the worker after listen()/evconnlistener_new() is called.
-    socket_->addOptions(listen_socket_options_);
+void ListenerImpl::setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets) {
+  ASSERT(worker_sockets_.empty());
+  ASSERT(sockets.empty() || sockets[0] == socket_);
+  worker_sockets_ = sockets;
+  // The first socket is socket_, which already has the options.
+  for (size_t i = 1; i < worker_sockets_.size(); i++) {
+    applySocketOptions(*worker_sockets_[i]);
   }
 }
 
+void ListenerImpl::applySocketOptions(Network::Socket& socket) {
+  if (!listen_socket_options_) {
+    return;
+  }
+  // 'pre_bind = false' as bind() is never done after this.
+  bool ok = Network::Socket::applyOptions(listen_socket_options_, socket,
+                                          envoy::api::v2::core::SocketOption::STATE_BOUND);
+  const std::string message =
+      fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
+  if (!ok) {
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  } else {
+    ENVOY_LOG(debug, "{}", message);
+  }
+
+  // Add the options to the socket so that STATE_LISTENING options can be
+  // set in the worker after listen()/evconnlistener_new() is called.
+  socket.addOptions(listen_socket_options_);
+}
+
 ListenerManagerImpl::ListenerManagerImpl(Instance& server,
                                          ListenerComponentFactory& listener_factory,
                                          WorkerFactory& worker_factory, TimeSource& time_source)
@@ -626,6 +748,46 @@ ListenerManagerStats ListenerManagerImpl::generateStats(Stats::Scope& scope) {
                                      POOL_GAUGE_PREFIX(scope, final_prefix))};
 }
 
+void ListenerManagerImpl::createWorkerSockets(ListenerImpl& listener) {
+  // Server config validation sets nullptr sockets.
+  if (!listener.reusePort() || !listener.getSocket()) {
+    return;
+  }
+
+  // The listener's socket may have been handed over by a parent process whose listener didn't have
+  // reuse_port. It then lacks SO_REUSEPORT, which can't be set once bound, so no other socket can
+  // bind to its address and the workers share it as if reuse_port wasn't set.
+  if (!hasReusePort(*listener.getSocket())) {
+    ENVOY_LOG(warn,
+              "listener '{}': the socket bound to {} doesn't have SO_REUSEPORT, most likely as it "
+              "was inherited from a parent process without reuse_port. The workers will share it "
+              "until the next restart.",
+              listener.name(), listener.getSocket()->localAddress()->asString());
+    return;
+  }
+
+  // The workers bind to the address the listener's socket is bound to, which has the actual port
+  // when the configured one is 0.
+  std::vector<Network::SocketSharedPtr> sockets{listener.getSocket()};
+  for (uint32_t i = 1; i < workers_.size(); i++) {
+    sockets.push_back(factory_.createWorkerListenSocket(listener.getSocket()->localAddress(),
+                                                        listener.listenSocketOptions(), i));
+  }
+  listener.setWorkerSockets(sockets);
+}
+
+bool ListenerManagerImpl::hasReusePort(Network::Socket& socket) {
+  const Network::SocketOptionName optname = ENVOY_SOCKET_SO_REUSEPORT;
+  if (!optname.has_value()) {
+    return false;
+  }
+  int value = 0;
+  socklen_t len = sizeof(value);
+  const Api::SysCallIntResult result = Api::OsSysCallsSingleton::get().getsockopt(
+      socket.fd(), optname.value().first, optname.value().second, &value, &len);
+  return result.rc_ == 0 && value != 0;
+}
+
 bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& config,
                                               const std::string& version_info, bool modifiable) {
   std::string name;
@@ -669,17 +831,30 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     throw EnvoyException(message);
   }
 
+  // Likewise, whether the listener has a socket per worker can't change, as the sockets are reused.
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->reusePort() != new_listener->reusePort()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->reusePort() != new_listener->reusePort())) {
+    const std::string message = fmt::format(
+        "error updating listener: '{}' has a different reuse_port from existing listener", name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+
   bool added = false;
   if (existing_warming_listener != warming_listeners_.end()) {
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
     new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->setWorkerSockets((*existing_warming_listener)->getWorkerSockets());
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
     new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->setWorkerSockets((*existing_active_listener)->getWorkerSockets());
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -708,21 +883,22 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::SocketSharedPtr draining_listener_socket;
+    // The sockets of a draining listener are only reused if it has a socket per worker as well.
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
-          return *new_listener->address() == *listener.listener_->socket().localAddress();
+          return *new_listener->address() == *listener.listener_->socket().localAddress() &&
+                 new_listener->reusePort() == listener.listener_->reusePort();
         });
     if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
+      new_listener->setSocket(existing_draining_listener->listener_->getSocket());
+      new_listener->setWorkerSockets(existing_draining_listener->listener_->getWorkerSockets());
+    } else {
+      new_listener->setSocket(factory_.createListenSocket(new_listener->address(),
+                                                          new_listener->listenSocketOptions(),
+                                                          new_listener->bindToPort()));
+      createWorkerSockets(*new_listener);
     }
-
-    new_listener->setSocket(draining_listener_socket
-                                ? draining_listener_socket
-                                : factory_.createListenSocket(new_listener->address(),
-                                                              new_listener->listenSocketOptions(),
-                                                              new_listener->bindToPort()));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -12,6 +12,7 @@
 #include "envoy/stats/scope.h"
 
 #include "common/common/logger.h"
+#include "common/common/suffix_trie.h"
 #include "common/network/cidr_range.h"
 #include "common/network/lc_trie.h"
 
@@ -63,6 +64,10 @@ public:
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                               const Network::Socket::OptionsSharedPtr& options,
                                               bool bind_to_port) override;
+  Network::SocketSharedPtr
+  createWorkerListenSocket(Network::Address::InstanceConstSharedPtr address,
+                           const Network::Socket::OptionsSharedPtr& options,
+                           uint32_t worker_index) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
@@ -162,6 +167,20 @@ private:
    */
   ListenerList::iterator getListenerByName(ListenerList& listeners, const std::string& name);
 
+  /**
+   * Create a listen socket per worker for a listener which reuses its port, once its own socket is
+   * set. The first worker uses the listener's socket. If that socket lacks SO_REUSEPORT, no other
+   * socket can bind to its address, so the workers share it instead.
+   * @param listener supplies the listener to create the worker sockets of.
+   */
+  void createWorkerSockets(ListenerImpl& listener);
+
+  /**
+   * @param socket supplies a listen socket.
+   * @return bool whether the socket has SO_REUSEPORT set.
+   */
+  static bool hasReusePort(Network::Socket& socket);
+
   // Active listeners are listeners that are currently accepting new connections on the workers.
   ListenerList active_listeners_;
   // Warming listeners are listeners that may need further initialization via the listener's init
@@ -232,6 +251,14 @@ public:
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
   void setSocket(const Network::SocketSharedPtr& socket);
+  /**
+   * Set the listen sockets of the workers, the first of which must be the listener's socket.
+   * @param sockets supplies a socket per worker, or none if the workers share the listener's
+   *        socket.
+   */
+  void setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets);
+  const std::vector<Network::SocketSharedPtr>& getWorkerSockets() const { return worker_sockets_; }
+  bool reusePort() const { return reuse_port_; }
   void setSocketAndOptions(const Network::SocketSharedPtr& socket);
   const Network::Socket::OptionsSharedPtr& listenSocketOptions() { return listen_socket_options_; }
   const std::string& versionInfo() { return version_info_; }
@@ -240,6 +267,13 @@ public:
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
   Network::Socket& socket() override { return *socket_; }
+  Network::Socket& workerSocket(uint32_t worker_index) override {
+    if (worker_sockets_.empty()) {
+      return *socket_;
+    }
+    ASSERT(worker_index < worker_sockets_.size());
+    return *worker_sockets_[worker_index];
+  }
   bool bindToPort() override { return bind_to_port_; }
   bool handOffRestoredDestinationConnections() const override {
     return hand_off_restored_destination_connections_;
@@ -248,6 +282,7 @@ public:
   Stats::Scope& listenerScope() override { return *listener_scope_; }
   uint64_t listenerTag() const override { return listener_tag_; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
 
   // Server::Configuration::ListenerFactoryContext
   AccessLog::AccessLogManager& accessLogManager() override {
@@ -305,6 +340,9 @@ public:
   SystemTime last_updated_;
 
 private:
+  // The filter chains are first added to nested maps keyed on their configured destination ports,
+  // IPs, server names, transport protocols and application protocols, which are then compiled into
+  // the matchers below once all the filter chains are added.
   typedef std::unordered_map<std::string, Network::FilterChainSharedPtr> ApplicationProtocolsMap;
   typedef std::unordered_map<std::string, ApplicationProtocolsMap> TransportProtocolsMap;
   // Both exact server names and wildcard domains are part of the same map, in which wildcard
@@ -312,13 +350,42 @@ private:
   // between exact and wildcard entries.
   typedef std::unordered_map<std::string, TransportProtocolsMap> ServerNamesMap;
   typedef std::unordered_map<std::string, ServerNamesMap> DestinationIPsMap;
-  typedef std::shared_ptr<ServerNamesMap> ServerNamesMapSharedPtr;
-  typedef Network::LcTrie::LcTrie<ServerNamesMapSharedPtr> DestinationIPsTrie;
-  typedef std::unique_ptr<DestinationIPsTrie> DestinationIPsTriePtr;
-  typedef std::unordered_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>
-      DestinationPortsMap;
+  typedef std::unordered_map<uint16_t, DestinationIPsMap> DestinationPortsMap;
 
-  void addFilterChain(uint16_t destination_port, const std::vector<std::string>& destination_ips,
+  // Protocols are interned into IDs, indexing protocols_, when the matchers are compiled, so that
+  // each protocol of a connection is looked up once and then compared as an integer.
+  typedef uint32_t ProtocolId;
+
+  struct ApplicationProtocolsMatcher {
+    // In no particular order, since each protocol appears once and the connection's requested
+    // protocols decide the match. There are only a few of them, so they're scanned linearly.
+    std::vector<std::pair<ProtocolId, const Network::FilterChain*>> protocols_;
+    const Network::FilterChain* any_{};
+  };
+
+  struct TransportProtocolsMatcher {
+    std::vector<std::pair<ProtocolId, ApplicationProtocolsMatcher>> protocols_;
+    absl::optional<ApplicationProtocolsMatcher> any_;
+  };
+
+  struct ServerNamesMatcher {
+    // Both tries index into transport_protocols_. Wildcard domains are added as ".example.com"
+    // for "*.example.com", so that their longest match is on a label boundary.
+    SuffixTrie exact_;
+    SuffixTrie wildcards_;
+    absl::optional<uint32_t> any_;
+    std::vector<TransportProtocolsMatcher> transport_protocols_;
+  };
+
+  struct DestinationIPsMatcher {
+    // Indexes into server_names_, or null if the only entry is for any destination IP, in which
+    // case the trie lookup (and its allocation) is skipped.
+    std::unique_ptr<Network::LcTrie::LcTrie<uint32_t>> trie_;
+    std::vector<ServerNamesMatcher> server_names_;
+  };
+
+  void addFilterChain(DestinationPortsMap& destination_ports_map, uint16_t destination_port,
+                      const std::vector<std::string>& destination_ips,
                       const std::vector<std::string>& server_names,
                       const std::string& transport_protocol,
                       const std::vector<std::string>& application_protocols,
@@ -346,33 +413,47 @@ private:
                                              const std::vector<std::string>& application_protocols,
                                              const Network::FilterChainSharedPtr& filter_chain);
 
-  void convertDestinationIPsMapToTrie();
+  void compileFilterChainMatchers(const DestinationPortsMap& destination_ports_map);
+  DestinationIPsMatcher compileDestinationIPsMatcher(const DestinationIPsMap& destination_ips_map);
+  ServerNamesMatcher compileServerNamesMatcher(const ServerNamesMap& server_names_map);
+  TransportProtocolsMatcher
+  compileTransportProtocolsMatcher(const TransportProtocolsMap& transport_protocols_map);
+  ApplicationProtocolsMatcher
+  compileApplicationProtocolsMatcher(const ApplicationProtocolsMap& application_protocols_map);
+  ProtocolId internProtocol(const std::string& protocol);
+  absl::optional<ProtocolId> findProtocol(absl::string_view protocol) const;
+  void applySocketOptions(Network::Socket& socket);
 
   const Network::FilterChain*
-  findFilterChainForDestinationIP(const DestinationIPsTrie& destination_ips_trie,
+  findFilterChainForDestinationIP(const DestinationIPsMatcher& destination_ips_matcher,
+                                  const Network::Address::InstanceConstSharedPtr& address,
                                   const Network::ConnectionSocket& socket) const;
   const Network::FilterChain*
-  findFilterChainForServerName(const ServerNamesMap& server_names_map,
+  findFilterChainForServerName(const ServerNamesMatcher& server_names_matcher,
                                const Network::ConnectionSocket& socket) const;
   const Network::FilterChain*
-  findFilterChainForTransportProtocol(const TransportProtocolsMap& transport_protocols_map,
+  findFilterChainForTransportProtocol(const TransportProtocolsMatcher& transport_protocols_matcher,
                                       const Network::ConnectionSocket& socket) const;
-  const Network::FilterChain*
-  findFilterChainForApplicationProtocols(const ApplicationProtocolsMap& application_protocols_map,
-                                         const Network::ConnectionSocket& socket) const;
+  const Network::FilterChain* findFilterChainForApplicationProtocols(
+      const ApplicationProtocolsMatcher& application_protocols_matcher,
+      const Network::ConnectionSocket& socket) const;
 
   static bool isWildcardServerName(const std::string& name);
 
-  // Mapping of FilterChain's configured destination ports, IPs, server names, transport protocols
-  // and application protocols, using structures defined above.
-  DestinationPortsMap destination_ports_map_;
+  // Owns the filter chains, which the matchers point to.
+  std::vector<Network::FilterChainSharedPtr> filter_chains_;
+  std::vector<std::string> protocols_;
+  std::unordered_map<uint16_t, DestinationIPsMatcher> destination_ports_matchers_;
 
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
   Network::SocketSharedPtr socket_;
+  // A socket per worker, starting with socket_, if the listener reuses its port.
+  std::vector<Network::SocketSharedPtr> worker_sockets_;
   Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
   Stats::ScopePtr listener_scope_; // Stats with listener named scope.
   const bool bind_to_port_;
+  const bool reuse_port_;
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
   const uint64_t listener_tag_;
@@ -388,6 +469,7 @@ private:
   const envoy::api::v2::Listener config_;
   const std::string version_info_;
   Network::Socket::OptionsSharedPtr listen_socket_options_;
+  Network::ConnectionBalancerPtr connection_balancer_;
 };
 
 class FilterChainImpl : public Network::FilterChain {
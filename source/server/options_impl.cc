@@ -115,6 +115,14 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                                              cmd);
   TCLAP::SwitchArg disable_hot_restart("", "disable-hot-restart",
                                        "Disable hot restart functionality", cmd, false);
+  TCLAP::ValueArg<bool> use_libevent_buffers("", "use-libevent-buffers",
+                                             "Use the libevent evbuffer buffer implementation "
+                                             "instead of the native slice-based implementation",
+                                             false, true, "bool", cmd);
+  TCLAP::SwitchArg log_linear_histograms("", "log-linear-histograms",
+                                         "Record histograms in fixed log-linear buckets instead "
+                                         "of with libcircllhist",
+                                         cmd, false);
 
   cmd.setExceptionHandling(false);
   try {
@@ -149,6 +157,7 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   // TODO(jmarantz): should we also multiply these to bound the total amount of memory?
 
   hot_restart_disabled_ = disable_hot_restart.getValue();
+  libevent_buffers_enabled_ = use_libevent_buffers.getValue();
 
   log_level_ = default_log_level;
   for (size_t i = 0; i < ARRAY_SIZE(spdlog::level::level_names); i++) {
@@ -202,6 +211,7 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
   max_stats_ = max_stats.getValue();
   stats_options_.max_obj_name_length_ = max_obj_name_len.getValue();
+  stats_options_.log_linear_histograms_ = log_linear_histograms.getValue();
 
   if (hot_restart_version_option.getValue()) {
     std::cerr << hot_restart_version_cb(max_stats.getValue(), stats_options_.maxNameLength(),
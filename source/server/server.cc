@@ -2,6 +2,7 @@
 
 #include <signal.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -130,11 +131,19 @@ void InstanceUtil::flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks,
   for (const auto& sink : sinks) {
     sink->flush(source);
   }
-  // TODO(mrice32): this reset should be called by the StoreRoot on stat construction/destruction so
-  // that it doesn't need to be reset when the set of stats isn't changing.
+  // Ends the flush. The store's source only drops its snapshots if stats were created or destroyed
+  // since they were taken.
   source.clearCache();
 }
 
+void InstanceUtil::updateBufferPoolWatermarks(Runtime::Snapshot& snapshot) {
+  const uint64_t high_watermark = snapshot.getInteger("buffer.pool.high_watermark_bytes",
+                                                      Buffer::SlicePool::DefaultHighWatermark);
+  const uint64_t low_watermark = snapshot.getInteger("buffer.pool.low_watermark_bytes",
+                                                     Buffer::SlicePool::DefaultLowWatermark);
+  Buffer::SlicePool::setWatermarks(std::min(low_watermark, high_watermark), high_watermark);
+}
+
 void InstanceImpl::flushStats() {
   ENVOY_LOG(debug, "flushing stats");
   // A shutdown initiated before this callback may prevent this from being called as per
@@ -150,6 +159,15 @@ void InstanceImpl::flushStats() {
     server_stats_->total_connections_.set(numConnections() + info.num_connections_);
     server_stats_->days_until_first_cert_expiring_.set(
         sslContextManager().daysUntilFirstCertExpires());
+    // The watermarks are refreshed on each flush, so runtime changes apply without a restart.
+    InstanceUtil::updateBufferPoolWatermarks(runtime().snapshot());
+    const Buffer::SlicePool::Stats buffer_pool_stats = Buffer::SlicePool::stats();
+    buffer_pool_stats_->hit_.add(buffer_pool_stats.hits_ - last_buffer_pool_stats_.hits_);
+    buffer_pool_stats_->miss_.add(buffer_pool_stats.misses_ - last_buffer_pool_stats_.misses_);
+    buffer_pool_stats_->trimmed_.add(buffer_pool_stats.trimmed_ -
+                                     last_buffer_pool_stats_.trimmed_);
+    buffer_pool_stats_->resident_bytes_.set(buffer_pool_stats.resident_bytes_);
+    last_buffer_pool_stats_ = buffer_pool_stats;
     InstanceUtil::flushMetricsToSinks(config_->statsSinks(), stats_store_.source());
     // TODO(ramaraochavali): consider adding different flush interval for histograms.
     if (stat_flush_timer_ != nullptr) {
@@ -234,6 +252,9 @@ void InstanceImpl::initialize(Options& options,
 
   server_stats_.reset(
       new ServerStats{ALL_SERVER_STATS(POOL_GAUGE_PREFIX(stats_store_, "server."))});
+  buffer_pool_stats_.reset(new BufferPoolStats{
+      ALL_BUFFER_POOL_STATS(POOL_COUNTER_PREFIX(stats_store_, "server.buffer_pool."),
+                            POOL_GAUGE_PREFIX(stats_store_, "server.buffer_pool."))});
 
   server_stats_->concurrency_.set(options_.concurrency());
   server_stats_->hot_restart_epoch_.set(options_.restartEpoch());
@@ -17,6 +17,7 @@
 #include "envoy/tracing/http_tracer.h"
 
 #include "common/access_log/access_log_manager_impl.h"
+#include "common/buffer/slice_pool.h"
 #include "common/common/logger_delegates.h"
 #include "common/grpc/async_client_manager_impl.h"
 #include "common/runtime/runtime_impl.h"
@@ -57,6 +58,21 @@ struct ServerStats {
   ALL_SERVER_STATS(GENERATE_GAUGE_STRUCT)
 };
 
+/**
+ * Stats for the per-thread buffer slice pools. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_BUFFER_POOL_STATS(COUNTER, GAUGE)                                                      \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(trimmed)                                                                                 \
+  GAUGE(resident_bytes)
+// clang-format on
+
+struct BufferPoolStats {
+  ALL_BUFFER_POOL_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * Interface for creating service components during boot.
  */
@@ -96,6 +112,13 @@ public:
    */
   static void flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, Stats::Source& source);
 
+  /**
+   * Apply the buffer pool watermarks set in runtime, falling back to the defaults of
+   * Buffer::SlicePool. The low watermark is capped at the high watermark.
+   * @param snapshot supplies the runtime snapshot to read the watermarks from.
+   */
+  static void updateBufferPoolWatermarks(Runtime::Snapshot& snapshot);
+
   /**
    * Load a bootstrap config from either v1 or v2 and perform validation.
    * @param bootstrap supplies the bootstrap to fill.
@@ -203,6 +226,10 @@ private:
   time_t original_start_time_;
   Stats::StoreRoot& stats_store_;
   std::unique_ptr<ServerStats> server_stats_;
+  std::unique_ptr<BufferPoolStats> buffer_pool_stats_;
+  // Pool totals as of the previous flush, used to turn the pool's running totals into counter
+  // increments.
+  Buffer::SlicePool::Stats last_buffer_pool_stats_;
   ThreadLocal::Instance& thread_local_;
   Api::ApiPtr api_;
   Event::DispatcherPtr dispatcher_;
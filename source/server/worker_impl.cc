@@ -18,7 +18,8 @@ WorkerPtr ProdWorkerFactory::createWorker() {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher(time_system_));
   return WorkerPtr{new WorkerImpl(
       tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)})};
+      Network::ConnectionHandlerPtr{
+          new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher, next_worker_index_++)})};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
@@ -32,6 +32,8 @@ private:
   Api::Api& api_;
   TestHooks& hooks_;
   Event::TimeSystem& time_system_;
+  // Workers are indexed in creation order, which is the order of the listener manager's workers.
+  uint32_t next_worker_index_{};
 };
 
 /**
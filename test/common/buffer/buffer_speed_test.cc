@@ -0,0 +1,246 @@
+// Compares the native slice-based Buffer::OwnedImpl against the libevent evbuffer-backed one.
+// Every benchmark takes the implementation as its first argument: 0 selects the native
+// implementation and 1 selects the evbuffer implementation.
+//
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "common/buffer/buffer_impl.h"
+
+#include "absl/strings/string_view.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+
+static constexpr uint64_t MaxSliceSize = 16384;
+
+static void selectImpl(benchmark::State& state) {
+  Buffer::OwnedImpl::useOldImpl(state.range(0) != 0);
+}
+
+// Test the creation of an empty OwnedImpl.
+static void BM_BufferCreate(benchmark::State& state) {
+  selectImpl(state);
+  uint64_t length = 0;
+  for (auto _ : state) {
+    Buffer::OwnedImpl buffer;
+    length += buffer.length();
+  }
+  benchmark::DoNotOptimize(length);
+}
+BENCHMARK(BM_BufferCreate)->Arg(0)->Arg(1);
+
+// Grow an OwnedImpl in very small amounts.
+static void BM_AddSmallIncrement(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data("a");
+  const absl::string_view input(data);
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    buffer.add(input.data(), input.size());
+    if (buffer.length() >= MaxSliceSize) {
+      // Keep the test's memory usage from growing too large.
+      // @note Ideally we could use state.PauseTiming()/ResumeTiming() to exclude
+      // the time spent in the drain operation, but those functions themselves are
+      // heavyweight enough to cloud the measurements:
+      // https://github.com/google/benchmark/issues/179
+      buffer.drain(buffer.length());
+    }
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(BM_AddSmallIncrement)->Arg(0)->Arg(1);
+
+// Test the appending of varying amounts of content from a string to an OwnedImpl.
+static void BM_AddString(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data(state.range(1), 'a');
+  const absl::string_view input(data);
+  Buffer::OwnedImpl buffer(input.data(), input.size());
+  for (auto _ : state) {
+    buffer.add(data);
+    if (buffer.length() >= MaxSliceSize) {
+      buffer.drain(buffer.length());
+    }
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(BM_AddString)->Args({0, 1})->Args({0, 4096})->Args({0, 16384})->Args({0, 65536});
+BENCHMARK(BM_AddString)->Args({1, 1})->Args({1, 4096})->Args({1, 16384})->Args({1, 65536});
+
+// Test the prepending of varying amounts of content from a string to an OwnedImpl.
+static void BM_PrependString(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data(state.range(1), 'a');
+  const absl::string_view input(data);
+  Buffer::OwnedImpl buffer(input.data(), input.size());
+  for (auto _ : state) {
+    buffer.prepend(data);
+    if (buffer.length() >= MaxSliceSize) {
+      buffer.drain(buffer.length());
+    }
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(BM_PrependString)->Args({0, 1})->Args({0, 4096})->Args({0, 16384})->Args({0, 65536});
+BENCHMARK(BM_PrependString)->Args({1, 1})->Args({1, 4096})->Args({1, 16384})->Args({1, 65536});
+
+// Test moving the entire content of one OwnedImpl to another, as the connection and codec layers
+// do when shuttling a body between downstream and upstream.
+static void BM_MoveFull(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data(state.range(1), 'a');
+  const absl::string_view input(data);
+  Buffer::OwnedImpl buffer1(input.data(), input.size());
+  Buffer::OwnedImpl buffer2(input.data(), input.size());
+  for (auto _ : state) {
+    buffer1.move(buffer2); // now buffer1 has 2 copies of the input, and buffer2 is empty.
+    buffer2.move(buffer1, input.size()); // now buffer1 and buffer2 are the same size.
+  }
+  uint64_t length = buffer1.length();
+  benchmark::DoNotOptimize(length);
+}
+BENCHMARK(BM_MoveFull)->Args({0, 1})->Args({0, 4096})->Args({0, 16384})->Args({0, 65536});
+BENCHMARK(BM_MoveFull)->Args({1, 1})->Args({1, 4096})->Args({1, 16384})->Args({1, 65536});
+
+// Test moving content in pieces smaller than a slice, as the HTTP/2 codec does when it splits a
+// body into DATA frames.
+static void BM_MovePartial(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data(state.range(1), 'a');
+  const absl::string_view input(data);
+  const uint64_t chunk_size = state.range(2);
+  Buffer::OwnedImpl source;
+  Buffer::OwnedImpl destination;
+  for (auto _ : state) {
+    source.add(input.data(), input.size());
+    while (source.length() != 0) {
+      destination.move(source, std::min(chunk_size, source.length()));
+    }
+    destination.drain(destination.length());
+  }
+  benchmark::DoNotOptimize(destination.length());
+}
+BENCHMARK(BM_MovePartial)->Args({0, 65536, 1024})->Args({0, 65536, 16384});
+BENCHMARK(BM_MovePartial)->Args({1, 65536, 1024})->Args({1, 65536, 16384});
+
+// Test the reserve+commit cycle, for the special case where the reserved space is
+// fully used (and therefore the commit size equals the reservation size).
+static void BM_ReserveCommit(benchmark::State& state) {
+  selectImpl(state);
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    constexpr uint64_t NumSlices = 2;
+    Buffer::RawSlice slices[NumSlices];
+    uint64_t slices_used = buffer.reserve(state.range(1), slices, NumSlices);
+    uint64_t bytes_to_commit = 0;
+    for (uint64_t i = 0; i < slices_used; i++) {
+      bytes_to_commit += static_cast<uint64_t>(slices[i].len_);
+    }
+    buffer.commit(slices, slices_used);
+    if (buffer.length() >= MaxSliceSize) {
+      buffer.drain(buffer.length());
+    }
+    benchmark::DoNotOptimize(bytes_to_commit);
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(BM_ReserveCommit)->Args({0, 1})->Args({0, 4096})->Args({0, 16384})->Args({0, 65536});
+BENCHMARK(BM_ReserveCommit)->Args({1, 1})->Args({1, 4096})->Args({1, 16384})->Args({1, 65536});
+
+// Test the reserve+commit cycle, for the common case where the reserved space is
+// only partially used (and therefore the commit size is smaller than the reservation size).
+static void BM_ReserveCommitPartial(benchmark::State& state) {
+  selectImpl(state);
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    constexpr uint64_t NumSlices = 2;
+    Buffer::RawSlice slices[NumSlices];
+    uint64_t slices_used = buffer.reserve(state.range(1), slices, NumSlices);
+    ASSERT(slices_used > 0);
+    // Commit one byte from the first slice and nothing from any subsequent slice.
+    uint64_t bytes_to_commit = 1;
+    slices[0].len_ = bytes_to_commit;
+    buffer.commit(slices, 1);
+    if (buffer.length() >= MaxSliceSize) {
+      buffer.drain(buffer.length());
+    }
+    benchmark::DoNotOptimize(bytes_to_commit);
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(BM_ReserveCommitPartial)
+    ->Args({0, 1})
+    ->Args({0, 4096})
+    ->Args({0, 16384})
+    ->Args({0, 65536});
+BENCHMARK(BM_ReserveCommitPartial)
+    ->Args({1, 1})
+    ->Args({1, 4096})
+    ->Args({1, 16384})
+    ->Args({1, 65536});
+
+// Test the linearization of a buffer made up of many small slices.
+static void BM_Linearize(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data(state.range(1), 'a');
+  const absl::string_view input(data);
+  constexpr size_t NumSlices = 16;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Buffer::OwnedImpl buffer;
+    for (size_t i = 0; i < NumSlices; i++) {
+      buffer.appendSliceForTest(input.data(), input.size());
+    }
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(buffer.linearize(buffer.length()));
+  }
+}
+BENCHMARK(BM_Linearize)->Args({0, 1})->Args({0, 1024});
+BENCHMARK(BM_Linearize)->Args({1, 1})->Args({1, 1024});
+
+// Test getRawSlices() on a buffer made up of many slices, as done by every socket write.
+static void BM_GetRawSlices(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data(1024, 'a');
+  Buffer::OwnedImpl buffer;
+  for (int64_t i = 0; i < state.range(1); i++) {
+    buffer.appendSliceForTest(data);
+  }
+  constexpr uint64_t MaxSlices = 16;
+  Buffer::RawSlice slices[MaxSlices];
+  uint64_t num_slices = 0;
+  for (auto _ : state) {
+    num_slices += buffer.getRawSlices(slices, MaxSlices);
+  }
+  benchmark::DoNotOptimize(num_slices);
+}
+BENCHMARK(BM_GetRawSlices)->Args({0, 1})->Args({0, 16})->Args({0, 64});
+BENCHMARK(BM_GetRawSlices)->Args({1, 1})->Args({1, 16})->Args({1, 64});
+
+// Test search() for a pattern that straddles two slices near the end of the buffer.
+static void BM_Search(benchmark::State& state) {
+  selectImpl(state);
+  const std::string data(state.range(1), 'a');
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest(data + "\r");
+  buffer.appendSliceForTest("\n" + data);
+  ssize_t result = 0;
+  for (auto _ : state) {
+    result += buffer.search("\r\n", 2, 0);
+  }
+  benchmark::DoNotOptimize(result);
+}
+BENCHMARK(BM_Search)->Args({0, 16})->Args({0, 16384});
+BENCHMARK(BM_Search)->Args({1, 16})->Args({1, 16384});
+
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -15,14 +15,22 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
-class OwnedImplTest : public testing::Test {
+class OwnedImplTest : public testing::TestWithParam<bool> {
 public:
-  OwnedImplTest() {}
+  OwnedImplTest() : saved_use_old_impl_(OwnedImpl::newBuffersUseOldImpl()) {
+    OwnedImpl::useOldImpl(GetParam());
+  }
+  ~OwnedImplTest() { OwnedImpl::useOldImpl(saved_use_old_impl_); }
 
   bool release_callback_called_ = false;
+
+private:
+  const bool saved_use_old_impl_;
 };
 
-TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
+INSTANTIATE_TEST_CASE_P(OwnedImplTest, OwnedImplTest, testing::Bool());
+
+TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, nullptr);
   Buffer::OwnedImpl buffer;
@@ -33,7 +41,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
+TEST_P(OwnedImplTest, AddBufferFragmentWithCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
     release_callback_called_ = true;
@@ -51,7 +59,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
+TEST_P(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   char input_stack[] = "hello world";
   char* input = new char[11];
   std::copy(input_stack, input_stack + 11, input);
@@ -76,7 +84,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, Prepend) {
+TEST_P(OwnedImplTest, Prepend) {
   std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
   buffer.add(suffix);
@@ -86,7 +94,7 @@ TEST_F(OwnedImplTest, Prepend) {
   EXPECT_EQ(prefix + suffix, buffer.toString());
 }
 
-TEST_F(OwnedImplTest, PrependToEmptyBuffer) {
+TEST_P(OwnedImplTest, PrependToEmptyBuffer) {
   std::string data = "Hello, World!";
   Buffer::OwnedImpl buffer;
   buffer.prepend(data);
@@ -100,7 +108,7 @@ TEST_F(OwnedImplTest, PrependToEmptyBuffer) {
   EXPECT_EQ(data, buffer.toString());
 }
 
-TEST_F(OwnedImplTest, PrependBuffer) {
+TEST_P(OwnedImplTest, PrependBuffer) {
   std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
   buffer.add(suffix);
@@ -114,7 +122,7 @@ TEST_F(OwnedImplTest, PrependBuffer) {
   EXPECT_EQ(0, prefixBuffer.length());
 }
 
-TEST_F(OwnedImplTest, Write) {
+TEST_P(OwnedImplTest, Write) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -152,7 +160,7 @@ TEST_F(OwnedImplTest, Write) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, Read) {
+TEST_P(OwnedImplTest, Read) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -173,7 +181,7 @@ TEST_F(OwnedImplTest, Read) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, ToString) {
+TEST_P(OwnedImplTest, ToString) {
   Buffer::OwnedImpl buffer;
   EXPECT_EQ("", buffer.toString());
   auto append = [&buffer](absl::string_view str) { buffer.add(str.data(), str.size()); };
@@ -188,6 +196,195 @@ TEST_F(OwnedImplTest, ToString) {
   EXPECT_EQ(absl::StrCat("Hello, world!" + long_string), buffer.toString());
 }
 
+TEST_P(OwnedImplTest, UsesSelectedImpl) {
+  Buffer::OwnedImpl buffer;
+  EXPECT_EQ(GetParam(), buffer.usesOldImpl());
+}
+
+TEST_P(OwnedImplTest, MoveSlices) {
+  Buffer::OwnedImpl buffer1;
+  buffer1.appendSliceForTest("abc");
+  buffer1.appendSliceForTest("defg");
+  buffer1.appendSliceForTest("h");
+  EXPECT_EQ(8, buffer1.length());
+
+  Buffer::OwnedImpl buffer2;
+  buffer2.add("0123");
+  buffer2.move(buffer1);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ("", buffer1.toString());
+  EXPECT_EQ(12, buffer2.length());
+  EXPECT_EQ("0123abcdefgh", buffer2.toString());
+}
+
+TEST_P(OwnedImplTest, MovePartialSlices) {
+  Buffer::OwnedImpl buffer1;
+  buffer1.appendSliceForTest("abc");
+  buffer1.appendSliceForTest("defg");
+  buffer1.appendSliceForTest("hij");
+
+  Buffer::OwnedImpl buffer2;
+  buffer2.move(buffer1, 5);
+  EXPECT_EQ("abcde", buffer2.toString());
+  EXPECT_EQ("fghij", buffer1.toString());
+  EXPECT_EQ(5, buffer1.length());
+
+  buffer2.move(buffer1, 2);
+  EXPECT_EQ("abcdefg", buffer2.toString());
+  EXPECT_EQ("hij", buffer1.toString());
+
+  buffer2.move(buffer1, 3);
+  EXPECT_EQ("abcdefghij", buffer2.toString());
+  EXPECT_EQ(10, buffer2.length());
+  EXPECT_EQ(0, buffer1.length());
+}
+
+TEST_P(OwnedImplTest, ManySlices) {
+  // More slices than fit in the inline slice ring, with enough front and back churn to
+  // wrap around the ring several times.
+  Buffer::OwnedImpl buffer;
+  std::string expected;
+  for (int i = 0; i < 100; i++) {
+    const std::string data = absl::StrCat(i, ",");
+    buffer.appendSliceForTest(data);
+    expected += data;
+    if (i % 3 == 0) {
+      buffer.drain(2);
+      expected = expected.substr(2);
+    }
+  }
+  EXPECT_EQ(expected.size(), buffer.length());
+  EXPECT_EQ(expected, buffer.toString());
+
+  for (int i = 0; i < 20; i++) {
+    buffer.prepend("x");
+    expected = "x" + expected;
+  }
+  EXPECT_EQ(expected, buffer.toString());
+}
+
+TEST_P(OwnedImplTest, CopyOutAcrossSlices) {
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest("abc");
+  buffer.appendSliceForTest("defg");
+  buffer.appendSliceForTest("hij");
+
+  char out[8];
+  buffer.copyOut(2, 7, out);
+  EXPECT_EQ("cdefghi", std::string(out, 7));
+  buffer.copyOut(3, 4, out);
+  EXPECT_EQ("defg", std::string(out, 4));
+  buffer.copyOut(9, 1, out);
+  EXPECT_EQ("j", std::string(out, 1));
+  EXPECT_EQ(10, buffer.length());
+}
+
+TEST_P(OwnedImplTest, Linearize) {
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest("abc");
+  buffer.appendSliceForTest("defg");
+  buffer.appendSliceForTest("hij");
+
+  EXPECT_EQ("abc", std::string(static_cast<const char*>(buffer.linearize(3)), 3));
+  EXPECT_EQ("abcdef", std::string(static_cast<const char*>(buffer.linearize(6)), 6));
+  EXPECT_EQ("abcdefghij", std::string(static_cast<const char*>(buffer.linearize(10)), 10));
+  EXPECT_EQ(1, buffer.getRawSlices(nullptr, 0));
+  EXPECT_EQ("abcdefghij", buffer.toString());
+}
+
+TEST_P(OwnedImplTest, SearchAcrossSlices) {
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest("abc");
+  buffer.appendSliceForTest("d");
+  buffer.appendSliceForTest("efab");
+  buffer.appendSliceForTest("cdg");
+
+  EXPECT_EQ(0, buffer.search("abc", 3, 0));
+  EXPECT_EQ(2, buffer.search("cdef", 4, 0));
+  EXPECT_EQ(6, buffer.search("abcd", 4, 1));
+  EXPECT_EQ(8, buffer.search("cdg", 3, 0));
+  EXPECT_EQ(-1, buffer.search("cdgh", 4, 0));
+  EXPECT_EQ(-1, buffer.search("abc", 3, 7));
+  EXPECT_EQ(5, buffer.search("", 0, 5));
+}
+
+TEST_P(OwnedImplTest, ReserveCommit) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("abc");
+
+  RawSlice iovecs[2];
+  const uint64_t num_reserved = buffer.reserve(8000, iovecs, 2);
+  ASSERT_GE(num_reserved, 1);
+  uint64_t reserved = 0;
+  for (uint64_t i = 0; i < num_reserved; i++) {
+    memset(iovecs[i].mem_, 'x', iovecs[i].len_);
+    reserved += iovecs[i].len_;
+  }
+  EXPECT_GE(reserved, 8000);
+
+  // Commit only part of the first reservation.
+  iovecs[0].len_ = 5;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ(8, buffer.length());
+  EXPECT_EQ("abcxxxxx", buffer.toString());
+
+  // A later add() must land after the committed data.
+  buffer.add("yz");
+  EXPECT_EQ("abcxxxxxyz", buffer.toString());
+}
+
+TEST_P(OwnedImplTest, ReserveZeroCommit) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("abc");
+  RawSlice iovecs[2];
+  const uint64_t num_reserved = buffer.reserve(100, iovecs, 2);
+  for (uint64_t i = 0; i < num_reserved; i++) {
+    iovecs[i].len_ = 0;
+  }
+  buffer.commit(iovecs, num_reserved);
+  EXPECT_EQ(3, buffer.length());
+  EXPECT_EQ("abc", buffer.toString());
+}
+
+TEST_P(OwnedImplTest, ReservePartialCommitRepeated) {
+  Buffer::OwnedImpl buffer;
+  std::string expected;
+  for (int i = 0; i < 1000; i++) {
+    RawSlice iovecs[2];
+    const uint64_t num_reserved = buffer.reserve(16384, iovecs, 2);
+    ASSERT_GE(num_reserved, 1);
+    *static_cast<char*>(iovecs[0].mem_) = 'a' + (i % 26);
+    iovecs[0].len_ = 1;
+    buffer.commit(iovecs, 1);
+    expected.push_back('a' + (i % 26));
+  }
+  EXPECT_EQ(1000, buffer.length());
+  EXPECT_EQ(expected, buffer.toString());
+}
+
+TEST_P(OwnedImplTest, BufferFragmentMoveAndPrepend) {
+  char input[] = "world";
+  BufferFragmentImpl frag(input, 5, [this](const void*, size_t, const BufferFragmentImpl*) {
+    release_callback_called_ = true;
+  });
+  {
+    Buffer::OwnedImpl buffer1;
+    buffer1.addBufferFragment(frag);
+    buffer1.prepend("hello ");
+    buffer1.add("!");
+    EXPECT_EQ("hello world!", buffer1.toString());
+
+    Buffer::OwnedImpl buffer2;
+    buffer2.move(buffer1);
+    EXPECT_FALSE(release_callback_called_);
+    EXPECT_EQ("hello world!", buffer2.toString());
+    buffer2.drain(6);
+    EXPECT_FALSE(release_callback_called_);
+    EXPECT_EQ("world!", buffer2.toString());
+  }
+  EXPECT_TRUE(release_callback_called_);
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
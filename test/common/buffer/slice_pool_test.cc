@@ -0,0 +1,146 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/slice_pool.h"
+#include "common/common/thread.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class SlicePoolTest : public testing::Test {
+protected:
+  void SetUp() override {
+    SlicePool::drainThreadCache();
+    start_ = SlicePool::stats();
+  }
+
+  void TearDown() override {
+    SlicePool::setWatermarks(SlicePool::DefaultLowWatermark, SlicePool::DefaultHighWatermark);
+    SlicePool::drainThreadCache();
+  }
+
+  uint64_t hits() const { return SlicePool::stats().hits_ - start_.hits_; }
+  uint64_t misses() const { return SlicePool::stats().misses_ - start_.misses_; }
+  uint64_t trimmed() const { return SlicePool::stats().trimmed_ - start_.trimmed_; }
+  uint64_t resident() const { return SlicePool::stats().resident_bytes_; }
+
+  SlicePool::Stats start_;
+};
+
+TEST_F(SlicePoolTest, Poolable) {
+  EXPECT_FALSE(SlicePool::poolable(0));
+  EXPECT_FALSE(SlicePool::poolable(100));
+  EXPECT_TRUE(SlicePool::poolable(SlicePool::PageSize));
+  EXPECT_TRUE(SlicePool::poolable(SlicePool::MaxPooledPages * SlicePool::PageSize));
+  EXPECT_FALSE(SlicePool::poolable((SlicePool::MaxPooledPages + 1) * SlicePool::PageSize));
+}
+
+TEST_F(SlicePoolTest, NonPoolableSizesBypassCache) {
+  void* block = SlicePool::allocate(100);
+  SlicePool::release(block, 100);
+  const uint64_t large = (SlicePool::MaxPooledPages + 1) * SlicePool::PageSize;
+  block = SlicePool::allocate(large);
+  SlicePool::release(block, large);
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(0, misses());
+  EXPECT_EQ(0, resident());
+}
+
+TEST_F(SlicePoolTest, ReleasedBlockIsReused) {
+  const uint64_t size = 2 * SlicePool::PageSize;
+  void* block = SlicePool::allocate(size);
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(1, misses());
+  SlicePool::release(block, size);
+  EXPECT_EQ(size, resident());
+
+  // A different size class doesn't see the cached block.
+  void* other = SlicePool::allocate(SlicePool::PageSize);
+  EXPECT_EQ(2, misses());
+
+  EXPECT_EQ(block, SlicePool::allocate(size));
+  EXPECT_EQ(1, hits());
+  EXPECT_EQ(0, resident());
+
+  SlicePool::release(block, size);
+  SlicePool::release(other, SlicePool::PageSize);
+  EXPECT_EQ(size + SlicePool::PageSize, resident());
+  SlicePool::drainThreadCache();
+  EXPECT_EQ(0, resident());
+}
+
+TEST_F(SlicePoolTest, HighWatermarkTrimsToLowWatermark) {
+  const uint64_t size = SlicePool::PageSize;
+  SlicePool::setWatermarks(2 * size, 4 * size);
+  std::vector<void*> blocks;
+  for (int i = 0; i < 5; i++) {
+    blocks.push_back(SlicePool::allocate(size));
+  }
+  for (int i = 0; i < 4; i++) {
+    SlicePool::release(blocks[i], size);
+  }
+  EXPECT_EQ(4 * size, resident());
+  EXPECT_EQ(0, trimmed());
+
+  // Crossing the high watermark drops the cache back to the low watermark.
+  SlicePool::release(blocks[4], size);
+  EXPECT_EQ(2 * size, resident());
+  EXPECT_EQ(3, trimmed());
+}
+
+TEST_F(SlicePoolTest, ZeroHighWatermarkDisablesCaching) {
+  SlicePool::setWatermarks(0, 0);
+  void* block = SlicePool::allocate(SlicePool::PageSize);
+  SlicePool::release(block, SlicePool::PageSize);
+  EXPECT_EQ(0, resident());
+  SlicePool::release(SlicePool::allocate(SlicePool::PageSize), SlicePool::PageSize);
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(2, misses());
+}
+
+// Each thread has its own cache, and its counters survive the thread exiting.
+TEST_F(SlicePoolTest, PerThreadCaches) {
+  const uint64_t size = SlicePool::PageSize;
+  SlicePool::release(SlicePool::allocate(size), size);
+  EXPECT_EQ(size, resident());
+
+  Thread::Thread thread([size]() {
+    // The block cached by the main thread isn't visible here.
+    void* block = SlicePool::allocate(size);
+    SlicePool::release(block, size);
+    EXPECT_EQ(block, SlicePool::allocate(size));
+    SlicePool::release(block, size);
+  });
+  thread.join();
+
+  // The exiting thread returned its cache to the heap.
+  EXPECT_EQ(size, resident());
+  EXPECT_EQ(1, hits());
+  EXPECT_EQ(2, misses());
+}
+
+// Slices of a native OwnedImpl are recycled through the pool.
+TEST_F(SlicePoolTest, OwnedImplSlicesArePooled) {
+  const bool old_impl = OwnedImpl::newBuffersUseOldImpl();
+  OwnedImpl::useOldImpl(false);
+  {
+    OwnedImpl buffer;
+    RawSlice iovec;
+    buffer.reserve(16384, &iovec, 1);
+    iovec.len_ = 16384;
+    buffer.commit(&iovec, 1);
+    buffer.drain(buffer.length());
+    EXPECT_EQ(1, misses());
+    EXPECT_EQ(SlicePool::MaxPooledPages * SlicePool::PageSize, resident());
+
+    buffer.reserve(16384, &iovec, 1);
+    EXPECT_EQ(1, hits());
+    EXPECT_EQ(0, resident());
+  }
+  OwnedImpl::useOldImpl(old_impl);
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
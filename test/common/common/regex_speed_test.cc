@@ -0,0 +1,93 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <vector>
+
+#include "common/common/linear_regex.h"
+#include "common/common/regex.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Regex {
+
+static const char Path[] = "/api/v1/users/12345/orders/67890";
+
+/**
+ * Measure matching a typical route regex against a request path with each engine.
+ * The variable parameter is the Engine.
+ */
+static void RegexMatchRoute(benchmark::State& state) {
+  CompiledMatcherPtr matcher = Utility::parseRegex("/api/v[0-9]+/users/[0-9]+/orders/[^/]+",
+                                                   static_cast<Engine>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(matcher->match(Path));
+  }
+}
+BENCHMARK(RegexMatchRoute)
+    ->Arg(static_cast<int>(Engine::StdRegex))
+    ->Arg(static_cast<int>(Engine::Linear));
+
+static std::vector<std::string> routePatterns(int64_t num_patterns) {
+  std::vector<std::string> patterns;
+  for (int64_t i = 0; i < num_patterns; i++) {
+    patterns.push_back(fmt::format("/api/v[0-9]+/service_{}/[0-9]+(/.*)?", i));
+  }
+  return patterns;
+}
+
+/**
+ * Measure finding which of a number of route regexes match a request path by trying each of them
+ * in turn, as a virtual host does without a pattern set. Only the last pattern matches.
+ * The variable parameters are the Engine and the number of patterns.
+ */
+static void RegexMatchEach(benchmark::State& state) {
+  std::vector<CompiledMatcherPtr> matchers;
+  for (const std::string& pattern : routePatterns(state.range(1))) {
+    matchers.push_back(Utility::parseRegex(pattern, static_cast<Engine>(state.range(0))));
+  }
+  const std::string path = fmt::format("/api/v1/service_{}/12345/orders", state.range(1) - 1);
+  for (auto _ : state) {
+    for (const CompiledMatcherPtr& matcher : matchers) {
+      if (matcher->match(path)) {
+        break;
+      }
+    }
+  }
+}
+BENCHMARK(RegexMatchEach)
+    ->Args({static_cast<int>(Engine::StdRegex), 10})
+    ->Args({static_cast<int>(Engine::StdRegex), 100})
+    ->Args({static_cast<int>(Engine::Linear), 10})
+    ->Args({static_cast<int>(Engine::Linear), 100});
+
+/**
+ * Measure finding which of a number of route regexes match a request path with all of them
+ * compiled into one LinearProgram.
+ * The variable parameter is the number of patterns.
+ */
+static void RegexMatchSet(benchmark::State& state) {
+  LinearProgramPtr program = LinearProgram::compile(routePatterns(state.range(0)));
+  const std::string path = fmt::format("/api/v1/service_{}/12345/orders", state.range(0) - 1);
+  std::vector<uint32_t> matches;
+  for (auto _ : state) {
+    matches.clear();
+    program->match(path, matches);
+    benchmark::DoNotOptimize(matches.data());
+  }
+}
+BENCHMARK(RegexMatchSet)->Arg(10)->Arg(100);
+
+} // namespace Regex
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,313 @@
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/linear_regex.h"
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Regex {
+
+TEST(LinearProgramTest, UnsupportedConstructs) {
+  for (const char* pattern :
+       {"(a)\\1", "a(?=b)", "a(?!b)", "\\bfoo", "foo\\B", "[[:alpha:]]+", "\\x41", "\\u0041",
+        "\\cA", "[\\b]", "[]a]", "[^]a]", "a{1001}", "(a{100}){200}"}) {
+    std::regex(pattern, std::regex::optimize);
+    EXPECT_EQ(nullptr, LinearProgram::compile({pattern})) << pattern;
+  }
+}
+
+// Compare against std::regex over patterns exercising each supported construct.
+TEST(LinearProgramTest, MatchesStdRegex) {
+  const std::vector<std::string> patterns{
+      "",
+      "abc",
+      "a.c",
+      "a*",
+      "a+b?",
+      "(ab|cd)*e",
+      "(?:ab|cd)+",
+      "a{2}",
+      "a{2,}",
+      "a{2,4}",
+      "a{0,1}b{1,2}?",
+      "(a|)+b",
+      "(a*)*",
+      "^abc$",
+      "a^b",
+      "(^a|b)c",
+      "a$|b",
+      "[abc]+",
+      "[^abc]+",
+      "[a-z0-9_-]+",
+      "[-a]",
+      "[a-]",
+      "[\\d\\s]+",
+      "[\\]\\\\]+",
+      "\\d+\\.\\d+",
+      "\\D\\W\\S",
+      "\\w+@\\w+\\.com",
+      "\\s*\\t\\n\\r\\f\\v",
+      "\\/api\\/v[0-9]+\\/.*",
+      "/api/v[0-9]/regex",
+      "/foo/[^/]+/bar(/.*)?",
+      ".*\\.envoyproxy\\.io",
+      "(a|ab)(c|bcd)(d*)",
+      "((a)|b)+",
+      "x*?y+?z??",
+  };
+  const std::vector<std::string> inputs{
+      "",
+      "a",
+      "aa",
+      "aaa",
+      "aaaa",
+      "ab",
+      "abc",
+      "abcd",
+      "abbc",
+      "abcde",
+      "abcdcde",
+      "acd",
+      "b",
+      "bc",
+      "ac",
+      "a\nc",
+      "a\rc",
+      "aab",
+      "abb",
+      "x-y_z",
+      "-",
+      "12.34",
+      "1 2",
+      "]\\",
+      "a@b.com",
+      "  \t\n\r\f\v",
+      "/api/v1/foo",
+      "/api/v12/",
+      "/api/v1/regex",
+      "/foo/x/bar",
+      "/foo/x/bar/baz",
+      "/foo//bar",
+      "www.envoyproxy.io",
+      "envoyproxy.io",
+      "abcd",
+      "xyz",
+      "yy",
+      "\xff\x80",
+  };
+
+  for (const std::string& pattern : patterns) {
+    LinearProgramPtr program = LinearProgram::compile({pattern});
+    ASSERT_NE(nullptr, program) << pattern;
+    EXPECT_TRUE(program->usesDfa()) << pattern;
+    const std::regex regex(pattern, std::regex::optimize);
+    for (const std::string& input : inputs) {
+      EXPECT_EQ(std::regex_match(input, regex), program->matchAny(input))
+          << "pattern: " << pattern << " input: " << input;
+    }
+  }
+}
+
+TEST(LinearProgramTest, MultiplePatterns) {
+  LinearProgramPtr program = LinearProgram::compile({"/api/.*", "/api/v[0-9]", "/static/.*", ".*"});
+  ASSERT_NE(nullptr, program);
+
+  std::vector<uint32_t> matches;
+  program->match("/api/v1", matches);
+  EXPECT_THAT(matches, ElementsAre(0, 1, 3));
+
+  matches.clear();
+  program->match("/static/x", matches);
+  EXPECT_THAT(matches, ElementsAre(2, 3));
+
+  // Matches are appended.
+  program->match("/", matches);
+  EXPECT_THAT(matches, ElementsAre(2, 3, 3));
+
+  // A pattern failing to compile fails the whole program.
+  EXPECT_EQ(nullptr, LinearProgram::compile({"/api/.*", "(a)\\1"}));
+
+  LinearProgramPtr anchored = LinearProgram::compile({"^$"});
+  matches.clear();
+  anchored->match("a", matches);
+  EXPECT_THAT(matches, IsEmpty());
+  EXPECT_TRUE(anchored->matchAny(""));
+}
+
+// The DFA for a character some distance from the end has exponentially many states, so the NFA is
+// simulated instead.
+TEST(LinearProgramTest, NfaFallback) {
+  const std::string pattern = "(a|b)*a(a|b){12}";
+  LinearProgramPtr program = LinearProgram::compile({pattern, "b+"});
+  ASSERT_NE(nullptr, program);
+  EXPECT_FALSE(program->usesDfa());
+
+  const std::regex regex(pattern, std::regex::optimize);
+  for (const char* input :
+       {"", "a", "abbbbbbbbbbbb", "babbbbbbbbbbbb", "bbbbbbbbbbbbbb", "aaaaaaaaaaaaaaaaaaa"}) {
+    std::vector<uint32_t> matches;
+    program->match(input, matches);
+    EXPECT_EQ(std::regex_match(input, regex), !matches.empty() && matches[0] == 0) << input;
+  }
+
+  std::vector<uint32_t> matches;
+  program->match("bbbbbbbbbbbbbbbbbbbbb", matches);
+  EXPECT_THAT(matches, ElementsAre(1));
+  matches.clear();
+  program->match("abbbbbbbbbbbb", matches);
+  EXPECT_THAT(matches, ElementsAre(0));
+}
+
+namespace {
+
+// Generates random patterns out of the constructs LinearProgram supports, over a small alphabet so
+// that random inputs often match.
+class PatternGenerator {
+public:
+  explicit PatternGenerator(uint32_t seed) : random_(seed) {}
+
+  std::string generate() { return alternation(0); }
+
+private:
+  std::string alternation(uint32_t depth) {
+    std::string pattern = concatenation(depth);
+    while (uniform(4) == 0) {
+      pattern += "|" + concatenation(depth);
+    }
+    return pattern;
+  }
+
+  std::string concatenation(uint32_t depth) {
+    std::string pattern;
+    for (uint32_t i = uniform(3) + 1; i > 0; i--) {
+      if (uniform(10) == 0) {
+        // Anchors can't be quantified.
+        pattern += uniform(2) == 0 ? "^" : "$";
+      } else {
+        pattern += atom(depth) + quantifier();
+      }
+    }
+    return pattern;
+  }
+
+  std::string atom(uint32_t depth) {
+    static const char* const atoms[] = {"a",     "b",   "c",   ".",   "[ab]", "[^a]",
+                                        "[a-c]", "\\d", "\\w", "\\s", "\\D",  "\\n"};
+    const uint32_t choice = uniform(depth < MaxDepth ? 16 : 12);
+    if (choice < 12) {
+      return atoms[choice];
+    }
+    return (choice < 14 ? "(" : "(?:") + alternation(depth + 1) + ")";
+  }
+
+  std::string quantifier() {
+    static const char* const quantifiers[] = {"*", "+", "?", "{2}", "{0,}", "{1,2}", "{0,3}"};
+    const uint32_t choice = uniform(14);
+    if (choice >= 7) {
+      return "";
+    }
+    return std::string(quantifiers[choice]) + (uniform(4) == 0 ? "?" : "");
+  }
+
+  // Unlike the distributions, the output of the engine is the same with every standard library.
+  uint32_t uniform(uint32_t n) { return random_() % n; }
+
+  // Deeper nesting of quantifiers makes std::regex backtrack for too long.
+  static const uint32_t MaxDepth = 2;
+  std::mt19937 random_;
+};
+
+// Every string of up to max_length characters out of alphabet.
+std::vector<std::string> allStrings(const std::string& alphabet, size_t max_length) {
+  std::vector<std::string> strings{""};
+  for (size_t begin = 0; strings[begin].size() < max_length;) {
+    const size_t end = strings.size();
+    for (size_t i = begin; i < end; i++) {
+      for (const char c : alphabet) {
+        strings.push_back(strings[i] + c);
+      }
+    }
+    begin = end;
+  }
+  return strings;
+}
+
+} // namespace
+
+// Compare against std::regex over generated patterns and every short input, both with the DFA and
+// with the NFA simulation it falls back to past its maximum size, and with several patterns
+// compiled into one program.
+TEST(LinearProgramTest, DifferentialStdRegex) {
+  const uint32_t NumPatterns = 400;
+  const uint32_t PatternsPerProgram = 4;
+  PatternGenerator generator(1);
+  const std::vector<std::string> inputs = allStrings("ab1\n", 4);
+
+  std::vector<std::string> patterns;
+  std::vector<std::regex> regexes;
+  for (uint32_t i = 0; i < NumPatterns; i++) {
+    patterns.push_back(generator.generate());
+    regexes.emplace_back(patterns.back(), std::regex::optimize);
+  }
+
+  for (uint32_t first = 0; first < NumPatterns; first += PatternsPerProgram) {
+    const std::vector<std::string> program_patterns(patterns.begin() + first,
+                                                    patterns.begin() + first + PatternsPerProgram);
+    // A cap of 2 states only fits the dead and start states, so the DFA of most programs
+    // overflows it part way through being built.
+    for (const uint32_t max_dfa_states : {LinearProgram::DefaultMaxDfaStates, 2U, 0U}) {
+      LinearProgramPtr program = LinearProgram::compile(program_patterns, max_dfa_states);
+      ASSERT_NE(nullptr, program) << program_patterns[0];
+      if (max_dfa_states == 0) {
+        EXPECT_FALSE(program->usesDfa());
+      }
+
+      for (const std::string& input : inputs) {
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < PatternsPerProgram; i++) {
+          if (std::regex_match(input, regexes[first + i])) {
+            expected.push_back(i);
+          }
+        }
+        std::vector<uint32_t> matches;
+        program->match(input, matches);
+        EXPECT_EQ(expected, matches)
+            << "patterns: " << program_patterns[0] << " " << program_patterns[1] << " "
+            << program_patterns[2] << " " << program_patterns[3] << " input: " << input
+            << " max DFA states: " << max_dfa_states;
+        EXPECT_EQ(!expected.empty(), program->matchAny(input));
+      }
+    }
+  }
+}
+
+TEST(RegexUtilityTest, ParseRegex) {
+  for (Engine engine : {Engine::StdRegex, Engine::Linear}) {
+    EXPECT_THROW_WITH_REGEX(Utility::parseRegex("(+invalid)", engine), EnvoyException,
+                            "Invalid regex '\\(\\+invalid\\)': .+");
+
+    CompiledMatcherPtr matcher = Utility::parseRegex("/foo/[0-9]+", engine);
+    EXPECT_TRUE(matcher->match("/foo/123"));
+    EXPECT_FALSE(matcher->match("/foo/123/"));
+
+    // Unsupported by the linear engine, so compiled with std::regex instead.
+    CompiledMatcherPtr backreference = Utility::parseRegex("(a+)b\\1", engine);
+    EXPECT_TRUE(backreference->match("aabaa"));
+    EXPECT_FALSE(backreference->match("aaba"));
+  }
+}
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,99 @@
+#include <string>
+#include <vector>
+
+#include "common/common/suffix_trie.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(SuffixTrieTest, Empty) {
+  SuffixTrie trie;
+  EXPECT_TRUE(trie.empty());
+  EXPECT_FALSE(trie.findLongest("foo.com"));
+  EXPECT_FALSE(trie.findLongest(""));
+}
+
+TEST(SuffixTrieTest, LongestSuffix) {
+  SuffixTrie trie;
+  EXPECT_TRUE(trie.add(".baz.com", 0));
+  EXPECT_TRUE(trie.add("-bar.baz.com", 1));
+  EXPECT_TRUE(trie.add(".foo.com", 2));
+  EXPECT_TRUE(trie.add("o.com", 3));
+  EXPECT_FALSE(trie.empty());
+
+  EXPECT_EQ(1, trie.findLongest("foo-bar.baz.com").value());
+  EXPECT_EQ(0, trie.findLongest("foo.bar.baz.com").value());
+  EXPECT_EQ(0, trie.findLongest("-bar.bar.baz.com").value());
+  EXPECT_EQ(2, trie.findLongest("www.foo.com").value());
+  EXPECT_EQ(3, trie.findLongest("www.zoo.com").value());
+  EXPECT_FALSE(trie.findLongest("www.bar.com"));
+  EXPECT_FALSE(trie.findLongest("com"));
+
+  // A suffix doesn't match a key equal to it.
+  EXPECT_EQ(3, trie.findLongest(".foo.com").value());
+  EXPECT_FALSE(trie.findLongest("o.com"));
+  EXPECT_EQ(0, trie.findLongest("-bar.baz.com").value());
+}
+
+TEST(SuffixTrieTest, Find) {
+  SuffixTrie trie;
+  EXPECT_FALSE(trie.find(""));
+  EXPECT_TRUE(trie.add("www.foo.com", 0));
+  EXPECT_TRUE(trie.add("api.foo.com", 1));
+  EXPECT_TRUE(trie.add("foo.com", 2));
+
+  EXPECT_EQ(0, trie.find("www.foo.com").value());
+  EXPECT_EQ(1, trie.find("api.foo.com").value());
+  EXPECT_EQ(2, trie.find("foo.com").value());
+  // Keys ending within an edge or at a node without an index, or longer than any suffix.
+  EXPECT_FALSE(trie.find("oo.com"));
+  EXPECT_FALSE(trie.find(".foo.com"));
+  EXPECT_FALSE(trie.find("xwww.foo.com"));
+  EXPECT_FALSE(trie.find("www.bar.com"));
+  EXPECT_FALSE(trie.find(""));
+}
+
+TEST(SuffixTrieTest, DuplicateSuffix) {
+  SuffixTrie trie;
+  EXPECT_TRUE(trie.add(".foo.com", 0));
+  EXPECT_FALSE(trie.add(".foo.com", 1));
+  EXPECT_EQ(0, trie.findLongest("www.foo.com").value());
+
+  // A suffix ending at a node created by splitting an edge is still new.
+  EXPECT_TRUE(trie.add(".com", 2));
+  EXPECT_FALSE(trie.add(".com", 3));
+  EXPECT_EQ(2, trie.findLongest("www.bar.com").value());
+}
+
+// Compare against matching every suffix, over suffixes which share long tails so that edges are
+// split in every position.
+TEST(SuffixTrieTest, MatchesLinearScan) {
+  std::vector<std::string> suffixes;
+  for (const char* a : {"", "a", "ba", "b"}) {
+    for (const char* b : {"", ".", "c.", "dc."}) {
+      suffixes.push_back(std::string(b) + a + "x");
+    }
+  }
+  SuffixTrie trie;
+  for (uint32_t i = 0; i < suffixes.size(); i++) {
+    trie.add(suffixes[i], i);
+  }
+
+  for (const std::string& suffix : suffixes) {
+    for (const char* prefix : {"", "y", "c.", "yc."}) {
+      const std::string key = prefix + suffix;
+      absl::optional<uint32_t> expected;
+      for (uint32_t i = 0; i < suffixes.size(); i++) {
+        if (suffixes[i].size() < key.size() &&
+            key.compare(key.size() - suffixes[i].size(), suffixes[i].size(), suffixes[i]) == 0 &&
+            (!expected || suffixes[i].size() > suffixes[expected.value()].size())) {
+          expected = i;
+        }
+      }
+      EXPECT_EQ(expected, trie.findLongest(key)) << key;
+    }
+  }
+}
+
+} // namespace Envoy
@@ -0,0 +1,265 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <vector>
+
+#include "common/http/header_map_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Add several dummy headers to a HeaderMap.
+ * @param num_headers the number of dummy headers to add.
+ */
+static void addDummyHeaders(HeaderMap& headers, size_t num_headers) {
+  const std::string prefix("dummy-key-");
+  for (size_t i = 0; i < num_headers; i++) {
+    headers.addCopy(LowerCaseString(prefix + std::to_string(i)), "abcd");
+  }
+}
+
+/**
+ * Add the pseudo headers and common headers of a typical request.
+ */
+static void addRequestHeaders(HeaderMapImpl& headers) {
+  headers.insertMethod().value(std::string("GET"));
+  headers.insertPath().value(std::string("/some/path/to/a/resource"));
+  headers.insertHost().value(std::string("www.example.com"));
+  headers.insertScheme().value(std::string("https"));
+  headers.insertUserAgent().value(std::string("benchmark"));
+  headers.insertAcceptEncoding().value(std::string("gzip"));
+}
+
+/** Measure the construction/destruction speed of HeaderMapImpl.*/
+static void HeaderMapImplCreate(benchmark::State& state) {
+  for (auto _ : state) {
+    HeaderMapImpl headers;
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(HeaderMapImplCreate);
+
+/**
+ * Measure the speed of populating a request header map from scratch, including its inline
+ * headers, and destroying it.
+ * The variable parameter is the number of additional headers to add.
+ */
+static void HeaderMapImplPopulate(benchmark::State& state) {
+  const std::string prefix("dummy-key-");
+  std::vector<LowerCaseString> keys;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    keys.emplace_back(prefix + std::to_string(i));
+  }
+  const std::string value("01234567890123456789");
+  for (auto _ : state) {
+    HeaderMapImpl headers;
+    addRequestHeaders(headers);
+    for (const LowerCaseString& key : keys) {
+      headers.addCopy(key, value);
+    }
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(HeaderMapImplPopulate)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+
+/**
+ * Measure the speed of populating a header map through addViaMove(), as the codecs do.
+ * The variable parameter is the number of additional headers to add.
+ */
+static void HeaderMapImplAddViaMove(benchmark::State& state) {
+  const std::string prefix("dummy-key-");
+  std::vector<std::string> keys;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    keys.push_back(prefix + std::to_string(i));
+  }
+  const std::string value("01234567890123456789");
+  for (auto _ : state) {
+    HeaderMapImpl headers;
+    for (const std::string& key : keys) {
+      HeaderString key_string;
+      key_string.setCopy(key.c_str(), key.size());
+      HeaderString value_string;
+      value_string.setCopy(value.c_str(), value.size());
+      headers.addViaMove(std::move(key_string), std::move(value_string));
+    }
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(HeaderMapImplAddViaMove)->Arg(10)->Arg(50);
+
+/**
+ * Measure the speed of copying a header map.
+ * The variable parameter is the number of additional headers in the source map.
+ */
+static void HeaderMapImplCopy(benchmark::State& state) {
+  HeaderMapImpl source_headers;
+  addRequestHeaders(source_headers);
+  addDummyHeaders(source_headers, state.range(0));
+  const HeaderMap& source = source_headers;
+  for (auto _ : state) {
+    HeaderMapImpl headers(source);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(HeaderMapImplCopy)->Arg(0)->Arg(10)->Arg(50);
+
+/**
+ * Measure the speed of a get() of a non-inline header that is present in the map.
+ * The variable parameter is the number of additional headers in the map.
+ */
+static void HeaderMapImplGet(benchmark::State& state) {
+  const LowerCaseString key("x-custom-header");
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  addDummyHeaders(headers, state.range(0));
+  headers.addReference(key, "value");
+  size_t successes = 0;
+  for (auto _ : state) {
+    successes += (headers.get(key) != nullptr);
+  }
+  benchmark::DoNotOptimize(successes);
+}
+BENCHMARK(HeaderMapImplGet)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+
+/**
+ * Measure the speed of a get() of a non-inline header that isn't in the map, as filters do when
+ * checking for optional headers.
+ * The variable parameter is the number of additional headers in the map.
+ */
+static void HeaderMapImplGetMissing(benchmark::State& state) {
+  const LowerCaseString key("x-custom-header");
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  addDummyHeaders(headers, state.range(0));
+  size_t failures = 0;
+  for (auto _ : state) {
+    failures += (headers.get(key) == nullptr);
+  }
+  benchmark::DoNotOptimize(failures);
+}
+BENCHMARK(HeaderMapImplGetMissing)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+
+/**
+ * Measure the speed of accessing an inline header.
+ * The variable parameter is the number of additional headers in the map.
+ */
+static void HeaderMapImplGetInline(benchmark::State& state) {
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  addDummyHeaders(headers, state.range(0));
+  size_t size = 0;
+  for (auto _ : state) {
+    size += headers.Path()->value().size();
+  }
+  benchmark::DoNotOptimize(size);
+}
+BENCHMARK(HeaderMapImplGetInline)->Arg(0)->Arg(10)->Arg(50);
+
+/**
+ * Measure the speed of lookup(), which resolves a header name against the table of inline
+ * headers, as the codecs do for every header they receive.
+ * The variable parameter selects the key: 0 for an inline header, 1 for a long inline header and
+ * 2 for a header that isn't inline.
+ */
+static void HeaderMapImplLookup(benchmark::State& state) {
+  const std::vector<LowerCaseString> keys{Headers::get().ContentType,
+                                          Headers::get().EnvoyUpstreamRequestPerTryTimeoutMs,
+                                          LowerCaseString("x-custom-header")};
+  const LowerCaseString& key = keys[state.range(0)];
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  size_t found = 0;
+  for (auto _ : state) {
+    const HeaderEntry* entry;
+    found += (headers.lookup(key, &entry) == HeaderMap::Lookup::Found);
+  }
+  benchmark::DoNotOptimize(found);
+}
+BENCHMARK(HeaderMapImplLookup)->Arg(0)->Arg(1)->Arg(2);
+
+/**
+ * Measure the speed of iterating over every header in a map.
+ * The variable parameter is the number of additional headers in the map.
+ */
+static void HeaderMapImplIterate(benchmark::State& state) {
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  addDummyHeaders(headers, state.range(0));
+  size_t num_callbacks = 0;
+  auto counting_callback = [](const HeaderEntry&, void* context) -> HeaderMap::Iterate {
+    (*static_cast<size_t*>(context))++;
+    return HeaderMap::Iterate::Continue;
+  };
+  for (auto _ : state) {
+    headers.iterate(counting_callback, &num_callbacks);
+  }
+  benchmark::DoNotOptimize(num_callbacks);
+}
+BENCHMARK(HeaderMapImplIterate)->Arg(0)->Arg(10)->Arg(50);
+
+/**
+ * Measure the speed of removing a non-inline header and adding it back.
+ * The variable parameter is the number of additional headers in the map.
+ */
+static void HeaderMapImplRemove(benchmark::State& state) {
+  const LowerCaseString key("x-custom-header");
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  addDummyHeaders(headers, state.range(0));
+  for (auto _ : state) {
+    headers.addReference(key, "value");
+    headers.remove(key);
+  }
+  benchmark::DoNotOptimize(headers.size());
+}
+BENCHMARK(HeaderMapImplRemove)->Arg(0)->Arg(10)->Arg(50)->Arg(100);
+
+/**
+ * Measure the speed of removing an inline header and adding it back.
+ * The variable parameter is the number of additional headers in the map.
+ */
+static void HeaderMapImplRemoveInline(benchmark::State& state) {
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  addDummyHeaders(headers, state.range(0));
+  for (auto _ : state) {
+    headers.insertContentLength().value(uint64_t(1234));
+    headers.removeContentLength();
+  }
+  benchmark::DoNotOptimize(headers.size());
+}
+BENCHMARK(HeaderMapImplRemoveInline)->Arg(0)->Arg(10)->Arg(50);
+
+/**
+ * Measure the speed of removePrefix(), as used to strip internal headers.
+ * The variable parameter is the number of additional headers in the map.
+ */
+static void HeaderMapImplRemovePrefix(benchmark::State& state) {
+  const LowerCaseString prefix("x-envoy-");
+  const LowerCaseString key("x-envoy-internal");
+  HeaderMapImpl headers;
+  addRequestHeaders(headers);
+  addDummyHeaders(headers, state.range(0));
+  for (auto _ : state) {
+    headers.addReference(key, "true");
+    headers.removePrefix(prefix);
+  }
+  benchmark::DoNotOptimize(headers.size());
+}
+BENCHMARK(HeaderMapImplRemovePrefix)->Arg(0)->Arg(10)->Arg(50);
+
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,10 +1,13 @@
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "common/http/header_map_impl.h"
 
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 
 using ::testing::InSequence;
@@ -649,6 +652,27 @@ TEST(HeaderMapImplTest, Lookup) {
     EXPECT_EQ(HeaderMap::Lookup::NotFound, headers.lookup(Headers::get().Host, &entry));
     EXPECT_EQ(nullptr, entry);
   }
+
+  // Names that are not inline headers are not supported, whether they differ from an inline
+  // header only in a character the signature does not sample ("content-lenhth"), in its middle
+  // ("x-envoy-upstreaa-rq-timeout-ms") or last ("x-envoy-upstream-rq-timeout-mx",
+  // "transfer-encodinf") character, or in length ("content-length-", "").
+  for (const char* name :
+       {"content-lenhth", "x-envoy-upstreaa-rq-timeout-ms", "x-envoy-upstream-rq-timeout-mx",
+        "transfer-encodinf", "content-length-", ""}) {
+    const HeaderEntry* entry;
+    EXPECT_EQ(HeaderMap::Lookup::NotSupported, headers.lookup(LowerCaseString{name}, &entry))
+        << name;
+  }
+
+  // The legacy host header resolves to :authority.
+  {
+    headers.addCopy("host", "example.com");
+    const HeaderEntry* entry;
+    EXPECT_EQ(HeaderMap::Lookup::Found, headers.lookup(LowerCaseString{"host"}, &entry));
+    EXPECT_STREQ("example.com", entry->value().c_str());
+    EXPECT_EQ(entry, headers.Host());
+  }
 }
 
 TEST(HeaderMapImplTest, Get) {
@@ -917,5 +941,205 @@ TEST(HeaderMapImplTest, TestHeaderMapImplyCopy) {
   EXPECT_STREQ("bar", baz.get(LowerCaseString("foo"))->value().c_str());
 }
 
+// Entries must not move as the map grows past several storage chunks, since callers hold on to
+// HeaderEntry pointers (including the inline header pointers) across insertions.
+TEST(HeaderMapImplTest, EntriesStableAcrossGrowth) {
+  TestHeaderMapImpl headers;
+  headers.insertPath().value(std::string("/"));
+  headers.addCopy(LowerCaseString("first"), "value");
+  const HeaderEntry* path = headers.Path();
+  const HeaderEntry* first = headers.get(LowerCaseString("first"));
+
+  for (int i = 0; i < 200; i++) {
+    headers.addCopy(LowerCaseString(absl::StrCat("x-header-", i)), absl::StrCat(i));
+  }
+  headers.insertMethod().value(std::string("GET"));
+
+  EXPECT_EQ(203UL, headers.size());
+  EXPECT_EQ(path, headers.Path());
+  EXPECT_EQ(first, headers.get(LowerCaseString("first")));
+  EXPECT_STREQ("/", path->value().c_str());
+  EXPECT_STREQ("value", first->value().c_str());
+  EXPECT_STREQ("199", headers.get(LowerCaseString("x-header-199"))->value().c_str());
+}
+
+// Storage freed by removals is reused, and order is preserved across removal and reinsertion.
+TEST(HeaderMapImplTest, RemoveAndReinsertMany) {
+  TestHeaderMapImpl headers;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 50; i++) {
+      headers.addCopy(LowerCaseString(absl::StrCat("x-header-", i)), absl::StrCat(round));
+    }
+    headers.insertPath().value(std::string("/"));
+    for (int i = 0; i < 50; i += 2) {
+      headers.remove(LowerCaseString(absl::StrCat("x-header-", i)));
+    }
+    EXPECT_EQ(26UL, headers.size());
+
+    std::vector<std::string> keys;
+    headers.iterate(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+          return HeaderMap::Iterate::Continue;
+        },
+        &keys);
+    ASSERT_EQ(26UL, keys.size());
+    EXPECT_EQ(":path", keys[0]);
+    for (size_t i = 1; i < keys.size(); i++) {
+      EXPECT_EQ(absl::StrCat("x-header-", 2 * i - 1), keys[i]);
+    }
+
+    headers.removePrefix(LowerCaseString(""));
+    EXPECT_EQ(0UL, headers.size());
+    EXPECT_EQ(nullptr, headers.Path());
+  }
+}
+
+// Exercise maps large enough to be indexed, including repeated keys, checking get() against a
+// scan of the map in iteration order.
+TEST(HeaderMapImplTest, LargeMapLookups) {
+  TestHeaderMapImpl headers;
+  auto first_with_key = [&headers](const std::string& key) -> const HeaderEntry* {
+    std::pair<std::string, const HeaderEntry*> search{key, nullptr};
+    headers.iterate(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          auto* search = static_cast<std::pair<std::string, const HeaderEntry*>*>(context);
+          if (header.key() == search->first.c_str()) {
+            search->second = &header;
+            return HeaderMap::Iterate::Break;
+          }
+          return HeaderMap::Iterate::Continue;
+        },
+        &search);
+    return search.second;
+  };
+  auto verify = [&]() {
+    for (int i = 0; i < 120; i++) {
+      const std::string key = absl::StrCat("x-header-", i);
+      EXPECT_EQ(first_with_key(key), headers.get(LowerCaseString(key))) << key;
+    }
+    EXPECT_EQ(first_with_key(":path"), headers.get(LowerCaseString(":path")));
+  };
+
+  for (int i = 0; i < 100; i++) {
+    headers.addCopy(LowerCaseString(absl::StrCat("x-header-", i)), "a");
+    verify();
+  }
+  headers.insertPath().value(std::string("/"));
+  // Repeat some keys; get() must keep returning the first one.
+  for (int i = 0; i < 100; i += 10) {
+    headers.addCopy(LowerCaseString(absl::StrCat("x-header-", i)), "b");
+  }
+  EXPECT_EQ(111UL, headers.size());
+  verify();
+  EXPECT_STREQ("a", headers.get(LowerCaseString("x-header-10"))->value().c_str());
+
+  // Removing a repeated key removes every copy.
+  headers.remove(LowerCaseString("x-header-10"));
+  EXPECT_EQ(nullptr, headers.get(LowerCaseString("x-header-10")));
+  EXPECT_EQ(109UL, headers.size());
+  verify();
+
+  // Remove in an order that shuffles the index's probe runs, then shrink below the threshold.
+  for (int i = 99; i >= 0; i -= 3) {
+    headers.remove(LowerCaseString(absl::StrCat("x-header-", i)));
+  }
+  verify();
+  headers.removePrefix(LowerCaseString("x-header-1"));
+  verify();
+  for (int i = 0; i < 100; i++) {
+    if (i % 7 != 0) {
+      headers.remove(LowerCaseString(absl::StrCat("x-header-", i)));
+    }
+  }
+  verify();
+
+  // Grow back above the threshold.
+  for (int i = 0; i < 120; i++) {
+    headers.addCopy(LowerCaseString(absl::StrCat("x-header-", i)), "c");
+  }
+  verify();
+  headers.removePrefix(LowerCaseString(""));
+  EXPECT_EQ(0UL, headers.size());
+  verify();
+}
+
+// Removals leave holes in the map's order which are skipped by iteration and compacted later, so
+// interleave removals and insertions, including of pseudo headers, and check the order both ways.
+TEST(HeaderMapImplTest, InterleavedRemoveAndInsert) {
+  TestHeaderMapImpl headers;
+  std::vector<std::string> expected;
+  auto add = [&](const std::string& key) {
+    headers.addCopy(LowerCaseString(key), "value");
+    if (key[0] == ':') {
+      auto it = std::find_if(expected.begin(), expected.end(),
+                             [](const std::string& existing) { return existing[0] != ':'; });
+      expected.insert(it, key);
+    } else {
+      expected.push_back(key);
+    }
+  };
+  auto remove = [&](const std::string& key) {
+    headers.remove(LowerCaseString(key));
+    expected.erase(std::remove(expected.begin(), expected.end(), key), expected.end());
+  };
+  auto verify = [&]() {
+    std::vector<std::string> keys;
+    headers.iterate(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+          return HeaderMap::Iterate::Continue;
+        },
+        &keys);
+    EXPECT_EQ(expected, keys);
+    keys.clear();
+    headers.iterateReverse(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+          return HeaderMap::Iterate::Continue;
+        },
+        &keys);
+    EXPECT_EQ(std::vector<std::string>(expected.rbegin(), expected.rend()), keys);
+    EXPECT_EQ(expected.size(), headers.size());
+  };
+
+  for (int i = 0; i < 40; i++) {
+    add(absl::StrCat("x-header-", i));
+  }
+  // Remove from the front, the middle and the back, then refill each gap.
+  for (int round = 0; round < 5; round++) {
+    remove(absl::StrCat("x-header-", round));
+    remove(absl::StrCat("x-header-", 20 + round));
+    remove(absl::StrCat("x-header-", 39 - round));
+    verify();
+    add(absl::StrCat(":pseudo-", round));
+    add(absl::StrCat("x-header-", 20 + round));
+    verify();
+  }
+  // Remove pseudo headers, leaving holes among them, then add more.
+  remove(":pseudo-1");
+  remove(":pseudo-3");
+  add(":path");
+  verify();
+  // Remove most of the map, which compacts it, then grow it back.
+  for (int i = 0; i < 40; i++) {
+    if (i % 4 != 0) {
+      remove(absl::StrCat("x-header-", i));
+    }
+  }
+  verify();
+  for (int i = 0; i < 20; i++) {
+    add(absl::StrCat("x-other-", i));
+    remove(absl::StrCat("x-other-", i / 2));
+  }
+  add(":method");
+  verify();
+  // Removing the last entry repeatedly shrinks the map from the end.
+  while (!expected.empty()) {
+    remove(expected.back());
+    verify();
+  }
+}
+
 } // namespace Http
 } // namespace Envoy
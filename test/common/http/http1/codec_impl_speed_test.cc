@@ -0,0 +1,178 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http1/codec_impl.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Adds num_headers custom headers, on top of the few common ones already in the map.
+ */
+static void addHeaders(TestHeaderMapImpl& headers, int64_t num_headers) {
+  for (int64_t i = 0; i < num_headers; i++) {
+    headers.addCopy(fmt::format("x-custom-header-{}", i), fmt::format("custom-value-{}", i));
+  }
+}
+
+/**
+ * A connection which drains whatever the codec writes to it.
+ */
+class DrainingConnection : public NiceMock<Network::MockConnection> {
+public:
+  DrainingConnection() {
+    ON_CALL(*this, write(_, _)).WillByDefault(Invoke([](Buffer::Instance& data, bool) -> void {
+      data.drain(data.length());
+    }));
+  }
+};
+
+/**
+ * Measure the time to encode the headers of a header only response. Each iteration also parses
+ * the minimal request the response answers. The variable parameter is the number of custom
+ * headers.
+ */
+static void ResponseHeadersEncode(benchmark::State& state) {
+  DrainingConnection connection;
+  NiceMock<MockServerConnectionCallbacks> callbacks;
+  NiceMock<Http1Settings> codec_settings;
+  ServerConnectionImpl codec(connection, callbacks, codec_settings);
+  NiceMock<MockStreamDecoder> decoder;
+  StreamEncoder* response_encoder = nullptr;
+  ON_CALL(callbacks, newStream(_))
+      .WillByDefault(Invoke([&](StreamEncoder& encoder) -> StreamDecoder& {
+        response_encoder = &encoder;
+        return decoder;
+      }));
+
+  TestHeaderMapImpl headers{{":status", "200"},
+                            {"content-type", "application/json"},
+                            {"date", "Tue, 16 Oct 2018 10:00:00 GMT"},
+                            {"server", "envoy"},
+                            {"x-envoy-upstream-service-time", "12"}};
+  addHeaders(headers, state.range(0));
+  const std::string request = "GET / HTTP/1.1\r\nhost: example.com\r\n\r\n";
+  for (auto _ : state) {
+    Buffer::OwnedImpl data(request);
+    codec.dispatch(data);
+    response_encoder->encodeHeaders(headers, true);
+  }
+}
+BENCHMARK(ResponseHeadersEncode)->Arg(0)->Arg(10)->Arg(50);
+
+/**
+ * Measure the time to encode the headers of a header only request. Each iteration also parses
+ * the minimal response to the request. The variable parameter is the number of custom headers.
+ */
+static void RequestHeadersEncode(benchmark::State& state) {
+  DrainingConnection connection;
+  NiceMock<MockConnectionCallbacks> callbacks;
+  ClientConnectionImpl codec(connection, callbacks);
+  NiceMock<MockStreamDecoder> decoder;
+
+  TestHeaderMapImpl headers{{":method", "GET"},
+                            {":path", "/api/v1/resources?page=2"},
+                            {":authority", "example.com"},
+                            {"user-agent", "curl/7.54.0"},
+                            {"accept", "*/*"},
+                            {"x-request-id", "f0a6b5a4-7c3b-4f8e-9b0e-4f3b5c0d3c2a"}};
+  addHeaders(headers, state.range(0));
+  const std::string response = "HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n";
+  for (auto _ : state) {
+    codec.newStream(decoder).encodeHeaders(headers, true);
+    Buffer::OwnedImpl data(response);
+    codec.dispatch(data);
+  }
+}
+BENCHMARK(RequestHeadersEncode)->Arg(0)->Arg(10)->Arg(50);
+
+/**
+ * Measure the time to parse requests. Each iteration also encodes a minimal response, which lets
+ * the server connection move on to the next request. Build with --define http1_parser=fast to
+ * measure FastRequestParserImpl rather than http_parser.
+ */
+static void dispatchRequests(benchmark::State& state, const std::string& request) {
+  DrainingConnection connection;
+  NiceMock<MockServerConnectionCallbacks> callbacks;
+  NiceMock<Http1Settings> codec_settings;
+  ServerConnectionImpl codec(connection, callbacks, codec_settings);
+  NiceMock<MockStreamDecoder> decoder;
+  StreamEncoder* response_encoder = nullptr;
+  ON_CALL(callbacks, newStream(_))
+      .WillByDefault(Invoke([&](StreamEncoder& encoder) -> StreamDecoder& {
+        response_encoder = &encoder;
+        return decoder;
+      }));
+
+  TestHeaderMapImpl response_headers{{":status", "200"}};
+  for (auto _ : state) {
+    Buffer::OwnedImpl data(request);
+    codec.dispatch(data);
+    response_encoder->encodeHeaders(response_headers, true);
+  }
+}
+
+/**
+ * The variable parameter is the number of custom headers of the request, on top of a few common
+ * ones.
+ */
+static void RequestDecode(benchmark::State& state) {
+  std::string request = "GET /api/v1/resources?page=2 HTTP/1.1\r\n"
+                        "host: example.com\r\n"
+                        "user-agent: Mozilla/5.0 (X11; Linux x86_64; rv:62.0) Gecko/20100101\r\n"
+                        "accept: text/html,application/xhtml+xml,application/xml;q=0.9\r\n"
+                        "accept-encoding: gzip, deflate, br\r\n"
+                        "x-request-id: f0a6b5a4-7c3b-4f8e-9b0e-4f3b5c0d3c2a\r\n";
+  for (int64_t i = 0; i < state.range(0); i++) {
+    request += fmt::format("x-custom-header-{}: custom-value-{}\r\n", i, i);
+  }
+  request += "\r\n";
+  dispatchRequests(state, request);
+}
+BENCHMARK(RequestDecode)->Arg(0)->Arg(10)->Arg(50);
+
+/**
+ * The variable parameter is the size of the chunked body of the request, sent in 1 KiB chunks.
+ */
+static void ChunkedRequestDecode(benchmark::State& state) {
+  std::string request = "POST /upload HTTP/1.1\r\n"
+                        "host: example.com\r\n"
+                        "content-type: application/octet-stream\r\n"
+                        "transfer-encoding: chunked\r\n\r\n";
+  const std::string chunk = "400\r\n" + std::string(1024, 'a') + "\r\n";
+  for (int64_t i = 0; i < state.range(0) / 1024; i++) {
+    request += chunk;
+  }
+  request += "0\r\n\r\n";
+  dispatchRequests(state, request);
+}
+BENCHMARK(ChunkedRequestDecode)->Arg(1024)->Arg(16384)->Arg(131072);
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
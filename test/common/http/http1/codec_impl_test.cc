@@ -27,10 +27,11 @@ namespace Envoy {
 namespace Http {
 namespace Http1 {
 
-class Http1ServerConnectionImplTest : public ::testing::Test {
+// Runs with both request parsers, whichever one the build selects.
+class Http1ServerConnectionImplTest : public testing::TestWithParam<RequestParserType> {
 public:
   void initialize() {
-    codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_));
+    codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_, GetParam()));
   }
 
   NiceMock<Network::MockConnection> connection_;
@@ -43,6 +44,9 @@ public:
   void expect400(Protocol p, bool allow_absolute_url, Buffer::OwnedImpl& buffer);
 };
 
+INSTANTIATE_TEST_CASE_P(RequestParsers, Http1ServerConnectionImplTest,
+                        testing::Values(RequestParserType::HttpParser, RequestParserType::Fast));
+
 void Http1ServerConnectionImplTest::expect400(Protocol p, bool allow_absolute_url,
                                               Buffer::OwnedImpl& buffer) {
   InSequence sequence;
@@ -52,7 +56,7 @@ void Http1ServerConnectionImplTest::expect400(Protocol p, bool allow_absolute_ur
 
   if (allow_absolute_url) {
     codec_settings_.allow_absolute_url_ = allow_absolute_url;
-    codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_));
+    codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_, GetParam()));
   }
 
   Http::MockStreamDecoder decoder;
@@ -71,7 +75,7 @@ void Http1ServerConnectionImplTest::expectHeadersTest(Protocol p, bool allow_abs
   // Make a new 'codec' with the right settings
   if (allow_absolute_url) {
     codec_settings_.allow_absolute_url_ = allow_absolute_url;
-    codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_));
+    codec_.reset(new ServerConnectionImpl(connection_, callbacks_, codec_settings_, GetParam()));
   }
 
   Http::MockStreamDecoder decoder;
@@ -83,7 +87,7 @@ void Http1ServerConnectionImplTest::expectHeadersTest(Protocol p, bool allow_abs
   EXPECT_EQ(p, codec_->protocol());
 }
 
-TEST_F(Http1ServerConnectionImplTest, EmptyHeader) {
+TEST_P(Http1ServerConnectionImplTest, EmptyHeader) {
   initialize();
 
   InSequence sequence;
@@ -104,7 +108,7 @@ TEST_F(Http1ServerConnectionImplTest, EmptyHeader) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10) {
+TEST_P(Http1ServerConnectionImplTest, Http10) {
   initialize();
 
   InSequence sequence;
@@ -121,7 +125,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10) {
   EXPECT_EQ(Protocol::Http10, codec_->protocol());
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
+TEST_P(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
   initialize();
 
   TestHeaderMapImpl expected_headers{{":path", "/"}, {":method", "GET"}};
@@ -129,7 +133,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10AbsoluteNoOp) {
   expectHeadersTest(Protocol::Http10, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http10Absolute) {
+TEST_P(Http1ServerConnectionImplTest, Http10Absolute) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -138,7 +142,7 @@ TEST_F(Http1ServerConnectionImplTest, Http10Absolute) {
   expectHeadersTest(Protocol::Http10, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -147,7 +151,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath1) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -156,7 +160,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePath2) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
   TestHeaderMapImpl expected_headers{
       {":authority", "www.somewhere.com:4532"}, {":path", "/foo/bar"}, {":method", "GET"}};
   Buffer::OwnedImpl buffer(
@@ -164,7 +168,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathWithPort) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -173,7 +177,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsoluteEnabledNoOp) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11InvalidRequest) {
+TEST_P(Http1ServerConnectionImplTest, Http11InvalidRequest) {
   initialize();
 
   // Invalid because www.somewhere.com is not an absolute path nor an absolute url
@@ -181,7 +185,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11InvalidRequest) {
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -190,21 +194,21 @@ TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathNoSlash) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePathBad) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePathBad) {
   initialize();
 
   Buffer::OwnedImpl buffer("GET * HTTP/1.1\r\nHost: bah\r\n\r\n");
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11AbsolutePortTooLarge) {
+TEST_P(Http1ServerConnectionImplTest, Http11AbsolutePortTooLarge) {
   initialize();
 
   Buffer::OwnedImpl buffer("GET http://foobar.com:1000000 HTTP/1.1\r\nHost: bah\r\n\r\n");
   expect400(Protocol::Http11, true, buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11RelativeOnly) {
+TEST_P(Http1ServerConnectionImplTest, Http11RelativeOnly) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -213,7 +217,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11RelativeOnly) {
   expectHeadersTest(Protocol::Http11, false, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, Http11Options) {
+TEST_P(Http1ServerConnectionImplTest, Http11Options) {
   initialize();
 
   TestHeaderMapImpl expected_headers{
@@ -222,7 +226,7 @@ TEST_F(Http1ServerConnectionImplTest, Http11Options) {
   expectHeadersTest(Protocol::Http11, true, buffer, expected_headers);
 }
 
-TEST_F(Http1ServerConnectionImplTest, SimpleGet) {
+TEST_P(Http1ServerConnectionImplTest, SimpleGet) {
   initialize();
 
   InSequence sequence;
@@ -238,7 +242,7 @@ TEST_F(Http1ServerConnectionImplTest, SimpleGet) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, BadRequestNoStream) {
+TEST_P(Http1ServerConnectionImplTest, BadRequestNoStream) {
   initialize();
 
   std::string output;
@@ -249,7 +253,7 @@ TEST_F(Http1ServerConnectionImplTest, BadRequestNoStream) {
   EXPECT_EQ("HTTP/1.1 400 Bad Request\r\ncontent-length: 0\r\nconnection: close\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, BadRequestStartedStream) {
+TEST_P(Http1ServerConnectionImplTest, BadRequestStartedStream) {
   initialize();
 
   std::string output;
@@ -266,7 +270,7 @@ TEST_F(Http1ServerConnectionImplTest, BadRequestStartedStream) {
   EXPECT_EQ("HTTP/1.1 400 Bad Request\r\ncontent-length: 0\r\nconnection: close\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, HostHeaderTranslation) {
+TEST_P(Http1ServerConnectionImplTest, HostHeaderTranslation) {
   initialize();
 
   InSequence sequence;
@@ -282,7 +286,7 @@ TEST_F(Http1ServerConnectionImplTest, HostHeaderTranslation) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
+TEST_P(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
   initialize();
 
   InSequence sequence;
@@ -302,7 +306,7 @@ TEST_F(Http1ServerConnectionImplTest, CloseDuringHeadersComplete) {
   EXPECT_NE(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, PostWithContentLength) {
+TEST_P(Http1ServerConnectionImplTest, PostWithContentLength) {
   initialize();
 
   InSequence sequence;
@@ -324,7 +328,7 @@ TEST_F(Http1ServerConnectionImplTest, PostWithContentLength) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
+TEST_P(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -347,7 +351,7 @@ TEST_F(Http1ServerConnectionImplTest, HeaderOnlyResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 0\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, ChunkedResponse) {
+TEST_P(Http1ServerConnectionImplTest, ChunkedResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -374,7 +378,7 @@ TEST_F(Http1ServerConnectionImplTest, ChunkedResponse) {
             output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, ContentLengthResponse) {
+TEST_P(Http1ServerConnectionImplTest, ContentLengthResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -400,7 +404,7 @@ TEST_F(Http1ServerConnectionImplTest, ContentLengthResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 11\r\n\r\nHello World", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, HeadRequestResponse) {
+TEST_P(Http1ServerConnectionImplTest, HeadRequestResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -423,7 +427,7 @@ TEST_F(Http1ServerConnectionImplTest, HeadRequestResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ncontent-length: 5\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, HeadChunkedRequestResponse) {
+TEST_P(Http1ServerConnectionImplTest, HeadChunkedRequestResponse) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -446,7 +450,7 @@ TEST_F(Http1ServerConnectionImplTest, HeadChunkedRequestResponse) {
   EXPECT_EQ("HTTP/1.1 200 OK\r\ntransfer-encoding: chunked\r\n\r\n", output);
 }
 
-TEST_F(Http1ServerConnectionImplTest, DoubleRequest) {
+TEST_P(Http1ServerConnectionImplTest, DoubleRequest) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -471,7 +475,7 @@ TEST_F(Http1ServerConnectionImplTest, DoubleRequest) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
+TEST_P(Http1ServerConnectionImplTest, RequestWithTrailers) {
   initialize();
 
   NiceMock<Http::MockStreamDecoder> decoder;
@@ -488,7 +492,7 @@ TEST_F(Http1ServerConnectionImplTest, RequestWithTrailers) {
   EXPECT_EQ(0U, buffer.length());
 }
 
-TEST_F(Http1ServerConnectionImplTest, UpgradeRequest) {
+TEST_P(Http1ServerConnectionImplTest, UpgradeRequest) {
   initialize();
 
   InSequence sequence;
@@ -511,7 +515,7 @@ TEST_F(Http1ServerConnectionImplTest, UpgradeRequest) {
   codec_->dispatch(websocket_payload);
 }
 
-TEST_F(Http1ServerConnectionImplTest, UpgradeRequestWithEarlyData) {
+TEST_P(Http1ServerConnectionImplTest, UpgradeRequestWithEarlyData) {
   initialize();
 
   InSequence sequence;
@@ -526,7 +530,7 @@ TEST_F(Http1ServerConnectionImplTest, UpgradeRequestWithEarlyData) {
   codec_->dispatch(buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, UpgradeRequestWithTEChunked) {
+TEST_P(Http1ServerConnectionImplTest, UpgradeRequestWithTEChunked) {
   initialize();
 
   InSequence sequence;
@@ -543,7 +547,7 @@ TEST_F(Http1ServerConnectionImplTest, UpgradeRequestWithTEChunked) {
   codec_->dispatch(buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, UpgradeRequestWithNoBody) {
+TEST_P(Http1ServerConnectionImplTest, UpgradeRequestWithNoBody) {
   initialize();
 
   InSequence sequence;
@@ -560,7 +564,7 @@ TEST_F(Http1ServerConnectionImplTest, UpgradeRequestWithNoBody) {
   codec_->dispatch(buffer);
 }
 
-TEST_F(Http1ServerConnectionImplTest, WatermarkTest) {
+TEST_P(Http1ServerConnectionImplTest, WatermarkTest) {
   EXPECT_CALL(connection_, bufferLimit()).Times(1).WillOnce(Return(10));
   initialize();
 
@@ -631,6 +635,31 @@ TEST_F(Http1ClientConnectionImplTest, HostHeaderTranslate) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n", output);
 }
 
+// The header block is reserved at once, so it must be sized exactly even when it outgrows the
+// minimum reservation.
+TEST_F(Http1ClientConnectionImplTest, LargeHeaderBlock) {
+  initialize();
+
+  Http::MockStreamDecoder response_decoder;
+  Http::StreamEncoder& request_encoder = codec_->newStream(response_decoder);
+
+  std::string output;
+  ON_CALL(connection_, write(_, _)).WillByDefault(AddBufferToString(&output));
+
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  std::string expected_headers;
+  const std::string value(100, 'a');
+  for (int i = 0; i < 100; i++) {
+    const std::string key = "x-header-" + std::to_string(i);
+    headers.addCopy(key, value);
+    expected_headers += key + ": " + value + "\r\n";
+  }
+  request_encoder.encodeHeaders(headers, false);
+  EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\n" + expected_headers +
+                "transfer-encoding: chunked\r\n\r\n",
+            output);
+}
+
 TEST_F(Http1ClientConnectionImplTest, Reset) {
   initialize();
 
@@ -658,6 +687,11 @@ TEST_F(Http1ClientConnectionImplTest, MultipleHeaderOnlyThenNoContentLength) {
   EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n", output);
   output.clear();
 
+  EXPECT_CALL(response_decoder, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder, decodeData(_, true));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  codec_->dispatch(response);
+
   // Simulate the underlying connection being backed up. Ensure that it is
   // read-enabled as the new stream is created.
   EXPECT_CALL(connection_, readEnabled())
@@ -904,8 +938,122 @@ TEST_F(Http1ClientConnectionImplTest, HighwatermarkMultipleResponses) {
       ->onUnderlyingConnectionBelowWriteBufferLowWatermark();
 }
 
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequests) {
+  initialize();
+
+  InSequence s;
+
+  std::string output;
+  ON_CALL(connection_, write(_, _)).WillByDefault(AddBufferToString(&output));
+
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  NiceMock<Http::MockStreamDecoder> response_decoder1;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  request_encoder1.encodeHeaders(headers, true);
+  NiceMock<Http::MockStreamDecoder> response_decoder2;
+  TestHeaderMapImpl head_headers{{":method", "HEAD"}, {":path", "/"}, {":authority", "host"}};
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+  EXPECT_NE(&request_encoder1, &request_encoder2);
+  request_encoder2.encodeHeaders(head_headers, true);
+  EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n"
+            "HEAD / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n",
+            output);
+
+  // The responses arrive in order, the second one to a HEAD request.
+  EXPECT_CALL(response_decoder1, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder1, decodeData(BufferStringEqual("hello"), false));
+  EXPECT_CALL(response_decoder1, decodeData(BufferStringEqual(""), true));
+  EXPECT_CALL(response_decoder2, decodeHeaders_(_, true));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello"
+                             "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n");
+  codec_->dispatch(response);
+}
+
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequestsReset) {
+  initialize();
+
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  NiceMock<Http::MockStreamDecoder> response_decoder1;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  Http::MockStreamCallbacks callbacks1;
+  request_encoder1.getStream().addCallbacks(callbacks1);
+  request_encoder1.encodeHeaders(headers, true);
+  NiceMock<Http::MockStreamDecoder> response_decoder2;
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+  request_encoder2.encodeHeaders(headers, true);
+
+  // Resetting the first request resets the one pipelined after it, whose reset from the callbacks
+  // of the first, as when the connection is closed, is reported once, as unanswered.
+  EXPECT_CALL(callbacks1, onResetStream(StreamResetReason::LocalReset))
+      .WillOnce(Invoke([&](StreamResetReason) -> void {
+        request_encoder2.getStream().resetStream(StreamResetReason::ConnectionTermination);
+      }));
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::PipelinedRequestUnanswered));
+  request_encoder1.getStream().resetStream(StreamResetReason::LocalReset);
+}
+
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequestUnanswered) {
+  initialize();
+
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  NiceMock<Http::MockStreamDecoder> response_decoder1;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  request_encoder1.encodeHeaders(headers, true);
+  NiceMock<Http::MockStreamDecoder> response_decoder2;
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+  request_encoder2.encodeHeaders(headers, true);
+  NiceMock<Http::MockStreamDecoder> response_decoder3;
+  Http::StreamEncoder& request_encoder3 = codec_->newStream(response_decoder3);
+  Http::MockStreamCallbacks callbacks3;
+  request_encoder3.getStream().addCallbacks(callbacks3);
+  request_encoder3.encodeHeaders(headers, true);
+
+  // The first response completes and the second one begins.
+  EXPECT_CALL(response_decoder1, decodeHeaders_(_, true));
+  EXPECT_CALL(response_decoder2, decodeHeaders_(_, false));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"
+                             "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n");
+  codec_->dispatch(response);
+
+  // Closing the connection resets the remaining requests. Only the one whose response had not
+  // begun is reported as unanswered.
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::ConnectionTermination));
+  EXPECT_CALL(callbacks3, onResetStream(StreamResetReason::PipelinedRequestUnanswered));
+  request_encoder2.getStream().resetStream(StreamResetReason::ConnectionTermination);
+}
+
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequestsReadDisable) {
+  initialize();
+
+  InSequence s;
+
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  NiceMock<Http::MockStreamDecoder> response_decoder1;
+  Http::StreamEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  request_encoder1.encodeHeaders(headers, true);
+  EXPECT_CALL(connection_, readDisable(true));
+  request_encoder1.getStream().readDisable(true);
+
+  // The pipelined stream leaves the first one's flow control alone.
+  EXPECT_CALL(connection_, readDisable(_)).Times(0);
+  NiceMock<Http::MockStreamDecoder> response_decoder2;
+  Http::StreamEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+  request_encoder2.encodeHeaders(headers, true);
+
+  // Once the first response completes, its calls are unwound so that the second response can be
+  // read, and later calls from the first stream have no effect.
+  EXPECT_CALL(connection_, readDisable(false));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  codec_->dispatch(response);
+  request_encoder1.getStream().readDisable(false);
+}
+
 // For issue #1421 regression test that Envoy's HTTP parser applies header limits early.
-TEST_F(Http1ServerConnectionImplTest, TestCodecHeaderLimits) {
+TEST_P(Http1ServerConnectionImplTest, TestCodecHeaderLimits) {
   initialize();
 
   std::string exception_reason;
@@ -44,9 +44,9 @@ class ConnPoolImplForTest : public ConnPoolImpl {
 public:
   ConnPoolImplForTest(Event::MockDispatcher& dispatcher,
                       Upstream::ClusterInfoConstSharedPtr cluster,
-                      NiceMock<Event::MockTimer>* upstream_ready_timer)
+                      NiceMock<Event::MockTimer>* upstream_ready_timer, uint32_t max_pipeline_depth)
       : ConnPoolImpl(dispatcher, Upstream::makeTestHost(cluster, "tcp://127.0.0.1:9000"),
-                     Upstream::ResourcePriority::Default, nullptr),
+                     Upstream::ResourcePriority::Default, nullptr, max_pipeline_depth),
         mock_dispatcher_(dispatcher), mock_upstream_ready_timer_(upstream_ready_timer) {}
 
   ~ConnPoolImplForTest() {
@@ -122,9 +122,10 @@ public:
  */
 class Http1ConnPoolImplTest : public testing::Test {
 public:
-  Http1ConnPoolImplTest()
+  Http1ConnPoolImplTest() : Http1ConnPoolImplTest(1) {}
+  Http1ConnPoolImplTest(uint32_t max_pipeline_depth)
       : upstream_ready_timer_(new NiceMock<Event::MockTimer>(&dispatcher_)),
-        conn_pool_(dispatcher_, cluster_, upstream_ready_timer_) {}
+        conn_pool_(dispatcher_, cluster_, upstream_ready_timer_, max_pipeline_depth) {}
 
   ~Http1ConnPoolImplTest() {
     // Make sure all gauges are 0.
@@ -717,6 +718,187 @@ TEST_F(Http1ConnPoolImplTest, RemoteCloseToCompleteResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test fixture for connection pools which pipeline up to 3 requests per connection.
+ */
+class Http1ConnPoolImplPipelineTest : public Http1ConnPoolImplTest {
+public:
+  Http1ConnPoolImplPipelineTest() : Http1ConnPoolImplTest(3) {
+    cluster_->resource_manager_.reset(
+        new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+  }
+};
+
+/**
+ * Test that requests are pipelined on a busy connection up to the pipeline depth, after which they
+ * wait for a response to complete.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, PipelineRequests) {
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Immediate);
+  r3.startRequest();
+  ActiveTestRequest r4(*this, 0, ActiveTestRequest::Type::Pending);
+
+  // Finish r1, which makes room for r4.
+  conn_pool_.expectEnableUpstreamReady();
+  r4.expectNewStream();
+  r1.completeResponse(false);
+  conn_pool_.expectAndRunUpstreamReady();
+  r4.startRequest();
+
+  r2.completeResponse(true);
+  r3.completeResponse(false);
+  r4.completeResponse(false);
+
+  // The idle connection is reused without pipelining.
+  ActiveTestRequest r5(*this, 0, ActiveTestRequest::Type::Immediate);
+  r5.startRequest();
+  r5.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(3U, cluster_->stats_.upstream_rq_pipelined_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pipeline_reset_.value());
+}
+
+/**
+ * Test that a request is only pipelined once the request ahead of it has been fully sent.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, PipelineAfterEncodeComplete) {
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Pending);
+
+  conn_pool_.expectEnableUpstreamReady();
+  r1.startRequest();
+  r2.expectNewStream();
+  conn_pool_.expectAndRunUpstreamReady();
+  r2.startRequest();
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipelined_.value());
+}
+
+/**
+ * Test that every request in flight is reset when a pipelining connection is closed, and that the
+ * pipelined ones whose response had not begun are counted.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, DisconnectWithPipelinedRequests) {
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Immediate);
+  r3.startRequest();
+
+  // The response to r1 completes and the one to r2 begins before the upstream goes away.
+  r1.completeResponse(false);
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new TestHeaderMapImpl{{":status", "200"}}},
+                                   false);
+
+  Http::MockStreamCallbacks stream_callbacks2;
+  EXPECT_CALL(stream_callbacks2, onResetStream(StreamResetReason::ConnectionTermination));
+  r2.request_encoder_.getStream().addCallbacks(stream_callbacks2);
+  Http::MockStreamCallbacks stream_callbacks3;
+  EXPECT_CALL(stream_callbacks3, onResetStream(StreamResetReason::ConnectionTermination));
+  r3.request_encoder_.getStream().addCallbacks(stream_callbacks3);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_destroy_with_active_rq_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipeline_reset_.value());
+}
+
+/**
+ * Test that the requests pipelined behind a response carrying 'connection: close' are reset and
+ * counted when the pool closes the connection.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, ConnectionCloseHeaderWithPipelinedRequests) {
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+
+  // The codec client resets r2 as the connection closes. The HTTP/1 codec then reports it as
+  // unanswered, which the mock codec does not.
+  Http::MockStreamCallbacks stream_callbacks2;
+  EXPECT_CALL(stream_callbacks2, onResetStream(StreamResetReason::ConnectionTermination));
+  r2.request_encoder_.getStream().addCallbacks(stream_callbacks2);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  r1.inner_decoder_->decodeHeaders(
+      HeaderMapPtr{new TestHeaderMapImpl{{":status", "200"}, {"Connection", "Close"}}}, true);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_destroy_local_with_active_rq_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipeline_reset_.value());
+}
+
+/**
+ * Test that requests are not pipelined past the requests a connection has left.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, PipelineMaxRequestsPerConnection) {
+  InSequence s;
+
+  cluster_->max_requests_per_connection_ = 2;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Pending);
+  r3.handle_->cancel();
+
+  r1.completeResponse(false);
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  r2.completeResponse(false);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_max_requests_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_destroy_with_active_rq_.value());
+}
+
+/**
+ * Test that draining a pipelining connection lets the requests in flight complete.
+ */
+TEST_F(Http1ConnPoolImplPipelineTest, DrainPipelinedConnection) {
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+
+  conn_pool_.drainConnections();
+  r1.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  r2.completeResponse(false);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_destroy_with_active_rq_.value());
+}
+
 } // namespace Http1
 } // namespace Http
 } // namespace Envoy
@@ -0,0 +1,282 @@
+#include <http_parser.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/http/http1/fast_request_parser_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+/**
+ * Records the callbacks of the parser. The body is recorded apart since it may be reported in any
+ * number of pieces.
+ */
+class RecordingCallbacks : public ParserCallbacks {
+public:
+  // Http1::ParserCallbacks
+  void onMessageBegin() override { events_.push_back("begin"); }
+  void onUrl(const char* data, size_t length) override {
+    events_.push_back("url " + std::string(data, length));
+  }
+  void onHeaderField(const char*, size_t) override { ADD_FAILURE(); }
+  void onHeaderValue(const char*, size_t) override { ADD_FAILURE(); }
+  void onHeader(const char* key, size_t key_length, const char* value,
+                size_t value_length) override {
+    events_.push_back(std::string(key, key_length) + ": " + std::string(value, value_length));
+  }
+  int onHeadersComplete() override {
+    events_.push_back("headers complete");
+    return headers_complete_rc_;
+  }
+  void onBody(const char* data, size_t length) override { body_.append(data, length); }
+  void onMessageComplete() override {
+    events_.push_back("complete");
+    if (pause_on_complete_) {
+      parser_->pause(true);
+    }
+  }
+
+  std::vector<std::string> events_;
+  std::string body_;
+  int headers_complete_rc_{};
+  bool pause_on_complete_{};
+  Parser* parser_{};
+};
+
+class FastRequestParserImplTest : public testing::Test {
+public:
+  FastRequestParserImplTest() : parser_(callbacks_) { callbacks_.parser_ = &parser_; }
+
+  size_t execute(const std::string& data) { return parser_.execute(data.data(), data.size()); }
+
+  // Feed the data one byte at a time, each from its own allocation.
+  void executeBytewise(const std::string& data) {
+    for (const char c : data) {
+      std::unique_ptr<char> byte(new char(c));
+      EXPECT_EQ(1, parser_.execute(byte.get(), 1));
+    }
+  }
+
+  void expectError(const std::string& data, const std::string& error_name) {
+    execute(data);
+    EXPECT_EQ(ParserStatus::Error, parser_.status());
+    EXPECT_EQ(error_name, parser_.errorName());
+  }
+
+  RecordingCallbacks callbacks_;
+  FastRequestParserImpl parser_;
+};
+
+TEST_F(FastRequestParserImplTest, SimpleGet) {
+  const std::string request = "GET /index.html HTTP/1.1\r\nhost: example.com\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ(ParserStatus::Ok, parser_.status());
+  EXPECT_EQ((std::vector<std::string>{"begin", "url /index.html", "host: example.com",
+                                      "headers complete", "complete"}),
+            callbacks_.events_);
+  EXPECT_EQ(HTTP_GET, parser_.method());
+  EXPECT_EQ(1, parser_.httpMajor());
+  EXPECT_EQ(1, parser_.httpMinor());
+  EXPECT_FALSE(parser_.isChunked());
+  EXPECT_EQ(ULLONG_MAX, parser_.contentLength());
+}
+
+TEST_F(FastRequestParserImplTest, Http10WithBareLineFeeds) {
+  const std::string request = "M-SEARCH * HTTP/1.0\nman: \"ssdp:discover\"\n\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ((std::vector<std::string>{"begin", "url *", "man: \"ssdp:discover\"",
+                                      "headers complete", "complete"}),
+            callbacks_.events_);
+  EXPECT_EQ(HTTP_MSEARCH, parser_.method());
+  EXPECT_EQ(0, parser_.httpMinor());
+}
+
+// Values longer than 16 bytes go through the vectorized scans, when enabled. Whitespace around
+// values is trimmed, and the bytes which only the tables accept are kept.
+TEST_F(FastRequestParserImplTest, LongHeaders) {
+  const std::string value(100, 'v');
+  const std::string request = "POST /upload HTTP/1.1\r\n"
+                              "x-custom-header-with-a-long-name|~:  \t" +
+                              value + " \t\r\n"
+                                      "x-empty:\r\n"
+                                      "x-obs-text: caf\xc3\xa9\tand more text\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ((std::vector<std::string>{"begin", "url /upload",
+                                      "x-custom-header-with-a-long-name|~: " + value, "x-empty: ",
+                                      "x-obs-text: caf\xc3\xa9\tand more text",
+                                      "headers complete", "complete"}),
+            callbacks_.events_);
+}
+
+TEST_F(FastRequestParserImplTest, HeadAcrossCalls) {
+  executeBytewise("\r\nGET / HTTP/1.1\r\nhost: example.com\r\naccept: */*\r\n\r");
+  EXPECT_EQ((std::vector<std::string>{"begin"}), callbacks_.events_);
+  executeBytewise("\n");
+  EXPECT_EQ((std::vector<std::string>{"begin", "url /", "host: example.com", "accept: */*",
+                                      "headers complete", "complete"}),
+            callbacks_.events_);
+}
+
+TEST_F(FastRequestParserImplTest, PausedInBetweenPipelinedRequests) {
+  callbacks_.pause_on_complete_ = true;
+  const std::string first = "GET /first HTTP/1.1\r\n\r\n";
+  const std::string second = "GET /second HTTP/1.1\r\n\r\n";
+  EXPECT_EQ(first.size(), execute(first + second));
+  EXPECT_EQ(ParserStatus::Paused, parser_.status());
+  EXPECT_EQ(0, execute(second));
+
+  parser_.pause(false);
+  EXPECT_EQ(second.size(), execute(second));
+  EXPECT_EQ((std::vector<std::string>{"begin", "url /first", "headers complete", "complete",
+                                      "begin", "url /second", "headers complete", "complete"}),
+            callbacks_.events_);
+}
+
+TEST_F(FastRequestParserImplTest, ContentLengthBody) {
+  executeBytewise("PUT / HTTP/1.1\r\ncontent-length: 11\r\n\r\nhello world");
+  EXPECT_EQ((std::vector<std::string>{"begin", "url /", "content-length: 11", "headers complete",
+                                      "complete"}),
+            callbacks_.events_);
+  EXPECT_EQ("hello world", callbacks_.body_);
+  EXPECT_EQ(11, parser_.contentLength());
+}
+
+TEST_F(FastRequestParserImplTest, ChunkedBody) {
+  const std::string request = "POST / HTTP/1.1\r\ntransfer-encoding: gzip, Chunked\r\n\r\n"
+                              "5\r\nhello\r\n"
+                              "6;name=value\r\n world\r\n"
+                              "0\r\nx-trailer: value\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ("hello world", callbacks_.body_);
+  EXPECT_TRUE(parser_.isChunked());
+  EXPECT_EQ("complete", callbacks_.events_.back());
+
+  callbacks_.events_.clear();
+  callbacks_.body_.clear();
+  executeBytewise(request);
+  EXPECT_EQ("hello world", callbacks_.body_);
+  EXPECT_EQ("complete", callbacks_.events_.back());
+}
+
+TEST_F(FastRequestParserImplTest, NoBodyAfterHeadersComplete) {
+  callbacks_.headers_complete_rc_ = 2;
+  const std::string request =
+      "GET / HTTP/1.1\r\nconnection: upgrade\r\nupgrade: websocket\r\ncontent-length: 5\r\n\r\n";
+  EXPECT_EQ(request.size(), execute(request));
+  EXPECT_EQ("complete", callbacks_.events_.back());
+  EXPECT_EQ("", callbacks_.body_);
+}
+
+TEST_F(FastRequestParserImplTest, EndOfConnection) {
+  EXPECT_EQ(0, parser_.execute(nullptr, 0));
+  EXPECT_EQ(ParserStatus::Ok, parser_.status());
+
+  execute("GET / HTTP/1.1\r\n");
+  EXPECT_EQ(0, parser_.execute(nullptr, 0));
+  EXPECT_EQ(ParserStatus::Error, parser_.status());
+  EXPECT_STREQ("HPE_INVALID_EOF_STATE", parser_.errorName());
+}
+
+TEST_F(FastRequestParserImplTest, InvalidMethod) {
+  expectError("BREW /pot HTTP/1.1\r\n\r\n", "HPE_INVALID_METHOD");
+  EXPECT_EQ((std::vector<std::string>{"begin"}), callbacks_.events_);
+  EXPECT_EQ(0, execute("GET / HTTP/1.1\r\n\r\n"));
+}
+
+// A bad method is rejected before the rest of the head is received.
+TEST_F(FastRequestParserImplTest, InvalidMethodPrefix) {
+  expectError("bad", "HPE_INVALID_METHOD");
+  EXPECT_TRUE(callbacks_.events_.empty());
+}
+
+TEST_F(FastRequestParserImplTest, InvalidMethodPrefixSpanningCalls) {
+  EXPECT_EQ(1, execute("G"));
+  EXPECT_EQ(ParserStatus::Ok, parser_.status());
+  expectError("g", "HPE_INVALID_METHOD");
+  EXPECT_EQ((std::vector<std::string>{"begin"}), callbacks_.events_);
+}
+
+TEST_F(FastRequestParserImplTest, InvalidUrl) {
+  expectError("GET /a\x01 HTTP/1.1\r\n\r\n", "HPE_INVALID_URL");
+}
+
+TEST_F(FastRequestParserImplTest, InvalidVersion) {
+  expectError("GET / HTTP/1.12\r\n\r\n", "HPE_INVALID_VERSION");
+}
+
+TEST_F(FastRequestParserImplTest, FoldedHeaderValue) {
+  expectError("GET / HTTP/1.1\r\nx-folded: first\r\n second\r\n\r\n", "HPE_INVALID_HEADER_TOKEN");
+}
+
+TEST_F(FastRequestParserImplTest, InvalidHeaderField) {
+  expectError("GET / HTTP/1.1\r\nx-bad field: value\r\n\r\n", "HPE_INVALID_HEADER_TOKEN");
+}
+
+TEST_F(FastRequestParserImplTest, InvalidHeaderValue) {
+  expectError("GET / HTTP/1.1\r\nx-header: a value with a \x7f byte\r\n\r\n",
+              "HPE_INVALID_HEADER_TOKEN");
+}
+
+TEST_F(FastRequestParserImplTest, InvalidContentLength) {
+  expectError("PUT / HTTP/1.1\r\ncontent-length: 1x\r\n\r\n", "HPE_INVALID_CONTENT_LENGTH");
+}
+
+TEST_F(FastRequestParserImplTest, ContentLengthOverflow) {
+  expectError("PUT / HTTP/1.1\r\ncontent-length: 18446744073709551615\r\n\r\n",
+              "HPE_INVALID_CONTENT_LENGTH");
+}
+
+TEST_F(FastRequestParserImplTest, DuplicateContentLength) {
+  expectError("PUT / HTTP/1.1\r\ncontent-length: 1\r\ncontent-length: 1\r\n\r\n",
+              "HPE_UNEXPECTED_CONTENT_LENGTH");
+}
+
+TEST_F(FastRequestParserImplTest, ContentLengthAndChunked) {
+  expectError("PUT / HTTP/1.1\r\ncontent-length: 1\r\ntransfer-encoding: chunked\r\n\r\n",
+              "HPE_UNEXPECTED_CONTENT_LENGTH");
+}
+
+TEST_F(FastRequestParserImplTest, NotChunked) {
+  expectError("PUT / HTTP/1.1\r\ntransfer-encoding: gzip\r\n\r\n",
+              "HPE_INVALID_TRANSFER_ENCODING");
+}
+
+TEST_F(FastRequestParserImplTest, InvalidChunkSize) {
+  expectError("PUT / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\nz\r\n",
+              "HPE_INVALID_CHUNK_SIZE");
+}
+
+TEST_F(FastRequestParserImplTest, ChunkSizeOverflow) {
+  expectError("PUT / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n10000000000000000\r\n",
+              "HPE_INVALID_CHUNK_SIZE");
+}
+
+TEST_F(FastRequestParserImplTest, MissingChunkDataEnd) {
+  expectError("PUT / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n1\r\nab\r\n", "HPE_STRICT");
+}
+
+TEST_F(FastRequestParserImplTest, HeadOverflow) {
+  execute("GET / HTTP/1.1\r\n");
+  const std::string header = "x-header: " + std::string(1024, 'q') + "\r\n";
+  for (int i = 0; i < 79; ++i) {
+    EXPECT_EQ(header.size(), execute(header));
+  }
+  EXPECT_EQ(ParserStatus::Ok, parser_.status());
+  expectError(header, "HPE_HEADER_OVERFLOW");
+}
+
+TEST_F(FastRequestParserImplTest, TrailersOverflow) {
+  execute("PUT / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n0\r\n");
+  expectError(std::string(FastRequestParserImpl::MAX_HEAD_SIZE + 1, 'x'), "HPE_HEADER_OVERFLOW");
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/http/codec.h"
 #include "envoy/stats/scope.h"
@@ -811,6 +812,55 @@ TEST_P(Http2CodecImplTest, TestCodecHeaderCompression) {
   }
 }
 
+TEST_P(Http2CodecImplTest, RemoteMaxConcurrentStreams) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  TestHeaderMapImpl response_headers{{":status", "200"}};
+  EXPECT_CALL(response_decoder_, decodeHeaders_(_, true));
+  response_encoder_->encodeHeaders(response_headers, true);
+
+  // The server only advertises a limit other than the initial one, which leaves the client
+  // unlimited.
+  if (server_http2settings_.max_concurrent_streams_ != NGHTTP2_INITIAL_MAX_CONCURRENT_STREAMS) {
+    EXPECT_EQ(server_http2settings_.max_concurrent_streams_, client_.remoteMaxConcurrentStreams());
+  } else {
+    EXPECT_EQ(NGHTTP2_DEFAULT_MAX_CONCURRENT_STREAMS, client_.remoteMaxConcurrentStreams());
+  }
+}
+
+// Verify that the DATA frames of a body are written to the connection at once.
+TEST_P(Http2CodecImplTest, DataFramesSingleWrite) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  request_encoder_->encodeHeaders(request_headers, false);
+
+  std::vector<uint64_t> write_lengths;
+  ON_CALL(client_connection_, write(_, _))
+      .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+        write_lengths.push_back(data.length());
+        server_wrapper_.dispatch(data, server_);
+      }));
+
+  // The body spans three DATA frames of the default maximum frame size.
+  static const uint64_t FRAME_SIZE = 16384;
+  Buffer::OwnedImpl body(std::string(3 * FRAME_SIZE, 'a'));
+  EXPECT_CALL(request_decoder_, decodeData(_, false)).Times(AnyNumber());
+  EXPECT_CALL(request_decoder_, decodeData(_, true));
+  request_encoder_->encodeData(body, true);
+
+  ASSERT_FALSE(write_lengths.empty());
+  EXPECT_EQ(3 * (9 + FRAME_SIZE), write_lengths.front());
+  EXPECT_EQ(0U, body.length());
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
@@ -148,14 +148,13 @@ TEST_F(Http2ConnPoolImplTest, DrainConnections) {
   r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
   expectClientConnect(1);
 
-  // This will move primary to draining and destroy draining.
+  // This will move the second client to draining alongside the first.
   pool_.drainConnections();
-  EXPECT_CALL(*this, onClientDestroy());
-  dispatcher_.clearDeferredDeleteList();
 
-  // This will destroy draining.
+  // This will destroy both draining clients.
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
   test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
-  EXPECT_CALL(*this, onClientDestroy());
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
   dispatcher_.clearDeferredDeleteList();
 }
 
@@ -450,6 +449,183 @@ TEST_F(Http2ConnPoolImplTest, GoAway) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
 }
 
+/**
+ * Test that streams are spread over multiple connections, on the least loaded one.
+ */
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsLeastLoaded) {
+  InSequence s;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1024, 1));
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  expectClientConnect(0);
+
+  // The first connection is carrying a stream, so a second one is opened.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  expectClientConnect(1);
+
+  // Both connections are carrying a stream, so they start being shared.
+  ActiveTestRequest r3(*this, 0);
+
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  ActiveTestRequest r4(*this, 1);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+  EXPECT_EQ(4U, cluster_->stats_.upstream_rq_total_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_http2_stream_limited_.value());
+}
+
+/**
+ * Test that the single connection of a default pool isn't charged to the connections circuit
+ * breaker.
+ */
+TEST_F(Http2ConnPoolImplTest, SingleConnectionNotCharged) {
+  InSequence s;
+  Upstream::ResourceManager::Resource& connections =
+      cluster_->resourceManager(Upstream::ResourcePriority::Default).connections();
+  ASSERT_EQ(1U, connections.max());
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  expectClientConnect(0);
+  ActiveTestRequest r2(*this, 0);
+  EXPECT_TRUE(connections.canCreate());
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_TRUE(connections.canCreate());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_overflow_.value());
+}
+
+/**
+ * Test that the connections circuit breaker keeps streams on the connections already open.
+ */
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsOverflow) {
+  InSequence s;
+  Upstream::ResourceManager::Resource& connections =
+      cluster_->resourceManager(Upstream::ResourcePriority::Default).connections();
+  cluster_->http2_settings_.max_connections_per_host_ = 3;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  expectClientConnect(0);
+
+  // The second connection takes the only slot the cluster allows.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  expectClientConnect(1);
+  EXPECT_FALSE(connections.canCreate());
+
+  // No third connection can be opened, so a busy one is shared.
+  ActiveTestRequest r3(*this, 0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+  EXPECT_EQ(3U, cluster_->stats_.upstream_rq_total_.value());
+  EXPECT_TRUE(connections.canCreate());
+}
+
+/**
+ * Test that the peer's SETTINGS_MAX_CONCURRENT_STREAMS is respected when choosing a connection.
+ */
+TEST_F(Http2ConnPoolImplTest, RemoteMaxConcurrentStreams) {
+  InSequence s;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1024, 1));
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  test_clients_[0].codec_->remote_max_concurrent_streams_ = 1;
+  ActiveTestRequest r1(*this, 0);
+  expectClientConnect(0);
+
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  expectClientConnect(1);
+
+  // The first connection is at its limit, so the second one is shared even though it is carrying
+  // more streams.
+  ActiveTestRequest r3(*this, 1);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_http2_stream_limited_.value());
+
+  // With every connection at its limit, the least loaded one is still used.
+  test_clients_[1].codec_->remote_max_concurrent_streams_ = 2;
+  ActiveTestRequest r4(*this, 0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_http2_stream_limited_.value());
+
+  // Once a stream completes, its connection is available again.
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  ActiveTestRequest r5(*this, 1);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_http2_stream_limited_.value());
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that draining and GOAWAY apply to every connection.
+ */
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsDrain) {
+  InSequence s;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1024, 1));
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  expectClientConnect(0);
+
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  expectClientConnect(1);
+
+  // The second connection goes away, so a new stream opens a third one.
+  test_clients_[1].codec_client_->raiseGoAway();
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 2);
+  expectClientConnect(2);
+
+  ReadyWatcher drained;
+  pool_.addDrainedCallback([&]() -> void { drained.ready(); });
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(drained, ready());
+  EXPECT_CALL(r3.decoder_, decodeHeaders_(_, true));
+  r3.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
@@ -74,6 +74,23 @@ TEST(HttpUtility, isUpgrade) {
       TestHeaderMapImpl{{"connection", "keep-alive, Upgrade"}, {"upgrade", "FOO"}}));
 }
 
+TEST(HttpUtility, isPipelinable) {
+  EXPECT_FALSE(Utility::isPipelinable(TestHeaderMapImpl{}));
+  EXPECT_FALSE(Utility::isPipelinable(TestHeaderMapImpl{{":method", "POST"}}));
+  EXPECT_FALSE(Utility::isPipelinable(TestHeaderMapImpl{{":method", "get"}}));
+  EXPECT_FALSE(Utility::isPipelinable(
+      TestHeaderMapImpl{{":method", "GET"}, {"connection", "upgrade"}, {"upgrade", "websocket"}}));
+  EXPECT_FALSE(
+      Utility::isPipelinable(TestHeaderMapImpl{{":method", "GET"}, {"content-length", "5"}}));
+  EXPECT_FALSE(Utility::isPipelinable(
+      TestHeaderMapImpl{{":method", "GET"}, {"transfer-encoding", "chunked"}}));
+
+  EXPECT_TRUE(Utility::isPipelinable(TestHeaderMapImpl{{":method", "GET"}}));
+  EXPECT_TRUE(Utility::isPipelinable(TestHeaderMapImpl{{":method", "HEAD"}}));
+  EXPECT_TRUE(
+      Utility::isPipelinable(TestHeaderMapImpl{{":method", "GET"}, {"content-length", "0"}}));
+}
+
 // Start with H1 style websocket request headers. Transform to H2 and back.
 TEST(HttpUtility, H1H2H1Request) {
   TestHeaderMapImpl converted_headers = {
@@ -227,6 +244,7 @@ TEST(HttpUtility, parseHttp2Settings) {
               http2_settings.initial_stream_window_size_);
     EXPECT_EQ(Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE,
               http2_settings.initial_connection_window_size_);
+    EXPECT_EQ(1U, http2_settings.max_connections_per_host_);
   }
 
   {
@@ -0,0 +1,128 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "common/common/thread.h"
+#include "common/network/connection_balancer_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::InSequence;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class MockBalancedConnectionHandler : public BalancedConnectionHandler {
+public:
+  void post(ConnectionSocketPtr&& socket) override {
+    ConnectionSocketPtr posted_socket = std::move(socket);
+    post_();
+  }
+
+  MOCK_CONST_METHOD0(numConnections, uint64_t());
+  MOCK_METHOD0(incNumConnections, void());
+  MOCK_METHOD0(post_, void());
+};
+
+TEST(NopConnectionBalancerImplTest, CurrentHandler) {
+  NopConnectionBalancerImpl balancer;
+  NiceMock<MockBalancedConnectionHandler> handler1;
+  NiceMock<MockBalancedConnectionHandler> handler2;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+
+  EXPECT_CALL(handler1, incNumConnections()).Times(0);
+  EXPECT_CALL(handler1, post_()).Times(0);
+  ConnectionSocketPtr socket{new NiceMock<MockConnectionSocket>()};
+  EXPECT_FALSE(balancer.balanceSocket(handler1, socket));
+  EXPECT_NE(nullptr, socket);
+  balancer.unregisterHandler(handler1);
+  balancer.unregisterHandler(handler2);
+}
+
+TEST(ExactConnectionBalancerImplTest, FewestConnections) {
+  ExactConnectionBalancerImpl balancer;
+  MockBalancedConnectionHandler handler1;
+  MockBalancedConnectionHandler handler2;
+  MockBalancedConnectionHandler handler3;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.registerHandler(handler3);
+
+  // Another handler has fewer connections, and is counted before the socket is posted to it.
+  EXPECT_CALL(handler1, numConnections()).WillRepeatedly(Return(2));
+  EXPECT_CALL(handler2, numConnections()).WillRepeatedly(Return(1));
+  EXPECT_CALL(handler3, numConnections()).WillRepeatedly(Return(0));
+  {
+    InSequence s;
+    EXPECT_CALL(handler3, incNumConnections());
+    EXPECT_CALL(handler3, post_());
+  }
+  ConnectionSocketPtr socket{new NiceMock<MockConnectionSocket>()};
+  EXPECT_TRUE(balancer.balanceSocket(handler1, socket));
+  EXPECT_EQ(nullptr, socket);
+
+  // The current handler wins ties, and isn't counted as it counts its connections itself.
+  EXPECT_CALL(handler1, numConnections()).WillRepeatedly(Return(1));
+  EXPECT_CALL(handler3, numConnections()).WillRepeatedly(Return(1));
+  EXPECT_CALL(handler2, incNumConnections()).Times(0);
+  EXPECT_CALL(handler2, post_()).Times(0);
+  socket.reset(new NiceMock<MockConnectionSocket>());
+  EXPECT_FALSE(balancer.balanceSocket(handler2, socket));
+  EXPECT_NE(nullptr, socket);
+
+  // Unregistered handlers aren't picked.
+  balancer.unregisterHandler(handler2);
+  EXPECT_CALL(handler3, numConnections()).WillRepeatedly(Return(0));
+  EXPECT_CALL(handler3, incNumConnections());
+  EXPECT_CALL(handler3, post_());
+  EXPECT_TRUE(balancer.balanceSocket(handler1, socket));
+
+  balancer.unregisterHandler(handler1);
+  balancer.unregisterHandler(handler3);
+}
+
+// A handler being unregistered by its worker while a socket is posted to it from another worker
+// is only unregistered once the post is done, so that it may then be destroyed.
+TEST(ExactConnectionBalancerImplTest, UnregisterDuringPost) {
+  ExactConnectionBalancerImpl balancer;
+  NiceMock<MockBalancedConnectionHandler> handler1;
+  NiceMock<MockBalancedConnectionHandler> handler2;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  ON_CALL(handler1, numConnections()).WillByDefault(Return(1));
+  ON_CALL(handler2, numConnections()).WillByDefault(Return(0));
+
+  std::atomic<bool> unregistered{false};
+  Thread::ThreadPtr worker2;
+  EXPECT_CALL(handler2, post_()).WillOnce(Invoke([&]() -> void {
+    worker2 = std::make_unique<Thread::Thread>([&]() -> void {
+      balancer.unregisterHandler(handler2);
+      unregistered = true;
+    });
+    // Give the other worker a chance to unregister the handler, which it mustn't get.
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(unregistered);
+  }));
+  ConnectionSocketPtr socket{new NiceMock<MockConnectionSocket>()};
+  EXPECT_TRUE(balancer.balanceSocket(handler1, socket));
+  worker2->join();
+  EXPECT_TRUE(unregistered);
+
+  // The unregistered handler is no longer picked.
+  EXPECT_CALL(handler2, post_()).Times(0);
+  socket.reset(new NiceMock<MockConnectionSocket>());
+  EXPECT_FALSE(balancer.balanceSocket(handler1, socket));
+  balancer.unregisterHandler(handler1);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
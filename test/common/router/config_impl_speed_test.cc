@@ -0,0 +1,117 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "envoy/api/v2/rds.pb.h"
+
+#include "common/router/config_impl.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Builds a route configuration with a single virtual host of num_routes prefix routes, each for a
+ * different service.
+ */
+static envoy::api::v2::RouteConfiguration makeRouteConfig(int64_t num_routes) {
+  envoy::api::v2::RouteConfiguration route_config;
+  envoy::api::v2::route::VirtualHost* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("service");
+  virtual_host->add_domains("*");
+  for (int64_t i = 0; i < num_routes; i++) {
+    envoy::api::v2::route::Route* route = virtual_host->add_routes();
+    route->mutable_match()->set_prefix(fmt::format("/api/v1/service_{}/", i));
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  return route_config;
+}
+
+/**
+ * Measure the time to find the route of a request which matches the last configured route, the
+ * worst case for a linear scan of the routes.
+ * The variable parameter is the number of routes.
+ */
+static void RouteLookupLastRoute(benchmark::State& state) {
+  const int64_t num_routes = state.range(0);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(makeRouteConfig(num_routes), factory_context, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", "www.lyft.com"},
+      {":path", fmt::format("/api/v1/service_{}/method?id=1", num_routes - 1)},
+      {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(RouteLookupLastRoute)->Arg(10)->Arg(1000)->Arg(10000);
+
+/**
+ * Measure the time to find that no route matches a request, which requires ruling out every route.
+ * The variable parameter is the number of routes.
+ */
+static void RouteLookupNoMatch(benchmark::State& state) {
+  const int64_t num_routes = state.range(0);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(makeRouteConfig(num_routes), factory_context, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", "www.lyft.com"}, {":path", "/api/v2/service_0/method"}, {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(RouteLookupNoMatch)->Arg(10)->Arg(1000)->Arg(10000);
+
+/**
+ * Builds a route configuration with num_hosts virtual hosts, each with one wildcard domain. The
+ * wildcard suffixes have up to 200 distinct lengths.
+ */
+static envoy::api::v2::RouteConfiguration makeWildcardRouteConfig(int64_t num_hosts) {
+  envoy::api::v2::RouteConfiguration route_config;
+  for (int64_t i = 0; i < num_hosts; i++) {
+    envoy::api::v2::route::VirtualHost* virtual_host = route_config.add_virtual_hosts();
+    virtual_host->set_name(fmt::format("tenant_{}", i));
+    virtual_host->add_domains(fmt::format("*.{}{}.example.com", std::string(i % 200, 't'), i));
+    envoy::api::v2::route::Route* route = virtual_host->add_routes();
+    route->mutable_match()->set_prefix("/");
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  return route_config;
+}
+
+/**
+ * Measure the time to find the route of a request matching a wildcard domain.
+ * The variable parameter is the number of wildcard domains.
+ */
+static void RouteLookupWildcardHost(benchmark::State& state) {
+  const int64_t num_hosts = state.range(0);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(makeWildcardRouteConfig(num_hosts), factory_context, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority",
+       fmt::format("www.{}{}.example.com", std::string((num_hosts - 1) % 200, 't'), num_hosts - 1)},
+      {":path", "/"},
+      {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(RouteLookupWildcardHost)->Arg(10)->Arg(1000)->Arg(20000);
+
+} // namespace Router
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
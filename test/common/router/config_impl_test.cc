@@ -1040,6 +1040,125 @@ TEST(RouteMatcherTest, Priority) {
             config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)->routeEntry()->priority());
 }
 
+// Virtual hosts with enough routes look their prefix and path routes up in a trie. The first
+// matching route in configuration order must still win, whatever kind of match it uses.
+TEST(RouteMatcherTest, IndexedRoutesKeepConfigurationOrder) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: local_service
+    domains: ["*"]
+    routes:
+      - match:
+          prefix: "/api"
+          headers:
+            - name: x-canary
+              exact_match: "true"
+        route:
+          cluster: canary
+      - match:
+          regex: "/api/v[0-9]/regex"
+        route:
+          cluster: regex
+      - match:
+          path: "/api/v1/exact"
+        route:
+          cluster: exact
+      - match:
+          prefix: "/API/V1/CASE"
+          case_sensitive: false
+        route:
+          cluster: case_insensitive
+      - match:
+          prefix: "/api/v1"
+        route:
+          cluster: v1
+      - match:
+          path: "/api/v1/shadowed"
+        route:
+          cluster: shadowed
+      - match:
+          prefix: "/api/v2"
+        route:
+          cluster: v2
+      - match:
+          prefix: "/"
+          query_parameters:
+            - name: debug
+        route:
+          cluster: debug
+      - match:
+          prefix: "/"
+        route:
+          cluster: default
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+
+  const auto cluster = [&config](const std::string& path) {
+    return config.route(genHeaders("www.lyft.com", path, "GET"), 0)->routeEntry()->clusterName();
+  };
+
+  EXPECT_EQ("regex", cluster("/api/v1/regex"));
+  EXPECT_EQ("exact", cluster("/api/v1/exact"));
+  EXPECT_EQ("exact", cluster("/api/v1/exact?foo=bar"));
+  EXPECT_EQ("v1", cluster("/api/v1/exact/"));
+  EXPECT_EQ("case_insensitive", cluster("/api/v1/case/foo"));
+  EXPECT_EQ("case_insensitive", cluster("/Api/V1/Case"));
+  EXPECT_EQ("v1", cluster("/api/v1/shadowed"));
+  EXPECT_EQ("v2", cluster("/api/v2/regex/"));
+  EXPECT_EQ("debug", cluster("/api/v3?debug"));
+  EXPECT_EQ("default", cluster("/api/v3"));
+  EXPECT_EQ("default", cluster("/"));
+
+  Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v1/exact", "GET");
+  headers.addCopy("x-canary", "true");
+  EXPECT_EQ("canary", config.route(headers, 0)->routeEntry()->clusterName());
+}
+
+// A regex the linear engine doesn't support leaves all the regex routes to be tried in turn.
+TEST(RouteMatcherTest, IndexedRegexRoutesWithUnsupportedRegex) {
+  std::string yaml = R"EOF(
+virtual_hosts:
+  - name: local_service
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/a" }
+        route: { cluster: a }
+      - match: { regex: "/(x+)/\\1" }
+        route: { cluster: backreference }
+      - match: { regex: "/[xy]+/.*" }
+        route: { cluster: regex }
+      - match: { prefix: "/b" }
+        route: { cluster: b }
+      - match: { path: "/c" }
+        route: { cluster: c }
+      - match: { prefix: "/d" }
+        route: { cluster: d }
+      - match: { prefix: "/e" }
+        route: { cluster: e }
+      - match: { prefix: "/" }
+        route: { cluster: default }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  for (bool unsupported : {true, false}) {
+    if (!unsupported) {
+      yaml.replace(yaml.find("\\\\1"), 3, "y+");
+    }
+    TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+    const auto cluster = [&config](const std::string& path) {
+      return config.route(genHeaders("www.lyft.com", path, "GET"), 0)->routeEntry()->clusterName();
+    };
+
+    EXPECT_EQ(unsupported ? "backreference" : "regex", cluster("/xx/xx"));
+    EXPECT_EQ("backreference", cluster(unsupported ? "/x/x" : "/x/y"));
+    EXPECT_EQ("regex", cluster("/yx/foo?bar"));
+    EXPECT_EQ("c", cluster("/c"));
+    EXPECT_EQ("default", cluster("/x"));
+  }
+}
+
 TEST(RouteMatcherTest, NoHostRewriteAndAutoRewrite) {
   std::string json = R"EOF(
 {
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "common/router/path_trie.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+
+class PathTrieTest : public testing::Test {
+protected:
+  std::vector<uint32_t> find(const std::string& path) {
+    const size_t query = path.find('?');
+    return find(path, query == std::string::npos ? path.size() : query);
+  }
+
+  std::vector<uint32_t> find(const std::string& path, size_t path_length) {
+    std::vector<uint32_t> indices;
+    trie_.find(path, path_length, indices);
+    std::sort(indices.begin(), indices.end());
+    return indices;
+  }
+
+  PathTrie trie_;
+};
+
+TEST_F(PathTrieTest, Empty) {
+  EXPECT_TRUE(trie_.empty());
+  EXPECT_THAT(find("/"), IsEmpty());
+  EXPECT_THAT(find(""), IsEmpty());
+}
+
+TEST_F(PathTrieTest, Prefixes) {
+  trie_.addPrefix("/", 0);
+  trie_.addPrefix("/api/v1", 1);
+  trie_.addPrefix("/api/v2", 2);
+  trie_.addPrefix("/api", 3);
+  trie_.addPrefix("", 4);
+  EXPECT_FALSE(trie_.empty());
+
+  EXPECT_THAT(find("/api/v1/foo"), ElementsAre(0, 1, 3, 4));
+  EXPECT_THAT(find("/api/v2"), ElementsAre(0, 2, 3, 4));
+  EXPECT_THAT(find("/api/v"), ElementsAre(0, 3, 4));
+  EXPECT_THAT(find("/ap"), ElementsAre(0, 4));
+  EXPECT_THAT(find("foo"), ElementsAre(4));
+  // Prefixes match on the query string too.
+  EXPECT_THAT(find("/api?/v1"), ElementsAre(0, 3, 4));
+}
+
+TEST_F(PathTrieTest, Paths) {
+  trie_.addPath("/foo", 0);
+  trie_.addPath("/foo/bar", 1);
+  trie_.addPath("/foo", 2);
+  trie_.addPath("/fo", 3);
+
+  EXPECT_THAT(find("/foo"), ElementsAre(0, 2));
+  EXPECT_THAT(find("/foo/bar"), ElementsAre(1));
+  EXPECT_THAT(find("/fo"), ElementsAre(3));
+  EXPECT_THAT(find("/foo/"), IsEmpty());
+  EXPECT_THAT(find("/f"), IsEmpty());
+  // Paths don't match on the query string.
+  EXPECT_THAT(find("/foo?bar"), ElementsAre(0, 2));
+  EXPECT_THAT(find("/foo/bar?"), ElementsAre(1));
+}
+
+TEST_F(PathTrieTest, PrefixesAndPaths) {
+  trie_.addPrefix("/foo", 0);
+  trie_.addPath("/foo", 1);
+  trie_.addPrefix("/foobar", 2);
+  trie_.addPath("/foobaz", 3);
+
+  EXPECT_THAT(find("/foo"), ElementsAre(0, 1));
+  EXPECT_THAT(find("/foobar"), ElementsAre(0, 2));
+  EXPECT_THAT(find("/foobaz"), ElementsAre(0, 3));
+  EXPECT_THAT(find("/foob"), ElementsAre(0));
+  EXPECT_THAT(find("/fo"), IsEmpty());
+}
+
+TEST_F(PathTrieTest, IgnoreCase) {
+  PathTrie trie(true);
+  trie.addPrefix("/Foo", 0);
+  trie.addPath("/foo/BAR", 1);
+  trie.addPrefix("/foo/bar/", 2);
+
+  std::vector<uint32_t> indices;
+  trie.find("/FOO/bar", 8, indices);
+  std::sort(indices.begin(), indices.end());
+  EXPECT_THAT(indices, ElementsAre(0, 1));
+
+  indices.clear();
+  trie.find("/fOo/BaR/baz", 12, indices);
+  std::sort(indices.begin(), indices.end());
+  EXPECT_THAT(indices, ElementsAre(0, 2));
+
+  indices.clear();
+  trie.find("/fo", 3, indices);
+  EXPECT_THAT(indices, IsEmpty());
+
+  // A case sensitive trie tells the cases apart.
+  trie_.addPrefix("/Foo", 0);
+  EXPECT_THAT(find("/foo"), IsEmpty());
+  EXPECT_THAT(find("/Foo"), ElementsAre(0));
+}
+
+// Compare against matching every key, over keys which share long prefixes so that edges are split
+// in every position.
+TEST_F(PathTrieTest, MatchesLinearScan) {
+  std::vector<std::string> keys;
+  for (const char* a : {"", "a", "ab", "b"}) {
+    for (const char* b : {"", "/", "/c", "/cd"}) {
+      keys.push_back(std::string("/") + a + b);
+    }
+  }
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    trie_.addPrefix(keys[i], 2 * i);
+    trie_.addPath(keys[i], 2 * i + 1);
+  }
+
+  for (const std::string& path : keys) {
+    for (const char* suffix : {"", "x", "?q", "/x?q"}) {
+      const std::string request = path + suffix;
+      const size_t query = request.find('?');
+      const std::string without_query = request.substr(0, query);
+      std::vector<uint32_t> expected;
+      for (uint32_t i = 0; i < keys.size(); i++) {
+        if (request.compare(0, keys[i].size(), keys[i]) == 0) {
+          expected.push_back(2 * i);
+        }
+        if (without_query == keys[i]) {
+          expected.push_back(2 * i + 1);
+        }
+      }
+      std::sort(expected.begin(), expected.end());
+      EXPECT_EQ(expected, find(request)) << request;
+    }
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
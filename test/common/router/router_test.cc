@@ -1273,6 +1273,204 @@ TEST_F(RouterTest, RetryUpstreamReset) {
   EXPECT_TRUE(verifyHostUpstreamStats(1, 1));
 }
 
+// An unanswered pipelined request is retried once without a retry policy.
+TEST_F(RouterTest, RetryPipelinedRequestUnansweredOnce) {
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  // The retry is counted against the retries circuit breaker until the request is sent again.
+  Upstream::ResourceManager& resource_manager =
+      cm_.thread_local_cluster_.cluster_.info_->resourceManager(
+          Upstream::ResourcePriority::Default);
+  Event::MockTimer* retry_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*retry_timer, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_CALL(*router_.retry_state_, shouldRetry(_, _, _)).Times(0);
+  EXPECT_CALL(*router_.retry_state_, onHostAttempted(_));
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(_)).Times(0);
+  encoder1.stream_.resetStream(Http::StreamResetReason::PipelinedRequestUnanswered);
+  EXPECT_EQ(1U, cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter("upstream_rq_retry")
+                    .value());
+  EXPECT_FALSE(resource_manager.retries().canCreate());
+
+  // We expect the timer to kick off a new request.
+  NiceMock<Http::MockStreamEncoder> encoder2;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  retry_timer->callback_();
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 0));
+  EXPECT_TRUE(resource_manager.retries().canCreate());
+
+  // The second time it's left to the retry policy.
+  EXPECT_CALL(*router_.retry_state_, shouldRetry(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(503));
+  EXPECT_CALL(callbacks_.request_info_,
+              setResponseFlag(RequestInfo::ResponseFlag::UpstreamConnectionTermination));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  encoder2.stream_.resetStream(Http::StreamResetReason::PipelinedRequestUnanswered);
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 1));
+}
+
+// An unanswered pipelined request isn't retried when the retries circuit breaker overflows.
+TEST_F(RouterTest, RetryPipelinedRequestUnansweredOverflow) {
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  // Another retry takes the only one the cluster allows.
+  Upstream::ResourceManager& resource_manager =
+      cm_.thread_local_cluster_.cluster_.info_->resourceManager(
+          Upstream::ResourcePriority::Default);
+  resource_manager.retries().inc();
+
+  EXPECT_CALL(callbacks_.dispatcher_, createTimer_(_)).Times(0);
+  EXPECT_CALL(*router_.retry_state_, shouldRetry(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(503));
+  EXPECT_CALL(callbacks_.request_info_,
+              setResponseFlag(RequestInfo::ResponseFlag::UpstreamOverflow));
+  EXPECT_CALL(callbacks_.request_info_,
+              setResponseFlag(RequestInfo::ResponseFlag::UpstreamConnectionTermination));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  encoder1.stream_.resetStream(Http::StreamResetReason::PipelinedRequestUnanswered);
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 1));
+  EXPECT_EQ(1U, cm_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .counter("upstream_rq_retry_overflow")
+                    .value());
+  EXPECT_EQ(0U, cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter("upstream_rq_retry")
+                    .value());
+
+  resource_manager.retries().dec();
+}
+
+// A pending retry of an unanswered pipelined request no longer counts against the retries circuit
+// breaker once the request is destroyed.
+TEST_F(RouterTest, RetryPipelinedRequestUnansweredDestroy) {
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  Upstream::ResourceManager& resource_manager =
+      cm_.thread_local_cluster_.cluster_.info_->resourceManager(
+          Upstream::ResourcePriority::Default);
+  Event::MockTimer* retry_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*retry_timer, enableTimer(std::chrono::milliseconds(0)));
+  encoder1.stream_.resetStream(Http::StreamResetReason::PipelinedRequestUnanswered);
+  EXPECT_FALSE(resource_manager.retries().canCreate());
+
+  router_.onDestroy();
+  EXPECT_TRUE(resource_manager.retries().canCreate());
+}
+
+// An unanswered pipelined request whose body wasn't buffered is left to the retry policy, as it
+// would otherwise be sent again without its body.
+TEST_F(RouterTest, RetryPipelinedRequestUnansweredUnbufferedBody) {
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, false);
+  Buffer::OwnedImpl body_data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, router_.decodeData(body_data, true));
+
+  EXPECT_CALL(callbacks_.dispatcher_, createTimer_(_)).Times(0);
+  EXPECT_CALL(*router_.retry_state_, shouldRetry(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(503));
+  EXPECT_CALL(callbacks_.request_info_,
+              setResponseFlag(RequestInfo::ResponseFlag::UpstreamConnectionTermination));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  encoder1.stream_.resetStream(Http::StreamResetReason::PipelinedRequestUnanswered);
+  EXPECT_TRUE(verifyHostUpstreamStats(0, 1));
+  EXPECT_EQ(0U, cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter("upstream_rq_retry")
+                    .value());
+}
+
+// An unanswered pipelined request whose body was buffered is retried with its body.
+TEST_F(RouterTest, RetryPipelinedRequestUnansweredBufferedBody) {
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder&, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(encoder1, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, false);
+  Buffer::InstancePtr body_data(new Buffer::OwnedImpl("hello"));
+  EXPECT_CALL(*router_.retry_state_, enabled()).WillOnce(Return(true));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, router_.decodeData(*body_data, true));
+
+  Event::MockTimer* retry_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*retry_timer, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_CALL(*router_.retry_state_, shouldRetry(_, _, _)).Times(0);
+  encoder1.stream_.resetStream(Http::StreamResetReason::PipelinedRequestUnanswered);
+
+  // The retry sends the buffered body.
+  Http::StreamDecoder* response_decoder = nullptr;
+  NiceMock<Http::MockStreamEncoder> encoder2;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder2, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  ON_CALL(callbacks_, decodingBuffer()).WillByDefault(Return(body_data.get()));
+  EXPECT_CALL(encoder2, encodeHeaders(_, false));
+  EXPECT_CALL(encoder2, encodeData(_, true));
+  retry_timer->callback_();
+
+  // Normal response.
+  EXPECT_CALL(*router_.retry_state_, shouldRetry(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putHttpResponseCode(200));
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
 TEST_F(RouterTest, RetryUpstreamPerTryTimeout) {
   NiceMock<Http::MockStreamEncoder> encoder1;
   Http::StreamDecoder* response_decoder = nullptr;
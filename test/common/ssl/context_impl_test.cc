@@ -357,6 +357,42 @@ TEST_F(SslServerContextImplTicketTest, VerifySanWithNoCA) {
                             "is insecure and not allowed");
 }
 
+// Every server context which offloads its private key operations shares the pool of the manager,
+// which grows to the largest number of threads asked for.
+TEST_F(SslContextImplTest, PrivateKeyOffloadPoolShared) {
+  Runtime::MockLoader runtime;
+  ContextManagerImpl manager(runtime);
+  Stats::IsolatedStoreImpl store;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      tls_context.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestkey.pem"));
+
+  ServerContextConfigImpl inline_config(tls_context, factory_context);
+  ServerContextSharedPtr inline_ctx(
+      manager.createSslServerContext(store, inline_config, std::vector<std::string>{}));
+  EXPECT_EQ(nullptr, dynamic_cast<ContextImpl&>(*inline_ctx).privateKeyOffloadPool());
+
+  tls_context.mutable_private_key_offload_threads()->set_value(2);
+  ServerContextConfigImpl config_a(tls_context, factory_context);
+  ServerContextSharedPtr ctx_a(
+      manager.createSslServerContext(store, config_a, std::vector<std::string>{}));
+  tls_context.mutable_private_key_offload_threads()->set_value(3);
+  ServerContextConfigImpl config_b(tls_context, factory_context);
+  ServerContextSharedPtr ctx_b(
+      manager.createSslServerContext(store, config_b, std::vector<std::string>{}));
+
+  PrivateKeyOffloadPool* pool = dynamic_cast<ContextImpl&>(*ctx_a).privateKeyOffloadPool();
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ(pool, dynamic_cast<ContextImpl&>(*ctx_b).privateKeyOffloadPool());
+  EXPECT_EQ(3, pool->numThreads());
+}
+
 class ClientContextConfigImplTest : public SslCertsTest {};
 
 // Validate that empty SNI (according to C string rules) fails config validation.
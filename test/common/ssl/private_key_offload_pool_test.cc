@@ -0,0 +1,80 @@
+#include <atomic>
+#include <thread>
+
+#include "common/common/thread.h"
+#include "common/ssl/private_key_offload_pool.h"
+
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Ssl {
+namespace {
+
+TEST(PrivateKeyOffloadPoolTest, RunsOperations) {
+  PrivateKeyOffloadPool pool(4);
+  std::atomic<uint32_t> ran{};
+  absl::Notification done;
+  for (uint32_t i = 0; i < 100; i++) {
+    pool.post([&ran, &done]() -> void {
+      if (++ran == 100) {
+        done.Notify();
+      }
+    });
+  }
+  done.WaitForNotification();
+  EXPECT_EQ(100, ran);
+}
+
+// The pool only ever grows, to the largest number of threads asked for.
+TEST(PrivateKeyOffloadPoolTest, EnsureThreads) {
+  PrivateKeyOffloadPool pool(2);
+  EXPECT_EQ(2, pool.numThreads());
+  pool.ensureThreads(1);
+  EXPECT_EQ(2, pool.numThreads());
+  pool.ensureThreads(3);
+  EXPECT_EQ(3, pool.numThreads());
+
+  // Every thread picks operations: each operation blocks its thread until all three run at once.
+  std::atomic<uint32_t> running{};
+  absl::Notification all_running;
+  for (uint32_t i = 0; i < 3; i++) {
+    pool.post([&running, &all_running]() -> void {
+      if (++running == 3) {
+        all_running.Notify();
+      }
+      all_running.WaitForNotification();
+    });
+  }
+  all_running.WaitForNotification();
+}
+
+// Operations still queued when the pool is destroyed are dropped, running ones are waited for.
+TEST(PrivateKeyOffloadPoolTest, DropsQueuedOperationsOnDestruction) {
+  auto pool = std::make_unique<PrivateKeyOffloadPool>(1);
+  std::atomic<uint32_t> ran{};
+  absl::Notification started;
+  absl::Notification resume;
+  pool->post([&]() -> void {
+    started.Notify();
+    resume.WaitForNotification();
+    ++ran;
+  });
+  started.WaitForNotification();
+  pool->post([&ran]() -> void { ++ran; });
+  EXPECT_EQ(1, pool->queueSize());
+
+  PrivateKeyOffloadPool* raw_pool = pool.get();
+  Thread::Thread destroyer([&pool]() -> void { pool.reset(); });
+  // The queued operation is dropped before the running one is waited for.
+  while (raw_pool->queueSize() != 0) {
+    std::this_thread::yield();
+  }
+  resume.Notify();
+  destroyer.join();
+  EXPECT_EQ(1, ran);
+}
+
+} // namespace
+} // namespace Ssl
+} // namespace Envoy
@@ -2486,6 +2486,43 @@ TEST_P(SslSocketTest, CipherSuites) {
   server_params->clear_cipher_suites();
 }
 
+TEST_P(SslSocketTest, PrivateKeyOffload) {
+  envoy::api::v2::Listener listener;
+  envoy::api::v2::listener::FilterChain* filter_chain = listener.add_filter_chains();
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      filter_chain->mutable_tls_context()->mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/ssl/test_data/san_dns_cert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/ssl/test_data/san_dns_key.pem"));
+  filter_chain->mutable_tls_context()->mutable_private_key_offload_threads()->set_value(2);
+  envoy::api::v2::auth::TlsParameters* server_params =
+      filter_chain->mutable_tls_context()->mutable_common_tls_context()->mutable_tls_params();
+
+  envoy::api::v2::auth::UpstreamTlsContext client;
+  envoy::api::v2::auth::TlsParameters* client_params =
+      client.mutable_common_tls_context()->mutable_tls_params();
+
+  // The server signs with the offloaded private key, using defaults (client & server).
+  testUtilV2(listener, client, "", true, "", "", "", "", "", "ssl.private_key_offload.operations",
+             1, GetParam());
+
+  // The server decrypts with the offloaded private key, using RSA key exchange.
+  client_params->add_cipher_suites("AES128-GCM-SHA256");
+  server_params->add_cipher_suites("AES128-GCM-SHA256");
+  testUtilV2(listener, client, "", true, "", "", "", "", "", "ssl.private_key_offload.operations",
+             1, GetParam());
+  client_params->clear_cipher_suites();
+  server_params->clear_cipher_suites();
+
+  // The server signs with the offloaded private key, using TLSv1.3.
+  client_params->set_tls_minimum_protocol_version(envoy::api::v2::auth::TlsParameters::TLSv1_3);
+  client_params->set_tls_maximum_protocol_version(envoy::api::v2::auth::TlsParameters::TLSv1_3);
+  server_params->set_tls_maximum_protocol_version(envoy::api::v2::auth::TlsParameters::TLSv1_3);
+  testUtilV2(listener, client, "", true, "TLSv1.3", "", "", "", "",
+             "ssl.private_key_offload.operations", 1, GetParam());
+}
+
 TEST_P(SslSocketTest, EcdhCurves) {
   envoy::api::v2::Listener listener;
   envoy::api::v2::listener::FilterChain* filter_chain = listener.add_filter_chains();
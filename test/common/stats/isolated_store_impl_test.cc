@@ -56,6 +56,20 @@ TEST(StatsIsolatedStoreImplTest, All) {
   EXPECT_EQ(2UL, store.gauges().size());
 }
 
+// Metrics with the same tag-extracted name and tags share a single decoded copy of each.
+TEST(StatsIsolatedStoreImplTest, SharedTagExtractedName) {
+  IsolatedStoreImpl store;
+
+  Counter& c = store.counter("shared");
+  Gauge& g = store.gauge("shared");
+  Counter& other = store.counter("other");
+  EXPECT_EQ(&c.tagExtractedName(), &g.tagExtractedName());
+  EXPECT_EQ(&c.tags(), &g.tags());
+  EXPECT_EQ(&c.tags(), &other.tags());
+  EXPECT_NE(&c.tagExtractedName(), &other.tagExtractedName());
+  EXPECT_EQ("other", other.tagExtractedName());
+}
+
 TEST(StatsIsolatedStoreImplTest, LongStatName) {
   IsolatedStoreImpl store;
   Stats::StatsOptionsImpl stats_options;
@@ -0,0 +1,95 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "common/stats/log_linear_histogram.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+class LogLinearHistogramTest : public testing::Test {
+protected:
+  std::vector<double> quantiles(const LogLinearHistogram& histogram,
+                                const std::vector<double>& quantiles) {
+    std::vector<double> computed;
+    histogram.computeQuantiles(quantiles, computed);
+    return computed;
+  }
+};
+
+TEST_F(LogLinearHistogramTest, Empty) {
+  LogLinearHistogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  for (double value : quantiles(histogram, {0, 0.5, 1})) {
+    EXPECT_TRUE(std::isnan(value));
+  }
+}
+
+// Values below 2 * SubBuckets have buckets of width 1, so their quantiles are exact up to the
+// interpolation within the bucket.
+TEST_F(LogLinearHistogramTest, SmallValuesAreExact) {
+  LogLinearHistogram histogram;
+  for (uint64_t value = 0; value < 2 * LogLinearHistogram::SubBuckets; value++) {
+    histogram.recordValue(value);
+  }
+  EXPECT_EQ(2 * LogLinearHistogram::SubBuckets, histogram.count());
+
+  const std::vector<double> computed = quantiles(histogram, {0, 0.5, 1});
+  EXPECT_DOUBLE_EQ(0, computed[0]);
+  EXPECT_DOUBLE_EQ(16, computed[1]);
+  EXPECT_DOUBLE_EQ(32, computed[2]);
+}
+
+TEST_F(LogLinearHistogramTest, RelativeError) {
+  const std::vector<uint64_t> values{100, 1000, 12345, 1000000, 123456789, 1ULL << 40,
+                                     std::numeric_limits<uint64_t>::max()};
+  for (uint64_t value : values) {
+    LogLinearHistogram histogram;
+    histogram.recordValue(value);
+    const std::vector<double> computed = quantiles(histogram, {0.5});
+    const double expected = static_cast<double>(value);
+    EXPECT_NEAR(expected, computed[0], expected / LogLinearHistogram::SubBuckets) << value;
+  }
+}
+
+TEST_F(LogLinearHistogramTest, Quantiles) {
+  LogLinearHistogram histogram;
+  for (uint64_t value = 1; value <= 10000; value++) {
+    histogram.recordValue(value);
+  }
+
+  const std::vector<double> computed = quantiles(histogram, {0.5, 0.9, 0.99, 1});
+  EXPECT_NEAR(5000, computed[0], 5000.0 / LogLinearHistogram::SubBuckets);
+  EXPECT_NEAR(9000, computed[1], 9000.0 / LogLinearHistogram::SubBuckets);
+  EXPECT_NEAR(9900, computed[2], 9900.0 / LogLinearHistogram::SubBuckets);
+  EXPECT_NEAR(10000, computed[3], 10000.0 / LogLinearHistogram::SubBuckets);
+}
+
+TEST_F(LogLinearHistogramTest, MergeAndClear) {
+  LogLinearHistogram histogram1;
+  LogLinearHistogram histogram2;
+  for (uint64_t value = 1; value <= 100; value++) {
+    histogram1.recordValue(value);
+    histogram2.recordValue(value + 100);
+  }
+
+  LogLinearHistogram merged;
+  merged.merge(histogram1);
+  merged.merge(histogram2);
+  EXPECT_EQ(200, merged.count());
+  EXPECT_NEAR(100, quantiles(merged, {0.5})[0], 100.0 / LogLinearHistogram::SubBuckets);
+
+  merged.clear();
+  EXPECT_EQ(0, merged.count());
+  EXPECT_TRUE(std::isnan(quantiles(merged, {0.5})[0]));
+
+  // The histogram is usable again after being cleared.
+  merged.recordValue(7);
+  EXPECT_DOUBLE_EQ(8, quantiles(merged, {1})[0]);
+}
+
+} // namespace Stats
+} // namespace Envoy
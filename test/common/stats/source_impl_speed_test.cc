@@ -0,0 +1,135 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/stats/sink.h"
+
+#include "common/stats/heap_stat_data.h"
+#include "common/stats/source_impl.h"
+#include "common/stats/stats_options_impl.h"
+#include "common/stats/thread_local_store.h"
+
+#include "absl/strings/str_cat.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Sink which only flushes the changed stats, so that the store retains its snapshots.
+ */
+class ChangedStatsSink : public Sink {
+public:
+  // Stats::Sink
+  void flush(Source&) override {}
+  bool flushesChangedStatsOnly() const override { return true; }
+  void onHistogramComplete(const Histogram&, uint64_t) override {}
+};
+
+/**
+ * A store holding a large number of counters and gauges, of which a small fraction is updated
+ * between flushes.
+ */
+class FlushFixture {
+public:
+  // Split evenly between counters and gauges.
+  static constexpr uint64_t NumStats = 500000;
+  // 1% of the stats are updated between flushes.
+  static constexpr uint64_t ChurnStride = 100;
+
+  FlushFixture() : alloc_(symbol_table_), store_(stats_options_, alloc_, symbol_table_) {
+    for (uint64_t i = 0; i < NumStats / 2; i++) {
+      counters_.push_back(&store_.counter(absl::StrCat("cluster.cluster_", i / 50, ".c", i)));
+      gauges_.push_back(&store_.gauge(absl::StrCat("cluster.cluster_", i / 50, ".g", i)));
+    }
+  }
+
+  ~FlushFixture() { store_.shutdownThreading(); }
+
+  /**
+   * Updates 1% of the stats, starting at a different offset for every flush.
+   */
+  void churn() {
+    for (uint64_t i = offset_++ % ChurnStride; i < counters_.size(); i += ChurnStride) {
+      counters_[i]->inc();
+      gauges_[i]->set(i);
+    }
+  }
+
+  StatsOptionsImpl stats_options_;
+  SymbolTableImpl symbol_table_;
+  HeapStatDataAllocator alloc_;
+  ThreadLocalStoreImpl store_;
+  std::vector<Counter*> counters_;
+  std::vector<Gauge*> gauges_;
+  uint64_t offset_{};
+};
+
+/**
+ * Measure a flush that snapshots every stat and walks all of them, as sinks did before stats
+ * tracked whether they changed.
+ */
+static void SourceImplFullFlush(benchmark::State& state) {
+  FlushFixture fixture;
+  SourceImpl source(fixture.store_);
+  uint64_t emitted = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    fixture.churn();
+    state.ResumeTiming();
+    for (const CounterSharedPtr& counter : source.cachedCounters()) {
+      if (counter->used()) {
+        emitted += counter->latch();
+      }
+    }
+    for (const GaugeSharedPtr& gauge : source.cachedGauges()) {
+      if (gauge->used()) {
+        emitted += gauge->value();
+      }
+    }
+    source.clearCache();
+  }
+  benchmark::DoNotOptimize(emitted);
+}
+BENCHMARK(SourceImplFullFlush)->Unit(benchmark::kMillisecond);
+
+/**
+ * Measure a flush through the store's own source, which retains its snapshots for a sink flushing
+ * the changed stats only, and only hands those to it.
+ */
+static void SourceImplIncrementalFlush(benchmark::State& state) {
+  FlushFixture fixture;
+  ChangedStatsSink sink;
+  fixture.store_.addSink(sink);
+  Source& source = fixture.store_.source();
+  uint64_t emitted = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    fixture.churn();
+    state.ResumeTiming();
+    for (const CounterSharedPtr& counter : source.changedCounters()) {
+      emitted += counter->latch();
+    }
+    for (const GaugeSharedPtr& gauge : source.changedGauges()) {
+      emitted += gauge->value();
+    }
+    source.clearCache();
+  }
+  benchmark::DoNotOptimize(emitted);
+}
+BENCHMARK(SourceImplIncrementalFlush)->Unit(benchmark::kMillisecond);
+
+} // namespace Stats
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
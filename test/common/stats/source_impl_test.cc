@@ -7,6 +7,7 @@
 #include "gtest/gtest.h"
 
 using testing::NiceMock;
+using testing::Return;
 using testing::ReturnPointee;
 
 namespace Envoy {
@@ -47,5 +48,54 @@ TEST(SourceImplTest, Caching) {
   EXPECT_EQ(source.cachedHistograms(), stored_histograms);
 }
 
+TEST(SourceImplTest, RetainedSnapshots) {
+  NiceMock<MockStore> store;
+  std::vector<CounterSharedPtr> stored_counters;
+  ON_CALL(store, counters()).WillByDefault(ReturnPointee(&stored_counters));
+
+  SourceImpl source(store, true);
+  stored_counters.push_back(std::make_shared<MockCounter>());
+  EXPECT_EQ(source.cachedCounters(), stored_counters);
+
+  // The snapshot outlives clearCache() until the source is marked stale.
+  source.clearCache();
+  stored_counters.push_back(std::make_shared<MockCounter>());
+  EXPECT_NE(source.cachedCounters(), stored_counters);
+
+  // Marking the source stale while its snapshots are in use only takes effect after the next
+  // clearCache(), so references handed out earlier stay valid.
+  source.markStale();
+  EXPECT_NE(source.cachedCounters(), stored_counters);
+  source.clearCache();
+  EXPECT_EQ(source.cachedCounters(), stored_counters);
+}
+
+TEST(SourceImplTest, ChangedStats) {
+  NiceMock<MockStore> store;
+  auto counter1 = std::make_shared<NiceMock<MockCounter>>();
+  auto counter2 = std::make_shared<NiceMock<MockCounter>>();
+  auto gauge = std::make_shared<NiceMock<MockGauge>>();
+  std::vector<CounterSharedPtr> stored_counters{counter1, counter2};
+  std::vector<GaugeSharedPtr> stored_gauges{gauge};
+  ON_CALL(store, counters()).WillByDefault(ReturnPointee(&stored_counters));
+  ON_CALL(store, gauges()).WillByDefault(ReturnPointee(&stored_gauges));
+
+  SourceImpl source(store, true);
+  EXPECT_CALL(*counter1, latchChanged()).WillOnce(Return(false));
+  EXPECT_CALL(*counter2, latchChanged()).WillOnce(Return(true));
+  EXPECT_CALL(*gauge, latchChanged()).WillOnce(Return(true));
+  const std::vector<CounterSharedPtr> expected_counters{counter2};
+  EXPECT_EQ(expected_counters, source.changedCounters());
+  EXPECT_EQ(stored_gauges, source.changedGauges());
+
+  // The changed set is computed once per flush, so every sink sees the same stats.
+  EXPECT_EQ(expected_counters, source.changedCounters());
+
+  source.clearCache();
+  EXPECT_CALL(*counter1, latchChanged()).WillOnce(Return(false));
+  EXPECT_CALL(*counter2, latchChanged()).WillOnce(Return(false));
+  EXPECT_TRUE(source.changedCounters().empty());
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -1,10 +1,12 @@
 #include <string>
 
+#include "common/common/thread.h"
 #include "common/stats/symbol_table_impl.h"
 
 #include "test/test_common/logging.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -180,5 +182,82 @@ TEST_F(StatNameTest, TestShrinkingExpectation) {
   EXPECT_EQ(table_size_0, table_.size());
 }
 
+TEST_F(StatNameTest, EncodingIsCompact) {
+  // Each of the first 127 symbols fits in a single byte.
+  StatNameImpl name("cluster.foo.upstream_rq_total", table_);
+  EXPECT_EQ(3, name.encoding().size());
+  EXPECT_EQ("cluster.foo.upstream_rq_total", name.toString());
+
+  std::vector<StatNamePtr> names;
+  for (int i = 0; i < 200; i++) {
+    names.push_back(table_.encode(std::to_string(i)));
+  }
+  StatNameImpl long_name("cluster.199", table_);
+  EXPECT_EQ(3, long_name.encoding().size());
+  EXPECT_EQ("cluster.199", long_name.toString());
+}
+
+TEST_F(StatNameTest, Lookup) {
+  std::string encoding;
+  EXPECT_FALSE(table_.lookup("foo.bar", encoding));
+
+  StatNameImpl name("foo.bar", table_);
+  EXPECT_TRUE(table_.lookup("foo.bar", encoding));
+  EXPECT_EQ(name.encoding(), encoding);
+  EXPECT_TRUE(table_.lookup("bar.foo", encoding));
+  EXPECT_NE(name.encoding(), encoding);
+  EXPECT_FALSE(table_.lookup("foo.baz", encoding));
+
+  // Lookups don't take references, so the symbols go away with the name.
+  EXPECT_EQ(2, table_.size());
+  { StatNameImpl moved(std::move(name)); }
+  EXPECT_EQ(0, table_.size());
+  EXPECT_FALSE(table_.lookup("foo.bar", encoding));
+}
+
+TEST_F(StatNameTest, EncodeIntoAndFree) {
+  std::string encoding;
+  table_.encodeInto("a.b", encoding);
+  const size_t size = encoding.size();
+  table_.encodeInto("a.c", encoding);
+  EXPECT_EQ(3, table_.size());
+  EXPECT_EQ("a.b", table_.decode(absl::string_view(encoding).substr(0, size)));
+  table_.free(encoding);
+  EXPECT_EQ(0, table_.size());
+}
+
+TEST_F(StatNameTest, DecodeManySymbols) {
+  // Enough symbols to spread over several blocks of the segment table.
+  std::vector<StatNamePtr> names;
+  for (int i = 0; i < 5000; i++) {
+    names.push_back(table_.encode(absl::StrCat("cluster.c", i)));
+  }
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_EQ(absl::StrCat("cluster.c", i), names[i]->toString());
+  }
+  names.resize(10);
+  EXPECT_EQ(11, table_.size());
+  StatNamePtr recycled = table_.encode("cluster.recycled");
+  EXPECT_EQ("cluster.recycled", recycled->toString());
+  EXPECT_EQ("cluster.c9", names[9]->toString());
+}
+
+TEST_F(StatNameTest, ConcurrentEncodeAndFree) {
+  std::vector<std::unique_ptr<Thread::Thread>> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.push_back(std::make_unique<Thread::Thread>([this, t]() {
+      for (int i = 0; i < 1000; i++) {
+        const std::string name = absl::StrCat("cluster.", i % 10, ".thread", t);
+        StatNameImpl stat_name(name, table_);
+        EXPECT_EQ(name, stat_name.toString());
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, table_.size());
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -0,0 +1,89 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management. The memory counters are only
+// meaningful when built with tcmalloc.
+
+#include <string>
+#include <vector>
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+
+#include "common/memory/stats.h"
+#include "common/stats/heap_stat_data.h"
+#include "common/stats/stats_options_impl.h"
+#include "common/stats/tag_producer_impl.h"
+#include "common/stats/thread_local_store.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "absl/strings/str_cat.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Measure the time and memory taken to instantiate the stats of a number of clusters, as happens
+ * when a large CDS response is applied. The stats are tag-extracted with the default tag
+ * extractors, as on a real server.
+ * The variable parameter is the number of clusters.
+ */
+static void ThreadLocalStoreClusterStats(benchmark::State& state) {
+  const int64_t num_clusters = state.range(0);
+  for (auto _ : state) {
+    StatsOptionsImpl stats_options;
+    SymbolTableImpl symbol_table;
+    HeapStatDataAllocator alloc(symbol_table);
+    ThreadLocalStoreImpl store(stats_options, alloc, symbol_table);
+    store.setTagProducer(
+        std::make_unique<TagProducerImpl>(envoy::config::metrics::v2::StatsConfig()));
+
+    const uint64_t start_bytes = Memory::Stats::totalCurrentlyAllocated();
+    std::vector<ScopePtr> scopes;
+    scopes.reserve(num_clusters);
+    for (int64_t i = 0; i < num_clusters; i++) {
+      scopes.push_back(store.createScope(absl::StrCat("cluster.cluster_", i, ".")));
+      Upstream::ClusterInfoImpl::generateStats(*scopes.back());
+    }
+    const uint64_t end_bytes = Memory::Stats::totalCurrentlyAllocated();
+    state.counters["bytes_per_cluster"] = (end_bytes - start_bytes) / num_clusters;
+
+    scopes.clear();
+    store.shutdownThreading();
+  }
+}
+BENCHMARK(ThreadLocalStoreClusterStats)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * Measure the speed of resolving an existing counter by name through a scope, as filters do for
+ * dynamically named stats. Threading isn't initialized, so every lookup goes to the central cache.
+ */
+static void ThreadLocalStoreCounterLookup(benchmark::State& state) {
+  StatsOptionsImpl stats_options;
+  SymbolTableImpl symbol_table;
+  HeapStatDataAllocator alloc(symbol_table);
+  ThreadLocalStoreImpl store(stats_options, alloc, symbol_table);
+  ScopePtr scope = store.createScope("cluster.cluster_0.");
+  Upstream::ClusterInfoImpl::generateStats(*scope);
+  const std::string name("upstream_rq_total");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(&scope->counter(name));
+  }
+  scope.reset();
+  store.shutdownThreading();
+}
+BENCHMARK(ThreadLocalStoreCounterLookup);
+
+} // namespace Stats
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -4,6 +4,7 @@
 #include <unordered_map>
 
 #include "common/common/c_smart_ptr.h"
+#include "common/common/thread.h"
 #include "common/stats/thread_local_store.h"
 
 #include "test/mocks/event/mocks.h"
@@ -13,6 +14,7 @@
 #include "test/test_common/logging.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -35,13 +37,14 @@ public:
   }
 
   void resetStoreWithAlloc(StatDataAllocator& alloc) {
-    store_ = std::make_unique<ThreadLocalStoreImpl>(options_, alloc);
+    store_ = std::make_unique<ThreadLocalStoreImpl>(options_, alloc, symbol_table_);
     store_->addSink(sink_);
   }
 
   NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
   NiceMock<ThreadLocal::MockInstance> tls_;
   StatsOptionsImpl options_;
+  SymbolTableImpl symbol_table_;
   std::unique_ptr<MockedTestAllocator> alloc_;
   MockSink sink_;
   std::unique_ptr<ThreadLocalStoreImpl> store_;
@@ -72,7 +75,7 @@ public:
   HistogramTest() : alloc_(options_) {}
 
   void SetUp() override {
-    store_ = std::make_unique<ThreadLocalStoreImpl>(options_, alloc_);
+    store_ = std::make_unique<ThreadLocalStoreImpl>(options_, alloc_, symbol_table_);
     store_->addSink(sink_);
     store_->initializeThreading(main_thread_dispatcher_, tls_);
   }
@@ -157,6 +160,7 @@ public:
   NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
   NiceMock<ThreadLocal::MockInstance> tls_;
   StatsOptionsImpl options_;
+  SymbolTableImpl symbol_table_;
   MockedTestAllocator alloc_;
   MockSink sink_;
   std::unique_ptr<ThreadLocalStoreImpl> store_;
@@ -471,7 +475,7 @@ public:
     store_.reset(); // delete before the allocator.
   }
 
-  HeapStatDataAllocator heap_alloc_;
+  HeapStatDataAllocator heap_alloc_{symbol_table_};
 };
 
 TEST_F(HeapStatsThreadLocalStoreTest, NonHotRestartNoTruncation) {
@@ -492,6 +496,128 @@ TEST_F(HeapStatsThreadLocalStoreTest, NonHotRestartNoTruncation) {
   tls_.shutdownThread();
 }
 
+// The names of the stats made by the heap allocator are interned in the same symbol table as the
+// keys of the caches, and a stat cached by a thread is found again by its name.
+TEST_F(HeapStatsThreadLocalStoreTest, SharedSymbolTable) {
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  // "stats" and "overflow", for the overflow counter.
+  EXPECT_EQ(2UL, symbol_table_.size());
+  Counter& c1 = store_->counter("c1");
+  Gauge& g1 = store_->gauge("stats.g1");
+  EXPECT_EQ(4UL, symbol_table_.size());
+  EXPECT_EQ(&c1, &store_->counter("c1"));
+  EXPECT_EQ(&g1, &store_->gauge("stats.g1"));
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+}
+
+// Threads resolving the same new stats at the same time through the central cache all end up
+// with the same objects.
+TEST_F(HeapStatsThreadLocalStoreTest, ConcurrentCentralCacheFills) {
+  ScopePtr scope = store_->createScope("scope.");
+  std::vector<std::vector<Counter*>> counters(4);
+  std::vector<std::vector<Gauge*>> gauges(counters.size());
+  std::vector<std::unique_ptr<Thread::Thread>> threads;
+  for (size_t i = 0; i < counters.size(); i++) {
+    threads.emplace_back(std::make_unique<Thread::Thread>([&scope, &counters, &gauges, i]() {
+      for (int j = 0; j < 100; j++) {
+        counters[i].push_back(&scope->counter(absl::StrCat("c", j)));
+        gauges[i].push_back(&scope->gauge(absl::StrCat("g", j)));
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  for (size_t i = 1; i < counters.size(); i++) {
+    EXPECT_EQ(counters[0], counters[i]);
+    EXPECT_EQ(gauges[0], gauges[i]);
+  }
+  // Includes overflow stat.
+  EXPECT_EQ(101UL, store_->counters().size());
+  EXPECT_EQ(100UL, store_->gauges().size());
+
+  scope.reset();
+  store_->shutdownThreading();
+}
+
+// By default the source of the store drops its snapshots at the end of every flush, so they don't
+// keep the stats of destroyed scopes. A sink flushing the changed stats only has them retained
+// until stats are created or scopes destroyed.
+TEST_F(HeapStatsThreadLocalStoreTest, RetainSnapshots) {
+  Source& source = store_->source();
+  ScopePtr scope = store_->createScope("scope.");
+  scope->counter("c1");
+  CounterSharedPtr c1 = TestUtility::findCounter(*store_, "scope.c1");
+  EXPECT_EQ(2L, c1.use_count());
+  source.cachedCounters();
+  EXPECT_EQ(3L, c1.use_count());
+  source.clearCache();
+  EXPECT_EQ(2L, c1.use_count());
+
+  NiceMock<MockSink> changed_stats_sink;
+  ON_CALL(changed_stats_sink, flushesChangedStatsOnly()).WillByDefault(Return(true));
+  store_->addSink(changed_stats_sink);
+  source.cachedCounters();
+  source.clearCache();
+  EXPECT_EQ(3L, c1.use_count());
+
+  scope.reset();
+  EXPECT_EQ(2L, c1.use_count());
+  source.cachedCounters();
+  EXPECT_EQ(1L, c1.use_count());
+  source.clearCache();
+  store_->shutdownThreading();
+}
+
+// With a sink flushing the changed stats only, the source of the store only reports the stats
+// updated since the previous flush as changed.
+TEST_F(HeapStatsThreadLocalStoreTest, IncrementalFlush) {
+  NiceMock<MockSink> changed_stats_sink;
+  ON_CALL(changed_stats_sink, flushesChangedStatsOnly()).WillByDefault(Return(true));
+  store_->addSink(changed_stats_sink);
+  Source& source = store_->source();
+  ScopePtr scope = store_->createScope("scope.");
+  Counter& c1 = scope->counter("c1");
+  Counter& c2 = scope->counter("c2");
+  Gauge& g1 = scope->gauge("g1");
+  // Includes overflow stat.
+  EXPECT_EQ(3UL, source.cachedCounters().size());
+  EXPECT_TRUE(source.changedCounters().empty());
+  EXPECT_TRUE(source.changedGauges().empty());
+  source.clearCache();
+
+  c1.inc();
+  g1.set(5);
+  const std::vector<CounterSharedPtr>& changed_counters = source.changedCounters();
+  ASSERT_EQ(1UL, changed_counters.size());
+  EXPECT_EQ("scope.c1", changed_counters[0]->name());
+  ASSERT_EQ(1UL, source.changedGauges().size());
+  EXPECT_EQ("scope.g1", source.changedGauges()[0]->name());
+  source.clearCache();
+
+  c2.add(2);
+  EXPECT_EQ("scope.c2", source.changedCounters().at(0)->name());
+  source.clearCache();
+  EXPECT_TRUE(source.changedCounters().empty());
+  EXPECT_TRUE(source.changedGauges().empty());
+  source.clearCache();
+
+  // New stats are picked up by the next flush.
+  scope->counter("c3").inc();
+  EXPECT_EQ(4UL, source.cachedCounters().size());
+  EXPECT_EQ("scope.c3", source.changedCounters().at(0)->name());
+  source.clearCache();
+
+  scope.reset();
+  EXPECT_EQ(1UL, source.cachedCounters().size());
+  source.clearCache();
+  store_->shutdownThreading();
+}
+
 TEST_F(StatsThreadLocalStoreTest, ShuttingDown) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
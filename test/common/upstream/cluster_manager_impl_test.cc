@@ -65,7 +65,7 @@ public:
 
   Http::ConnectionPool::InstancePtr
   allocateConnPool(Event::Dispatcher&, HostConstSharedPtr host, ResourcePriority, Http::Protocol,
-                   const Network::ConnectionSocket::OptionsSharedPtr&) override {
+                   bool, const Network::ConnectionSocket::OptionsSharedPtr&) override {
     return Http::ConnectionPool::InstancePtr{allocateConnPool_(host)};
   }
 
@@ -1220,6 +1220,51 @@ TEST_F(ClusterManagerImplTest, CloseHttpConnectionsOnHealthFailure) {
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
 }
 
+// Test that idempotent requests to a cluster which pipelines HTTP/1.1 requests get pools of their
+// own.
+TEST_F(ClusterManagerImplTest, PipelinedHttpConnPools) {
+  const std::string json =
+      fmt::sprintf("{%s}", clustersJson({defaultStaticClusterJson("some_cluster")}));
+  std::shared_ptr<MockCluster> cluster1(new NiceMock<MockCluster>());
+  cluster1->info_->name_ = "some_cluster";
+  cluster1->info_->http1_settings_.max_pipeline_depth_ = 4;
+  HostSharedPtr test_host = makeTestHost(cluster1->info_, "tcp://127.0.0.1:80");
+  cluster1->prioritySet().getMockHostSet(0)->hosts_ = {test_host};
+  ON_CALL(*cluster1, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _, _)).WillOnce(Return(cluster1));
+  EXPECT_CALL(*cluster1, initialize(_))
+      .WillOnce(Invoke([cluster1](std::function<void()> initialize_callback) {
+        initialize_callback();
+      }));
+  create(parseBootstrapFromJson(json));
+
+  struct TestLoadBalancerContext : public LoadBalancerContextBase {
+    TestLoadBalancerContext(const std::string& method) : headers_{{":method", method}} {}
+
+    const Http::HeaderMap* downstreamHeaders() const override { return &headers_; }
+
+    Http::TestHeaderMapImpl headers_;
+  };
+  TestLoadBalancerContext get_context("GET");
+  TestLoadBalancerContext head_context("HEAD");
+  TestLoadBalancerContext post_context("POST");
+
+  Http::ConnectionPool::MockInstance* cp1 = new Http::ConnectionPool::MockInstance();
+  Http::ConnectionPool::MockInstance* cp2 = new Http::ConnectionPool::MockInstance();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp1)).WillOnce(Return(cp2));
+  EXPECT_EQ(cp1, cluster_manager_->httpConnPoolForCluster("some_cluster", ResourcePriority::Default,
+                                                          Http::Protocol::Http11, &get_context));
+  EXPECT_EQ(cp2, cluster_manager_->httpConnPoolForCluster("some_cluster", ResourcePriority::Default,
+                                                          Http::Protocol::Http11, &post_context));
+  EXPECT_EQ(cp1, cluster_manager_->httpConnPoolForCluster("some_cluster", ResourcePriority::Default,
+                                                          Http::Protocol::Http11, &head_context));
+  EXPECT_EQ(cp2, cluster_manager_->httpConnPoolForCluster("some_cluster", ResourcePriority::Default,
+                                                          Http::Protocol::Http11, nullptr));
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
 // Test that we close all TCP connection pool connections when there is a host health failure.
 TEST_F(ClusterManagerImplTest, CloseTcpConnectionPoolsOnHealthFailure) {
   const std::string json =
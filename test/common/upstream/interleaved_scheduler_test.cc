@@ -0,0 +1,121 @@
+#include "common/upstream/interleaved_scheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+TEST(InterleavedSchedulerTest, Empty) {
+  InterleavedScheduler<uint32_t> sched;
+  EXPECT_TRUE(sched.empty());
+  EXPECT_EQ(nullptr, sched.pick());
+  sched.skip(1);
+  EXPECT_EQ(nullptr, sched.pick());
+}
+
+// Validate we get regular RR behavior when all weights are the same.
+TEST(InterleavedSchedulerTest, Unweighted) {
+  InterleavedScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    sched.add(3, std::make_shared<uint32_t>(i));
+  }
+  EXPECT_FALSE(sched.empty());
+
+  for (uint32_t rounds = 0; rounds < 128; ++rounds) {
+    for (uint32_t i = 0; i < num_entries; ++i) {
+      EXPECT_EQ(i, *sched.pick());
+    }
+  }
+}
+
+// Validate each round visits the entries at least as heavy as the round, heaviest first.
+TEST(InterleavedSchedulerTest, Interleaved) {
+  InterleavedScheduler<uint32_t> sched;
+  const uint32_t weights[] = {1, 3, 2, 3};
+  for (uint32_t i = 0; i < 4; ++i) {
+    sched.add(weights[i], std::make_shared<uint32_t>(i));
+  }
+
+  for (uint32_t cycle = 0; cycle < 2; ++cycle) {
+    for (uint32_t expected : {1, 3, 2, 0, 1, 3, 2, 1, 3}) {
+      EXPECT_EQ(expected, *sched.pick());
+    }
+  }
+}
+
+// Validate we get weighted RR behavior when weights are distinct.
+TEST(InterleavedSchedulerTest, Weighted) {
+  InterleavedScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+  uint32_t pick_count[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    sched.add(i + 1, std::make_shared<uint32_t>(i));
+    pick_count[i] = 0;
+  }
+
+  for (uint32_t i = 0; i < (num_entries * (1 + num_entries)) / 2; ++i) {
+    ++pick_count[*sched.pick()];
+  }
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_EQ(i + 1, pick_count[i]);
+  }
+}
+
+// Validate that skipping is equivalent to picking.
+TEST(InterleavedSchedulerTest, Skip) {
+  const uint32_t weights[] = {5, 1, 3, 3, 8, 1};
+  const auto make_sched = [&weights]() {
+    std::unique_ptr<InterleavedScheduler<uint32_t>> sched(new InterleavedScheduler<uint32_t>());
+    for (uint32_t i = 0; i < 6; ++i) {
+      sched->add(weights[i], std::make_shared<uint32_t>(i));
+    }
+    return sched;
+  };
+
+  // The cycle is 21 picks long.
+  for (uint64_t skipped : {0, 1, 5, 6, 13, 20, 21, 22, 100, 1000003}) {
+    auto picked = make_sched();
+    for (uint64_t i = 0; i < skipped % 21; ++i) {
+      picked->pick();
+    }
+    auto skipping = make_sched();
+    skipping->skip(skipped);
+    for (uint32_t i = 0; i < 42; ++i) {
+      EXPECT_EQ(*picked->pick(), *skipping->pick()) << skipped << " " << i;
+    }
+  }
+}
+
+// Validate that schedulers sharing a schedule keep their own position in it.
+TEST(InterleavedSchedulerTest, SharedSchedule) {
+  InterleavedScheduler<uint32_t> sched;
+  const uint32_t weights[] = {1, 3, 2, 3};
+  for (uint32_t i = 0; i < 4; ++i) {
+    sched.add(weights[i], std::make_shared<uint32_t>(i));
+  }
+  InterleavedScheduler<uint32_t> shared(sched.schedule());
+  EXPECT_EQ(sched.schedule(), shared.schedule());
+  EXPECT_FALSE(shared.empty());
+
+  shared.skip(3);
+  for (uint32_t expected : {1, 3, 2, 0, 1, 3, 2, 1, 3}) {
+    EXPECT_EQ(expected, *sched.pick());
+  }
+  for (uint32_t expected : {0, 1, 3, 2, 1, 3, 1, 3, 2}) {
+    EXPECT_EQ(expected, *shared.pick());
+  }
+
+  InterleavedScheduler<uint32_t> empty;
+  InterleavedScheduler<uint32_t> shared_empty(empty.schedule());
+  EXPECT_TRUE(shared_empty.empty());
+  EXPECT_EQ(nullptr, shared_empty.pick());
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
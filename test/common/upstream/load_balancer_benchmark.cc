@@ -1,6 +1,10 @@
 // Usage: bazel run //test/common/upstream:load_balancer_benchmark
 
+#include <cmath>
+#include <unordered_map>
+
 #include "common/runtime/runtime_impl.h"
+#include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/maglev_lb.h"
 #include "common/upstream/ring_hash_lb.h"
 #include "common/upstream/upstream_impl.h"
@@ -30,8 +34,8 @@ public:
                                    should_weight ? weight : 1));
     }
     HostVectorConstSharedPtr updated_hosts{new HostVector(hosts)};
-    host_set.updateHosts(updated_hosts, updated_hosts, nullptr, nullptr, {}, hosts, {},
-                         absl::nullopt);
+    host_set.updateHosts(updated_hosts, updated_hosts, HostsPerLocalityImpl::empty(),
+                         HostsPerLocalityImpl::empty(), {}, hosts, {}, absl::nullopt);
   }
 
   PrioritySetImpl priority_set_;
@@ -56,6 +60,27 @@ public:
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
 };
 
+class RoundRobinTester : public BaseTester {
+public:
+  RoundRobinTester(uint64_t num_hosts, uint32_t weighted_subset_percent, uint32_t weight,
+                   bool interleaved)
+      : BaseTester(num_hosts, weighted_subset_percent, weight) {
+    stats_.max_host_weight_.set(weight);
+    if (interleaved) {
+      common_config_.set_weighted_scheduler(envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED);
+    }
+    lb_.reset(new RoundRobinLoadBalancer(priority_set_, nullptr, stats_, runtime_, random_,
+                                         common_config_));
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_{ClusterInfoImpl::generateStats(stats_store_)};
+  NiceMock<Runtime::MockLoader> runtime_;
+  Runtime::RandomGeneratorImpl random_;
+  envoy::api::v2::Cluster::CommonLbConfig common_config_;
+  std::unique_ptr<RoundRobinLoadBalancer> lb_;
+};
+
 uint64_t hashInt(uint64_t i) {
   // Hack to hash an integer.
   return HashUtil::xxHash64(absl::string_view(reinterpret_cast<const char*>(&i), sizeof(i)));
@@ -86,16 +111,21 @@ void BM_MaglevLoadBalancerBuildTable(benchmark::State& state) {
   for (auto _ : state) {
     state.PauseTiming();
     const uint64_t num_hosts = state.range(0);
+    const uint64_t table_size = state.range(1);
     BaseTester tester(num_hosts);
     state.ResumeTiming();
     MaglevTable table(HostsPerLocalityImpl(tester.priority_set_.getOrCreateHostSet(0).hosts()),
-                      nullptr);
+                      nullptr, table_size);
   }
 }
 BENCHMARK(BM_MaglevLoadBalancerBuildTable)
-    ->Arg(100)
-    ->Arg(200)
-    ->Arg(500)
+    ->Args({100, 65537})
+    ->Args({200, 65537})
+    ->Args({500, 65537})
+    ->Args({5000, 65537})
+    ->Args({5000, 655373})
+    ->Args({50000, 655373})
+    ->Args({50000, 5000011})
     ->Unit(benchmark::kMillisecond);
 
 class TestLoadBalancerContext : public LoadBalancerContextBase {
@@ -181,7 +211,7 @@ void BM_MaglevLoadBalancerChooseHost(benchmark::State& state) {
     // std::unordered_map. However, it should be roughly equivalent to the work done when
     // comparing different hashing algorithms.
     for (uint64_t i = 0; i < keys_to_simulate; i++) {
-      hit_counter[table.chooseHost(hashInt(i))->address()->asString()] += 1;
+      hit_counter[table.chooseHost(hashInt(i), 0)->address()->asString()] += 1;
     }
 
     // Do not time computation of mean, standard deviation, and relative standard deviation.
@@ -196,6 +226,151 @@ BENCHMARK(BM_MaglevLoadBalancerChooseHost)
     ->Args({500, 100000})
     ->Unit(benchmark::kMillisecond);
 
+void BM_RoundRobinLoadBalancerBuild(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    const uint64_t num_hosts = state.range(0);
+    const bool interleaved = state.range(1);
+    BaseTester tester(num_hosts, 50, 10);
+    Stats::IsolatedStoreImpl stats_store;
+    ClusterStats stats{ClusterInfoImpl::generateStats(stats_store)};
+    NiceMock<Runtime::MockLoader> runtime;
+    Runtime::RandomGeneratorImpl random;
+    envoy::api::v2::Cluster::CommonLbConfig common_config;
+    if (interleaved) {
+      common_config.set_weighted_scheduler(envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED);
+    }
+    state.ResumeTiming();
+
+    // The schedules are built on construction, and the interleaved one on its first pick.
+    RoundRobinLoadBalancer lb(tester.priority_set_, nullptr, stats, runtime, random,
+                              common_config);
+    lb.chooseHost(nullptr);
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerBuild)
+    ->Args({500, 0})
+    ->Args({500, 1})
+    ->Args({5000, 0})
+    ->Args({5000, 1})
+    ->Args({50000, 0})
+    ->Args({50000, 1})
+    ->Unit(benchmark::kMillisecond);
+
+void BM_RoundRobinLoadBalancerChooseHost(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const bool interleaved = state.range(1);
+  // Half of the hosts weighted 10, the other half 1.
+  RoundRobinTester tester(num_hosts, 50, 10, interleaved);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tester.lb_->chooseHost(nullptr));
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerChooseHost)
+    ->Args({500, 0})
+    ->Args({500, 1})
+    ->Args({5000, 0})
+    ->Args({5000, 1})
+    ->Args({50000, 0})
+    ->Args({50000, 1});
+
+// Measures how far from their weighted share the picks of each host are, after every number of
+// picks up to picks_to_simulate. The error is in picks, so that 1 is the best any schedule can do.
+void BM_RoundRobinLoadBalancerWeightedError(benchmark::State& state) {
+  for (auto _ : state) {
+    const uint64_t num_hosts = state.range(0);
+    const bool interleaved = state.range(1);
+    const uint64_t weighted_subset_percent = state.range(2);
+    const uint64_t weight = state.range(3);
+    const uint64_t picks_to_simulate = state.range(4);
+
+    RoundRobinTester tester(num_hosts, weighted_subset_percent, weight, interleaved);
+    const HostVector& hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+    std::unordered_map<const Host*, uint64_t> picks;
+    double total_weight = 0;
+    for (const HostSharedPtr& host : hosts) {
+      total_weight += host->weight();
+      picks[host.get()] = 0;
+    }
+
+    double max_error = 0;
+    for (uint64_t i = 1; i <= picks_to_simulate; i++) {
+      const Host* host = tester.lb_->chooseHost(nullptr).get();
+      picks[host]++;
+      // Only the picked host's count changed, but every other host's share grew.
+      const double expected = i * host->weight() / total_weight;
+      max_error = std::max(max_error, std::abs(picks[host] - expected));
+    }
+    for (const HostSharedPtr& host : hosts) {
+      const double expected = picks_to_simulate * host->weight() / total_weight;
+      max_error = std::max(max_error, std::abs(picks[host.get()] - expected));
+    }
+
+    state.counters["max_error_picks"] = max_error;
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerWeightedError)
+    ->Args({500, 0, 50, 10, 100000})
+    ->Args({500, 1, 50, 10, 100000})
+    ->Args({5000, 0, 5, 127, 100000})
+    ->Args({5000, 1, 5, 127, 100000})
+    ->Args({5000, 0, 95, 2, 100000})
+    ->Args({5000, 1, 95, 2, 100000})
+    ->Unit(benchmark::kMillisecond);
+
+// Measures the cost of applying a membership update on every worker, sequentially, with the workers
+// either sharing the host snapshot and its interleaved schedule, or each copying the hosts and
+// building its own schedule.
+void BM_RoundRobinLoadBalancerUpdate(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t num_workers = state.range(1);
+  const bool shared = state.range(2);
+  BaseTester tester(num_hosts, 50, 10);
+  const HostVector& hosts = tester.priority_set_.hostSetsPerPriority()[0]->hosts();
+  Stats::IsolatedStoreImpl stats_store;
+  ClusterStats stats{ClusterInfoImpl::generateStats(stats_store)};
+  NiceMock<Runtime::MockLoader> runtime;
+  Runtime::RandomGeneratorImpl random;
+  envoy::api::v2::Cluster::CommonLbConfig common_config;
+  common_config.set_weighted_scheduler(envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED);
+  InterleavedScheduleCacheSharedPtr schedule_cache;
+  if (shared) {
+    schedule_cache = std::make_shared<InterleavedScheduleCache>();
+  }
+
+  std::vector<std::unique_ptr<PrioritySetImpl>> priority_sets;
+  std::vector<std::unique_ptr<RoundRobinLoadBalancer>> lbs;
+  for (uint64_t i = 0; i < num_workers; i++) {
+    priority_sets.emplace_back(new PrioritySetImpl());
+    priority_sets.back()->getOrCreateHostSet(0);
+    lbs.emplace_back(new RoundRobinLoadBalancer(*priority_sets.back(), nullptr, stats, runtime,
+                                                random, common_config, schedule_cache));
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    // Each update is a new snapshot of the hosts.
+    HostVectorConstSharedPtr snapshot(new HostVector(hosts));
+    state.ResumeTiming();
+
+    for (auto& priority_set : priority_sets) {
+      HostVectorConstSharedPtr worker_hosts =
+          shared ? snapshot : std::make_shared<const HostVector>(*snapshot);
+      priority_set->getOrCreateHostSet(0).updateHosts(
+          worker_hosts, worker_hosts, HostsPerLocalityImpl::empty(), HostsPerLocalityImpl::empty(),
+          {}, {}, {}, absl::nullopt);
+    }
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerUpdate)
+    ->Args({10000, 1, 0})
+    ->Args({10000, 1, 1})
+    ->Args({10000, 8, 0})
+    ->Args({10000, 8, 1})
+    ->Args({10000, 64, 0})
+    ->Args({10000, 64, 1})
+    ->Unit(benchmark::kMillisecond);
+
 void BM_RingHashLoadBalancerHostLoss(benchmark::State& state) {
   for (auto _ : state) {
     const uint64_t num_hosts = state.range(0);
@@ -253,7 +428,7 @@ void BM_MaglevLoadBalancerHostLoss(benchmark::State& state) {
                       nullptr);
     std::vector<HostConstSharedPtr> hosts;
     for (uint64_t i = 0; i < keys_to_simulate; i++) {
-      hosts.push_back(table.chooseHost(hashInt(i)));
+      hosts.push_back(table.chooseHost(hashInt(i), 0));
     }
 
     BaseTester tester2(num_hosts - hosts_to_lose);
@@ -261,7 +436,7 @@ void BM_MaglevLoadBalancerHostLoss(benchmark::State& state) {
                        nullptr);
     std::vector<HostConstSharedPtr> hosts2;
     for (uint64_t i = 0; i < keys_to_simulate; i++) {
-      hosts2.push_back(table2.chooseHost(hashInt(i)));
+      hosts2.push_back(table2.chooseHost(hashInt(i), 0));
     }
 
     ASSERT(hosts.size() == hosts2.size());
@@ -297,7 +472,7 @@ void BM_MaglevLoadBalancerWeighted(benchmark::State& state) {
                       nullptr);
     std::vector<HostConstSharedPtr> hosts;
     for (uint64_t i = 0; i < keys_to_simulate; i++) {
-      hosts.push_back(table.chooseHost(hashInt(i)));
+      hosts.push_back(table.chooseHost(hashInt(i), 0));
     }
 
     BaseTester tester2(num_hosts, weighted_subset_percent, after_weight);
@@ -305,7 +480,7 @@ void BM_MaglevLoadBalancerWeighted(benchmark::State& state) {
                        nullptr);
     std::vector<HostConstSharedPtr> hosts2;
     for (uint64_t i = 0; i < keys_to_simulate; i++) {
-      hosts2.push_back(table2.chooseHost(hashInt(i)));
+      hosts2.push_back(table2.chooseHost(hashInt(i), 0));
     }
 
     ASSERT(hosts.size() == hosts2.size());
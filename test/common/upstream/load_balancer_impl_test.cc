@@ -497,6 +497,117 @@ TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+TEST_P(RoundRobinLoadBalancerTest, WeightedInterleaved) {
+  common_config_.set_weighted_scheduler(envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED);
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+  // Initial weights respected.
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  // Modify weights, the schedule only changes when the host set is refreshed.
+  hostSet().healthy_hosts_[0]->weight(3);
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  hostSet().runCallbacks({}, {});
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+}
+
+// Validate that the RNG seed offsets the interleaved schedule.
+TEST_P(RoundRobinLoadBalancerTest, WeightedInterleavedSeed) {
+  common_config_.set_weighted_scheduler(envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED);
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  EXPECT_CALL(random_, random()).WillRepeatedly(Return(4));
+  init(false);
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+}
+
+// Validate that load balancers sharing a schedule cache each keep their own position in the
+// schedule of the hosts they share.
+TEST(RoundRobinLoadBalancerSharedScheduleTest, Workers) {
+  Stats::IsolatedStoreImpl stats_store;
+  ClusterStats stats{ClusterInfoImpl::generateStats(stats_store)};
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Runtime::MockRandomGenerator> random1;
+  NiceMock<Runtime::MockRandomGenerator> random2;
+  ON_CALL(random1, random()).WillByDefault(Return(0));
+  ON_CALL(random2, random()).WillByDefault(Return(1));
+  envoy::api::v2::Cluster::CommonLbConfig common_config;
+  common_config.set_weighted_scheduler(envoy::api::v2::Cluster::CommonLbConfig::INTERLEAVED);
+  InterleavedScheduleCacheSharedPtr schedule_cache = std::make_shared<InterleavedScheduleCache>();
+
+  PrioritySetImpl priority_set1;
+  PrioritySetImpl priority_set2;
+  priority_set1.getOrCreateHostSet(0);
+  priority_set2.getOrCreateHostSet(0);
+  RoundRobinLoadBalancer lb1(priority_set1, nullptr, stats, runtime, random1, common_config,
+                             schedule_cache);
+  RoundRobinLoadBalancer lb2(priority_set2, nullptr, stats, runtime, random2, common_config,
+                             schedule_cache);
+
+  std::shared_ptr<MockClusterInfo> info{new NiceMock<MockClusterInfo>()};
+  HostVectorConstSharedPtr hosts(new HostVector(
+      {makeTestHost(info, "tcp://127.0.0.1:80", 1), makeTestHost(info, "tcp://127.0.0.1:81", 2)}));
+  for (PrioritySetImpl* priority_set : {&priority_set1, &priority_set2}) {
+    priority_set->getOrCreateHostSet(0).updateHosts(
+        hosts, hosts, HostsPerLocalityImpl::empty(), HostsPerLocalityImpl::empty(), {}, *hosts,
+        {}, absl::nullopt);
+  }
+
+  for (uint32_t i = 0; i < 2; ++i) {
+    EXPECT_EQ((*hosts)[1], lb1.chooseHost(nullptr));
+    EXPECT_EQ((*hosts)[0], lb2.chooseHost(nullptr));
+    EXPECT_EQ((*hosts)[0], lb1.chooseHost(nullptr));
+    EXPECT_EQ((*hosts)[1], lb2.chooseHost(nullptr));
+    EXPECT_EQ((*hosts)[1], lb1.chooseHost(nullptr));
+    EXPECT_EQ((*hosts)[1], lb2.chooseHost(nullptr));
+  }
+}
+
+TEST(InterleavedScheduleCacheTest, Schedules) {
+  std::shared_ptr<MockClusterInfo> info{new NiceMock<MockClusterInfo>()};
+  InterleavedScheduleCache cache;
+  HostVectorConstSharedPtr hosts(new HostVector(
+      {makeTestHost(info, "tcp://127.0.0.1:80", 1), makeTestHost(info, "tcp://127.0.0.1:81", 2)}));
+
+  // The schedule of the same hosts is shared.
+  const auto schedule = cache.get(hosts, *hosts);
+  EXPECT_EQ(schedule, cache.get(hosts, *hosts));
+
+  // A copy of the hosts is another snapshot.
+  HostVectorConstSharedPtr copy(new HostVector(*hosts));
+  EXPECT_NE(schedule, cache.get(copy, *copy));
+
+  // Weights are updated in place, which invalidates the schedule.
+  (*hosts)[0]->weight(3);
+  const auto reweighted = cache.get(hosts, *hosts);
+  EXPECT_NE(schedule, reweighted);
+  EXPECT_EQ(reweighted, cache.get(hosts, *hosts));
+
+  // Snapshots are released once the cache holds the last reference to them.
+  std::weak_ptr<const HostVector> released = copy;
+  copy.reset();
+  EXPECT_FALSE(released.expired());
+  cache.get(hosts, *hosts);
+  EXPECT_TRUE(released.expired());
+}
+
 TEST_P(RoundRobinLoadBalancerTest, MaxUnhealthyPanic) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
                               makeTestHost(info_, "tcp://127.0.0.1:81")};
@@ -16,6 +16,44 @@ public:
   absl::optional<uint64_t> hash_key_;
 };
 
+// Maglev load balancer which counts the probes of its tables.
+class ProbeCountingMaglevLoadBalancer : public ThreadAwareLoadBalancerBase {
+public:
+  class ProbeCountingTable : public HashingLoadBalancer {
+  public:
+    ProbeCountingTable(const HostVector& hosts, uint64_t table_size)
+        : table_(HostsPerLocalityImpl(hosts, false), nullptr, table_size) {}
+
+    // ThreadAwareLoadBalancerBase::HashingLoadBalancer
+    HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override {
+      probes_++;
+      return table_.chooseHost(hash, attempt);
+    }
+
+    const MaglevTable table_;
+    mutable uint64_t probes_{};
+  };
+
+  ProbeCountingMaglevLoadBalancer(const PrioritySet& priority_set, ClusterStats& stats,
+                                  Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+                                  const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+                                  uint64_t table_size)
+      : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random, common_config),
+        table_size_(table_size) {}
+
+  std::shared_ptr<ProbeCountingTable> table_;
+
+private:
+  // ThreadAwareLoadBalancerBase
+  HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) override {
+    table_ = std::make_shared<ProbeCountingTable>(host_set.hosts(), table_size_);
+    return table_;
+  }
+  bool hashesByWeight() const override { return true; }
+
+  const uint64_t table_size_;
+};
+
 // Note: ThreadAwareLoadBalancer base is heavily tested by RingHashLoadBalancerTest. Only basic
 //       functionality is covered here.
 class MaglevLoadBalancerTest : public ::testing::Test {
@@ -225,5 +263,126 @@ TEST_F(MaglevLoadBalancerTest, LocalityWeightedGlobalPanic) {
   }
 }
 
+// Only the table of the priority which changed is rebuilt.
+TEST_F(MaglevLoadBalancerTest, RebuildUpdatedPriorityOnly) {
+  MockHostSet& failover_host_set = *priority_set_.getMockHostSet(1);
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  failover_host_set.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:91")};
+  failover_host_set.healthy_hosts_ = failover_host_set.hosts_;
+  init(7);
+  const HostSharedPtr host = host_set_.hosts_[0];
+
+  // The hosts of P=0 change without a callback, so its table still has the previous host.
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:92")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  failover_host_set.runCallbacks({}, {});
+  {
+    TestLoadBalancerContext context(0);
+    EXPECT_EQ(host, lb_->factory()->create()->chooseHost(&context));
+  }
+
+  host_set_.runCallbacks({}, {});
+  {
+    TestLoadBalancerContext context(0);
+    EXPECT_EQ(host_set_.hosts_[0], lb_->factory()->create()->chooseHost(&context));
+  }
+}
+
+// Requests go to the following hosts of the table when their host is at its bound.
+TEST_F(MaglevLoadBalancerTest, BoundedLoads) {
+  host_set_.hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  common_config_.mutable_hash_balance_factor()->set_value(125);
+  init(7);
+
+  // Same table as the basic test. With 11 active requests, each host may carry
+  // ceil(12 * 1.25 / 6) = 3 of them.
+  LoadBalancerPtr lb = lb_->factory()->create();
+  stats_.upstream_rq_active_.set(11);
+  host_set_.hosts_[2]->stats().rq_active_.set(2);
+  {
+    TestLoadBalancerContext context(0);
+    EXPECT_EQ(host_set_.hosts_[2], lb->chooseHost(&context));
+  }
+
+  host_set_.hosts_[2]->stats().rq_active_.set(3);
+  host_set_.hosts_[4]->stats().rq_active_.set(3);
+  {
+    TestLoadBalancerContext context(0);
+    EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+  }
+  {
+    // The walk wraps around the end of the table.
+    host_set_.hosts_[3]->stats().rq_active_.set(3);
+    TestLoadBalancerContext context(6);
+    EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+  }
+  {
+    TestLoadBalancerContext context(5);
+    EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+  }
+}
+
+// When every host is at its bound, the least loaded one is chosen after a bounded walk.
+TEST_F(MaglevLoadBalancerTest, BoundedLoadsSaturated) {
+  host_set_.hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  common_config_.mutable_hash_balance_factor()->set_value(125);
+  ProbeCountingMaglevLoadBalancer counting_lb(priority_set_, stats_, runtime_, random_,
+                                              common_config_, MaglevTable::DefaultTableSize);
+  counting_lb.initialize();
+
+  // With 11 active requests, each host may carry 3 of them, and all are at their bound. Without a
+  // bound on the walk, each request would probe the whole table.
+  LoadBalancerPtr lb = counting_lb.factory()->create();
+  stats_.upstream_rq_active_.set(11);
+  for (const HostSharedPtr& host : host_set_.hosts_) {
+    host->stats().rq_active_.set(3);
+  }
+  for (uint64_t i = 0; i < 100; ++i) {
+    counting_lb.table_->probes_ = 0;
+    TestLoadBalancerContext context(i);
+    EXPECT_NE(nullptr, lb->chooseHost(&context));
+    EXPECT_LE(host_set_.hosts_.size(), counting_lb.table_->probes_);
+    EXPECT_GE(8 * host_set_.hosts_.size(), counting_lb.table_->probes_);
+  }
+}
+
+// The bound of each host is proportional to its weight.
+TEST_F(MaglevLoadBalancerTest, BoundedLoadsWeighted) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
+                      makeTestHost(info_, "tcp://127.0.0.1:91", 3)};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  common_config_.mutable_hash_balance_factor()->set_value(100);
+  init(17);
+
+  // With 7 active requests, the hosts may carry 2 and 6 of them.
+  LoadBalancerPtr lb = lb_->factory()->create();
+  stats_.upstream_rq_active_.set(7);
+  host_set_.hosts_[0]->stats().rq_active_.set(2);
+  host_set_.hosts_[1]->stats().rq_active_.set(5);
+  for (uint32_t i = 0; i < 17; ++i) {
+    TestLoadBalancerContext context(i);
+    EXPECT_EQ(host_set_.hosts_[1], lb->chooseHost(&context));
+  }
+
+  host_set_.hosts_[0]->stats().rq_active_.set(1);
+  host_set_.hosts_[1]->stats().rq_active_.set(6);
+  for (uint32_t i = 0; i < 17; ++i) {
+    TestLoadBalancerContext context(i);
+    EXPECT_EQ(host_set_.hosts_[0], lb->chooseHost(&context));
+  }
+}
+
 } // namespace Upstream
 } // namespace Envoy
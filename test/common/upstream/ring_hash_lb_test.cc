@@ -278,5 +278,70 @@ TEST_P(RingHashLoadBalancerTest, UnevenHosts) {
   }
 }
 
+// Requests go to the following hosts of the ring when their host is at its bound.
+TEST_P(RingHashLoadBalancerTest, BoundedLoads) {
+  hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                      makeTestHost(info_, "tcp://127.0.0.1:81")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = (envoy::api::v2::Cluster::RingHashLbConfig());
+  config_.value().mutable_minimum_ring_size()->set_value(3);
+  config_.value().mutable_deprecated_v1()->mutable_use_std_hash()->set_value(false);
+  common_config_.mutable_hash_balance_factor()->set_value(150);
+  init();
+
+  // hash ring:
+  // port | position
+  // ---------------------------
+  // :80  | 5454692015285649509
+  // :81  | 7859399908942313493
+  // :80  | 13838424394637650569
+  // :81  | 16064866803292627174
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context_80(0);
+  TestLoadBalancerContext context_81(6000000000000000000);
+
+  // With 3 active requests, each host may carry ceil(4 * 1.5 / 2) = 3 of them.
+  stats_.upstream_rq_active_.set(3);
+  hostSet().hosts_[0]->stats().rq_active_.set(2);
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context_80));
+  EXPECT_EQ(hostSet().hosts_[1], lb->chooseHost(&context_81));
+
+  hostSet().hosts_[0]->stats().rq_active_.set(3);
+  EXPECT_EQ(hostSet().hosts_[1], lb->chooseHost(&context_80));
+  EXPECT_EQ(hostSet().hosts_[1], lb->chooseHost(&context_81));
+
+  hostSet().hosts_[0]->stats().rq_active_.set(0);
+  hostSet().hosts_[1]->stats().rq_active_.set(3);
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context_80));
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context_81));
+
+  // When both hosts are at their bound, the least loaded one is chosen.
+  hostSet().hosts_[0]->stats().rq_active_.set(4);
+  hostSet().hosts_[1]->stats().rq_active_.set(5);
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context_80));
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context_81));
+}
+
+// Without a balance factor, loads are not bounded.
+TEST_P(RingHashLoadBalancerTest, UnboundedLoads) {
+  hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                      makeTestHost(info_, "tcp://127.0.0.1:81")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = (envoy::api::v2::Cluster::RingHashLbConfig());
+  config_.value().mutable_minimum_ring_size()->set_value(3);
+  config_.value().mutable_deprecated_v1()->mutable_use_std_hash()->set_value(false);
+  init();
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  hostSet().hosts_[0]->stats().rq_active_.set(100);
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context));
+}
+
 } // namespace Upstream
 } // namespace Envoy
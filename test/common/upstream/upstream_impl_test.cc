@@ -1531,6 +1531,27 @@ TEST_F(ClusterInfoImplTest, Metadata) {
   EXPECT_EQ(LoadBalancerType::Maglev, cluster->info()->lbType());
 }
 
+// Maglev table size must be prime.
+TEST_F(ClusterInfoImplTest, MaglevTableSize) {
+  const auto yaml = [](uint64_t table_size) -> std::string {
+    return R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: MAGLEV
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    maglev_lb_config:
+      table_size: )EOF" +
+           std::to_string(table_size);
+  };
+
+  auto cluster = makeCluster(yaml(655373));
+  EXPECT_EQ(655373, cluster->info()->lbMaglevConfig().value().table_size().value());
+
+  EXPECT_THROW_WITH_MESSAGE(makeCluster(yaml(65536)), EnvoyException,
+                            "cluster: maglev table size 65536 is not a prime number");
+}
+
 // Cluster extension protocol options fails validation when configured for an unregistered filter.
 TEST_F(ClusterInfoImplTest, ExtensionProtocolOptionsForUnknownFilter) {
   const std::string yaml = R"EOF(
@@ -101,6 +101,57 @@ TEST_F(TcpStatsdSinkTest, BasicFlow) {
   tls_.shutdownThread();
 }
 
+TEST_F(TcpStatsdSinkTest, FlushUnchangedStats) {
+  InSequence s;
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 2;
+  gauge->used_ = true;
+  ON_CALL(*gauge, latchChanged()).WillByDefault(Return(false));
+  source_.gauges_.push_back(gauge);
+
+  expectCreateConnection();
+  EXPECT_CALL(*connection_, write(BufferStringEqual("envoy.test_gauge:2|g\n"), _));
+  sink_->flush(source_);
+  EXPECT_CALL(*connection_, write(BufferStringEqual("envoy.test_gauge:2|g\n"), _));
+  sink_->flush(source_);
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::NoFlush));
+  tls_.shutdownThread();
+}
+
+TEST_F(TcpStatsdSinkTest, FlushChangedStatsOnly) {
+  InSequence s;
+  sink_.reset(new TcpStatsdSink(local_info_, "fake_cluster", tls_, cluster_manager_,
+                                cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_,
+                                getDefaultPrefix(), true));
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->latch_ = 1;
+  counter->used_ = true;
+  source_.counters_.push_back(counter);
+
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 2;
+  gauge->used_ = true;
+  source_.gauges_.push_back(gauge);
+
+  expectCreateConnection();
+  EXPECT_CALL(*connection_,
+              write(BufferStringEqual("envoy.test_counter:1|c\nenvoy.test_gauge:2|g\n"), _));
+  sink_->flush(source_);
+
+  ON_CALL(*counter, latchChanged()).WillByDefault(Return(false));
+  ON_CALL(*gauge, latchChanged()).WillByDefault(Return(false));
+  EXPECT_CALL(*connection_, write(BufferStringEqual(""), _));
+  sink_->flush(source_);
+
+  EXPECT_CALL(*connection_, close(Network::ConnectionCloseType::NoFlush));
+  tls_.shutdownThread();
+}
+
 TEST_F(TcpStatsdSinkTest, BufferReallocate) {
   InSequence s;
 
@@ -15,7 +15,9 @@
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::_;
 using testing::NiceMock;
+using testing::Return;
 
 namespace Envoy {
 namespace Extensions {
@@ -157,6 +159,58 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   tls_.shutdownThread();
 }
 
+// By default every flush sends all the used stats, so a statsd server that lost a gauge gets it
+// back on the next flush.
+TEST(UdpStatsdSinkTest, FlushUnchangedStats) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false);
+
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  ON_CALL(*gauge, latchChanged()).WillByDefault(Return(false));
+  source.gauges_.push_back(gauge);
+
+  EXPECT_CALL(*writer_ptr, write("envoy.test_gauge:1|g")).Times(2);
+  sink.flush(source);
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, FlushChangedStatsOnly) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false, getDefaultPrefix(), true);
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->used_ = true;
+  counter->latch_ = 1;
+  source.counters_.push_back(counter);
+
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  source.gauges_.push_back(gauge);
+
+  EXPECT_CALL(*writer_ptr, write("envoy.test_counter:1|c"));
+  EXPECT_CALL(*writer_ptr, write("envoy.test_gauge:1|g"));
+  sink.flush(source);
+
+  ON_CALL(*counter, latchChanged()).WillByDefault(Return(false));
+  ON_CALL(*gauge, latchChanged()).WillByDefault(Return(false));
+  EXPECT_CALL(*writer_ptr, write(_)).Times(0);
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
 TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   NiceMock<Stats::MockSource> source;
   auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
@@ -136,6 +136,7 @@ TEST(StatsConfigTest, TcpSinkDefaultPrefix) {
   auto tcp_sink = dynamic_cast<Common::Statsd::TcpStatsdSink*>(sink.get());
   ASSERT_NE(tcp_sink, nullptr);
   EXPECT_EQ(tcp_sink->getPrefix(), defaultPrefix);
+  EXPECT_FALSE(tcp_sink->flushesChangedStatsOnly());
 }
 
 TEST(StatsConfigTest, TcpSinkCustomPrefix) {
@@ -163,6 +164,28 @@ TEST(StatsConfigTest, TcpSinkCustomPrefix) {
   EXPECT_EQ(tcp_sink->getPrefix(), prefix);
 }
 
+TEST(StatsConfigTest, TcpSinkChangedStatsOnly) {
+  const std::string name = StatsSinkNames::get().Statsd;
+
+  envoy::config::metrics::v2::StatsdSink sink_config;
+  sink_config.set_tcp_cluster_name("fake_cluster");
+  sink_config.set_flush_changed_stats_only(true);
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(name);
+  ASSERT_NE(factory, nullptr);
+
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  MessageUtil::jsonConvert(sink_config, *message);
+
+  NiceMock<Server::MockInstance> server;
+  Stats::SinkPtr sink = factory->createStatsSink(*message, server);
+  ASSERT_NE(sink, nullptr);
+
+  auto tcp_sink = dynamic_cast<Common::Statsd::TcpStatsdSink*>(sink.get());
+  ASSERT_NE(tcp_sink, nullptr);
+  EXPECT_TRUE(tcp_sink->flushesChangedStatsOnly());
+}
+
 class StatsConfigLoopbackTest : public testing::TestWithParam<Network::Address::IpVersion> {};
 INSTANTIATE_TEST_CASE_P(IpVersions, StatsConfigLoopbackTest,
                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
@@ -191,6 +214,7 @@ TEST_P(StatsConfigLoopbackTest, ValidUdpIpStatsd) {
   EXPECT_NE(sink, nullptr);
   EXPECT_NE(dynamic_cast<Common::Statsd::UdpStatsdSink*>(sink.get()), nullptr);
   EXPECT_EQ(dynamic_cast<Common::Statsd::UdpStatsdSink*>(sink.get())->getUseTagForTest(), false);
+  EXPECT_FALSE(sink->flushesChangedStatsOnly());
 }
 
 // Negative test for protoc-gen-validate constraints for statsd.
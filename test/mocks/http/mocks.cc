@@ -14,6 +14,7 @@ using testing::Matcher;
 using testing::MatcherInterface;
 using testing::MatchResultListener;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::ReturnRef;
 using testing::SaveArg;
 
@@ -62,7 +63,10 @@ MockServerConnection::MockServerConnection() {
 
 MockServerConnection::~MockServerConnection() {}
 
-MockClientConnection::MockClientConnection() {}
+MockClientConnection::MockClientConnection() {
+  ON_CALL(*this, remoteMaxConcurrentStreams())
+      .WillByDefault(ReturnPointee(&remote_max_concurrent_streams_));
+}
 MockClientConnection::~MockClientConnection() {}
 
 MockFilterChainFactory::MockFilterChainFactory() {}
@@ -158,6 +158,9 @@ public:
 
   // Http::ClientConnection
   MOCK_METHOD1(newStream, StreamEncoder&(StreamDecoder& response_decoder));
+  MOCK_METHOD0(remoteMaxConcurrentStreams, uint32_t());
+
+  uint32_t remote_max_concurrent_streams_{std::numeric_limits<uint32_t>::max()};
 };
 
 class MockFilterChainFactory : public FilterChainFactory {
@@ -33,6 +33,8 @@ MockOptions::MockOptions(const std::string& config_path) : config_path_(config_p
   ON_CALL(*this, statsOptions()).WillByDefault(ReturnRef(stats_options_));
   ON_CALL(*this, restartEpoch()).WillByDefault(ReturnPointee(&hot_restart_epoch_));
   ON_CALL(*this, hotRestartDisabled()).WillByDefault(ReturnPointee(&hot_restart_disabled_));
+  ON_CALL(*this, libeventBuffersEnabled())
+      .WillByDefault(ReturnPointee(&libevent_buffers_enabled_));
 }
 MockOptions::~MockOptions() {}
 
@@ -64,7 +66,7 @@ MockGuardDog::MockGuardDog() : watch_dog_(new NiceMock<MockWatchDog>()) {
 }
 MockGuardDog::~MockGuardDog() {}
 
-MockHotRestart::MockHotRestart() {
+MockHotRestart::MockHotRestart() : stats_allocator_(symbol_table_) {
   ON_CALL(*this, logLock()).WillByDefault(ReturnRef(log_lock_));
   ON_CALL(*this, accessLogLock()).WillByDefault(ReturnRef(access_log_lock_));
   ON_CALL(*this, statsAllocator()).WillByDefault(ReturnRef(stats_allocator_));
@@ -88,6 +90,12 @@ MockListenerComponentFactory::MockListenerComponentFactory()
         }
         return socket_;
       }));
+  ON_CALL(*this, createWorkerListenSocket(_, _, _))
+      .WillByDefault(Invoke([](Network::Address::InstanceConstSharedPtr,
+                               const Network::Socket::OptionsSharedPtr&,
+                               uint32_t) -> Network::SocketSharedPtr {
+        return std::make_shared<NiceMock<Network::MockListenSocket>>();
+      }));
 }
 MockListenerComponentFactory::~MockListenerComponentFactory() {}
 
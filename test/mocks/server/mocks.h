@@ -72,6 +72,7 @@ public:
   MOCK_CONST_METHOD0(maxStats, uint64_t());
   MOCK_CONST_METHOD0(statsOptions, const Stats::StatsOptions&());
   MOCK_CONST_METHOD0(hotRestartDisabled, bool());
+  MOCK_CONST_METHOD0(libeventBuffersEnabled, bool());
 
   std::string config_path_;
   std::string config_yaml_;
@@ -86,6 +87,7 @@ public:
   uint32_t concurrency_{1};
   uint64_t hot_restart_epoch_{};
   bool hot_restart_disabled_{};
+  bool libevent_buffers_enabled_{true};
 };
 
 class MockConfigTracker : public ConfigTracker {
@@ -167,7 +169,8 @@ public:
 
   // Server::HotRestart
   MOCK_METHOD0(drainParentListeners, void());
-  MOCK_METHOD1(duplicateParentListenSocket, int(const std::string& address));
+  MOCK_METHOD2(duplicateParentListenSocket,
+               int(const std::string& address, uint32_t worker_index));
   MOCK_METHOD1(getParentStats, void(GetParentStatsInfo& info));
   MOCK_METHOD2(initialize, void(Event::Dispatcher& dispatcher, Server::Instance& server));
   MOCK_METHOD1(shutdownParentAdmin, void(ShutdownParentAdminInfo& info));
@@ -181,6 +184,7 @@ public:
 private:
   Thread::MutexBasicLockable log_lock_;
   Thread::MutexBasicLockable access_log_lock_;
+  Stats::SymbolTableImpl symbol_table_;
   Stats::HeapStatDataAllocator stats_allocator_;
 };
 
@@ -209,6 +213,10 @@ public:
                Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
                                         const Network::Socket::OptionsSharedPtr& options,
                                         bool bind_to_port));
+  MOCK_METHOD3(createWorkerListenSocket,
+               Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
+                                        const Network::Socket::OptionsSharedPtr& options,
+                                        uint32_t worker_index));
   MOCK_METHOD1(createDrainManager_, DrainManager*(envoy::api::v2::Listener::DrainType drain_type));
   MOCK_METHOD0(nextListenerTag, uint64_t());
 
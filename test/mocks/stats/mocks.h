@@ -39,6 +39,7 @@ public:
   MOCK_METHOD0(reset, void());
   MOCK_CONST_METHOD0(used, bool());
   MOCK_CONST_METHOD0(value, uint64_t());
+  MOCK_METHOD0(latchChanged, bool());
 
   bool used_;
   uint64_t value_;
@@ -65,6 +66,7 @@ public:
   MOCK_METHOD1(sub, void(uint64_t amount));
   MOCK_CONST_METHOD0(used, bool());
   MOCK_CONST_METHOD0(value, uint64_t());
+  MOCK_METHOD0(latchChanged, bool());
 
   bool used_;
   uint64_t value_;
@@ -125,11 +127,15 @@ public:
   MOCK_METHOD0(cachedCounters, const std::vector<CounterSharedPtr>&());
   MOCK_METHOD0(cachedGauges, const std::vector<GaugeSharedPtr>&());
   MOCK_METHOD0(cachedHistograms, const std::vector<ParentHistogramSharedPtr>&());
+  MOCK_METHOD0(changedCounters, const std::vector<CounterSharedPtr>&());
+  MOCK_METHOD0(changedGauges, const std::vector<GaugeSharedPtr>&());
   MOCK_METHOD0(clearCache, void());
 
   std::vector<CounterSharedPtr> counters_;
   std::vector<GaugeSharedPtr> gauges_;
   std::vector<ParentHistogramSharedPtr> histograms_;
+  std::vector<CounterSharedPtr> changed_counters_;
+  std::vector<GaugeSharedPtr> changed_gauges_;
 };
 
 class MockSink : public Sink {
@@ -138,6 +144,7 @@ public:
   ~MockSink();
 
   MOCK_METHOD1(flush, void(Source& source));
+  MOCK_CONST_METHOD0(flushesChangedStatsOnly, bool());
   MOCK_METHOD2(onHistogramComplete, void(const Histogram& histogram, uint64_t value));
 };
 
@@ -29,6 +29,19 @@ MockHostSet::MockHostSet(uint32_t priority, uint32_t overprovisioning_factor)
   ON_CALL(*this, healthyHostsPerLocality())
       .WillByDefault(
           Invoke([this]() -> const HostsPerLocality& { return *healthy_hosts_per_locality_; }));
+  // The hosts are held by value, so each snapshot is a copy.
+  ON_CALL(*this, hostsPtr()).WillByDefault(Invoke([this]() -> HostVectorConstSharedPtr {
+    return std::make_shared<const HostVector>(hosts_);
+  }));
+  ON_CALL(*this, healthyHostsPtr()).WillByDefault(Invoke([this]() -> HostVectorConstSharedPtr {
+    return std::make_shared<const HostVector>(healthy_hosts_);
+  }));
+  ON_CALL(*this, hostsPerLocalityPtr())
+      .WillByDefault(
+          Invoke([this]() -> HostsPerLocalityConstSharedPtr { return hosts_per_locality_; }));
+  ON_CALL(*this, healthyHostsPerLocalityPtr())
+      .WillByDefault(Invoke(
+          [this]() -> HostsPerLocalityConstSharedPtr { return healthy_hosts_per_locality_; }));
   ON_CALL(*this, localityWeights()).WillByDefault(Invoke([this]() -> LocalityWeightsConstSharedPtr {
     return locality_weights_;
   }));
@@ -52,6 +52,10 @@ public:
   MOCK_CONST_METHOD0(healthyHosts, const HostVector&());
   MOCK_CONST_METHOD0(hostsPerLocality, const HostsPerLocality&());
   MOCK_CONST_METHOD0(healthyHostsPerLocality, const HostsPerLocality&());
+  MOCK_CONST_METHOD0(hostsPtr, HostVectorConstSharedPtr());
+  MOCK_CONST_METHOD0(healthyHostsPtr, HostVectorConstSharedPtr());
+  MOCK_CONST_METHOD0(hostsPerLocalityPtr, HostsPerLocalityConstSharedPtr());
+  MOCK_CONST_METHOD0(healthyHostsPerLocalityPtr, HostsPerLocalityConstSharedPtr());
   MOCK_CONST_METHOD0(localityWeights, LocalityWeightsConstSharedPtr());
   MOCK_METHOD0(chooseLocality, absl::optional<uint32_t>());
   MOCK_METHOD8(updateHosts, void(std::shared_ptr<const HostVector> hosts,
@@ -174,9 +178,10 @@ public:
                                  const LocalInfo::LocalInfo& local_info,
                                  AccessLog::AccessLogManager& log_manager, Server::Admin& admin));
 
-  MOCK_METHOD5(allocateConnPool, Http::ConnectionPool::InstancePtr(
+  MOCK_METHOD6(allocateConnPool, Http::ConnectionPool::InstancePtr(
                                      Event::Dispatcher& dispatcher, HostConstSharedPtr host,
                                      ResourcePriority priority, Http::Protocol protocol,
+                                     bool pipelined,
                                      const Network::ConnectionSocket::OptionsSharedPtr& options));
 
   MOCK_METHOD4(
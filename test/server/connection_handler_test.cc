@@ -1,7 +1,13 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "envoy/stats/scope.h"
 
+#include "common/common/thread.h"
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 
@@ -19,6 +25,8 @@ using testing::ByRef;
 using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
+using testing::Ref;
+using testing::SaveArg;
 using testing::Return;
 using testing::ReturnRef;
 
@@ -38,11 +46,12 @@ public:
                  bool hand_off_restored_destination_connections, const std::string& name)
         : parent_(parent), tag_(tag), bind_to_port_(bind_to_port),
           hand_off_restored_destination_connections_(hand_off_restored_destination_connections),
-          name_(name) {}
+          name_(name), connection_balancer_(&parent.connection_balancer_) {}
 
     Network::FilterChainManager& filterChainManager() override { return parent_.manager_; }
     Network::FilterChainFactory& filterChainFactory() override { return parent_.factory_; }
     Network::Socket& socket() override { return socket_; }
+    Network::Socket& workerSocket(uint32_t) override { return worker_socket_; }
     bool bindToPort() override { return bind_to_port_; }
     bool handOffRestoredDestinationConnections() const override {
       return hand_off_restored_destination_connections_;
@@ -51,13 +60,16 @@ public:
     Stats::Scope& listenerScope() override { return parent_.stats_store_; }
     uint64_t listenerTag() const override { return tag_; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
 
     ConnectionHandlerTest& parent_;
     Network::MockListenSocket socket_;
+    Network::MockListenSocket worker_socket_;
     uint64_t tag_;
     bool bind_to_port_;
     const bool hand_off_restored_destination_connections_;
     const std::string name_;
+    Network::ConnectionBalancer* connection_balancer_;
   };
 
   typedef std::unique_ptr<TestListener> TestListenerPtr;
@@ -73,10 +85,12 @@ public:
 
   Stats::IsolatedStoreImpl stats_store_;
   NiceMock<Event::MockDispatcher> dispatcher_;
+  // The listeners and their balancer outlive the handler, which unregisters from the balancer.
+  Network::NopConnectionBalancerImpl connection_balancer_;
+  std::list<TestListenerPtr> listeners_;
   Network::ConnectionHandlerPtr handler_;
   NiceMock<Network::MockFilterChainManager> manager_;
   NiceMock<Network::MockFilterChainFactory> factory_;
-  std::list<TestListenerPtr> listeners_;
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
@@ -116,6 +130,181 @@ TEST_F(ConnectionHandlerTest, RemoveListener) {
   handler_->removeListeners(0);
 }
 
+TEST_F(ConnectionHandlerTest, WorkerListener) {
+  InSequence s;
+  handler_.reset(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, 2));
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(dispatcher_, createListener_(Ref(test_listener->worker_socket_), _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection});
+  EXPECT_EQ(1UL, stats_store_.counter("downstream_cx_total").value());
+  EXPECT_EQ(1UL, stats_store_.counter("worker_2.downstream_cx_total").value());
+  EXPECT_EQ(1UL, stats_store_.gauge("worker_2.downstream_cx_active").value());
+
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0UL, stats_store_.gauge("worker_2.downstream_cx_active").value());
+  EXPECT_EQ(1UL, stats_store_.counter("worker_2.downstream_cx_total").value());
+
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
+// Validate that accepted sockets are handed to the worker with the fewest connections.
+TEST_F(ConnectionHandlerTest, ExactBalance) {
+  Network::ExactConnectionBalancerImpl balancer;
+  ConnectionHandlerImpl handler0(ENVOY_LOGGER(), dispatcher_, 0);
+  ConnectionHandlerImpl handler1(ENVOY_LOGGER(), dispatcher_, 1);
+
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->connection_balancer_ = &balancer;
+  Network::ListenerCallbacks* listener_callbacks0;
+  Network::ListenerCallbacks* listener_callbacks1;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks0 = &cb;
+            return new NiceMock<Network::MockListener>();
+          }))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks1 = &cb;
+            return new NiceMock<Network::MockListener>();
+          }));
+  EXPECT_CALL(test_listener->socket_, localAddress()).Times(2);
+  handler0.addListener(*test_listener);
+  handler1.addListener(*test_listener);
+
+  EXPECT_CALL(manager_, findFilterChain(_)).WillRepeatedly(Return(filter_chain_.get()));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillRepeatedly(Return(true));
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _))
+      .WillOnce(Return(new NiceMock<Network::MockConnection>()))
+      .WillOnce(Return(new NiceMock<Network::MockConnection>()));
+
+  // Both workers have no connections, so the worker which accepts the socket keeps it.
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_EQ(0UL, handler0.numConnections());
+  EXPECT_EQ(1UL, handler1.numConnections());
+
+  // The next socket is posted to the other worker, which has fewer connections.
+  std::function<void()> post_cb;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_EQ(0UL, handler0.numConnections());
+  EXPECT_EQ(1UL, handler1.numConnections());
+  post_cb();
+  EXPECT_EQ(1UL, handler0.numConnections());
+  EXPECT_EQ(1UL, handler1.numConnections());
+
+  EXPECT_EQ(2UL, stats_store_.counter("downstream_cx_total").value());
+  EXPECT_EQ(1UL, stats_store_.gauge("worker_0.downstream_cx_active").value());
+  EXPECT_EQ(1UL, stats_store_.gauge("worker_1.downstream_cx_active").value());
+}
+
+// Validate that a socket posted to a worker which has stopped its listener since is dropped.
+TEST_F(ConnectionHandlerTest, ExactBalanceStoppedListener) {
+  Network::ExactConnectionBalancerImpl balancer;
+  ConnectionHandlerImpl handler0(ENVOY_LOGGER(), dispatcher_, 0);
+  ConnectionHandlerImpl handler1(ENVOY_LOGGER(), dispatcher_, 1);
+
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->connection_balancer_ = &balancer;
+  Network::ListenerCallbacks* listener_callbacks1;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Return(new NiceMock<Network::MockListener>()))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks1 = &cb;
+            return new NiceMock<Network::MockListener>();
+          }));
+  EXPECT_CALL(test_listener->socket_, localAddress()).Times(2);
+  handler0.addListener(*test_listener);
+  handler1.addListener(*test_listener);
+
+  // Give worker 1 a connection, so that the next socket goes to worker 0.
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
+  listener_callbacks1->onNewConnection(
+      Network::ConnectionPtr{new NiceMock<Network::MockConnection>()});
+
+  std::function<void()> post_cb;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+
+  handler0.stopListeners();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).Times(0);
+  post_cb();
+  EXPECT_EQ(0UL, handler0.numConnections());
+
+  // Worker 0 is no longer balanced to.
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(nullptr));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+}
+
+// Validate that a worker removing its listener while another worker hands it a socket waits for the
+// hand-off to be done, and drops the socket.
+TEST_F(ConnectionHandlerTest, ExactBalanceRemoveListenerDuringHandOff) {
+  Network::ExactConnectionBalancerImpl balancer;
+  ConnectionHandlerImpl handler0(ENVOY_LOGGER(), dispatcher_, 0);
+  ConnectionHandlerImpl handler1(ENVOY_LOGGER(), dispatcher_, 1);
+
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->connection_balancer_ = &balancer;
+  Network::ListenerCallbacks* listener_callbacks1;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Return(new NiceMock<Network::MockListener>()))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks1 = &cb;
+            return new NiceMock<Network::MockListener>();
+          }));
+  EXPECT_CALL(test_listener->socket_, localAddress()).Times(2);
+  handler0.addListener(*test_listener);
+  handler1.addListener(*test_listener);
+
+  // Give worker 1 a connection, so that the next socket goes to worker 0.
+  listener_callbacks1->onNewConnection(
+      Network::ConnectionPtr{new NiceMock<Network::MockConnection>()});
+
+  // Worker 0 removes its listener as the socket is being posted to it. Its listener is only
+  // destroyed once the post is done.
+  std::atomic<bool> removed{false};
+  Thread::ThreadPtr worker0;
+  std::function<void()> post_cb;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(Invoke([&](std::function<void()> cb) -> void {
+    post_cb = cb;
+    worker0 = std::make_unique<Thread::Thread>([&]() -> void {
+      handler0.removeListeners(1);
+      removed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(removed);
+  }));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  worker0->join();
+  EXPECT_TRUE(removed);
+
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).Times(0);
+  post_cb();
+  EXPECT_EQ(0UL, handler0.numConnections());
+}
+
 TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
   InSequence s;
 
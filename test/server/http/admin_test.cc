@@ -47,7 +47,7 @@ namespace Server {
 class AdminStatsTest : public testing::TestWithParam<Network::Address::IpVersion> {
 public:
   AdminStatsTest() : alloc_(options_) {
-    store_ = std::make_unique<Stats::ThreadLocalStoreImpl>(options_, alloc_);
+    store_ = std::make_unique<Stats::ThreadLocalStoreImpl>(options_, alloc_, symbol_table_);
     store_->addSink(sink_);
   }
 
@@ -62,6 +62,7 @@ public:
   NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
   NiceMock<ThreadLocal::MockInstance> tls_;
   Stats::StatsOptionsImpl options_;
+  Stats::SymbolTableImpl symbol_table_;
   Stats::MockedTestAllocator alloc_;
   Stats::MockSink sink_;
   std::unique_ptr<Stats::ThreadLocalStoreImpl> store_;
@@ -1094,7 +1095,7 @@ TEST_P(AdminInstanceTest, PostRequest) {
 
 class PrometheusStatsFormatterTest : public testing::Test {
 protected:
-  PrometheusStatsFormatterTest() /*: alloc_(stats_options_)*/ {}
+  PrometheusStatsFormatterTest() : alloc_(symbol_table_) {}
   void addCounter(const std::string& name, std::vector<Stats::Tag> cluster_tags) {
     std::string tname = std::string(name);
     counters_.push_back(alloc_.makeCounter(name, std::move(tname), std::move(cluster_tags)));
@@ -1106,6 +1107,7 @@ protected:
   }
 
   Stats::StatsOptionsImpl stats_options_;
+  Stats::SymbolTableImpl symbol_table_;
   Stats::HeapStatDataAllocator alloc_;
   std::vector<Stats::CounterSharedPtr> counters_;
   std::vector<Stats::GaugeSharedPtr> gauges_;
@@ -0,0 +1,111 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <vector>
+
+#include "envoy/api/v2/lds.pb.h"
+
+#include "common/network/address_impl.h"
+#include "common/network/listen_socket_impl.h"
+
+#include "server/listener_manager_impl.h"
+
+#include "test/mocks/server/mocks.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Builds a listener with num_tenants TLS filter chains, each matching one exact server name and
+ * one wildcard domain, and a catch-all filter chain.
+ */
+static envoy::api::v2::Listener makeListener(int64_t num_tenants) {
+  envoy::api::v2::Listener listener;
+  listener.set_name("tls_termination");
+  listener.mutable_address()->mutable_socket_address()->set_address("127.0.0.1");
+  listener.mutable_address()->mutable_socket_address()->set_port_value(443);
+  listener.add_listener_filters()->set_name("envoy.listener.tls_inspector");
+  for (int64_t i = 0; i < num_tenants; i++) {
+    auto* filter_chain_match = listener.add_filter_chains()->mutable_filter_chain_match();
+    filter_chain_match->add_server_names(fmt::format("tenant-{}.example.com", i));
+    filter_chain_match->add_server_names(fmt::format("*.tenant-{}.example.net", i));
+    filter_chain_match->set_transport_protocol("tls");
+    filter_chain_match->add_application_protocols("h2");
+    filter_chain_match->add_application_protocols("http/1.1");
+  }
+  listener.add_filter_chains();
+  return listener;
+}
+
+/**
+ * A listener manager holding the listener built by makeListener(), which isn't started.
+ */
+class ListenerFixture {
+public:
+  ListenerFixture(int64_t num_tenants) {
+    ON_CALL(worker_factory_, createWorker_()).WillByDefault(testing::Return(new MockWorker()));
+    manager_.reset(
+        new ListenerManagerImpl(server_, listener_factory_, worker_factory_, time_source_));
+    manager_->addOrUpdateListener(makeListener(num_tenants), "", true);
+  }
+
+  const Network::FilterChainManager& filterChainManager() {
+    return manager_->listeners().back().get().filterChainManager();
+  }
+
+private:
+  testing::NiceMock<MockInstance> server_;
+  testing::NiceMock<MockListenerComponentFactory> listener_factory_;
+  testing::NiceMock<MockWorkerFactory> worker_factory_;
+  testing::NiceMock<MockTimeSource> time_source_;
+  std::unique_ptr<ListenerManagerImpl> manager_;
+};
+
+/**
+ * Measure the time to find the filter chain of a TLS connection, given its server name.
+ * The variable parameter is the number of tenants.
+ */
+static void findFilterChain(benchmark::State& state, const std::string& server_name) {
+  ListenerFixture fixture(state.range(0));
+  Network::ConnectionSocketImpl socket(
+      -1, std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 443),
+      std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1", 40000));
+  socket.setDetectedTransportProtocol("tls");
+  socket.setRequestedServerName(server_name);
+  socket.setRequestedApplicationProtocols({"h2", "http/1.1"});
+  const Network::FilterChainManager& filter_chain_manager = fixture.filterChainManager();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(filter_chain_manager.findFilterChain(socket));
+  }
+}
+
+static void FilterChainLookupExactServerName(benchmark::State& state) {
+  findFilterChain(state, fmt::format("tenant-{}.example.com", state.range(0) - 1));
+}
+BENCHMARK(FilterChainLookupExactServerName)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void FilterChainLookupWildcardServerName(benchmark::State& state) {
+  findFilterChain(state, fmt::format("www.api.tenant-{}.example.net", state.range(0) - 1));
+}
+BENCHMARK(FilterChainLookupWildcardServerName)->Arg(10)->Arg(1000)->Arg(10000);
+
+static void FilterChainLookupCatchAll(benchmark::State& state) {
+  findFilterChain(state, "unknown.example.org");
+}
+BENCHMARK(FilterChainLookupCatchAll)->Arg(10)->Arg(1000)->Arg(10000);
+
+} // namespace Server
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
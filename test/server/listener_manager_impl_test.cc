@@ -5,6 +5,7 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/config/metadata.h"
 #include "common/network/address_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/socket_option_impl.h"
 #include "common/network/utility.h"
@@ -147,13 +148,13 @@ public:
                   const std::string& server_name, bool expect_server_name_match,
                   const std::string& transport_protocol, bool expect_transport_protocol_match,
                   const std::vector<std::string>& application_protocols) {
-    const int times = expect_destination_port_match ? 2 : 1;
+    UNREFERENCED_PARAMETER(expect_destination_port_match);
     if (absl::StartsWith(destination_address, "/")) {
       address_.reset(new Network::Address::PipeInstance(destination_address));
     } else {
       address_.reset(new Network::Address::Ipv4Instance(destination_address, destination_port));
     }
-    EXPECT_CALL(*socket_, localAddress()).Times(times).WillRepeatedly(ReturnRef(address_));
+    EXPECT_CALL(*socket_, localAddress()).WillOnce(ReturnRef(address_));
 
     if (expect_destination_address_match) {
       EXPECT_CALL(*socket_, requestedServerName()).WillOnce(Return(absl::string_view(server_name)));
@@ -406,8 +407,185 @@ TEST_F(ListenerManagerImplTest, AddListenerAddressNotMatching) {
   EXPECT_CALL(*listener_foo, onDestroy());
 }
 
+TEST_F(ListenerManagerImplTest, ReusePort) {
+  InSequence s;
+
+  // Records the SO_REUSEPORT set on the listener's socket.
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  // Replace the manager with one which has three workers.
+  server_.options_.concurrency_ = 3;
+  EXPECT_CALL(worker_factory_, createWorker_())
+      .Times(3)
+      .WillRepeatedly(Invoke([]() -> Worker* { return new MockWorker(); }));
+  manager_.reset(
+      new ListenerManagerImpl(server_, listener_factory_, worker_factory_, time_source_));
+
+  const std::string listener_foo_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    reuse_port: true
+    filter_chains:
+    - filters:
+  )EOF";
+
+  // The first worker uses the listener's socket, and the others get their own.
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  EXPECT_CALL(listener_factory_, createWorkerListenSocket(_, _, 1));
+  EXPECT_CALL(listener_factory_, createWorkerListenSocket(_, _, 2));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
+  checkStats(1, 0, 0, 0, 1, 0);
+
+  Network::ListenerConfig& listener = manager_->listeners()[0].get();
+  Network::Socket* worker_socket_1 = &listener.workerSocket(1);
+  Network::Socket* worker_socket_2 = &listener.workerSocket(2);
+  EXPECT_EQ(&listener.socket(), &listener.workerSocket(0));
+  EXPECT_NE(&listener.socket(), worker_socket_1);
+  EXPECT_NE(worker_socket_1, worker_socket_2);
+
+  // Update foo listener, keeping the worker sockets.
+  const std::string listener_foo_update_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    reuse_port: true
+    per_connection_buffer_limit_bytes: 10
+    filter_chains:
+    - filters:
+  )EOF";
+
+  ListenerHandle* listener_foo_update = expectListenerCreate(false);
+  EXPECT_CALL(*listener_foo, onDestroy());
+  EXPECT_TRUE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_update_yaml), "", true));
+  checkStats(1, 1, 0, 0, 1, 0);
+  Network::ListenerConfig& updated_listener = manager_->listeners()[0].get();
+  EXPECT_EQ(worker_socket_1, &updated_listener.workerSocket(1));
+  EXPECT_EQ(worker_socket_2, &updated_listener.workerSocket(2));
+
+  // Update foo listener, but without reuse_port. Should throw.
+  const std::string listener_foo_no_reuse_port_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    filter_chains:
+    - filters:
+  )EOF";
+
+  ListenerHandle* listener_foo_no_reuse_port = expectListenerCreate(false);
+  EXPECT_CALL(*listener_foo_no_reuse_port, onDestroy());
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_no_reuse_port_yaml), "",
+                                    true),
+      EnvoyException,
+      "error updating listener: 'foo' has a different reuse_port from existing listener");
+
+  EXPECT_CALL(*listener_foo_update, onDestroy());
+}
+
+// A socket handed over by a parent process whose listener didn't have reuse_port lacks
+// SO_REUSEPORT, so the workers share it rather than failing to bind sockets of their own.
+TEST_F(ListenerManagerImplTest, ReusePortInheritedSocket) {
+  InSequence s;
+
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  // Replace the manager with one which has two workers.
+  server_.options_.concurrency_ = 2;
+  EXPECT_CALL(worker_factory_, createWorker_())
+      .Times(2)
+      .WillRepeatedly(Invoke([]() -> Worker* { return new MockWorker(); }));
+  manager_.reset(
+      new ListenerManagerImpl(server_, listener_factory_, worker_factory_, time_source_));
+
+  const std::string listener_foo_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    reuse_port: true
+    filter_chains:
+    - filters:
+  )EOF";
+
+  // The parent's socket is already bound, so SO_REUSEPORT isn't set on it.
+  auto parent_socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+  ON_CALL(*parent_socket, fd()).WillByDefault(Return(42));
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true)).WillOnce(Return(parent_socket));
+  EXPECT_CALL(listener_factory_, createWorkerListenSocket(_, _, _)).Times(0);
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
+  checkStats(1, 0, 0, 0, 1, 0);
+
+  Network::ListenerConfig& listener = manager_->listeners()[0].get();
+  EXPECT_EQ(parent_socket.get(), &listener.socket());
+  EXPECT_EQ(&listener.socket(), &listener.workerSocket(0));
+  EXPECT_EQ(&listener.socket(), &listener.workerSocket(1));
+
+  // Updating foo listener keeps sharing the socket.
+  const std::string listener_foo_update_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    reuse_port: true
+    per_connection_buffer_limit_bytes: 10
+    filter_chains:
+    - filters:
+  )EOF";
+
+  ListenerHandle* listener_foo_update = expectListenerCreate(false);
+  EXPECT_CALL(*listener_foo, onDestroy());
+  EXPECT_TRUE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_update_yaml), "", true));
+  checkStats(1, 1, 0, 0, 1, 0);
+  Network::ListenerConfig& updated_listener = manager_->listeners()[0].get();
+  EXPECT_EQ(parent_socket.get(), &updated_listener.socket());
+  EXPECT_EQ(&updated_listener.socket(), &updated_listener.workerSocket(1));
+
+  EXPECT_CALL(*listener_foo_update, onDestroy());
+}
+
+TEST_F(ListenerManagerImplTest, ExactConnectionBalance) {
+  const std::string listener_foo_yaml = R"EOF(
+    name: "foo"
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    connection_balance_config:
+      exact_balance: {}
+    filter_chains:
+    - filters:
+  )EOF";
+
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
+  EXPECT_NE(nullptr, dynamic_cast<Network::ExactConnectionBalancerImpl*>(
+                         &manager_->listeners()[0].get().connectionBalancer()));
+
+  EXPECT_CALL(*listener_foo, onDestroy());
+}
+
+TEST_F(ListenerManagerImplTest, ReusePortPipe) {
+  const std::string listener_foo_yaml = R"EOF(
+    name: "foo"
+    address:
+      pipe: { path: "/foo" }
+    reuse_port: true
+    filter_chains:
+    - filters:
+  )EOF";
+
+  EXPECT_CALL(listener_factory_, createDrainManager_(_));
+  EXPECT_THROW_WITH_MESSAGE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true),
+      EnvoyException, "error adding listener 'foo': reuse_port requires an IP address");
+}
+
 // Make sure that a listener creation does not fail on IPv4 only setups when FilterChainMatch is not
-// specified and we try to create default CidrRange. See convertDestinationIPsMapToTrie function for
+// specified and we try to create default CidrRange. See compileDestinationIPsMatcher function for
 // more details.
 TEST_F(ListenerManagerImplTest, AddListenerOnIpv4OnlySetups) {
   InSequence s;
@@ -437,7 +615,7 @@ TEST_F(ListenerManagerImplTest, AddListenerOnIpv4OnlySetups) {
 }
 
 // Make sure that a listener creation does not fail on IPv6 only setups when FilterChainMatch is not
-// specified and we try to create default CidrRange. See convertDestinationIPsMapToTrie function for
+// specified and we try to create default CidrRange. See compileDestinationIPsMatcher function for
 // more details.
 TEST_F(ListenerManagerImplTest, AddListenerOnIpv6OnlySetups) {
   InSequence s;
@@ -93,6 +93,7 @@ TEST(OptionsImplTest, All) {
   EXPECT_EQ(std::chrono::seconds(60), options->drainTime());
   EXPECT_EQ(std::chrono::seconds(90), options->parentShutdownTime());
   EXPECT_EQ(true, options->hotRestartDisabled());
+  EXPECT_EQ(true, options->libeventBuffersEnabled());
 
   options = createOptionsImpl("envoy --mode init_only");
   EXPECT_EQ(Server::Mode::InitOnly, options->mode());
@@ -102,6 +103,7 @@ TEST(OptionsImplTest, SetAll) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello");
   bool v2_config_only = options->v2ConfigOnly();
   bool hot_restart_disabled = options->hotRestartDisabled();
+  bool libevent_buffers_enabled = options->libeventBuffersEnabled();
   Stats::StatsOptionsImpl stats_options;
   stats_options.max_obj_name_length_ = 54321;
   stats_options.max_stat_suffix_length_ = 1234;
@@ -127,6 +129,7 @@ TEST(OptionsImplTest, SetAll) {
   options->setMaxStats(12345);
   options->setStatsOptions(stats_options);
   options->setHotRestartDisabled(!options->hotRestartDisabled());
+  options->setLibeventBuffersEnabled(!options->libeventBuffersEnabled());
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
@@ -150,6 +153,7 @@ TEST(OptionsImplTest, SetAll) {
   EXPECT_EQ(stats_options.max_obj_name_length_, options->statsOptions().maxObjNameLength());
   EXPECT_EQ(stats_options.max_stat_suffix_length_, options->statsOptions().maxStatSuffixLength());
   EXPECT_EQ(!hot_restart_disabled, options->hotRestartDisabled());
+  EXPECT_EQ(!libevent_buffers_enabled, options->libeventBuffersEnabled());
 }
 
 TEST(OptionsImplTest, DefaultParams) {
@@ -160,6 +164,20 @@ TEST(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
   EXPECT_EQ(false, options->hotRestartDisabled());
+  EXPECT_EQ(true, options->libeventBuffersEnabled());
+  EXPECT_EQ(false, options->statsOptions().logLinearHistograms());
+}
+
+TEST(OptionsImplTest, LogLinearHistograms) {
+  std::unique_ptr<OptionsImpl> options =
+      createOptionsImpl("envoy -c hello --log-linear-histograms");
+  EXPECT_EQ(true, options->statsOptions().logLinearHistograms());
+}
+
+TEST(OptionsImplTest, NativeBuffers) {
+  std::unique_ptr<OptionsImpl> options =
+      createOptionsImpl("envoy -c hello --use-libevent-buffers 0");
+  EXPECT_EQ(false, options->libeventBuffersEnabled());
 }
 
 TEST(OptionsImplTest, BadCliOption) {
@@ -1,3 +1,4 @@
+#include "common/buffer/slice_pool.h"
 #include "common/common/version.h"
 #include "common/network/address_impl.h"
 #include "common/thread_local/thread_local_impl.h"
@@ -5,6 +6,7 @@
 #include "server/server.h"
 
 #include "test/integration/server.h"
+#include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/stats/mocks.h"
 #include "test/test_common/environment.h"
@@ -18,8 +20,10 @@ using testing::HasSubstr;
 using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
+using testing::NiceMock;
 using testing::Property;
 using testing::Ref;
+using testing::Return;
 using testing::SaveArg;
 using testing::StrictMock;
 
@@ -49,6 +53,58 @@ TEST(ServerInstanceUtil, flushHelper) {
   InstanceUtil::flushMetricsToSinks(sinks, source);
 }
 
+TEST(ServerInstanceUtil, UpdateBufferPoolWatermarks) {
+  const uint64_t size = Buffer::SlicePool::PageSize;
+  Buffer::SlicePool::drainThreadCache();
+  NiceMock<Runtime::MockSnapshot> snapshot;
+  ON_CALL(snapshot, getInteger("buffer.pool.high_watermark_bytes", _))
+      .WillByDefault(Return(4 * size));
+  ON_CALL(snapshot, getInteger("buffer.pool.low_watermark_bytes", _))
+      .WillByDefault(Return(2 * size));
+  InstanceUtil::updateBufferPoolWatermarks(snapshot);
+
+  // Crossing the high watermark trims the pool of the thread down to the low watermark.
+  std::vector<void*> blocks;
+  for (int i = 0; i < 5; i++) {
+    blocks.push_back(Buffer::SlicePool::allocate(size));
+  }
+  for (void* block : blocks) {
+    Buffer::SlicePool::release(block, size);
+  }
+  EXPECT_EQ(2 * size, Buffer::SlicePool::stats().resident_bytes_);
+
+  // A low watermark above the high one is capped at it.
+  ON_CALL(snapshot, getInteger("buffer.pool.low_watermark_bytes", _))
+      .WillByDefault(Return(8 * size));
+  InstanceUtil::updateBufferPoolWatermarks(snapshot);
+  Buffer::SlicePool::drainThreadCache();
+  blocks.clear();
+  for (int i = 0; i < 5; i++) {
+    blocks.push_back(Buffer::SlicePool::allocate(size));
+  }
+  for (void* block : blocks) {
+    Buffer::SlicePool::release(block, size);
+  }
+  EXPECT_EQ(4 * size, Buffer::SlicePool::stats().resident_bytes_);
+
+  // Without runtime overrides, the defaults apply: the cache holds up to the default high
+  // watermark and is trimmed to the default low watermark once it crosses it.
+  NiceMock<Runtime::MockSnapshot> default_snapshot;
+  InstanceUtil::updateBufferPoolWatermarks(default_snapshot);
+  Buffer::SlicePool::drainThreadCache();
+  blocks.clear();
+  for (uint64_t i = 0; i <= Buffer::SlicePool::DefaultHighWatermark / size; i++) {
+    blocks.push_back(Buffer::SlicePool::allocate(size));
+  }
+  for (uint64_t i = 0; i < Buffer::SlicePool::DefaultHighWatermark / size; i++) {
+    Buffer::SlicePool::release(blocks[i], size);
+  }
+  EXPECT_EQ(Buffer::SlicePool::DefaultHighWatermark, Buffer::SlicePool::stats().resident_bytes_);
+  Buffer::SlicePool::release(blocks.back(), size);
+  EXPECT_EQ(Buffer::SlicePool::DefaultLowWatermark, Buffer::SlicePool::stats().resident_bytes_);
+  Buffer::SlicePool::drainThreadCache();
+}
+
 class RunHelperTest : public testing::Test {
 public:
   RunHelperTest() {